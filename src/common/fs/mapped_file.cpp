@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/fs/file.h"
+#include "common/fs/mapped_file.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+
+namespace Common::FS {
+
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    Open(path);
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    Close();
+    Swap(other);
+    return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path, bool allow_fallback) {
+    Close();
+
+#ifdef _WIN32
+    const HANDLE file_handle = CreateFileW(path.c_str(), GENERIC_READ,
+                                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER file_size{};
+        if (GetFileSizeEx(file_handle, &file_size) && file_size.QuadPart == 0) {
+            is_open = true;
+        } else if (file_size.QuadPart > 0) {
+            const HANDLE map_handle =
+                CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (map_handle != nullptr) {
+                mapping = MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+                if (mapping != nullptr) {
+                    mapping_handle = map_handle;
+                    data = static_cast<const u8*>(mapping);
+                    size = static_cast<size_t>(file_size.QuadPart);
+                    is_open = true;
+                } else {
+                    CloseHandle(map_handle);
+                }
+            }
+        }
+        CloseHandle(file_handle);
+    }
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd != -1) {
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat) == 0 && file_stat.st_size == 0) {
+            is_open = true;
+        } else if (file_stat.st_size > 0) {
+            const size_t file_size = static_cast<size_t>(file_stat.st_size);
+            void* const base = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED) {
+                mapping = base;
+                data = static_cast<const u8*>(base);
+                size = file_size;
+                is_open = true;
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    if (is_open) {
+        return true;
+    }
+    if (!allow_fallback) {
+        return false;
+    }
+
+    // Fall back to reading the whole file, this also covers paths the native APIs cannot open.
+    const IOFile file{path, FileAccessMode::Read, FileType::BinaryFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open file at path={}", PathToUTF8String(path));
+        return false;
+    }
+    fallback_buffer.resize(file.GetSize());
+    if (file.ReadSpan(std::span<u8>(fallback_buffer)) != fallback_buffer.size()) {
+        LOG_ERROR(Common_Filesystem, "Failed to read file at path={}", PathToUTF8String(path));
+        fallback_buffer = {};
+        return false;
+    }
+    data = fallback_buffer.data();
+    size = fallback_buffer.size();
+    is_open = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (mapping != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+#else
+        munmap(mapping, size);
+#endif
+        mapping = nullptr;
+    }
+    fallback_buffer = {};
+    data = nullptr;
+    size = 0;
+    is_open = false;
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+    std::swap(mapping, other.mapping);
+#ifdef _WIN32
+    std::swap(mapping_handle, other.mapping_handle);
+#endif
+    std::swap(fallback_buffer, other.fallback_buffer);
+    std::swap(is_open, other.is_open);
+}
+
+} // namespace Common::FS
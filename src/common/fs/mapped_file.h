@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Common::FS {
+
+/**
+ * Read-only view of a whole file mapped into the address space of the process.
+ *
+ * When the host does not support mapping the file (e.g. Android content URIs), the contents are
+ * read into an owned buffer instead, so callers can always rely on Data() for random access.
+ */
+class MappedFile {
+public:
+    MappedFile();
+
+    /**
+     * Maps the file at path for reading.
+     *
+     * @param path Filesystem path
+     */
+    explicit MappedFile(const std::filesystem::path& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * Maps the file at path for reading.
+     * If a file is already mapped, it is unmapped first.
+     *
+     * @param path Filesystem path
+     * @param allow_fallback Whether to read the file into memory when it cannot be mapped
+     *
+     * @returns True if the file contents are accessible, false otherwise.
+     */
+    bool Open(const std::filesystem::path& path, bool allow_fallback = true);
+
+    /// Unmaps the file and releases any owned buffer.
+    void Close();
+
+    /**
+     * Checks whether the file is mapped (or its contents were read into memory).
+     * Empty files are reported as open with a zero-sized view.
+     *
+     * @returns True if the file is open, false otherwise.
+     */
+    [[nodiscard]] bool IsOpen() const {
+        return is_open;
+    }
+
+    /// Returns whether the file is backed by a host memory mapping.
+    [[nodiscard]] bool IsMapped() const {
+        return mapping != nullptr;
+    }
+
+    /// Returns a view of the file contents.
+    [[nodiscard]] std::span<const u8> Data() const {
+        return {data, size};
+    }
+
+    /// Returns the size of the file in bytes.
+    [[nodiscard]] size_t Size() const {
+        return size;
+    }
+
+private:
+    void Swap(MappedFile& other) noexcept;
+
+    const u8* data{};
+    size_t size{};
+    void* mapping{};
+#ifdef _WIN32
+    void* mapping_handle{};
+#endif
+    std::vector<u8> fallback_buffer;
+    bool is_open{};
+};
+
+} // namespace Common::FS
@@ -47,6 +47,18 @@ bool PageTable::ContinueTraversal(TraversalEntry* out_entry, TraversalContext* c
     return true;
 }
 
+std::size_t PageTable::ContiguousMemoryPages(std::size_t page_index, uintptr_t raw,
+                                             std::size_t max_pages) const noexcept {
+    if (max_pages == 0 || PageInfo::ExtractType(raw) != PageType::Memory) {
+        return 0;
+    }
+    std::size_t num_pages = 1;
+    while (num_pages < max_pages && pointers[page_index + num_pages].Raw() == raw) {
+        ++num_pages;
+    }
+    return num_pages;
+}
+
 void PageTable::Resize(std::size_t address_space_width_in_bits, std::size_t page_size_in_bits) {
     const std::size_t num_page_table_entries{1ULL
                                              << (address_space_width_in_bits - page_size_in_bits)};
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 
 #include "common/common_types.h"
@@ -118,6 +119,47 @@ struct PageTable {
         return current_address_space_width_in_bits;
     }
 
+    /**
+     * Returns the number of pages, starting at page_index and up to max_pages, mapped as Memory to
+     * a contiguous host range. Pointers are biased by the address of their page, so the pages of
+     * such a range share the same page info. raw is the page info of the first page, as read by
+     * the caller. Returns zero when it is not Memory or max_pages is zero.
+     */
+    [[nodiscard]] std::size_t ContiguousMemoryPages(std::size_t page_index, uintptr_t raw,
+                                                    std::size_t max_pages) const noexcept;
+
+    /**
+     * Splits a range of the address space in runs of pages and calls
+     * func(vaddr, size, pointer, type) on each of them, in address order. Pages mapped as Memory
+     * to a contiguous host range form a single run, other pages are a run each. The pointer and
+     * type of a run come from a single read of its first page info, entries remapped concurrently
+     * do not split it.
+     */
+    template <std::size_t PageBits, typename Func>
+    void ForEachPageRun(u64 vaddr, std::size_t size, Func&& func) const {
+        constexpr u64 PageSize = u64{1} << PageBits;
+        constexpr u64 PageMask = PageSize - 1;
+        std::size_t page_index = vaddr >> PageBits;
+        std::size_t page_offset = vaddr & PageMask;
+        while (size) {
+            const uintptr_t raw = pointers[page_index].Raw();
+            const PageType type = PageInfo::ExtractType(raw);
+            std::size_t num_pages = 1;
+            if (type == PageType::Memory) {
+                const std::size_t max_pages = (page_offset + size + PageMask) >> PageBits;
+                num_pages = std::max<std::size_t>(
+                    ContiguousMemoryPages(page_index, raw, max_pages), 1);
+            }
+            const std::size_t run_size =
+                std::min<std::size_t>((num_pages << PageBits) - page_offset, size);
+            func(static_cast<u64>((page_index << PageBits) + page_offset), run_size,
+                 PageInfo::ExtractPointer(raw), type);
+            page_index += num_pages;
+            page_offset = 0;
+            size -= run_size;
+        }
+    }
+
     bool GetPhysicalAddress(Common::PhysicalAddress* out_phys_addr,
                             Common::ProcessAddress virt_addr) const {
         if (virt_addr > (1ULL << this->GetAddressSpaceBits())) {
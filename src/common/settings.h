@@ -212,6 +212,13 @@ struct Values {
                                              true,
                                              true,
                                              &use_speed_limit};
+    SwitchableSetting<u8, true> service_host_threads{linkage,
+                                                     1,
+                                                     1,
+                                                     8,
+                                                     "service_host_threads",
+                                                     Category::Core,
+                                                     Specialization::Countable};
 
     // Cpu
     SwitchableSetting<CpuBackend, true> cpu_backend{linkage,
@@ -421,6 +428,12 @@ struct Values {
                                                              Specialization::Default,
                                                              true,
                                                              true};
+    SwitchableSetting<bool> use_pipeline_cache_warmup{linkage, false, "use_pipeline_cache_warmup",
+                                                      Category::RendererAdvanced};
+    SwitchableSetting<bool> use_disk_texture_cache{linkage, false, "use_disk_texture_cache",
+                                                   Category::RendererAdvanced};
+    SwitchableSetting<bool> use_translated_shader_cache{
+        linkage, false, "use_translated_shader_cache", Category::RendererAdvanced};
     SwitchableSetting<bool> enable_compute_pipelines{linkage, false, "enable_compute_pipelines",
                                                      Category::RendererAdvanced};
     SwitchableSetting<bool> use_video_framerate{linkage, false, "use_video_framerate",
@@ -572,6 +585,8 @@ struct Values {
                                         Category::DataStorage};
     Setting<std::string> gamecard_path{linkage, std::string(), "gamecard_path",
                                        Category::DataStorage};
+    Setting<u32, true> fs_block_cache_size{linkage, 64, 0, 1024, "fs_block_cache_size",
+                                           Category::DataStorage};
 
     // Debugging
     bool record_frame_times;
@@ -588,11 +603,24 @@ struct Values {
     Setting<bool> enable_fs_access_log{linkage, false, "enable_fs_access_log", Category::Debugging};
     Setting<bool> reporting_services{
         linkage, false, "reporting_services", Category::Debugging, Specialization::Default, false};
+    Setting<bool> record_ipc_statistics{linkage, false, "record_ipc_statistics",
+                                        Category::Debugging};
     Setting<bool> quest_flag{linkage, false, "quest_flag", Category::Debugging};
     Setting<bool> disable_macro_jit{linkage, false, "disable_macro_jit",
                                     Category::DebuggingGraphics};
     Setting<bool> disable_macro_hle{linkage, false, "disable_macro_hle",
                                     Category::DebuggingGraphics};
+    Setting<bool> profile_macros{linkage, false, "profile_macros", Category::DebuggingGraphics};
+    Setting<bool> verify_macro_hle{linkage, false, "verify_macro_hle",
+                                   Category::DebuggingGraphics};
+    Setting<bool> record_gpu_commands{linkage, false, "record_gpu_commands",
+                                      Category::DebuggingGraphics, Specialization::Default, false};
+    Setting<bool> null_renderer_accounting{linkage,
+                                           false,
+                                           "null_renderer_accounting",
+                                           Category::DebuggingGraphics,
+                                           Specialization::Default,
+                                           false};
     Setting<bool> extended_logging{
         linkage, false, "extended_logging", Category::Debugging, Specialization::Default, false};
     Setting<bool> use_debug_asserts{linkage, false, "use_debug_asserts", Category::Debugging};
@@ -5,7 +5,9 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -114,4 +116,51 @@ private:
 
 using ThreadWorker = StatefulThreadWorker<>;
 
+/**
+ * Calls func(index) for every index in [0, count). Indices are handed out to the workers and to
+ * the calling thread, which keeps running the ones no worker has picked up yet. This is never
+ * slower than a serial loop when the workers are busy, and it's safe to call from a worker.
+ * The first exception thrown by func is rethrown once every index has been processed.
+ */
+template <typename Func>
+void ParallelFor(ThreadWorker& workers, size_t count, Func&& func) {
+    struct State {
+        std::atomic<size_t> next_index{};
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t num_done{};
+        std::exception_ptr exception;
+    };
+    const auto state = std::make_shared<State>();
+    // Tasks still queued after this function returns find no index left and never touch func
+    const auto run = [count, &func](State& shared) {
+        size_t index;
+        while ((index = shared.next_index.fetch_add(1, std::memory_order_relaxed)) < count) {
+            std::exception_ptr exception;
+            try {
+                func(index);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            std::scoped_lock lock{shared.mutex};
+            if (exception && !shared.exception) {
+                shared.exception = exception;
+            }
+            if (++shared.num_done == count) {
+                shared.condition.notify_all();
+            }
+        }
+    };
+    for (size_t task = 1; task < count; ++task) {
+        workers.QueueWork([state, run] { run(*state); });
+    }
+    run(*state);
+
+    std::unique_lock lock{state->mutex};
+    state->condition.wait(lock, [&] { return state->num_done == count; });
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
 } // namespace Common
@@ -41,6 +41,7 @@
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/hle/service/glue/glue_manager.h"
 #include "core/hle/service/glue/time/static.h"
+#include "core/hle/service/ipc_statistics.h"
 #include "core/hle/service/psc/time/static.h"
 #include "core/hle/service/psc/time/steady_clock.h"
 #include "core/hle/service/psc/time/system_clock.h"
@@ -282,6 +283,9 @@ struct System::Impl {
 
         audio_core = std::make_unique<AudioCore::AudioCore>(system);
 
+        if (Settings::values.record_ipc_statistics) {
+            ipc_statistics = std::make_unique<Service::IpcStatistics>();
+        }
         service_manager = std::make_shared<Service::SM::ServiceManager>(kernel);
         services =
             std::make_unique<Service::Services>(service_manager, system, stop_event.get_token());
@@ -416,6 +420,13 @@ struct System::Impl {
                                         perf_stats->GetMeanFrametime());
         }
 
+        if (ipc_statistics) {
+            const auto* const application_process = kernel.ApplicationProcess();
+            ipc_statistics->LogSummary();
+            ipc_statistics->SaveReport(
+                application_process ? application_process->GetProgramId() : 0);
+        }
+
         is_powered_on = false;
         exit_locked = false;
         exit_requested = false;
@@ -432,6 +443,7 @@ struct System::Impl {
         kernel.ShutdownCores();
         services.reset();
         service_manager.reset();
+        ipc_statistics.reset();
         fs_controller.Reset();
         cheat_engine.reset();
         telemetry_session.reset();
@@ -534,6 +546,9 @@ struct System::Impl {
     /// Services
     std::unique_ptr<Service::Services> services;
 
+    /// Statistics of the requests served by services, when enabled
+    std::unique_ptr<Service::IpcStatistics> ipc_statistics;
+
     /// Telemetry session for this emulation session
     std::unique_ptr<Core::TelemetrySession> telemetry_session;
 
@@ -881,6 +896,10 @@ const Reporter& System::GetReporter() const {
     return impl->reporter;
 }
 
+Service::IpcStatistics* System::GetIpcStatistics() {
+    return impl->ipc_statistics.get();
+}
+
 Service::Glue::ARPManager& System::GetARPManager() {
     return impl->arp_manager;
 }
@@ -72,6 +72,7 @@ namespace Glue {
 class ARPManager;
 }
 
+class IpcStatistics;
 class ServerManager;
 
 namespace SM {
@@ -375,6 +376,9 @@ public:
 
     [[nodiscard]] const Reporter& GetReporter() const;
 
+    /// Gets the statistics of the requests served by HLE services, nullptr when not recorded
+    [[nodiscard]] Service::IpcStatistics* GetIpcStatistics();
+
     [[nodiscard]] Service::Glue::ARPManager& GetARPManager();
     [[nodiscard]] const Service::Glue::ARPManager& GetARPManager() const;
 
@@ -2,9 +2,13 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #ifdef _WIN32
 #include "common/windows/timer_resolution.h"
@@ -31,20 +35,269 @@ struct CoreTiming::Event {
     u64 fifo_order;
     std::weak_ptr<EventType> type;
     s64 reschedule_time;
-    heap_t::handle_type handle{};
+
+    // Links owned by the event queue
+    u32 bucket;
+    u32 prev;
+    u32 next;
+    u32 type_prev;
+    u32 type_next;
 
     // Sort by time, unless the times are the same, in which case sort by
     // the order added to the queue
-    friend bool operator>(const Event& left, const Event& right) {
-        return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-    }
-
     friend bool operator<(const Event& left, const Event& right) {
         return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
     }
 };
 
-CoreTiming::CoreTiming() : clock{Common::CreateOptimalClock()} {}
+/**
+ * Hierarchical timing wheel of the pending events.
+ *
+ * Every level has 64 slots, a slot spans 1024ns on the first level and a whole lower level on
+ * the others. An event goes to the level of the highest bit where its time differs from the time
+ * of the wheel, so events of a level always come after the events of the levels below.
+ * Scheduling and unscheduling are O(1), the next event is found in the first occupied slot, moving
+ * the events of a higher level slot down when the lower levels are empty. Events are sorted by
+ * time and scheduling order.
+ */
+class CoreTiming::EventQueue {
+public:
+    using Handle = u32;
+    static constexpr Handle NIL = std::numeric_limits<u32>::max();
+
+    EventQueue() {
+        heads.fill(NIL);
+    }
+
+    ~EventQueue() {
+        Clear();
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return size == 0;
+    }
+
+    [[nodiscard]] Event& operator[](Handle handle) noexcept {
+        return events[handle];
+    }
+
+    void Push(s64 time, u64 fifo_order, const std::shared_ptr<EventType>& type,
+              s64 reschedule_time) {
+        Handle handle;
+        if (free_list != NIL) {
+            handle = free_list;
+            free_list = events[handle].next;
+        } else {
+            handle = static_cast<Handle>(events.size());
+            events.emplace_back();
+        }
+        Event& event{events[handle]};
+        event.time = time;
+        event.fifo_order = fifo_order;
+        event.type = type;
+        event.reschedule_time = reschedule_time;
+
+        event.type_prev = NIL;
+        event.type_next = type->first_pending;
+        if (type->first_pending != NIL) {
+            events[type->first_pending].type_prev = handle;
+        }
+        type->first_pending = handle;
+
+        Link(handle);
+        ++size;
+    }
+
+    /// Removes an event from the queue, the handle may be reused afterwards
+    void Erase(Handle handle) {
+        Unlink(handle);
+
+        Event& event{events[handle]};
+        if (event.type_next != NIL) {
+            events[event.type_next].type_prev = event.type_prev;
+        }
+        if (event.type_prev != NIL) {
+            events[event.type_prev].type_next = event.type_next;
+        } else if (const auto type{event.type.lock()}) {
+            type->first_pending = event.type_next;
+        }
+        event.type.reset();
+        event.bucket = FREE_BUCKET;
+        event.next = free_list;
+        free_list = handle;
+        --size;
+    }
+
+    /// Removes all the pending instances of an event type
+    void EraseType(EventType& type) {
+        while (type.first_pending != NIL) {
+            Erase(type.first_pending);
+        }
+    }
+
+    /// Moves an event to a new time, keeping its handle
+    void Reschedule(Handle handle, s64 time, u64 fifo_order, s64 reschedule_time) {
+        Unlink(handle);
+        Event& event{events[handle]};
+        event.time = time;
+        event.fifo_order = fifo_order;
+        event.reschedule_time = reschedule_time;
+        Link(handle);
+    }
+
+    /// Returns the next event to run, NIL when the queue is empty
+    [[nodiscard]] Handle Top() {
+        while (size != 0) {
+            const auto [level, slot]{FirstOccupiedSlot()};
+            if (level == 0) {
+                return Earliest(slot);
+            }
+            if (level < NUM_LEVELS) {
+                // The lower levels are empty, move the time of the wheel to the start of the slot
+                // and spread its events over the lower levels
+                const u32 shift{LevelShift(level)};
+                const u64 upper_mask{~u64{0} << (shift + SLOT_BITS)};
+                wheel_time = static_cast<s64>((static_cast<u64>(wheel_time) & upper_mask) |
+                                              (static_cast<u64>(slot) << shift));
+                Redistribute(level * SLOTS_PER_LEVEL + slot);
+                continue;
+            }
+            // Only events beyond the range of the wheel are left
+            s64 earliest{std::numeric_limits<s64>::max()};
+            for (Handle it = heads[OVERFLOW_BUCKET]; it != NIL; it = events[it].next) {
+                earliest = std::min(earliest, events[it].time);
+            }
+            wheel_time = earliest;
+            Redistribute(OVERFLOW_BUCKET);
+        }
+        return NIL;
+    }
+
+    /// Removes all events
+    void Clear() {
+        for (Event& event : events) {
+            if (event.bucket == FREE_BUCKET) {
+                continue;
+            }
+            if (const auto type{event.type.lock()}) {
+                type->first_pending = NIL;
+            }
+        }
+        events.clear();
+        heads.fill(NIL);
+        occupied.fill(0);
+        free_list = NIL;
+        size = 0;
+    }
+
+private:
+    static constexpr u32 SLOT_BITS = 6;
+    static constexpr u32 SLOTS_PER_LEVEL = 1U << SLOT_BITS;
+    static constexpr u32 FIRST_LEVEL_SHIFT = 10;
+    static constexpr u32 NUM_LEVELS = 7;
+    static constexpr u32 OVERFLOW_BUCKET = NUM_LEVELS * SLOTS_PER_LEVEL;
+    static constexpr u32 FREE_BUCKET = OVERFLOW_BUCKET + 1;
+
+    static constexpr u32 LevelShift(u32 level) {
+        return FIRST_LEVEL_SHIFT + level * SLOT_BITS;
+    }
+
+    /// Returns the slot of an event relative to the current time of the wheel
+    [[nodiscard]] u32 Bucket(s64 time) const {
+        const u64 wheel{static_cast<u64>(wheel_time)};
+        if (time <= wheel_time) {
+            // Late events run before anything else, together with the ones of the current slot
+            return static_cast<u32>((wheel >> FIRST_LEVEL_SHIFT) % SLOTS_PER_LEVEL);
+        }
+        const u64 target{static_cast<u64>(time)};
+        const u32 highest_bit{static_cast<u32>(std::bit_width(target ^ wheel)) - 1};
+        const u32 level{highest_bit < FIRST_LEVEL_SHIFT
+                            ? 0
+                            : (highest_bit - FIRST_LEVEL_SHIFT) / SLOT_BITS};
+        if (level >= NUM_LEVELS) {
+            return OVERFLOW_BUCKET;
+        }
+        return level * SLOTS_PER_LEVEL +
+               static_cast<u32>((target >> LevelShift(level)) % SLOTS_PER_LEVEL);
+    }
+
+    /// Returns the level and slot of the earliest events, NUM_LEVELS when the wheel is empty
+    [[nodiscard]] std::pair<u32, u32> FirstOccupiedSlot() const {
+        for (u32 level = 0; level < NUM_LEVELS; ++level) {
+            const u64 current{(static_cast<u64>(wheel_time) >> LevelShift(level)) %
+                              SLOTS_PER_LEVEL};
+            const u64 pending{occupied[level] & (~u64{0} << current)};
+            if (pending != 0) {
+                return {level, static_cast<u32>(std::countr_zero(pending))};
+            }
+        }
+        return {NUM_LEVELS, 0};
+    }
+
+    void Link(Handle handle) {
+        Event& event{events[handle]};
+        const u32 bucket{Bucket(event.time)};
+        event.bucket = bucket;
+        event.prev = NIL;
+        event.next = heads[bucket];
+        if (heads[bucket] != NIL) {
+            events[heads[bucket]].prev = handle;
+        }
+        heads[bucket] = handle;
+        if (bucket != OVERFLOW_BUCKET) {
+            occupied[bucket / SLOTS_PER_LEVEL] |= u64{1} << (bucket % SLOTS_PER_LEVEL);
+        }
+    }
+
+    void Unlink(Handle handle) {
+        const Event& event{events[handle]};
+        const u32 bucket{event.bucket};
+        if (event.next != NIL) {
+            events[event.next].prev = event.prev;
+        }
+        if (event.prev != NIL) {
+            events[event.prev].next = event.next;
+        } else {
+            heads[bucket] = event.next;
+        }
+        if (heads[bucket] == NIL && bucket != OVERFLOW_BUCKET) {
+            occupied[bucket / SLOTS_PER_LEVEL] &= ~(u64{1} << (bucket % SLOTS_PER_LEVEL));
+        }
+    }
+
+    void Redistribute(u32 bucket) {
+        Handle it{heads[bucket]};
+        heads[bucket] = NIL;
+        if (bucket != OVERFLOW_BUCKET) {
+            occupied[bucket / SLOTS_PER_LEVEL] &= ~(u64{1} << (bucket % SLOTS_PER_LEVEL));
+        }
+        while (it != NIL) {
+            const Handle next{events[it].next};
+            Link(it);
+            it = next;
+        }
+    }
+
+    [[nodiscard]] Handle Earliest(u32 bucket) const {
+        Handle earliest{heads[bucket]};
+        for (Handle it = events[earliest].next; it != NIL; it = events[it].next) {
+            if (events[it] < events[earliest]) {
+                earliest = it;
+            }
+        }
+        return earliest;
+    }
+
+    std::vector<Event> events;
+    std::array<Handle, OVERFLOW_BUCKET + 1> heads;
+    std::array<u64, NUM_LEVELS> occupied{};
+    Handle free_list{NIL};
+    size_t size{};
+    s64 wheel_time{};
+};
+
+CoreTiming::CoreTiming()
+    : clock{Common::CreateOptimalClock()}, event_queue{std::make_unique<EventQueue>()} {}
 
 CoreTiming::~CoreTiming() {
     Reset();
@@ -73,7 +326,7 @@ void CoreTiming::Initialize(std::function<void()>&& on_thread_init_) {
 
 void CoreTiming::ClearPendingEvents() {
     std::scoped_lock lock{advance_lock, basic_lock};
-    event_queue.clear();
+    event_queue->Clear();
     event.Set();
 }
 
@@ -112,7 +365,7 @@ bool CoreTiming::IsRunning() const {
 
 bool CoreTiming::HasPendingEvents() const {
     std::scoped_lock lock{basic_lock};
-    return !(wait_set && event_queue.empty());
+    return !(wait_set && event_queue->Empty());
 }
 
 void CoreTiming::ScheduleEvent(std::chrono::nanoseconds ns_into_future,
@@ -121,8 +374,7 @@ void CoreTiming::ScheduleEvent(std::chrono::nanoseconds ns_into_future,
         std::scoped_lock scope{basic_lock};
         const auto next_time{absolute_time ? ns_into_future : GetGlobalTimeNs() + ns_into_future};
 
-        auto h{event_queue.emplace(Event{next_time.count(), event_fifo_id++, event_type, 0})};
-        (*h).handle = h;
+        event_queue->Push(next_time.count(), event_fifo_id++, event_type, 0);
     }
 
     event.Set();
@@ -136,9 +388,7 @@ void CoreTiming::ScheduleLoopingEvent(std::chrono::nanoseconds start_time,
         std::scoped_lock scope{basic_lock};
         const auto next_time{absolute_time ? start_time : GetGlobalTimeNs() + start_time};
 
-        auto h{event_queue.emplace(
-            Event{next_time.count(), event_fifo_id++, event_type, resched_time.count()})};
-        (*h).handle = h;
+        event_queue->Push(next_time.count(), event_fifo_id++, event_type, resched_time.count());
     }
 
     event.Set();
@@ -148,19 +398,7 @@ void CoreTiming::UnscheduleEvent(const std::shared_ptr<EventType>& event_type,
                                  UnscheduleEventType type) {
     {
         std::scoped_lock lk{basic_lock};
-
-        std::vector<heap_t::handle_type> to_remove;
-        for (auto itr = event_queue.begin(); itr != event_queue.end(); itr++) {
-            const Event& e = *itr;
-            if (e.type.lock().get() == event_type.get()) {
-                to_remove.push_back(itr->handle);
-            }
-        }
-
-        for (auto& h : to_remove) {
-            event_queue.erase(h);
-        }
-
+        event_queue->EraseType(*event_type);
         event_type->sequence_number++;
     }
 
@@ -201,56 +439,61 @@ std::optional<s64> CoreTiming::Advance() {
     std::scoped_lock lock{advance_lock, basic_lock};
     global_timer = GetGlobalTimeNs().count();
 
-    while (!event_queue.empty() && event_queue.top().time <= global_timer) {
-        const Event& evt = event_queue.top();
-
-        if (const auto event_type{evt.type.lock()}) {
-            const auto evt_time = evt.time;
-            const auto evt_sequence_num = event_type->sequence_number;
-
-            if (evt.reschedule_time == 0) {
-                event_queue.pop();
+    EventQueue::Handle handle{};
+    while ((handle = event_queue->Top()) != EventQueue::NIL &&
+           (*event_queue)[handle].time <= global_timer) {
+        const Event& evt = (*event_queue)[handle];
+        const auto event_type{evt.type.lock()};
+        if (!event_type) {
+            event_queue->Erase(handle);
+            continue;
+        }
+        // The event can't be accessed while the lock is released, new events may move it
+        const auto evt_time = evt.time;
+        const auto evt_reschedule_time = evt.reschedule_time;
+        const auto evt_sequence_num = event_type->sequence_number;
 
-                basic_lock.unlock();
+        if (evt_reschedule_time == 0) {
+            event_queue->Erase(handle);
 
-                event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
+            basic_lock.unlock();
 
-                basic_lock.lock();
-            } else {
-                basic_lock.unlock();
+            event_type->callback(evt_time,
+                                 std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
 
-                const auto new_schedule_time{event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
+            basic_lock.lock();
+        } else {
+            basic_lock.unlock();
 
-                basic_lock.lock();
+            const auto new_schedule_time{event_type->callback(
+                evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
 
-                if (evt_sequence_num != event_type->sequence_number) {
-                    // Heap handle is invalidated after external modification.
-                    continue;
-                }
+            basic_lock.lock();
 
-                const auto next_schedule_time{new_schedule_time.has_value()
-                                                  ? new_schedule_time.value().count()
-                                                  : evt.reschedule_time};
+            if (evt_sequence_num != event_type->sequence_number) {
+                // The event was unscheduled during the callback, its handle is no longer valid.
+                continue;
+            }
 
-                // If this event was scheduled into a pause, its time now is going to be way
-                // behind. Re-set this event to continue from the end of the pause.
-                auto next_time{evt.time + next_schedule_time};
-                if (evt.time < pause_end_time) {
-                    next_time = pause_end_time + next_schedule_time;
-                }
+            const auto next_schedule_time{new_schedule_time.has_value()
+                                              ? new_schedule_time.value().count()
+                                              : evt_reschedule_time};
 
-                event_queue.update(evt.handle, Event{next_time, event_fifo_id++, evt.type,
-                                                     next_schedule_time, evt.handle});
+            // If this event was scheduled into a pause, its time now is going to be way
+            // behind. Re-set this event to continue from the end of the pause.
+            auto next_time{evt_time + next_schedule_time};
+            if (evt_time < pause_end_time) {
+                next_time = pause_end_time + next_schedule_time;
             }
+
+            event_queue->Reschedule(handle, next_time, event_fifo_id++, next_schedule_time);
         }
 
         global_timer = GetGlobalTimeNs().count();
     }
 
-    if (!event_queue.empty()) {
-        return event_queue.top().time;
+    if (handle != EventQueue::NIL) {
+        return (*event_queue)[handle].time;
     } else {
         return std::nullopt;
     }
@@ -6,14 +6,13 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <thread>
 
-#include <boost/heap/fibonacci_heap.hpp>
-
 #include "common/common_types.h"
 #include "common/thread.h"
 #include "common/wall_clock.h"
@@ -36,6 +35,9 @@ struct EventType {
     /// A monotonic sequence number, incremented when this event is
     /// changed externally.
     size_t sequence_number;
+    /// First pending instance of this event in the core timing queue, maintained by CoreTiming
+    /// to unschedule the event without searching the queue.
+    u32 first_pending = std::numeric_limits<u32>::max();
 };
 
 enum class UnscheduleEventType {
@@ -140,6 +142,7 @@ public:
 
 private:
     struct Event;
+    class EventQueue;
 
     static void ThreadEntry(CoreTiming& instance);
     void ThreadLoop();
@@ -154,10 +157,7 @@ private:
     s64 timer_resolution_ns;
 #endif
 
-    using heap_t =
-        boost::heap::fibonacci_heap<CoreTiming::Event, boost::heap::compare<std::greater<>>>;
-
-    heap_t event_queue;
+    std::unique_ptr<EventQueue> event_queue;
     u64 event_fifo_id = 0;
 
     Common::Event event{};
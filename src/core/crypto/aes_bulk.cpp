@@ -0,0 +1,355 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#if defined(ARCHITECTURE_x86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#elif defined(ARCHITECTURE_arm64)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#include <sse2neon.h>
+#pragma GCC diagnostic pop
+#endif
+
+#include "common/assert.h"
+#include "common/swap.h"
+#include "common/thread_worker.h"
+#include "core/crypto/aes_bulk.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
+#if defined(ARCHITECTURE_x86_64) ||                                                                \
+    (defined(ARCHITECTURE_arm64) &&                                                                \
+     ((defined(_M_ARM64) && !defined(__clang__)) || defined(__ARM_FEATURE_CRYPTO)))
+#define HAS_BULK_AES 1
+#endif
+
+namespace Core::Crypto {
+namespace {
+
+constexpr std::size_t AESBlockSize = 0x10;
+
+// Number of blocks kept in flight to hide the latency of the AES round instructions.
+constexpr std::size_t PipelineBlocks = 8;
+
+// Requests at least this large are split into chunks decrypted by the worker threads.
+constexpr std::size_t ParallelThreshold = 0x100000;
+constexpr std::size_t ParallelChunkSize = 0x40000;
+
+struct Counter {
+    u64 high;
+    u64 low;
+};
+
+Counter LoadCounter(const std::array<u8, 0x10>& iv) {
+    Counter counter;
+    std::memcpy(&counter.high, iv.data(), sizeof(u64));
+    std::memcpy(&counter.low, iv.data() + sizeof(u64), sizeof(u64));
+    return {Common::swap64(counter.high), Common::swap64(counter.low)};
+}
+
+void AdvanceCounter(Counter& counter, u64 value) {
+    const u64 low = counter.low + value;
+    if (low < counter.low) {
+        ++counter.high;
+    }
+    counter.low = low;
+}
+
+Common::ThreadWorker& GetWorkers() {
+    static Common::ThreadWorker workers{
+        std::max<std::size_t>(std::thread::hardware_concurrency() / 2, 1), "CryptoWorker"};
+    return workers;
+}
+
+/// Calls func(offset, length) over size bytes, splitting the range into granularity aligned
+/// chunks processed by the worker threads when it is large enough. Returns once all chunks are
+/// done.
+template <typename Func>
+void ForEachChunk(std::size_t size, std::size_t granularity, Func&& func) {
+    if (size < ParallelThreshold) {
+        func(0, size);
+        return;
+    }
+
+    const std::size_t chunk_size =
+        std::max(granularity, ParallelChunkSize / granularity * granularity);
+    const std::size_t num_chunks = (size + chunk_size - 1) / chunk_size;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t remaining = num_chunks - 1;
+
+    auto& workers = GetWorkers();
+    for (std::size_t chunk = 1; chunk < num_chunks; ++chunk) {
+        workers.QueueWork([&, chunk] {
+            const std::size_t offset = chunk * chunk_size;
+            func(offset, std::min(chunk_size, size - offset));
+
+            std::scoped_lock lock{mutex};
+            if (--remaining == 0) {
+                cv.notify_one();
+            }
+        });
+    }
+
+    // Take the first chunk on the calling thread instead of idling.
+    func(0, std::min(chunk_size, size));
+
+    std::unique_lock lock{mutex};
+    cv.wait(lock, [&] { return remaining == 0; });
+}
+
+#ifdef HAS_BULK_AES
+
+using RoundKeys = std::array<std::array<u8, 0x10>, 11>;
+
+__m128i LoadBlock(const u8* data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+void StoreBlock(u8* data, __m128i block) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), block);
+}
+
+void LoadKeys(const RoundKeys& keys, __m128i (&out)[11]) {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        out[i] = LoadBlock(keys[i].data());
+    }
+}
+
+template <int Rcon>
+__m128i ExpandKeyStep(__m128i key) {
+    const __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, Rcon), 0xff);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+RoundKeys ExpandKey(const u8* key) {
+    __m128i keys[11];
+    keys[0] = LoadBlock(key);
+    keys[1] = ExpandKeyStep<0x01>(keys[0]);
+    keys[2] = ExpandKeyStep<0x02>(keys[1]);
+    keys[3] = ExpandKeyStep<0x04>(keys[2]);
+    keys[4] = ExpandKeyStep<0x08>(keys[3]);
+    keys[5] = ExpandKeyStep<0x10>(keys[4]);
+    keys[6] = ExpandKeyStep<0x20>(keys[5]);
+    keys[7] = ExpandKeyStep<0x40>(keys[6]);
+    keys[8] = ExpandKeyStep<0x80>(keys[7]);
+    keys[9] = ExpandKeyStep<0x1B>(keys[8]);
+    keys[10] = ExpandKeyStep<0x36>(keys[9]);
+
+    RoundKeys out;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        StoreBlock(out[i].data(), keys[i]);
+    }
+    return out;
+}
+
+/// Converts encryption round keys into the keys of the equivalent inverse cipher.
+RoundKeys MakeDecryptKeys(const RoundKeys& keys) {
+    RoundKeys out;
+    out[0] = keys[10];
+    for (std::size_t i = 1; i < 10; ++i) {
+        StoreBlock(out[i].data(), _mm_aesimc_si128(LoadBlock(keys[10 - i].data())));
+    }
+    out[10] = keys[0];
+    return out;
+}
+
+__m128i MakeCounterBlock(const Counter& counter) {
+    return _mm_set_epi64x(static_cast<s64>(Common::swap64(counter.low)),
+                          static_cast<s64>(Common::swap64(counter.high)));
+}
+
+/// Calls func with every index below N as a constant, so that the compiler keeps all blocks of a
+/// pipeline in registers regardless of the optimization level.
+template <std::size_t N, typename Func>
+void Unroll(Func&& func) {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (func(std::integral_constant<std::size_t, I>{}), ...);
+    }(std::make_index_sequence<N>{});
+}
+
+template <std::size_t N>
+void EncryptBlocks(const __m128i (&keys)[11], __m128i (&blocks)[N]) {
+    Unroll<N>([&](auto i) { blocks[i] = _mm_xor_si128(blocks[i], keys[0]); });
+    Unroll<9>([&](auto round) {
+        Unroll<N>([&](auto i) { blocks[i] = _mm_aesenc_si128(blocks[i], keys[round + 1]); });
+    });
+    Unroll<N>([&](auto i) { blocks[i] = _mm_aesenclast_si128(blocks[i], keys[10]); });
+}
+
+template <std::size_t N>
+void DecryptBlocks(const __m128i (&keys)[11], __m128i (&blocks)[N]) {
+    Unroll<N>([&](auto i) { blocks[i] = _mm_xor_si128(blocks[i], keys[0]); });
+    Unroll<9>([&](auto round) {
+        Unroll<N>([&](auto i) { blocks[i] = _mm_aesdec_si128(blocks[i], keys[round + 1]); });
+    });
+    Unroll<N>([&](auto i) { blocks[i] = _mm_aesdeclast_si128(blocks[i], keys[10]); });
+}
+
+__m128i EncryptBlock(const __m128i (&keys)[11], __m128i block) {
+    __m128i blocks[1]{block};
+    EncryptBlocks(keys, blocks);
+    return blocks[0];
+}
+
+/// Multiplies an XTS tweak by x in GF(2^128), using the little-endian convention of IEEE 1619.
+__m128i NextTweak(__m128i tweak) {
+    // Move the top bit of every 32-bit lane into the bottom of the next one, the top bit of the
+    // whole value wraps around as the reduction polynomial.
+    __m128i carry = _mm_shuffle_epi32(_mm_srai_epi32(tweak, 31), 0x93);
+    carry = _mm_and_si128(carry, _mm_set_epi32(1, 1, 1, 0x87));
+    return _mm_xor_si128(_mm_slli_epi32(tweak, 1), carry);
+}
+
+void CTRTranscode(const RoundKeys& round_keys, const u8* src, std::size_t size, u8* dest,
+                  Counter counter) {
+    __m128i keys[11];
+    LoadKeys(round_keys, keys);
+
+    std::size_t offset = 0;
+    for (; offset + PipelineBlocks * AESBlockSize <= size; offset += PipelineBlocks * AESBlockSize) {
+        __m128i blocks[PipelineBlocks];
+        Unroll<PipelineBlocks>([&](auto i) {
+            blocks[i] = MakeCounterBlock(counter);
+            AdvanceCounter(counter, 1);
+        });
+        EncryptBlocks(keys, blocks);
+        Unroll<PipelineBlocks>([&](auto i) {
+            const std::size_t block_offset = offset + i * AESBlockSize;
+            StoreBlock(dest + block_offset,
+                       _mm_xor_si128(LoadBlock(src + block_offset), blocks[i]));
+        });
+    }
+    for (; offset < size; offset += AESBlockSize) {
+        const __m128i keystream = EncryptBlock(keys, MakeCounterBlock(counter));
+        AdvanceCounter(counter, 1);
+
+        const std::size_t length = std::min(AESBlockSize, size - offset);
+        if (length == AESBlockSize) {
+            StoreBlock(dest + offset, _mm_xor_si128(LoadBlock(src + offset), keystream));
+            continue;
+        }
+        std::array<u8, AESBlockSize> block{};
+        std::memcpy(block.data(), src + offset, length);
+        StoreBlock(block.data(), _mm_xor_si128(LoadBlock(block.data()), keystream));
+        std::memcpy(dest + offset, block.data(), length);
+    }
+}
+
+void XTSDecryptSector(const __m128i (&keys)[11], __m128i tweak, const u8* src, std::size_t size,
+                      u8* dest) {
+    std::size_t offset = 0;
+    for (; offset + PipelineBlocks * AESBlockSize <= size; offset += PipelineBlocks * AESBlockSize) {
+        __m128i tweaks[PipelineBlocks];
+        __m128i blocks[PipelineBlocks];
+        Unroll<PipelineBlocks>([&](auto i) {
+            tweaks[i] = tweak;
+            tweak = NextTweak(tweak);
+            blocks[i] = _mm_xor_si128(LoadBlock(src + offset + i * AESBlockSize), tweaks[i]);
+        });
+        DecryptBlocks(keys, blocks);
+        Unroll<PipelineBlocks>([&](auto i) {
+            StoreBlock(dest + offset + i * AESBlockSize, _mm_xor_si128(blocks[i], tweaks[i]));
+        });
+    }
+    for (; offset < size; offset += AESBlockSize) {
+        __m128i block[1]{_mm_xor_si128(LoadBlock(src + offset), tweak)};
+        DecryptBlocks(keys, block);
+        StoreBlock(dest + offset, _mm_xor_si128(block[0], tweak));
+        tweak = NextTweak(tweak);
+    }
+}
+
+void XTSDecrypt(const RoundKeys& decrypt_keys, const RoundKeys& tweak_keys, const u8* src,
+                std::size_t size, u8* dest, std::size_t sector_size, Counter sector) {
+    __m128i keys[11];
+    __m128i tweak_cipher[11];
+    LoadKeys(decrypt_keys, keys);
+    LoadKeys(tweak_keys, tweak_cipher);
+
+    for (std::size_t offset = 0; offset < size; offset += sector_size) {
+        const __m128i tweak = EncryptBlock(tweak_cipher, MakeCounterBlock(sector));
+        AdvanceCounter(sector, 1);
+        XTSDecryptSector(keys, tweak, src + offset, std::min(sector_size, size - offset),
+                         dest + offset);
+    }
+}
+
+#endif
+
+} // Anonymous namespace
+
+bool IsBulkAESSupported() {
+#if defined(ARCHITECTURE_x86_64)
+    return Common::GetCPUCaps().aes;
+#elif defined(HAS_BULK_AES)
+    return true;
+#else
+    return false;
+#endif
+}
+
+BulkCTRCipher::BulkCTRCipher(const Key128& key) {
+#ifdef HAS_BULK_AES
+    round_keys = ExpandKey(key.data());
+#else
+    UNREACHABLE();
+#endif
+}
+
+void BulkCTRCipher::Transcode(const u8* src, std::size_t size, u8* dest, const IVData& iv) const {
+#ifdef HAS_BULK_AES
+    const Counter counter = LoadCounter(iv);
+    ForEachChunk(size, AESBlockSize, [&](std::size_t offset, std::size_t length) {
+        Counter chunk_counter = counter;
+        AdvanceCounter(chunk_counter, offset / AESBlockSize);
+        CTRTranscode(round_keys, src + offset, length, dest + offset, chunk_counter);
+    });
+#else
+    UNREACHABLE();
+#endif
+}
+
+BulkXTSCipher::BulkXTSCipher(const Key256& key) {
+#ifdef HAS_BULK_AES
+    decrypt_keys = MakeDecryptKeys(ExpandKey(key.data()));
+    tweak_keys = ExpandKey(key.data() + 0x10);
+#else
+    UNREACHABLE();
+#endif
+}
+
+void BulkXTSCipher::Decrypt(const u8* src, std::size_t size, u8* dest, std::size_t sector_size,
+                            const IVData& iv) const {
+    ASSERT(sector_size % AESBlockSize == 0 && size % AESBlockSize == 0);
+#ifdef HAS_BULK_AES
+    const Counter sector = LoadCounter(iv);
+    ForEachChunk(size, sector_size, [&](std::size_t offset, std::size_t length) {
+        Counter chunk_sector = sector;
+        AdvanceCounter(chunk_sector, offset / sector_size);
+        XTSDecrypt(decrypt_keys, tweak_keys, src + offset, length, dest + offset, sector_size,
+                   chunk_sector);
+    });
+#else
+    UNREACHABLE();
+#endif
+}
+
+} // namespace Core::Crypto
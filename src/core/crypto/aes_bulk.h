@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "common/common_types.h"
+#include "core/crypto/key_manager.h"
+
+namespace Core::Crypto {
+
+/// Returns whether the host has the AES instructions needed by the bulk ciphers.
+[[nodiscard]] bool IsBulkAESSupported();
+
+/**
+ * AES-128-CTR for bulk storage reads.
+ *
+ * Several counter blocks are pipelined through the hardware AES units (AES-NI on x86_64, the
+ * ARMv8 cryptography extensions on arm64) and large requests are split across worker threads.
+ * Must only be used when IsBulkAESSupported() returns true. Instances hold no per-call state and
+ * can be shared between threads.
+ */
+class BulkCTRCipher {
+public:
+    using IVData = std::array<u8, 0x10>;
+
+    explicit BulkCTRCipher(const Key128& key);
+
+    /**
+     * Transcodes size bytes from src into dest. src and dest may be the same buffer.
+     *
+     * @param iv Big-endian counter of the first block
+     */
+    void Transcode(const u8* src, std::size_t size, u8* dest, const IVData& iv) const;
+
+private:
+    alignas(16) std::array<IVData, 11> round_keys;
+};
+
+/**
+ * AES-128-XTS decryption for bulk storage reads, with the big-endian sector tweaks used by NCAs.
+ *
+ * Same requirements and guarantees as BulkCTRCipher.
+ */
+class BulkXTSCipher {
+public:
+    using IVData = std::array<u8, 0x10>;
+
+    /// key holds the data key followed by the tweak key, matching AESCipher<Key256> in XTS mode.
+    explicit BulkXTSCipher(const Key256& key);
+
+    /**
+     * Decrypts size bytes from src into dest. src and dest may be the same buffer.
+     * size must be a multiple of the AES block size; the last sector may be shorter than the rest.
+     *
+     * @param sector_size Size of each sector, a multiple of the AES block size
+     * @param iv          Tweak of the first sector, incremented by one for every following sector
+     */
+    void Decrypt(const u8* src, std::size_t size, u8* dest, std::size_t sector_size,
+                 const IVData& iv) const;
+
+private:
+    alignas(16) std::array<IVData, 11> decrypt_keys;
+    alignas(16) std::array<IVData, 11> tweak_keys;
+};
+
+} // namespace Core::Crypto
@@ -72,7 +72,9 @@ void AESCipher<Key, KeySize>::Transcode(const u8* src, std::size_t size, u8* des
     mbedtls_cipher_reset(context);
 
     std::size_t written = 0;
-    if (mbedtls_cipher_get_cipher_mode(context) == MBEDTLS_MODE_XTS) {
+    const auto mode = mbedtls_cipher_get_cipher_mode(context);
+    if (mode == MBEDTLS_MODE_XTS || mode == MBEDTLS_MODE_CTR) {
+        // Stream and whole data unit modes can process the entire buffer in a single call.
         mbedtls_cipher_update(context, src, size, dest, &written);
         if (written != size) {
             LOG_WARNING(Crypto, "Not all data was decrypted requested={:016X}, actual={:016X}.",
@@ -242,6 +242,11 @@ size_t AesCtrCounterExtendedStorage::Read(u8* buffer, size_t size, size_t offset
 void SoftwareDecryptor::Decrypt(u8* buf, size_t buf_size,
                                 const std::array<u8, AesCtrCounterExtendedStorage::KeySize>& key,
                                 const std::array<u8, AesCtrCounterExtendedStorage::IvSize>& iv) {
+    if (Core::Crypto::IsBulkAESSupported()) {
+        Core::Crypto::BulkCTRCipher(key).Transcode(buf, buf_size, buf, iv);
+        return;
+    }
+
     Core::Crypto::AESCipher<Core::Crypto::Key128, AesCtrCounterExtendedStorage::KeySize> cipher(
         key, Core::Crypto::Mode::CTR);
     cipher.SetIV(iv);
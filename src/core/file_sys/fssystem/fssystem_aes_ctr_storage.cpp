@@ -33,6 +33,9 @@ AesCtrStorage::AesCtrStorage(VirtualFile base, const void* key, size_t key_size,
     std::memcpy(m_iv.data(), iv, IvSize);
 
     m_cipher.emplace(m_key, Core::Crypto::Mode::CTR);
+    if (Core::Crypto::IsBulkAESSupported()) {
+        m_bulk_cipher.emplace(m_key);
+    }
 }
 
 size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
@@ -48,8 +51,14 @@ size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
     ASSERT(Common::IsAligned(offset, BlockSize));
     ASSERT(Common::IsAligned(size, BlockSize));
 
-    // Read the data.
-    m_base_storage->Read(buffer, size, offset);
+    // Decrypt straight out of the base storage when it is directly addressable, otherwise read
+    // the data and decrypt it in place.
+    const u8* src = buffer;
+    if (const auto span = m_base_storage->ReadSpan(size, offset); span.size() == size) {
+        src = span.data();
+    } else {
+        m_base_storage->Read(buffer, size, offset);
+    }
 
     // Setup the counter.
     std::array<u8, IvSize> ctr;
@@ -57,8 +66,13 @@ size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
     AddCounter(ctr.data(), IvSize, offset / BlockSize);
 
     // Decrypt.
-    m_cipher->SetIV(ctr);
-    m_cipher->Transcode(buffer, size, buffer, Core::Crypto::Op::Decrypt);
+    if (m_bulk_cipher) {
+        m_bulk_cipher->Transcode(src, size, buffer, ctr);
+    } else {
+        std::scoped_lock lk{m_cipher_mutex};
+        m_cipher->SetIV(ctr);
+        m_cipher->Transcode(src, size, buffer, Core::Crypto::Op::Decrypt);
+    }
 
     return size;
 }
@@ -104,9 +118,12 @@ size_t AesCtrStorage::Write(const u8* buffer, size_t size, size_t offset) {
         }
 
         // Encrypt the data.
-        m_cipher->SetIV(ctr);
-        m_cipher->Transcode(buffer, write_size, reinterpret_cast<u8*>(write_buf),
-                            Core::Crypto::Op::Encrypt);
+        {
+            std::scoped_lock lk{m_cipher_mutex};
+            m_cipher->SetIV(ctr);
+            m_cipher->Transcode(buffer, write_size, reinterpret_cast<u8*>(write_buf),
+                                Core::Crypto::Op::Encrypt);
+        }
 
         // Write the encrypted data.
         m_base_storage->Write(reinterpret_cast<u8*>(write_buf), write_size, offset + cur_offset);
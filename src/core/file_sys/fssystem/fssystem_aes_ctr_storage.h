@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <mutex>
 #include <optional>
 
+#include "core/crypto/aes_bulk.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/errors.h"
@@ -38,6 +40,8 @@ private:
     std::array<u8, KeySize> m_key;
     std::array<u8, IvSize> m_iv;
     mutable std::optional<Core::Crypto::AESCipher<Core::Crypto::Key128>> m_cipher;
+    mutable std::mutex m_cipher_mutex;
+    std::optional<Core::Crypto::BulkCTRCipher> m_bulk_cipher;
 };
 
 } // namespace FileSys
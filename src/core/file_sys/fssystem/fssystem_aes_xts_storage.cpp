@@ -36,6 +36,9 @@ AesXtsStorage::AesXtsStorage(VirtualFile base, const void* key1, const void* key
     std::memcpy(m_iv.data(), iv, IvSize);
 
     m_cipher.emplace(m_key, Core::Crypto::Mode::XTS);
+    if (Core::Crypto::IsBulkAESSupported()) {
+        m_bulk_cipher.emplace(m_key);
+    }
 }
 
 size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
@@ -75,9 +78,15 @@ size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
             std::memset(tmp_buf.GetBuffer(), 0, skip_size);
             std::memcpy(tmp_buf.GetBuffer() + skip_size, buffer, data_size);
 
-            m_cipher->SetIV(ctr);
-            m_cipher->Transcode(tmp_buf.GetBuffer(), m_block_size, tmp_buf.GetBuffer(),
-                                Core::Crypto::Op::Decrypt);
+            if (m_bulk_cipher) {
+                u8* const tmp = reinterpret_cast<u8*>(tmp_buf.GetBuffer());
+                m_bulk_cipher->Decrypt(tmp, m_block_size, tmp, m_block_size, ctr);
+            } else {
+                std::scoped_lock lk{m_mutex};
+                m_cipher->SetIV(ctr);
+                m_cipher->Transcode(tmp_buf.GetBuffer(), m_block_size, tmp_buf.GetBuffer(),
+                                    Core::Crypto::Op::Decrypt);
+            }
 
             std::memcpy(buffer, tmp_buf.GetBuffer() + skip_size, data_size);
         }
@@ -87,7 +96,15 @@ size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
         ASSERT(processed_size == std::min(size, m_block_size - skip_size));
     }
 
+    // Decrypt all aligned sectors in one batch when possible.
+    if (m_bulk_cipher) {
+        m_bulk_cipher->Decrypt(buffer + processed_size, size - processed_size,
+                               buffer + processed_size, m_block_size, ctr);
+        return size;
+    }
+
     // Decrypt aligned chunks.
+    std::scoped_lock lk{m_mutex};
     char* cur = reinterpret_cast<char*>(buffer) + processed_size;
     size_t remaining = size - processed_size;
     while (remaining > 0) {
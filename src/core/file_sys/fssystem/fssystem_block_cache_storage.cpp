@@ -0,0 +1,236 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/div_ceil.h"
+#include "core/file_sys/fssystem/fssystem_block_cache_storage.h"
+
+namespace FileSys {
+
+namespace {
+
+struct BlockKey {
+    u64 storage_id;
+    u64 block_index;
+
+    bool operator==(const BlockKey&) const = default;
+};
+
+struct BlockKeyHash {
+    size_t operator()(const BlockKey& key) const noexcept {
+        return static_cast<size_t>((key.storage_id * 0x9E3779B97F4A7C15ULL) ^ key.block_index);
+    }
+};
+
+// Process-wide block cache, split into shards with their own lock and LRU list so concurrent
+// readers of different blocks rarely contend.
+class BlockCache {
+public:
+    static constexpr size_t NumShards = 16;
+
+    static BlockCache& Instance() {
+        static BlockCache cache;
+        return cache;
+    }
+
+    void SetCapacity(size_t capacity) {
+        for (auto& shard : m_shards) {
+            std::scoped_lock lk{shard.mutex};
+            shard.capacity = capacity / NumShards;
+            shard.EvictLocked();
+        }
+    }
+
+    bool Contains(const BlockKey& key) {
+        auto& shard = GetShard(key);
+        std::scoped_lock lk{shard.mutex};
+        return shard.map.contains(key);
+    }
+
+    // Copies size bytes starting at offset within the block to out, returns false on a miss.
+    bool Lookup(const BlockKey& key, u8* out, size_t offset, size_t size) {
+        auto& shard = GetShard(key);
+        std::scoped_lock lk{shard.mutex};
+        const auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        std::memcpy(out, it->second->data.data() + offset, size);
+        return true;
+    }
+
+    void Insert(const BlockKey& key, const u8* data, size_t size) {
+        auto& shard = GetShard(key);
+        std::scoped_lock lk{shard.mutex};
+        if (shard.capacity < size || shard.map.contains(key)) {
+            return;
+        }
+        shard.lru.push_front(Entry{key, std::vector<u8>(data, data + size)});
+        shard.map.emplace(key, shard.lru.begin());
+        shard.size += size;
+        shard.EvictLocked();
+    }
+
+    void Erase(u64 storage_id) {
+        for (auto& shard : m_shards) {
+            std::scoped_lock lk{shard.mutex};
+            for (auto it = shard.lru.begin(); it != shard.lru.end();) {
+                if (it->key.storage_id != storage_id) {
+                    ++it;
+                    continue;
+                }
+                shard.size -= it->data.size();
+                shard.map.erase(it->key);
+                it = shard.lru.erase(it);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        BlockKey key;
+        std::vector<u8> data;
+    };
+
+    struct Shard {
+        void EvictLocked() {
+            while (size > capacity && !lru.empty()) {
+                size -= lru.back().data.size();
+                map.erase(lru.back().key);
+                lru.pop_back();
+            }
+        }
+
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<BlockKey, std::list<Entry>::iterator, BlockKeyHash> map;
+        size_t size{};
+        size_t capacity{};
+    };
+
+    Shard& GetShard(const BlockKey& key) {
+        // Consecutive blocks of a storage land on different shards.
+        return m_shards[(key.storage_id + key.block_index) % NumShards];
+    }
+
+    std::array<Shard, NumShards> m_shards;
+};
+
+std::atomic<u64> g_next_storage_id{};
+std::atomic<bool> g_cache_enabled{};
+
+} // Anonymous namespace
+
+BlockCacheStorage::BlockCacheStorage(VirtualFile base)
+    : m_base_storage(std::move(base)), m_size(m_base_storage->GetSize()),
+      m_id(g_next_storage_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+BlockCacheStorage::~BlockCacheStorage() {
+    BlockCache::Instance().Erase(m_id);
+}
+
+void BlockCacheStorage::SetCacheSize(size_t size) {
+    BlockCache::Instance().SetCapacity(size);
+    g_cache_enabled.store(size != 0, std::memory_order_relaxed);
+}
+
+size_t BlockCacheStorage::GetSize() const {
+    return m_size;
+}
+
+size_t BlockCacheStorage::Read(u8* buffer, size_t size, size_t offset) const {
+    if (offset >= m_size) {
+        return 0;
+    }
+    size = std::min(size, m_size - offset);
+    if (size == 0) {
+        return 0;
+    }
+
+    const size_t read_ahead = this->UpdateReadAhead(offset, size);
+    if (size >= BypassSize || !g_cache_enabled.load(std::memory_order_relaxed)) {
+        return m_base_storage->Read(buffer, size, offset);
+    }
+    return this->ReadBlocks(buffer, size, offset, read_ahead);
+}
+
+size_t BlockCacheStorage::UpdateReadAhead(size_t offset, size_t size) const {
+    // Grow the window while reads continue where the previous one ended, reset it otherwise.
+    const size_t expected = m_next_sequential_offset.exchange(offset + size);
+    if (offset != expected) {
+        m_read_ahead_blocks.store(0, std::memory_order_relaxed);
+        return 0;
+    }
+    const size_t current = m_read_ahead_blocks.load(std::memory_order_relaxed);
+    const size_t next = std::min(std::max<size_t>(current * 2, 1), MaxReadAheadBlocks);
+    m_read_ahead_blocks.store(next, std::memory_order_relaxed);
+    return next;
+}
+
+size_t BlockCacheStorage::ReadBlocks(u8* buffer, size_t size, size_t offset,
+                                     size_t read_ahead) const {
+    auto& cache = BlockCache::Instance();
+    const auto make_key = [this](size_t block) { return BlockKey{m_id, block}; };
+
+    const size_t end_offset = offset + size;
+    const size_t last_block = (end_offset - 1) / BlockSize;
+    const size_t num_blocks = Common::DivCeil(m_size, BlockSize);
+
+    std::vector<u8> run_buffer;
+    size_t block = offset / BlockSize;
+    while (block <= last_block) {
+        // Copy the requested part of the block if it is cached.
+        const size_t block_offset = block * BlockSize;
+        const size_t copy_begin = std::max(offset, block_offset);
+        const size_t copy_end = std::min(end_offset, block_offset + BlockSize);
+        if (cache.Lookup(make_key(block), buffer + (copy_begin - offset),
+                         copy_begin - block_offset, copy_end - copy_begin)) {
+            ++block;
+            continue;
+        }
+
+        // Gather the run of missing blocks starting here. When it reaches the end of the request,
+        // extend it by the read-ahead window.
+        size_t run_end = block + 1;
+        while (run_end <= last_block && !cache.Contains(make_key(run_end))) {
+            ++run_end;
+        }
+        if (run_end > last_block) {
+            const size_t ahead_end = std::min(num_blocks, last_block + 1 + read_ahead);
+            while (run_end < ahead_end && !cache.Contains(make_key(run_end))) {
+                ++run_end;
+            }
+        }
+
+        // Read the whole run from the base storage with a single request.
+        const size_t run_offset = block_offset;
+        const size_t run_size = std::min(run_end * BlockSize, m_size) - run_offset;
+        run_buffer.resize(run_size);
+        if (m_base_storage->Read(run_buffer.data(), run_size, run_offset) != run_size) {
+            return m_base_storage->Read(buffer, size, offset);
+        }
+
+        for (size_t i = block; i < run_end; ++i) {
+            const size_t data_offset = (i - block) * BlockSize;
+            cache.Insert(make_key(i), run_buffer.data() + data_offset,
+                         std::min(BlockSize, run_size - data_offset));
+        }
+
+        const size_t run_copy_end = std::min(end_offset, run_offset + run_size);
+        std::memcpy(buffer + (copy_begin - offset), run_buffer.data() + (copy_begin - run_offset),
+                    run_copy_end - copy_begin);
+        block = std::min(run_end, last_block + 1);
+    }
+
+    return size;
+}
+
+} // namespace FileSys
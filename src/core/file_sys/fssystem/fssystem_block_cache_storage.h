@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+
+#include "core/file_sys/fssystem/fs_i_storage.h"
+
+namespace FileSys {
+
+// Caches fixed-size blocks of a storage in a process-wide, size-bounded LRU cache, so repeated
+// small reads do not travel through the decryption and verification layers below again.
+// Sequential access is detected per storage and grows a read-ahead window, batching the reads
+// issued to the base storage.
+class BlockCacheStorage : public IReadOnlyStorage {
+    SUYU_NON_COPYABLE(BlockCacheStorage);
+    SUYU_NON_MOVEABLE(BlockCacheStorage);
+
+public:
+    static constexpr size_t BlockSize = 0x4000;
+    static constexpr size_t MaxReadAheadBlocks = 16;
+
+    // Reads at least this large are served directly from the base storage.
+    static constexpr size_t BypassSize = 0x40000;
+
+public:
+    explicit BlockCacheStorage(VirtualFile base);
+    ~BlockCacheStorage() override;
+
+    virtual size_t Read(u8* buffer, size_t size, size_t offset) const override;
+    virtual size_t GetSize() const override;
+
+    // Sets the combined capacity of the block caches of all storages, zero disables caching.
+    static void SetCacheSize(size_t size);
+
+private:
+    size_t ReadBlocks(u8* buffer, size_t size, size_t offset, size_t read_ahead) const;
+    size_t UpdateReadAhead(size_t offset, size_t size) const;
+
+    VirtualFile m_base_storage;
+    size_t m_size;
+    u64 m_id;
+    mutable std::atomic<size_t> m_next_sequential_offset{};
+    mutable std::atomic<size_t> m_read_ahead_blocks{};
+};
+
+} // namespace FileSys
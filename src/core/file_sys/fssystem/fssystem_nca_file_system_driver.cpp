@@ -1,10 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project & 2024 suyu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/settings.h"
 #include "core/file_sys/fssystem/fssystem_aes_ctr_counter_extended_storage.h"
 #include "core/file_sys/fssystem/fssystem_aes_ctr_storage.h"
 #include "core/file_sys/fssystem/fssystem_aes_xts_storage.h"
 #include "core/file_sys/fssystem/fssystem_alignment_matching_storage.h"
+#include "core/file_sys/fssystem/fssystem_block_cache_storage.h"
 #include "core/file_sys/fssystem/fssystem_compressed_storage.h"
 #include "core/file_sys/fssystem/fssystem_hierarchical_integrity_verification_storage.h"
 #include "core/file_sys/fssystem/fssystem_hierarchical_sha256_storage.h"
@@ -286,7 +288,19 @@ Result NcaFileSystemDriver::OpenStorageImpl(VirtualFile* out, NcaFsHeaderReader*
     }
 
     // Create the non-raw storage.
-    R_RETURN(this->CreateStorageByRawStorage(out, out_header_reader, std::move(storage), ctx));
+    R_TRY(this->CreateStorageByRawStorage(std::addressof(storage), out_header_reader,
+                                          std::move(storage), ctx));
+
+    // Cache blocks above the decryption and verification layers, if enabled.
+    const size_t block_cache_size =
+        static_cast<size_t>(Settings::values.fs_block_cache_size.GetValue()) * 1024 * 1024;
+    BlockCacheStorage::SetCacheSize(block_cache_size);
+    if (block_cache_size != 0) {
+        storage = std::make_shared<BlockCacheStorage>(std::move(storage));
+    }
+
+    *out = std::move(storage);
+    R_SUCCEED();
 }
 
 Result NcaFileSystemDriver::CreateStorageByRawStorage(VirtualFile* out,
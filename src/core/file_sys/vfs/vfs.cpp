@@ -162,6 +162,10 @@ std::string VfsFile::GetExtension() const {
 
 VfsDirectory::~VfsDirectory() = default;
 
+std::span<const u8> VfsFile::ReadSpan(std::size_t length, std::size_t offset) const {
+    return {};
+}
+
 std::optional<u8> VfsFile::ReadByte(std::size_t offset) const {
     u8 out{};
     const std::size_t size = Read(&out, sizeof(u8), offset);
@@ -507,10 +511,19 @@ bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t blo
     if (!dest->Resize(src->GetSize()))
         return false;
 
-    std::vector<u8> temp(std::min(block_size, src->GetSize()));
+    std::vector<u8> temp;
     for (std::size_t i = 0; i < src->GetSize(); i += block_size) {
         const auto read = std::min(block_size, src->GetSize() - i);
 
+        // Write straight out of the source storage when it is directly addressable.
+        if (const auto span = src->ReadSpan(read, i); span.size() == read) {
+            if (dest->Write(span.data(), read, i) != read) {
+                return false;
+            }
+            continue;
+        }
+
+        temp.resize(std::min(block_size, src->GetSize()));
         if (src->Read(temp.data(), read, i) != read) {
             return false;
         }
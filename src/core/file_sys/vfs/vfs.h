@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -110,6 +111,12 @@ public:
     // into file. Returns number of bytes successfully written.
     virtual std::size_t Write(const u8* data, std::size_t length, std::size_t offset = 0) = 0;
 
+    // Returns a view of length bytes starting at offset directly into the storage backing the
+    // file, avoiding the copy made by Read. The view stays valid for as long as the file is alive.
+    // Returns an empty span if the file has no directly addressable storage or the range is out of
+    // bounds, in which case callers must fall back to Read.
+    virtual std::span<const u8> ReadSpan(std::size_t length, std::size_t offset = 0) const;
+
     // Reads exactly one byte at the offset provided, returning std::nullopt on error.
     virtual std::optional<u8> ReadByte(std::size_t offset = 0) const;
     // Reads size bytes starting at offset in file into a vector.
@@ -185,6 +185,28 @@ std::size_t ConcatenatedVfsFile::Write(const u8* data, std::size_t length, std::
     return 0;
 }
 
+std::span<const u8> ConcatenatedVfsFile::ReadSpan(std::size_t length, std::size_t offset) const {
+    const ConcatenationEntry key{
+        .offset = offset,
+        .file = nullptr,
+    };
+
+    if (concatenation_map.empty()) {
+        return {};
+    }
+
+    // Only ranges contained within a single file can be exposed directly.
+    const auto it =
+        std::prev(std::upper_bound(concatenation_map.begin(), concatenation_map.end(), key));
+    const u64 file_seek = offset - it->offset;
+    const u64 file_size = it->file->GetSize();
+    if (file_seek > file_size || length > file_size - file_seek) {
+        return {};
+    }
+
+    return it->file->ReadSpan(length, file_seek);
+}
+
 bool ConcatenatedVfsFile::Rename(std::string_view new_name) {
     return false;
 }
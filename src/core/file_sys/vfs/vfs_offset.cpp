@@ -55,6 +55,13 @@ std::size_t OffsetVfsFile::Write(const u8* data, std::size_t length, std::size_t
     return file->Write(data, TrimToFit(length, r_offset), offset + r_offset);
 }
 
+std::span<const u8> OffsetVfsFile::ReadSpan(std::size_t length, std::size_t r_offset) const {
+    if (r_offset > size || length > size - r_offset) {
+        return {};
+    }
+    return file->ReadSpan(length, offset + r_offset);
+}
+
 std::optional<u8> OffsetVfsFile::ReadByte(std::size_t r_offset) const {
     if (r_offset >= size) {
         return std::nullopt;
@@ -3,11 +3,13 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
 #include <utility>
 #include "common/assert.h"
 #include "common/fs/file.h"
 #include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
 #include "common/fs/path_util.h"
 #include "common/logging/log.h"
 #include "core/file_sys/vfs/vfs.h"
@@ -32,6 +34,9 @@ namespace {
 
 constexpr size_t MaxOpenFiles = 512;
 
+// Files at least this large are mapped instead of read through an IOFile when opened read-only.
+constexpr size_t MinMappedFileSize = 64 * 1024 * 1024;
+
 constexpr FS::FileAccessMode ModeFlagsToFileAccessMode(OpenMode mode) {
     switch (mode) {
     case OpenMode::Read:
@@ -315,6 +320,16 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (const auto* const mapped = GetMapping(); mapped != nullptr) {
+        const auto contents = mapped->Data();
+        if (offset >= contents.size()) {
+            return 0;
+        }
+        const std::size_t read_size = std::min(length, contents.size() - offset);
+        std::memcpy(data, contents.data() + offset, read_size);
+        return read_size;
+    }
+
     auto lk = base.RefreshReference(path, perms, *reference);
     if (!reference->file || !reference->file->Seek(static_cast<s64>(offset))) {
         return 0;
@@ -331,10 +346,48 @@ std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t o
     return reference->file->WriteSpan(std::span{data, length});
 }
 
+std::span<const u8> RealVfsFile::ReadSpan(std::size_t length, std::size_t offset) const {
+    const auto* const mapped = GetMapping();
+    if (mapped == nullptr) {
+        return {};
+    }
+    const auto contents = mapped->Data();
+    if (offset > contents.size() || length > contents.size() - offset) {
+        return {};
+    }
+    return contents.subspan(offset, length);
+}
+
 bool RealVfsFile::Rename(std::string_view name) {
     return base.MoveFile(path, parent_path + '/' + std::string(name)) != nullptr;
 }
 
+const FS::MappedFile* RealVfsFile::GetMapping() const {
+    std::call_once(mapping_flag, [this] {
+        // Only map files that cannot change underneath the mapping through this object.
+        if (perms != OpenMode::Read) {
+            return;
+        }
+#ifdef ANDROID
+        // Content URIs cannot be mapped.
+        if (path[0] != '/') {
+            return;
+        }
+#endif
+        if (GetSize() < MinMappedFileSize) {
+            return;
+        }
+        auto mapped = std::make_unique<FS::MappedFile>();
+        if (!mapped->Open(path, false) || !mapped->IsMapped()) {
+            LOG_DEBUG(Common_Filesystem, "Failed to map file at path={}, using buffered reads",
+                      path);
+            return;
+        }
+        mapping = std::move(mapped);
+    });
+    return mapping.get();
+}
+
 // TODO(DarkLordZach): MSVC would not let me combine the following two functions using 'if
 // constexpr' because there is a compile error in the branch not used.
 
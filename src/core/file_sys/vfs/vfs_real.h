@@ -4,6 +4,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string_view>
@@ -13,7 +14,8 @@
 
 namespace Common::FS {
 class IOFile;
-}
+class MappedFile;
+} // namespace Common::FS
 
 namespace FileSys {
 
@@ -87,6 +89,7 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    std::span<const u8> ReadSpan(std::size_t length, std::size_t offset) const override;
     bool Rename(std::string_view name) override;
 
 private:
@@ -101,6 +104,13 @@ private:
     std::vector<std::string> path_components;
     std::optional<u64> size;
     OpenMode perms;
+
+    // Large read-only files (game images) are mapped on first access so reads can be served
+    // straight from the mapping without going through the reference list.
+    const Common::FS::MappedFile* GetMapping() const;
+
+    mutable std::once_flag mapping_flag;
+    mutable std::unique_ptr<Common::FS::MappedFile> mapping;
 };
 
 // An implementation of VfsDirectory that represents a directory on the user's computer.
@@ -338,16 +338,34 @@ void ReadInArgument(bool is_domain, CallArguments& args, const u8* raw_data, HLE
         } else if constexpr (ArgumentTraits<ArgType>::Type == ArgumentType::OutBuffer) {
             using ElementType = typename ArgType::Type;
 
-            // Set up scratch buffer.
+            // Alias mapped buffers are written in place when they are contiguous in host memory,
+            // as the server mapping of the client memory is on hardware. Otherwise, set up a
+            // scratch buffer written back after the call.
             auto& buffer = temp[OutBufferIndex];
+            buffer.resize_destructive(0);
+
+            std::span<u8> output;
             if (ctx.CanWriteBuffer(OutBufferIndex)) {
-                buffer.resize_destructive(ctx.GetWriteBufferSize(OutBufferIndex));
-            } else {
-                buffer.resize_destructive(0);
+                constexpr bool CanMapAlias =
+                    (ArgType::Attr & (BufferAttr_HipcMapAlias | BufferAttr_HipcAutoSelect)) != 0;
+                const bool is_map_alias = CanMapAlias &&
+                                          ctx.BufferDescriptorB().size() > OutBufferIndex &&
+                                          ctx.BufferDescriptorB()[OutBufferIndex].Size() != 0;
+                if (is_map_alias) {
+                    const auto spans = ctx.WriteBufferSpans(OutBufferIndex);
+                    if (spans.size() == 1) {
+                        output = spans.front();
+                        ctx.MarkBufferWrittenInPlace(OutBufferIndex);
+                    }
+                }
+                if (output.empty()) {
+                    buffer.resize_destructive(ctx.GetWriteBufferSize(OutBufferIndex));
+                    output = buffer;
+                }
             }
 
-            ElementType* ptr = (ElementType*) buffer.data();
-            size_t size = buffer.size() / sizeof(ElementType);
+            ElementType* ptr = (ElementType*) output.data();
+            size_t size = output.size() / sizeof(ElementType);
 
             std::get<ArgIndex>(args) = std::span(ptr, size);
 
@@ -412,6 +430,7 @@ void WriteOutArgument(bool is_domain, CallArguments& args, u8* raw_data, HLERequ
 
             return WriteOutArgument<MethodArguments, CallArguments, PrevAlign, DataOffset, OutBufferIndex + 1, RawDataFinished, ArgIndex + 1>(is_domain, args, raw_data, ctx, temp);
         } else if constexpr (ArgumentTraits<ArgType>::Type == ArgumentType::OutBuffer) {
+            // Buffers written in place left their scratch buffer empty
             auto& buffer = temp[OutBufferIndex];
             const size_t size = buffer.size();
 
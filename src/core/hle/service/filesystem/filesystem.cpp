@@ -728,6 +728,11 @@ void LoopProcess(Core::System& system) {
     server_manager->RegisterNamedService("fsp-ldr", std::make_shared<FSP_LDR>(system));
     server_manager->RegisterNamedService("fsp:pr", std::make_shared<FSP_PR>(system));
     server_manager->RegisterNamedService("fsp-srv", std::move(FileSystemProxyFactory));
+
+    // Requests of a session are never handled concurrently, as its holder is only linked back
+    // to the wait list after replying, so extra threads only serve different sessions in parallel
+    server_manager->StartAdditionalHostThreads(
+        "FS", Settings::values.service_host_threads.GetValue() - 1);
     ServerManager::RunServer(std::move(server_manager));
 }
 
@@ -335,28 +335,24 @@ std::vector<u8> HLERequestContext::ReadBufferCopy(std::size_t buffer_index) cons
 }
 
 std::span<const u8> HLERequestContext::ReadBufferA(std::size_t buffer_index) const {
-    Core::Memory::CpuGuestMemory<u8, Core::Memory::GuestMemoryFlags::UnsafeRead> gm(memory, 0, 0);
-
     ASSERT_OR_EXECUTE_MSG(
         BufferDescriptorA().size() > buffer_index, { return {}; },
         "BufferDescriptorA invalid buffer_index {}", buffer_index);
-    return gm.Read(BufferDescriptorA()[buffer_index].Address(),
-                   BufferDescriptorA()[buffer_index].Size(), &read_buffer_data_a[buffer_index]);
+    return ReadGuestBuffer(BufferDescriptorA()[buffer_index].Address(),
+                           BufferDescriptorA()[buffer_index].Size(), buffer_index,
+                           read_buffer_data_a[buffer_index]);
 }
 
 std::span<const u8> HLERequestContext::ReadBufferX(std::size_t buffer_index) const {
-    Core::Memory::CpuGuestMemory<u8, Core::Memory::GuestMemoryFlags::UnsafeRead> gm(memory, 0, 0);
-
     ASSERT_OR_EXECUTE_MSG(
         BufferDescriptorX().size() > buffer_index, { return {}; },
         "BufferDescriptorX invalid buffer_index {}", buffer_index);
-    return gm.Read(BufferDescriptorX()[buffer_index].Address(),
-                   BufferDescriptorX()[buffer_index].Size(), &read_buffer_data_x[buffer_index]);
+    return ReadGuestBuffer(BufferDescriptorX()[buffer_index].Address(),
+                           BufferDescriptorX()[buffer_index].Size(), buffer_index,
+                           read_buffer_data_x[buffer_index]);
 }
 
 std::span<const u8> HLERequestContext::ReadBuffer(std::size_t buffer_index) const {
-    Core::Memory::CpuGuestMemory<u8, Core::Memory::GuestMemoryFlags::UnsafeRead> gm(memory, 0, 0);
-
     const bool is_buffer_a{BufferDescriptorA().size() > buffer_index &&
                            BufferDescriptorA()[buffer_index].Size()};
     const bool is_buffer_x{BufferDescriptorX().size() > buffer_index &&
@@ -372,17 +368,76 @@ std::span<const u8> HLERequestContext::ReadBuffer(std::size_t buffer_index) cons
         ASSERT_OR_EXECUTE_MSG(
             BufferDescriptorA().size() > buffer_index, { return {}; },
             "BufferDescriptorA invalid buffer_index {}", buffer_index);
-        return gm.Read(BufferDescriptorA()[buffer_index].Address(),
-                       BufferDescriptorA()[buffer_index].Size(), &read_buffer_data_a[buffer_index]);
+        return ReadGuestBuffer(BufferDescriptorA()[buffer_index].Address(),
+                               BufferDescriptorA()[buffer_index].Size(), buffer_index,
+                               read_buffer_data_a[buffer_index]);
     } else {
         ASSERT_OR_EXECUTE_MSG(
             BufferDescriptorX().size() > buffer_index, { return {}; },
             "BufferDescriptorX invalid buffer_index {}", buffer_index);
-        return gm.Read(BufferDescriptorX()[buffer_index].Address(),
-                       BufferDescriptorX()[buffer_index].Size(), &read_buffer_data_x[buffer_index]);
+        return ReadGuestBuffer(BufferDescriptorX()[buffer_index].Address(),
+                               BufferDescriptorX()[buffer_index].Size(), buffer_index,
+                               read_buffer_data_x[buffer_index]);
     }
 }
 
+std::span<const std::span<const u8>> HLERequestContext::ReadBufferSpans(
+    std::size_t buffer_index) const {
+    ASSERT_OR_EXECUTE_MSG(
+        buffer_index < read_buffer_spans.size() && CanReadBuffer(buffer_index), { return {}; },
+        "Read buffer is invalid, index={}", buffer_index);
+
+    const bool is_buffer_a{BufferDescriptorA().size() > buffer_index &&
+                           BufferDescriptorA()[buffer_index].Size()};
+    const u64 address{is_buffer_a ? BufferDescriptorA()[buffer_index].Address()
+                                  : BufferDescriptorX()[buffer_index].Address()};
+    const u64 size{is_buffer_a ? BufferDescriptorA()[buffer_index].Size()
+                               : BufferDescriptorX()[buffer_index].Size()};
+
+    auto& spans = read_buffer_spans[buffer_index];
+    if (!memory.GetReadSpansUnsafe(address, size, spans)) {
+        spans.clear();
+    }
+    return spans;
+}
+
+std::span<const std::span<u8>> HLERequestContext::WriteBufferSpans(
+    std::size_t buffer_index) const {
+    ASSERT_OR_EXECUTE_MSG(
+        buffer_index < write_buffer_spans.size() && CanWriteBuffer(buffer_index), { return {}; },
+        "Write buffer is invalid, index={}", buffer_index);
+
+    const bool is_buffer_b{BufferDescriptorB().size() > buffer_index &&
+                           BufferDescriptorB()[buffer_index].Size()};
+    const u64 address{is_buffer_b ? BufferDescriptorB()[buffer_index].Address()
+                                  : BufferDescriptorC()[buffer_index].Address()};
+
+    auto& spans = write_buffer_spans[buffer_index];
+    const std::size_t size{GetWriteBufferSize(buffer_index)};
+    if (!memory.GetWriteSpans(address, size, spans)) {
+        spans.clear();
+    }
+    return spans;
+}
+
+void HLERequestContext::MarkBufferWrittenInPlace(std::size_t buffer_index) const {
+    written_buffer_bytes += GetWriteBufferSize(buffer_index);
+}
+
+std::span<const u8> HLERequestContext::ReadGuestBuffer(u64 address, u64 size,
+                                                       std::size_t buffer_index,
+                                                       Common::ScratchBuffer<u8>& backup) const {
+    // Buffers contiguous in host memory are read in place, even when they span several mappings
+    if (buffer_index < read_buffer_spans.size()) {
+        auto& spans = read_buffer_spans[buffer_index];
+        if (memory.GetReadSpansUnsafe(address, size, spans) && spans.size() == 1) {
+            return spans.front();
+        }
+    }
+    Core::Memory::CpuGuestMemory<u8, Core::Memory::GuestMemoryFlags::UnsafeRead> gm(memory, 0, 0);
+    return gm.Read(address, size, &backup);
+}
+
 std::size_t HLERequestContext::WriteBuffer(const void* buffer, std::size_t size,
                                            std::size_t buffer_index) const {
     if (size == 0) {
@@ -430,6 +485,7 @@ std::size_t HLERequestContext::WriteBufferB(const void* buffer, std::size_t size
     }
 
     memory.WriteBlock(BufferDescriptorB()[buffer_index].Address(), buffer, size);
+    written_buffer_bytes += size;
     return size;
 }
 
@@ -447,6 +503,7 @@ std::size_t HLERequestContext::WriteBufferC(const void* buffer, std::size_t size
     }
 
     memory.WriteBlock(BufferDescriptorC()[buffer_index].Address(), buffer, size);
+    written_buffer_bytes += size;
     return size;
 }
 
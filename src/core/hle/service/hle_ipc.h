@@ -269,6 +269,26 @@ public:
     /// Helper function to read a copy of a buffer using the appropriate buffer descriptor
     [[nodiscard]] std::vector<u8> ReadBufferCopy(std::size_t buffer_index = 0) const;
 
+    /**
+     * Gets the host memory backing a read buffer, to read it in place without a copy.
+     * Spans are in guest order, guest pages contiguous in host memory share a span.
+     * Returns no spans when the buffer is empty or not entirely mapped, ReadBuffer copes with it.
+     */
+    [[nodiscard]] std::span<const std::span<const u8>> ReadBufferSpans(
+        std::size_t buffer_index = 0) const;
+
+    /**
+     * Gets the host memory backing a write buffer, to fill it in place instead of staging the
+     * data for WriteBuffer.
+     * Returns no spans when the buffer is empty, not entirely mapped or holds GPU memory,
+     * WriteBuffer copes with it.
+     */
+    [[nodiscard]] std::span<const std::span<u8>> WriteBufferSpans(
+        std::size_t buffer_index = 0) const;
+
+    /// Counts a write buffer filled in place through WriteBufferSpans as written.
+    void MarkBufferWrittenInPlace(std::size_t buffer_index = 0) const;
+
     /// Helper function to write a buffer using the appropriate buffer descriptor
     std::size_t WriteBuffer(const void* buffer, std::size_t size,
                             std::size_t buffer_index = 0) const;
@@ -327,6 +347,14 @@ public:
     /// Helper function to test whether the output buffer at buffer_index can be written
     [[nodiscard]] bool CanWriteBuffer(std::size_t buffer_index = 0) const;
 
+    /**
+     * Gets the number of bytes written to the output buffers so far. Buffers filled in place
+     * count whole, as the handler may fill any part of them.
+     */
+    [[nodiscard]] u64 GetWrittenBufferBytes() const {
+        return written_buffer_bytes;
+    }
+
     [[nodiscard]] Handle GetCopyHandle(std::size_t index) const {
         return incoming_copy_handles.at(index);
     }
@@ -394,6 +422,10 @@ private:
 
     void ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming);
 
+    [[nodiscard]] std::span<const u8> ReadGuestBuffer(u64 address, u64 size,
+                                                       std::size_t buffer_index,
+                                                       Common::ScratchBuffer<u8>& backup) const;
+
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     Kernel::KServerSession* server_session{};
     Kernel::KHandleTable* client_handle_table{};
@@ -431,6 +463,9 @@ private:
 
     mutable std::array<Common::ScratchBuffer<u8>, 3> read_buffer_data_a{};
     mutable std::array<Common::ScratchBuffer<u8>, 3> read_buffer_data_x{};
+    mutable std::array<std::vector<std::span<const u8>>, 3> read_buffer_spans{};
+    mutable std::array<std::vector<std::span<u8>>, 3> write_buffer_spans{};
+    mutable u64 written_buffer_bytes{};
 };
 
 } // namespace Service
@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "core/hle/service/ipc_statistics.h"
+
+namespace Service {
+
+void LatencyHistogram::Add(u64 nanoseconds) {
+    ++buckets[BucketIndex(nanoseconds)];
+    ++count;
+    max = std::max(max, nanoseconds);
+}
+
+u64 LatencyHistogram::Percentile(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    const double rank = std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 *
+                                  static_cast<double>(count));
+    const u64 target = std::max<u64>(static_cast<u64>(rank), 1);
+    u64 seen = 0;
+    for (size_t index = 0; index < NUM_BUCKETS; ++index) {
+        seen += buckets[index];
+        if (seen >= target) {
+            return std::min(BucketUpperBound(index), max);
+        }
+    }
+    return max;
+}
+
+size_t LatencyHistogram::BucketIndex(u64 value) noexcept {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    // Each power of two is split in SUB_BUCKETS linear buckets
+    const size_t msb = static_cast<size_t>(std::bit_width(value)) - 1;
+    const size_t sub_bucket = static_cast<size_t>(value >> (msb - SUB_BUCKET_BITS)) &
+                              (SUB_BUCKETS - 1);
+    return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+u64 LatencyHistogram::BucketUpperBound(size_t index) noexcept {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const size_t msb = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const u64 sub_bucket = index % SUB_BUCKETS;
+    const u64 next_lower_bound = (SUB_BUCKETS + sub_bucket + 1) << (msb - SUB_BUCKET_BITS);
+    // The last bucket wraps around to the largest value
+    return next_lower_bound - 1;
+}
+
+IpcStatistics::IpcStatistics(std::chrono::seconds log_interval_)
+    : log_interval{log_interval_}, next_log{std::chrono::steady_clock::now() + log_interval} {}
+
+IpcStatistics::~IpcStatistics() = default;
+
+void IpcStatistics::Record(std::string_view service_name, u32 command_id,
+                           std::string_view command_name, std::chrono::nanoseconds latency,
+                           u64 bytes_in, u64 bytes_out) {
+    const u64 nanoseconds = static_cast<u64>(std::max<s64>(latency.count(), 0));
+
+    std::vector<CommandSummary> summary;
+    {
+        std::scoped_lock lk{mutex};
+        auto [it, is_new] = entries.try_emplace({std::string{service_name}, command_id});
+        Entry& entry = it->second;
+        if (is_new) {
+            entry.command_name = command_name;
+        }
+        entry.latency.Add(nanoseconds);
+        entry.total_ns += nanoseconds;
+        entry.bytes_in += bytes_in;
+        entry.bytes_out += bytes_out;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_log) {
+            return;
+        }
+        next_log = now + log_interval;
+        summary = Summarize();
+    }
+    Log(summary, 16);
+}
+
+std::vector<IpcStatistics::CommandSummary> IpcStatistics::GetSummary() const {
+    std::scoped_lock lk{mutex};
+    return Summarize();
+}
+
+void IpcStatistics::LogSummary(size_t max_commands) const {
+    Log(GetSummary(), max_commands);
+}
+
+void IpcStatistics::SaveReport(u64 title_id) const {
+    const auto summary = GetSummary();
+
+    nlohmann::json commands = nlohmann::json::array();
+    for (const CommandSummary& command : summary) {
+        commands.push_back({
+            {"service", command.service_name},
+            {"command_id", command.command_id},
+            {"command", command.command_name},
+            {"calls", command.calls},
+            {"total_ns", command.total_ns},
+            {"p50_ns", command.p50_ns},
+            {"p90_ns", command.p90_ns},
+            {"p99_ns", command.p99_ns},
+            {"max_ns", command.max_ns},
+            {"bytes_in", command.bytes_in},
+            {"bytes_out", command.bytes_out},
+        });
+    }
+
+    const auto time = std::time(nullptr);
+    const std::string timestamp = fmt::format("{:%FT%H-%M-%S}", *std::localtime(&time));
+    const nlohmann::json report{
+        {"title_id", fmt::format("{:016X}", title_id)},
+        {"timestamp", timestamp},
+        {"commands", std::move(commands)},
+    };
+
+    const auto filename = Common::FS::GetSuyuPath(Common::FS::SuyuPath::LogDir) /
+                          "ipc_statistics" / fmt::format("{:016X}_{}.json", title_id, timestamp);
+    if (!Common::FS::CreateParentDirs(filename)) {
+        LOG_ERROR(Service, "Failed to create path for '{}' to save IPC statistics",
+                  Common::FS::PathToUTF8String(filename));
+        return;
+    }
+    std::ofstream file;
+    Common::FS::OpenFileStream(file, filename, std::ios_base::out | std::ios_base::trunc);
+    file << std::setw(4) << report << std::endl;
+
+    LOG_INFO(Service, "Saved IPC statistics of {} commands to '{}'", summary.size(),
+             Common::FS::PathToUTF8String(filename));
+}
+
+std::vector<IpcStatistics::CommandSummary> IpcStatistics::Summarize() const {
+    std::vector<CommandSummary> summary;
+    summary.reserve(entries.size());
+    for (const auto& [key, entry] : entries) {
+        summary.push_back({
+            .service_name = key.first,
+            .command_id = key.second,
+            .command_name = entry.command_name,
+            .calls = entry.latency.Count(),
+            .total_ns = entry.total_ns,
+            .p50_ns = entry.latency.Percentile(50.0),
+            .p90_ns = entry.latency.Percentile(90.0),
+            .p99_ns = entry.latency.Percentile(99.0),
+            .max_ns = entry.latency.Max(),
+            .bytes_in = entry.bytes_in,
+            .bytes_out = entry.bytes_out,
+        });
+    }
+    std::ranges::stable_sort(summary, std::greater{}, &CommandSummary::total_ns);
+    return summary;
+}
+
+void IpcStatistics::Log(std::span<const CommandSummary> summary, size_t max_commands) {
+    LOG_INFO(Service, "IPC statistics, {} commands by total time:", summary.size());
+    for (const CommandSummary& command : summary.first(std::min(max_commands, summary.size()))) {
+        LOG_INFO(Service,
+                 "  {}::{} ({}): calls={} total={}us p50={}us p90={}us p99={}us in={}B out={}B",
+                 command.service_name, command.command_name, command.command_id, command.calls,
+                 command.total_ns / 1000, command.p50_ns / 1000, command.p90_ns / 1000,
+                 command.p99_ns / 1000, command.bytes_in, command.bytes_out);
+    }
+}
+
+} // namespace Service
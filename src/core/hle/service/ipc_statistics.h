@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Service {
+
+/// Log scaled histogram of latencies in nanoseconds, bucket bounds are within 25% of a sample
+class LatencyHistogram {
+public:
+    void Add(u64 nanoseconds);
+
+    /// Returns an upper bound of the given percentile, in the [0, 100] range
+    [[nodiscard]] u64 Percentile(double percentile) const;
+
+    [[nodiscard]] u64 Count() const noexcept {
+        return count;
+    }
+
+    [[nodiscard]] u64 Max() const noexcept {
+        return max;
+    }
+
+private:
+    static constexpr size_t SUB_BUCKET_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    [[nodiscard]] static size_t BucketIndex(u64 value) noexcept;
+    [[nodiscard]] static u64 BucketUpperBound(size_t index) noexcept;
+
+    std::array<u64, NUM_BUCKETS> buckets{};
+    u64 count{};
+    u64 max{};
+};
+
+/**
+ * Opt-in statistics of the requests served by HLE services, per service and command id.
+ * A summary of the most expensive commands is logged periodically, and the whole table can be
+ * saved as JSON at shutdown to find which services are worth optimizing.
+ */
+class IpcStatistics {
+public:
+    struct CommandSummary {
+        std::string service_name;
+        u32 command_id{};
+        std::string command_name;
+        u64 calls{};
+        u64 total_ns{};
+        u64 p50_ns{};
+        u64 p90_ns{};
+        u64 p99_ns{};
+        u64 max_ns{};
+        /// Size of the buffers the requests read from
+        u64 bytes_in{};
+        /// Bytes the handlers wrote to the output buffers
+        u64 bytes_out{};
+    };
+
+    explicit IpcStatistics(std::chrono::seconds log_interval = std::chrono::seconds{60});
+    ~IpcStatistics();
+
+    IpcStatistics(const IpcStatistics&) = delete;
+    IpcStatistics& operator=(const IpcStatistics&) = delete;
+
+    /// Records a served request. Thread safe.
+    void Record(std::string_view service_name, u32 command_id, std::string_view command_name,
+                std::chrono::nanoseconds latency, u64 bytes_in, u64 bytes_out);
+
+    /// Returns the statistics of every command, sorted by decreasing total latency
+    [[nodiscard]] std::vector<CommandSummary> GetSummary() const;
+
+    /// Logs the commands with the highest total latency
+    void LogSummary(size_t max_commands = 16) const;
+
+    /// Writes the statistics of every command to a JSON file in the log directory
+    void SaveReport(u64 title_id) const;
+
+private:
+    struct Entry {
+        std::string command_name;
+        LatencyHistogram latency;
+        u64 total_ns{};
+        u64 bytes_in{};
+        u64 bytes_out{};
+    };
+
+    [[nodiscard]] std::vector<CommandSummary> Summarize() const;
+
+    static void Log(std::span<const CommandSummary> summary, size_t max_commands);
+
+    mutable std::mutex mutex;
+    std::map<std::pair<std::string, u32>, Entry> entries;
+    std::chrono::steady_clock::duration log_interval;
+    std::chrono::steady_clock::time_point next_log;
+};
+
+} // namespace Service
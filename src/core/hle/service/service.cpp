@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+
 #include <fmt/format.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -9,6 +11,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/service/ipc_helpers.h"
+#include "core/hle/service/ipc_statistics.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/sm/sm.h"
 #include "core/reporter.h"
@@ -32,6 +35,18 @@ namespace Service {
     return function_string;
 }
 
+/// Sums the sizes of the buffers a request reads from
+static u64 GetReadBufferBytes(const HLERequestContext& ctx) {
+    u64 bytes_in = 0;
+    for (const auto& descriptor : ctx.BufferDescriptorA()) {
+        bytes_in += descriptor.Size();
+    }
+    for (const auto& descriptor : ctx.BufferDescriptorX()) {
+        bytes_in += descriptor.Size();
+    }
+    return bytes_in;
+}
+
 ServiceFrameworkBase::ServiceFrameworkBase(Core::System& system_, const char* service_name_,
                                            u32 max_sessions_, InvokerFn* handler_invoker_)
     : SessionRequestHandler(system_.Kernel(), service_name_), system{system_},
@@ -83,6 +98,23 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(HLERequestContext& ctx,
     }
 }
 
+void ServiceFrameworkBase::Invoke(HLERequestContext& ctx, const FunctionInfoBase& info) {
+    IpcStatistics* const ipc_statistics = system.GetIpcStatistics();
+    if (!ipc_statistics) {
+        handler_invoker(this, info.handler_callback, ctx);
+        return;
+    }
+    // Input sizes are taken before the handler runs, as it may alter the request. Output is what
+    // the handler actually wrote, not the capacity of the output buffers.
+    const u64 bytes_in = GetReadBufferBytes(ctx);
+    const u64 written_before = ctx.GetWrittenBufferBytes();
+    const auto start = std::chrono::steady_clock::now();
+    handler_invoker(this, info.handler_callback, ctx);
+    const auto latency = std::chrono::steady_clock::now() - start;
+    ipc_statistics->Record(service_name, ctx.GetCommand(), info.name, latency, bytes_in,
+                           ctx.GetWrittenBufferBytes() - written_before);
+}
+
 void ServiceFrameworkBase::InvokeRequest(HLERequestContext& ctx) {
     auto itr = handlers.find(ctx.GetCommand());
     const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
@@ -91,7 +123,7 @@ void ServiceFrameworkBase::InvokeRequest(HLERequestContext& ctx) {
     }
 
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName(), ctx.CommandBuffer()));
-    handler_invoker(this, info->handler_callback, ctx);
+    Invoke(ctx, *info);
 }
 
 void ServiceFrameworkBase::InvokeRequestTipc(HLERequestContext& ctx) {
@@ -105,7 +137,7 @@ void ServiceFrameworkBase::InvokeRequestTipc(HLERequestContext& ctx) {
     }
 
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName(), ctx.CommandBuffer()));
-    handler_invoker(this, info->handler_callback, ctx);
+    Invoke(ctx, *info);
 }
 
 Result ServiceFrameworkBase::HandleSyncRequest(Kernel::KServerSession& session,
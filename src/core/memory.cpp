@@ -246,9 +246,6 @@ struct Memory::Impl {
     bool WalkBlock(const Common::ProcessAddress addr, const std::size_t size, auto on_unmapped,
                    auto on_memory, auto on_rasterizer, auto increment) {
         const auto& page_table = *current_page_table;
-        std::size_t remaining_size = size;
-        std::size_t page_index = addr >> SUYU_PAGEBITS;
-        std::size_t page_offset = addr & SUYU_PAGEMASK;
         bool user_accessible = true;
 
         if (!AddressSpaceContains(page_table, addr, size)) [[unlikely]] {
@@ -256,44 +253,37 @@ struct Memory::Impl {
             return false;
         }
 
-        while (remaining_size) {
-            const std::size_t copy_amount =
-                std::min(static_cast<std::size_t>(SUYU_PAGESIZE) - page_offset, remaining_size);
-            const auto current_vaddr =
-                static_cast<u64>((page_index << SUYU_PAGEBITS) + page_offset);
-
-            const auto [pointer, type] = page_table.pointers[page_index].PointerType();
-            switch (type) {
-            case Common::PageType::Unmapped: {
-                user_accessible = false;
-                on_unmapped(copy_amount, current_vaddr);
-                break;
-            }
-            case Common::PageType::Memory: {
-                u8* mem_ptr =
-                    reinterpret_cast<u8*>(pointer + page_offset + (page_index << SUYU_PAGEBITS));
-                on_memory(copy_amount, mem_ptr);
-                break;
-            }
-            case Common::PageType::DebugMemory: {
-                u8* const mem_ptr{GetPointerFromDebugMemory(current_vaddr)};
-                on_memory(copy_amount, mem_ptr);
-                break;
-            }
-            case Common::PageType::RasterizerCachedMemory: {
-                u8* const host_ptr{GetPointerFromRasterizerCachedMemory(current_vaddr)};
-                on_rasterizer(current_vaddr, copy_amount, host_ptr);
-                break;
-            }
-            default:
-                UNREACHABLE();
-            }
-
-            page_index++;
-            page_offset = 0;
-            increment(copy_amount);
-            remaining_size -= copy_amount;
-        }
+        // Pages following a Memory page in the same host range are accessed in a single call
+        page_table.ForEachPageRun<SUYU_PAGEBITS>(
+            GetInteger(addr), size,
+            [&](const u64 current_vaddr, const std::size_t copy_amount, const uintptr_t pointer,
+                const Common::PageType type) {
+                switch (type) {
+                case Common::PageType::Unmapped: {
+                    user_accessible = false;
+                    on_unmapped(copy_amount, current_vaddr);
+                    break;
+                }
+                case Common::PageType::Memory: {
+                    u8* const mem_ptr{reinterpret_cast<u8*>(pointer + current_vaddr)};
+                    on_memory(copy_amount, mem_ptr);
+                    break;
+                }
+                case Common::PageType::DebugMemory: {
+                    u8* const mem_ptr{GetPointerFromDebugMemory(current_vaddr)};
+                    on_memory(copy_amount, mem_ptr);
+                    break;
+                }
+                case Common::PageType::RasterizerCachedMemory: {
+                    u8* const host_ptr{GetPointerFromRasterizerCachedMemory(current_vaddr)};
+                    on_rasterizer(current_vaddr, copy_amount, host_ptr);
+                    break;
+                }
+                default:
+                    UNREACHABLE();
+                }
+                increment(copy_amount);
+            });
 
         return user_accessible;
     }
@@ -407,6 +397,37 @@ struct Memory::Impl {
             [](const std::size_t copy_amount) {});
     }
 
+    template <bool WRITE, typename SpanType>
+    bool GetSpans(const Common::ProcessAddress addr, const std::size_t size,
+                  std::vector<SpanType>& out_spans) {
+        out_spans.clear();
+        const auto append = [&out_spans](u8* const host_ptr, const std::size_t amount) {
+            if (!out_spans.empty()) {
+                SpanType& last = out_spans.back();
+                if (last.data() + last.size() == host_ptr) {
+                    last = SpanType{last.data(), last.size() + amount};
+                    return;
+                }
+            }
+            out_spans.emplace_back(host_ptr, amount);
+        };
+        // The GPU must see writes to its memory after they happened, so those are not handed out
+        bool is_gpu_memory = false;
+        const bool is_mapped = WalkBlock(
+            addr, size, [](const std::size_t, const Common::ProcessAddress) {},
+            [&](const std::size_t copy_amount, u8* const host_ptr) {
+                append(host_ptr, copy_amount);
+            },
+            [&](const Common::ProcessAddress, const std::size_t copy_amount, u8* const host_ptr) {
+                if constexpr (WRITE) {
+                    is_gpu_memory = true;
+                }
+                append(host_ptr, copy_amount);
+            },
+            [](const std::size_t) {});
+        return is_mapped && !is_gpu_memory;
+    }
+
     bool CopyBlock(Common::ProcessAddress dest_addr, Common::ProcessAddress src_addr,
                    const std::size_t size) {
         return WalkBlock(
@@ -1052,6 +1073,16 @@ bool Memory::ZeroBlock(Common::ProcessAddress dest_addr, const std::size_t size)
     return impl->ZeroBlock(dest_addr, size);
 }
 
+bool Memory::GetReadSpansUnsafe(Common::ProcessAddress src_addr, const std::size_t size,
+                                std::vector<std::span<const u8>>& out_spans) {
+    return impl->GetSpans<false>(src_addr, size, out_spans);
+}
+
+bool Memory::GetWriteSpans(Common::ProcessAddress dest_addr, const std::size_t size,
+                           std::vector<std::span<u8>>& out_spans) {
+    return impl->GetSpans<true>(dest_addr, size, out_spans);
+}
+
 void Memory::SetGPUDirtyManagers(std::span<Core::GPUDirtyMemoryManager> managers) {
     impl->gpu_dirty_managers = managers;
 }
@@ -437,6 +437,34 @@ public:
      */
     bool ZeroBlock(Common::ProcessAddress dest_addr, std::size_t size);
 
+    /**
+     * Collects the host memory backing a range of the current process' address space, so it can
+     * be read in place. Pages contiguous in host memory are merged into the same span.
+     * This unsafe version does not flush GPU Memory, like ReadBlockUnsafe.
+     *
+     * @param src_addr  The virtual address of the range.
+     * @param size      The size of the range, in bytes.
+     * @param out_spans Receives the host spans backing the range, in address order.
+     *
+     * @returns false if part of the range is unmapped, out_spans does not cover it then.
+     */
+    bool GetReadSpansUnsafe(Common::ProcessAddress src_addr, std::size_t size,
+                            std::vector<std::span<const u8>>& out_spans);
+
+    /**
+     * Collects the host memory backing a range of the current process' address space, so it can
+     * be written in place. Ranges holding GPU Memory must be written with WriteBlock instead, so
+     * the GPU is told about the write once it happened.
+     *
+     * @param dest_addr The virtual address of the range.
+     * @param size      The size of the range, in bytes.
+     * @param out_spans Receives the host spans backing the range, in address order.
+     *
+     * @returns false if part of the range is unmapped or holds GPU Memory.
+     */
+    bool GetWriteSpans(Common::ProcessAddress dest_addr, std::size_t size,
+                       std::vector<std::span<u8>>& out_spans);
+
     /**
      * Invalidates a range of bytes within the current process' address space at the specified
      * virtual address.
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#include "common/assert.h"
+#include "shader_recompiler/arena.h"
+
+namespace Shader {
+namespace {
+thread_local Arena* current_arena{};
+} // Anonymous namespace
+
+Arena::Arena(size_t chunk_size_) : chunk_size{chunk_size_} {
+    AddChunk(chunk_size);
+    counters = {};
+}
+
+Arena::~Arena() = default;
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    ASSERT(std::has_single_bit(alignment));
+    const auto align{[alignment](std::byte* pointer) {
+        const uintptr_t address{reinterpret_cast<uintptr_t>(pointer)};
+        return pointer + (((address + alignment - 1) & ~(alignment - 1)) - address);
+    }};
+    std::byte* result{align(cursor)};
+    if (result > end || size > static_cast<size_t>(end - result)) {
+        AddChunk(size + alignment);
+        result = align(cursor);
+    }
+    cursor = result + size;
+    ++counters.num_allocations;
+    counters.allocated_bytes += size;
+    return result;
+}
+
+void Arena::Release() {
+    if (chunks.size() > 1) {
+        // Squash the chunks used by the last compilation into one to serve the next one
+        size_t total_size{};
+        for (const Chunk& chunk : chunks) {
+            total_size += chunk.size;
+        }
+        chunks.clear();
+        AddChunk(total_size);
+    } else {
+        cursor = chunks.front().storage.get();
+        end = cursor + chunks.front().size;
+    }
+    counters = {};
+}
+
+Arena* Arena::Current() noexcept {
+    return current_arena;
+}
+
+void Arena::AddChunk(size_t min_size) {
+    const size_t size{std::max(min_size, chunk_size)};
+    Chunk& chunk{chunks.emplace_back()};
+    chunk.storage.reset(new std::byte[size]);
+    chunk.size = size;
+    cursor = chunk.storage.get();
+    end = cursor + size;
+    ++counters.num_chunks;
+}
+
+ArenaScope::ArenaScope(Arena& arena) noexcept : previous{std::exchange(current_arena, &arena)} {}
+
+ArenaScope::~ArenaScope() {
+    current_arena = previous;
+}
+
+} // namespace Shader
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Shader {
+
+/**
+ * Monotonic allocator for the transient containers of a shader compilation.
+ * Deallocations are ignored, memory is reclaimed in one shot by Release. Chunks are kept between
+ * compilations so steady state translations do not reach the global allocator.
+ */
+class Arena {
+public:
+    struct Counters {
+        u64 num_allocations{}; ///< Allocations served since the last release
+        u64 allocated_bytes{}; ///< Bytes served since the last release
+        u64 num_chunks{};      ///< Chunks taken from the global allocator since the last release
+    };
+
+    explicit Arena(size_t chunk_size = 64 * 1024);
+    ~Arena();
+
+    Arena& operator=(const Arena&) = delete;
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(Arena&&) = delete;
+    Arena(Arena&&) = delete;
+
+    [[nodiscard]] void* Allocate(size_t size, size_t alignment);
+
+    /// Frees every allocation at once, objects allocated from the arena must be dead by now
+    void Release();
+
+    [[nodiscard]] const Counters& GetCounters() const noexcept {
+        return counters;
+    }
+
+    /// Returns the arena bound to the calling thread, nullptr when there is none
+    [[nodiscard]] static Arena* Current() noexcept;
+
+private:
+    friend class ArenaScope;
+
+    struct Chunk {
+        std::unique_ptr<std::byte[]> storage;
+        size_t size{};
+    };
+
+    void AddChunk(size_t min_size);
+
+    std::vector<Chunk> chunks;
+    std::byte* cursor{};
+    std::byte* end{};
+    size_t chunk_size{};
+    Counters counters{};
+};
+
+/// Binds an arena to the calling thread for the lifetime of the scope
+class [[nodiscard]] ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) noexcept;
+    ~ArenaScope();
+
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    ArenaScope(const ArenaScope&) = delete;
+
+private:
+    Arena* previous;
+};
+
+/// Standard allocator drawing from the arena bound at construction, or the heap without one
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept : arena{Arena::Current()} {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& rhs) noexcept : arena{rhs.arena} {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        if (arena) {
+            return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (!arena) {
+            std::allocator<T>{}.deallocate(p, n);
+        }
+    }
+
+    template <typename U>
+    [[nodiscard]] bool operator==(const ArenaAllocator<U>& rhs) const noexcept {
+        return arena == rhs.arena;
+    }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena* arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename T>
+using ArenaDeque = std::deque<T, ArenaAllocator<T>>;
+
+template <typename Key, typename T>
+using ArenaMap = std::map<Key, T, std::less<Key>, ArenaAllocator<std::pair<const Key, T>>>;
+
+template <typename Key, typename T>
+using ArenaUnorderedMap = std::unordered_map<Key, T, std::hash<Key>, std::equal_to<Key>,
+                                             ArenaAllocator<std::pair<const Key, T>>>;
+
+} // namespace Shader
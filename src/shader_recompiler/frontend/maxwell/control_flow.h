@@ -6,11 +6,11 @@
 #include <optional>
 #include <span>
 #include <string>
-#include <vector>
 
 #include <boost/container/small_vector.hpp>
 #include <boost/intrusive/set.hpp>
 
+#include "shader_recompiler/arena.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/frontend/ir/condition.h"
 #include "shader_recompiler/frontend/ir/reg.h"
@@ -58,7 +58,7 @@ public:
     [[nodiscard]] Stack Remove(Token token) const;
 
 private:
-    std::vector<StackEntry> entries;
+    ArenaVector<StackEntry> entries;
 };
 
 struct IndirectBranch {
@@ -86,7 +86,7 @@ struct Block : boost::intrusive::set_base_hook<
     Block* return_block{};
     IR::Reg branch_reg{};
     s32 branch_offset{};
-    std::vector<IndirectBranch> indirect_branches;
+    ArenaVector<IndirectBranch> indirect_branches;
 };
 
 struct Label {
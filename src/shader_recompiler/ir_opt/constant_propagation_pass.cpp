@@ -5,8 +5,10 @@
 #include <functional>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include "common/bit_cast.h"
+#include "shader_recompiler/arena.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/exception.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
@@ -1098,6 +1100,15 @@ void ConstantPropagation(Environment& env, IR::Block& block, IR::Inst& inst) {
     }
 }
 
+void ForwardIdentities(IR::Inst& inst) {
+    const size_t num_args{inst.NumArgs()};
+    for (size_t i = 0; i < num_args; ++i) {
+        const IR::Value arg{inst.Arg(i)};
+        if (arg.IsIdentity()) {
+            inst.SetArg(i, arg.Resolve());
+        }
+    }
+}
 } // Anonymous namespace
 
 void ConstantPropagationPass(Environment& env, IR::Program& program) {
@@ -1110,4 +1121,91 @@ void ConstantPropagationPass(Environment& env, IR::Program& program) {
     }
 }
 
+void SimplificationPass(Environment& env, IR::Program& program) {
+    // Instructions that may be dead, the block is null when it is not known
+    ArenaVector<std::pair<IR::Inst*, IR::Block*>> worklist;
+    ArenaVector<std::pair<IR::Inst*, IR::Block*>> deferred;
+    ArenaVector<IR::Inst*> operands;
+
+    // Removing an instruction drops a use from its operands, the ones left unused are queued.
+    // Queued instructions are invalidated where they are, the final dead code elimination erases
+    // them from their blocks.
+    const auto remove{[&](IR::Inst* inst, IR::Block* block) {
+        if (block) {
+            block->Instructions().erase(IR::Block::InstructionList::s_iterator_to(*inst));
+        }
+        if (inst->GetOpcode() == IR::Opcode::Void) {
+            return;
+        }
+        operands.clear();
+        const size_t num_args{inst->NumArgs()};
+        for (size_t i = 0; i < num_args; ++i) {
+            const IR::Value arg{inst->Arg(i)};
+            if (arg.IsIdentity() || !arg.IsImmediate()) {
+                operands.push_back(arg.Inst());
+            }
+        }
+        inst->Invalidate();
+        for (IR::Inst* const operand : operands) {
+            if (!operand->HasUses() && !operand->MayHaveSideEffects()) {
+                worklist.emplace_back(operand, nullptr);
+            }
+        }
+    }};
+
+    const auto end{program.post_order_blocks.rend()};
+    for (auto it = program.post_order_blocks.rbegin(); it != end; ++it) {
+        IR::Block* const block{*it};
+        for (IR::Inst& inst : block->Instructions()) {
+            if (inst.GetOpcode() == IR::Opcode::Phi) {
+                // Phi arguments coming from back edges are forwarded once all blocks are visited
+                deferred.emplace_back(&inst, block);
+                continue;
+            }
+            if (!inst.IsPseudoInstruction()) {
+                ForwardIdentities(inst);
+            }
+            ConstantPropagation(env, *block, inst);
+
+            if (inst.GetOpcode() == IR::Opcode::Identity) {
+                deferred.emplace_back(&inst, block);
+            } else if (!inst.HasUses() && !inst.MayHaveSideEffects()) {
+                worklist.emplace_back(&inst, block);
+            }
+        }
+    }
+    for (const auto& [inst, block] : deferred) {
+        if (inst->GetOpcode() == IR::Opcode::Phi) {
+            ForwardIdentities(*inst);
+        }
+    }
+    for (const auto& [inst, block] : deferred) {
+        if (inst->GetOpcode() == IR::Opcode::Phi) {
+            if (!inst->HasUses()) {
+                worklist.emplace_back(inst, block);
+            }
+        } else if (!inst->HasAssociatedPseudoOperation()) {
+            // All users have been forwarded by now. Uses of identities resolving to immediates are
+            // not counted, so their use count cannot be trusted.
+            remove(inst, block);
+        }
+    }
+    while (!worklist.empty()) {
+        const auto [inst, block]{worklist.back()};
+        worklist.pop_back();
+
+        const IR::Opcode opcode{inst->GetOpcode()};
+        if (opcode == IR::Opcode::Identity) {
+            continue;
+        }
+        if (opcode != IR::Opcode::Void && (inst->HasUses() || inst->MayHaveSideEffects())) {
+            continue;
+        }
+        if (opcode == IR::Opcode::Void && !block) {
+            continue;
+        }
+        remove(inst, block);
+    }
+}
+
 } // namespace Shader::Optimization
@@ -44,6 +44,8 @@ void ConfigureDebug::SetConfiguration() {
     ui->fs_access_log->setEnabled(runtime_lock);
     ui->fs_access_log->setChecked(Settings::values.enable_fs_access_log.GetValue());
     ui->reporting_services->setChecked(Settings::values.reporting_services.GetValue());
+    ui->record_ipc_statistics->setEnabled(runtime_lock);
+    ui->record_ipc_statistics->setChecked(Settings::values.record_ipc_statistics.GetValue());
     ui->dump_audio_commands->setChecked(Settings::values.dump_audio_commands.GetValue());
     ui->quest_flag->setChecked(Settings::values.quest_flag.GetValue());
     ui->use_debug_asserts->setChecked(Settings::values.use_debug_asserts.GetValue());
@@ -69,6 +71,15 @@ void ConfigureDebug::SetConfiguration() {
     ui->disable_macro_jit->setChecked(Settings::values.disable_macro_jit.GetValue());
     ui->disable_macro_hle->setEnabled(runtime_lock);
     ui->disable_macro_hle->setChecked(Settings::values.disable_macro_hle.GetValue());
+    ui->profile_macros->setEnabled(runtime_lock);
+    ui->profile_macros->setChecked(Settings::values.profile_macros.GetValue());
+    ui->verify_macro_hle->setEnabled(runtime_lock);
+    ui->verify_macro_hle->setChecked(Settings::values.verify_macro_hle.GetValue());
+    ui->record_gpu_commands->setEnabled(runtime_lock);
+    ui->record_gpu_commands->setChecked(Settings::values.record_gpu_commands.GetValue());
+    ui->null_renderer_accounting->setEnabled(runtime_lock);
+    ui->null_renderer_accounting->setChecked(
+        Settings::values.null_renderer_accounting.GetValue());
     ui->disable_loop_safety_checks->setEnabled(runtime_lock);
     ui->disable_loop_safety_checks->setChecked(
         Settings::values.disable_shader_loop_safety_checks.GetValue());
@@ -91,6 +102,7 @@ void ConfigureDebug::ApplyConfiguration() {
     Settings::values.program_args = ui->homebrew_args_edit->text().toStdString();
     Settings::values.enable_fs_access_log = ui->fs_access_log->isChecked();
     Settings::values.reporting_services = ui->reporting_services->isChecked();
+    Settings::values.record_ipc_statistics = ui->record_ipc_statistics->isChecked();
     Settings::values.dump_audio_commands = ui->dump_audio_commands->isChecked();
     Settings::values.quest_flag = ui->quest_flag->isChecked();
     Settings::values.use_debug_asserts = ui->use_debug_asserts->isChecked();
@@ -108,6 +120,10 @@ void ConfigureDebug::ApplyConfiguration() {
         ui->disable_loop_safety_checks->isChecked();
     Settings::values.disable_macro_jit = ui->disable_macro_jit->isChecked();
     Settings::values.disable_macro_hle = ui->disable_macro_hle->isChecked();
+    Settings::values.profile_macros = ui->profile_macros->isChecked();
+    Settings::values.verify_macro_hle = ui->verify_macro_hle->isChecked();
+    Settings::values.record_gpu_commands = ui->record_gpu_commands->isChecked();
+    Settings::values.null_renderer_accounting = ui->null_renderer_accounting->isChecked();
     Settings::values.extended_logging = ui->extended_logging->isChecked();
     Settings::values.perform_vulkan_check = ui->perform_vulkan_check->isChecked();
     UISettings::values.disable_web_applet = ui->disable_web_applet->isChecked();
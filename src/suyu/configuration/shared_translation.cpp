@@ -71,6 +71,10 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
               "faster or not.\n200% for a 30 FPS game is 60 FPS, and for a "
               "60 FPS game it will be 120 FPS.\nDisabling it means unlocking the framerate to the "
               "maximum your PC can reach."));
+    INSERT(Settings, service_host_threads, tr("File System Service Threads"),
+           tr("Number of host threads serving file system requests.\nMore threads let games "
+              "that stream assets from several threads read in parallel.\nTakes effect the next "
+              "time a game is started."));
 
     // Cpu
     INSERT(Settings, cpu_accuracy, tr("Accuracy:"),
@@ -207,6 +211,16 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
            tr("Enables GPU vendor-specific pipeline cache.\nThis option can improve shader loading "
               "time significantly in cases where the Vulkan driver does not store pipeline cache "
               "files internally."));
+    INSERT(Settings, use_pipeline_cache_warmup, tr("Prioritize frequently used pipelines"),
+           tr("Builds the cached pipelines used most in previous sessions before the game "
+              "starts.\nThe remaining pipelines are built in the background while playing."));
+    INSERT(Settings, use_disk_texture_cache, tr("Use disk decoded texture cache"),
+           tr("Stores textures converted on the CPU, such as ASTC on hosts without native "
+              "support, to disk.\nLater sessions load them instead of decoding them again, at "
+              "the cost of disk space."));
+    INSERT(Settings, use_translated_shader_cache, tr("Cache translated shaders"),
+           tr("Stores the host shaders translated for cached pipelines to disk.\nLater sessions "
+              "skip shader translation while loading, only the driver builds the pipelines."));
     INSERT(
         Settings, enable_compute_pipelines, tr("Enable Compute Pipelines (Intel Vulkan Only)"),
         tr("Enable compute pipelines, required by some games.\nThis setting only exists for Intel "
@@ -1,9 +1,11 @@
 // SPDX-FileCopyrightText: 2014 Citra Emulator Project & 2024 suyu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <regex>
 #include <string>
 #include <thread>
@@ -38,6 +40,7 @@
 #include "suyu_cmd/emu_window/emu_window_sdl2_gl.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2_null.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2_vk.h"
+#include "video_core/command_capture.h"
 #include "video_core/renderer_base.h"
 
 #ifdef _WIN32
@@ -78,6 +81,8 @@ static void PrintHelp(const char* argv0) {
                  "-m, --multiplayer=nick:password@address:port"
                  " Nickname, password, address and port for multiplayer\n"
                  "-p, --program         Pass following string as arguments to executable\n"
+                 "-r, --replay          Replay a GPU command capture with the game's GPU state,\n"
+                 "                      print the frame times and exit\n"
                  "-u, --user            Select a specific user profile from 0 to 7\n"
                  "-v, --version         Output version information and exit\n";
 }
@@ -183,6 +188,40 @@ static void OnStatusMessageReceived(const Network::StatusMessageEntry& msg) {
         std::cout << std::endl << "* " << message << std::endl << std::endl;
 }
 
+/// Replays a GPU command capture without running the game, prints the frame times
+static int ReplayGpuCommands(Core::System& system, const std::string& path) {
+    const auto records = Tegra::CommandCapture::LoadCapture(path);
+    if (!records) {
+        system.ShutdownMainProcess();
+        return -1;
+    }
+    Tegra::CommandCapture::Replayer replayer{system};
+    const auto frame_times = replayer.Run(*records);
+    system.ShutdownMainProcess();
+
+    if (frame_times.empty()) {
+        std::cout << "The capture contains no frames" << std::endl;
+        return 0;
+    }
+    auto sorted_times = frame_times;
+    std::sort(sorted_times.begin(), sorted_times.end());
+    const auto total = std::accumulate(frame_times.begin(), frame_times.end(),
+                                       std::chrono::nanoseconds{});
+    const auto to_ms = [](std::chrono::nanoseconds time) {
+        return std::chrono::duration<double, std::milli>(time).count();
+    };
+    for (size_t frame = 0; frame < frame_times.size(); ++frame) {
+        std::cout << fmt::format("Frame {}: {:.3f} ms", frame, to_ms(frame_times[frame]))
+                  << std::endl;
+    }
+    std::cout << fmt::format("{} frames, mean {:.3f} ms, median {:.3f} ms, max {:.3f} ms",
+                             frame_times.size(), to_ms(total) / frame_times.size(),
+                             to_ms(sorted_times[sorted_times.size() / 2]),
+                             to_ms(sorted_times.back()))
+              << std::endl;
+    return 0;
+}
+
 /// Application entry point
 int main(int argc, char** argv) {
 #ifdef _WIN32
@@ -211,6 +250,7 @@ int main(int argc, char** argv) {
     std::optional<std::string> config_path;
     std::string program_args;
     std::optional<int> selected_user;
+    std::optional<std::string> replay_path;
 
     bool use_multiplayer = false;
     bool fullscreen = false;
@@ -227,6 +267,7 @@ int main(int argc, char** argv) {
         {"game", required_argument, 0, 'g'},
         {"multiplayer", required_argument, 0, 'm'},
         {"program", optional_argument, 0, 'p'},
+        {"replay", required_argument, 0, 'r'},
         {"user", required_argument, 0, 'u'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -234,7 +275,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:fhvp::c:u:", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:fhvp::c:u:r:", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'c':
@@ -289,6 +330,9 @@ int main(int argc, char** argv) {
                 program_args = argv[optind];
                 ++optind;
                 break;
+            case 'r':
+                replay_path = optarg;
+                break;
             case 'u':
                 selected_user = atoi(optarg);
                 break;
@@ -430,6 +474,10 @@ int main(int argc, char** argv) {
             [](VideoCore::LoadCallbackStage, size_t value, size_t total) {});
     }
 
+    if (replay_path) {
+        return ReplayGpuCommands(system, *replay_path);
+    }
+
     system.RegisterExitCallback([&] {
         // Just exit right away.
         exit(0);
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/fs/mapped_file.h"
+
+namespace {
+std::filesystem::path WriteTestFile(const char* name, const std::vector<u8>& contents) {
+    const std::filesystem::path path{std::filesystem::temp_directory_path() / name};
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(contents.data()),
+               static_cast<std::streamsize>(contents.size()));
+    return path;
+}
+} // Anonymous namespace
+
+TEST_CASE("MappedFile: Contents", "[common]") {
+    std::vector<u8> contents(0x12345);
+    for (size_t i = 0; i < contents.size(); ++i) {
+        contents[i] = static_cast<u8>(i * 31);
+    }
+    const auto path{WriteTestFile("suyu_mapped_file_test.bin", contents)};
+    {
+        Common::FS::MappedFile file{path};
+        REQUIRE(file.IsOpen());
+        REQUIRE(file.Size() == contents.size());
+        REQUIRE(std::ranges::equal(file.Data(), contents));
+
+        // Moving hands over the view without copying it
+        const u8* const data{file.Data().data()};
+        Common::FS::MappedFile moved{std::move(file)};
+        REQUIRE(!file.IsOpen());
+        REQUIRE(moved.Data().data() == data);
+        REQUIRE(std::ranges::equal(moved.Data(), contents));
+
+        moved.Close();
+        REQUIRE(!moved.IsOpen());
+        REQUIRE(!moved.IsMapped());
+        REQUIRE(moved.Data().empty());
+
+        // Files can be modified once closed, a reopened view sees the new size
+        contents.resize(0x1000);
+        WriteTestFile("suyu_mapped_file_test.bin", contents);
+        REQUIRE(moved.Open(path));
+        REQUIRE(std::ranges::equal(moved.Data(), contents));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFile: Empty and missing files", "[common]") {
+    const auto path{WriteTestFile("suyu_mapped_file_empty_test.bin", {})};
+    Common::FS::MappedFile file{path};
+    REQUIRE(file.IsOpen());
+    REQUIRE(file.Size() == 0);
+    REQUIRE(file.Data().empty());
+    std::filesystem::remove(path);
+
+    REQUIRE(!file.Open(path));
+    REQUIRE(!file.IsOpen());
+    REQUIRE(!file.Open(path, false));
+}
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "common/page_table.h"
+
+namespace {
+using Common::PageTable;
+using Common::PageType;
+using namespace Common::Literals;
+
+constexpr size_t ADDRESS_SPACE_BITS = 32;
+constexpr size_t PAGE_BITS = 12;
+constexpr u64 PAGE_SIZE = 1ULL << PAGE_BITS;
+constexpr u64 PAGE_MASK = PAGE_SIZE - 1;
+
+/// Maps pages the way Core::Memory does, with pointers biased by the address of their page
+void Map(PageTable& table, u64 vaddr, u8* host, u64 size, PageType type) {
+    for (u64 page = vaddr >> PAGE_BITS; page < (vaddr + size) >> PAGE_BITS; ++page) {
+        const uintptr_t pointer = reinterpret_cast<uintptr_t>(host) - (vaddr & ~PAGE_MASK);
+        table.pointers[page].Store(pointer, type);
+    }
+}
+
+/// Reads guest memory like Core::Memory::ReadBlock, through the same page walk
+void ReadBlock(const PageTable& table, u64 vaddr, u8* dest, size_t size) {
+    const auto read_run = [&](u64 run_vaddr, size_t run_size, uintptr_t pointer, PageType) {
+        std::memcpy(dest, reinterpret_cast<const u8*>(pointer + run_vaddr), run_size);
+        dest += run_size;
+    };
+    table.ForEachPageRun<PAGE_BITS>(vaddr, size, read_run);
+}
+
+/// Reads guest memory one page at a time, the walk before contiguous pages were coalesced
+void ReadBlockPaged(const PageTable& table, u64 vaddr, u8* dest, size_t size) {
+    size_t page_index = vaddr >> PAGE_BITS;
+    size_t page_offset = vaddr & PAGE_MASK;
+    while (size) {
+        const size_t copy_amount = std::min<size_t>(PAGE_SIZE - page_offset, size);
+        const uintptr_t pointer = table.pointers[page_index].Pointer();
+        const u8* const src =
+            reinterpret_cast<const u8*>(pointer + page_offset + (page_index << PAGE_BITS));
+        std::memcpy(dest, src, copy_amount);
+        dest += copy_amount;
+        size -= copy_amount;
+        page_offset = 0;
+        ++page_index;
+    }
+}
+} // Anonymous namespace
+
+TEST_CASE("PageTable: Contiguous memory pages", "[common]") {
+    PageTable table;
+    table.Resize(ADDRESS_SPACE_BITS, PAGE_BITS);
+
+    std::vector<u8> first(8 * PAGE_SIZE);
+    std::vector<u8> second(4 * PAGE_SIZE);
+    Map(table, 0x10000, first.data(), first.size(), PageType::Memory);
+    Map(table, 0x18000, second.data(), second.size(), PageType::Memory);
+    Map(table, 0x1c000, second.data(), PAGE_SIZE, PageType::RasterizerCachedMemory);
+
+    const size_t base = 0x10000 >> PAGE_BITS;
+    const auto contiguous_pages = [&](size_t page_index, size_t max_pages) {
+        return table.ContiguousMemoryPages(page_index, table.pointers[page_index].Raw(),
+                                           max_pages);
+    };
+    REQUIRE(contiguous_pages(base, 64) == 8);
+    REQUIRE(contiguous_pages(base + 3, 64) == 5);
+    REQUIRE(contiguous_pages(base, 2) == 2);
+    REQUIRE(contiguous_pages(base, 0) == 0);
+    REQUIRE(contiguous_pages(base + 8, 64) == 4);
+    REQUIRE(contiguous_pages(base + 12, 64) == 0);
+    REQUIRE(contiguous_pages(base + 13, 64) == 0);
+
+    // The first page is covered by the page info the caller read, even once it is remapped
+    const uintptr_t raw = table.pointers[base].Raw();
+    Map(table, 0x10000, second.data(), PAGE_SIZE, PageType::Memory);
+    REQUIRE(table.ContiguousMemoryPages(base, raw, 64) == 8);
+    REQUIRE(table.ContiguousMemoryPages(base + 1, table.pointers[base].Raw(), 64) == 1);
+}
+
+TEST_CASE("PageTable: Page runs", "[common]") {
+    PageTable table;
+    table.Resize(ADDRESS_SPACE_BITS, PAGE_BITS);
+
+    std::vector<u8> memory(4 * PAGE_SIZE);
+    Map(table, 0x20000, memory.data(), 3 * PAGE_SIZE, PageType::Memory);
+    Map(table, 0x23000, memory.data() + 3 * PAGE_SIZE, PAGE_SIZE,
+        PageType::RasterizerCachedMemory);
+
+    struct Run {
+        u64 vaddr;
+        size_t size;
+        PageType type;
+        bool operator==(const Run&) const = default;
+    };
+    std::vector<Run> runs;
+    const auto add_run = [&](u64 vaddr, size_t size, uintptr_t, PageType type) {
+        runs.push_back({vaddr, size, type});
+    };
+    table.ForEachPageRun<PAGE_BITS>(0x20010, 5 * PAGE_SIZE, add_run);
+    REQUIRE(runs == std::vector<Run>{
+                        {0x20010, 3 * PAGE_SIZE - 0x10, PageType::Memory},
+                        {0x23000, PAGE_SIZE, PageType::RasterizerCachedMemory},
+                        {0x24000, PAGE_SIZE, PageType::Unmapped},
+                        {0x25000, 0x10, PageType::Unmapped},
+                    });
+}
+
+TEST_CASE("PageTable: Coalesced block read", "[common]") {
+    PageTable table;
+    table.Resize(ADDRESS_SPACE_BITS, PAGE_BITS);
+
+    std::vector<u8> first(16 * PAGE_SIZE);
+    std::vector<u8> second(16 * PAGE_SIZE);
+    for (size_t i = 0; i < first.size(); ++i) {
+        first[i] = static_cast<u8>(i * 7);
+        second[i] = static_cast<u8>(i * 13);
+    }
+    Map(table, 0x40000, first.data(), first.size(), PageType::Memory);
+    Map(table, 0x50000, second.data(), second.size(), PageType::Memory);
+
+    std::vector<u8> expected(first.begin() + 0x123, first.end());
+    expected.insert(expected.end(), second.begin(), second.begin() + 0x3456);
+
+    std::vector<u8> coalesced(expected.size());
+    std::vector<u8> paged(expected.size());
+    ReadBlock(table, 0x40123, coalesced.data(), coalesced.size());
+    ReadBlockPaged(table, 0x40123, paged.data(), paged.size());
+    REQUIRE(coalesced == expected);
+    REQUIRE(paged == expected);
+}
+
+TEST_CASE("PageTable: Block read throughput", "[.][common][benchmark]") {
+    PageTable table;
+    table.Resize(ADDRESS_SPACE_BITS, PAGE_BITS);
+
+    constexpr u64 IPC_BUFFER_ADDRESS = 0x100000;
+    constexpr u64 TEXTURE_ADDRESS = 0x1000000;
+    std::vector<u8> ipc_buffer(64_KiB);
+    std::vector<u8> texture(16_MiB);
+    Map(table, IPC_BUFFER_ADDRESS, ipc_buffer.data(), ipc_buffer.size(), PageType::Memory);
+    Map(table, TEXTURE_ADDRESS, texture.data(), texture.size(), PageType::Memory);
+
+    std::vector<u8> dest(texture.size());
+    BENCHMARK("64 KiB IPC buffer, page by page") {
+        ReadBlockPaged(table, IPC_BUFFER_ADDRESS, dest.data(), ipc_buffer.size());
+        return dest[0];
+    };
+    BENCHMARK("64 KiB IPC buffer, coalesced") {
+        ReadBlock(table, IPC_BUFFER_ADDRESS, dest.data(), ipc_buffer.size());
+        return dest[0];
+    };
+    BENCHMARK("16 MiB texture, page by page") {
+        ReadBlockPaged(table, TEXTURE_ADDRESS, dest.data(), texture.size());
+        return dest[0];
+    };
+    BENCHMARK("16 MiB texture, coalesced") {
+        ReadBlock(table, TEXTURE_ADDRESS, dest.data(), texture.size());
+        return dest[0];
+    };
+}
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/thread_worker.h"
+
+TEST_CASE("ParallelFor: Every index runs once", "[common]") {
+    Common::ThreadWorker workers(4, "ParallelForTest");
+    std::array<std::atomic<int>, 64> calls{};
+    Common::ParallelFor(workers, calls.size(), [&](size_t index) { ++calls[index]; });
+    for (const auto& count : calls) {
+        REQUIRE(count == 1);
+    }
+    // Nothing to do must return immediately
+    Common::ParallelFor(workers, 0, [](size_t) { FAIL("Called with no indices"); });
+}
+
+TEST_CASE("ParallelFor: Exceptions reach the caller", "[common]") {
+    Common::ThreadWorker workers(2, "ParallelForTest");
+    std::atomic<int> calls{};
+    REQUIRE_THROWS_AS(Common::ParallelFor(workers, 8,
+                                          [&](size_t index) {
+                                              ++calls;
+                                              if (index == 3) {
+                                                  throw std::runtime_error("stage failed");
+                                              }
+                                          }),
+                      std::runtime_error);
+    REQUIRE(calls == 8);
+}
+
+TEST_CASE("ParallelFor: Callable from a busy worker", "[common]") {
+    // A single worker running the outer loop can't pick up the inner tasks, the caller runs them
+    Common::ThreadWorker workers(1, "ParallelForTest");
+    std::atomic<int> calls{};
+    workers.QueueWork([&] {
+        Common::ParallelFor(workers, 4, [&](size_t) { ++calls; });
+    });
+    workers.WaitForRequests();
+    REQUIRE(calls == 4);
+}
@@ -1,15 +1,20 @@
 // SPDX-FileCopyrightText: 2016 Dolphin Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <chrono>
 #include <cstdlib>
 #include <memory>
 #include <optional>
+#include <random>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -139,3 +144,123 @@ TEST_CASE("CoreTiming[BasicOrderNoPausing]", "[core]") {
     printf("HostTimer No Pausing Timer Time: %.3f %.6f\n", timer_time / 1000.f,
            timer_time / 1000000.f);
 }
+
+TEST_CASE("CoreTiming[Ordering]", "[core]") {
+    Core::Timing::CoreTiming core_timing;
+    core_timing.SetMulticore(false);
+    core_timing.Initialize([]() {});
+
+    // Events run by time and then by scheduling order, far away events cross every level of the
+    // wheel and the overflow list
+    std::mt19937_64 rng{0x5eed};
+    std::vector<s64> times;
+    for (s64 i = 0; i < 64; ++i) {
+        times.push_back(i * 512);
+    }
+    for (s64 shift = 10; shift < 56; shift += 3) {
+        for (size_t i = 0; i < 16; ++i) {
+            times.push_back(static_cast<s64>(rng() % (u64{1} << shift)));
+        }
+    }
+    times.push_back(times[100]);
+    times.push_back(times[200]);
+
+    std::vector<std::pair<s64, size_t>> ran;
+    std::vector<std::shared_ptr<Core::Timing::EventType>> events;
+    for (size_t i = 0; i < times.size(); ++i) {
+        events.push_back(Core::Timing::CreateEvent(
+            "ordering", [&ran, i](s64 time, std::chrono::nanoseconds) {
+                ran.emplace_back(time, i);
+                return std::nullopt;
+            }));
+        core_timing.ScheduleEvent(std::chrono::nanoseconds{times[i]}, events[i], true);
+    }
+    // Unscheduled events never run
+    for (size_t i = 0; i < times.size(); i += 7) {
+        core_timing.UnscheduleEvent(events[i], Core::Timing::UnscheduleEventType::NoWait);
+    }
+
+    std::vector<std::pair<s64, size_t>> expected;
+    for (size_t i = 0; i < times.size(); ++i) {
+        if (i % 7 != 0) {
+            expected.emplace_back(times[i], i);
+        }
+    }
+    std::ranges::sort(expected);
+
+    // Advance to the middle of the events first, then past all of them
+    const s64 middle{expected[expected.size() / 2].first};
+    while (core_timing.GetGlobalTimeNs().count() < middle) {
+        core_timing.AddTicks(middle / 2 + 1);
+    }
+    REQUIRE(core_timing.Advance().has_value());
+    REQUIRE(ran.size() > 0);
+    REQUIRE(ran.size() < expected.size());
+    for (const auto& [time, index] : ran) {
+        REQUIRE(time <= core_timing.GetGlobalTimeNs().count());
+    }
+
+    core_timing.AddTicks(u64{1} << 57);
+    REQUIRE(!core_timing.Advance().has_value());
+    REQUIRE(ran == expected);
+}
+
+TEST_CASE("CoreTiming[LoopingEvents]", "[core]") {
+    Core::Timing::CoreTiming core_timing;
+    core_timing.SetMulticore(false);
+    core_timing.Initialize([]() {});
+
+    std::vector<s64> ran;
+    const auto looping{Core::Timing::CreateEvent(
+        "looping", [&ran](s64 time, std::chrono::nanoseconds) {
+            ran.push_back(time);
+            return std::nullopt;
+        })};
+    core_timing.ScheduleLoopingEvent(std::chrono::microseconds{10}, std::chrono::microseconds{10},
+                                     looping, true);
+    while (core_timing.GetGlobalTimeNs() < std::chrono::microseconds{55}) {
+        core_timing.AddTicks(100);
+        core_timing.Advance();
+    }
+    REQUIRE(ran == std::vector<s64>{10000, 20000, 30000, 40000, 50000});
+
+    core_timing.UnscheduleEvent(looping, Core::Timing::UnscheduleEventType::NoWait);
+    core_timing.AddTicks(u64{1} << 40);
+    REQUIRE(!core_timing.Advance().has_value());
+    REQUIRE(ran.size() == 5);
+}
+
+// Timer churn of the emulated system, events are scheduled and cancelled before they expire
+TEST_CASE("CoreTiming[Churn]", "[.][core][benchmark]") {
+    Core::Timing::CoreTiming core_timing;
+    core_timing.SetMulticore(false);
+    core_timing.Initialize([]() {});
+
+    std::vector<std::shared_ptr<Core::Timing::EventType>> events;
+    for (size_t i = 0; i < 256; ++i) {
+        events.push_back(Core::Timing::CreateEvent(
+            "churn", [](s64, std::chrono::nanoseconds) { return std::nullopt; }));
+    }
+    std::mt19937_64 rng{0x5eed};
+    std::vector<std::chrono::nanoseconds> delays;
+    for (size_t i = 0; i < events.size(); ++i) {
+        delays.emplace_back(1'000 + static_cast<s64>(rng() % 100'000'000));
+    }
+
+    BENCHMARK("Schedule and unschedule") {
+        for (size_t i = 0; i < events.size(); ++i) {
+            core_timing.ScheduleEvent(delays[i], events[i]);
+        }
+        for (const auto& event : events) {
+            core_timing.UnscheduleEvent(event, Core::Timing::UnscheduleEventType::NoWait);
+        }
+        return core_timing.HasPendingEvents();
+    };
+    BENCHMARK("Schedule and run") {
+        for (size_t i = 0; i < events.size(); ++i) {
+            core_timing.ScheduleEvent(delays[i], events[i]);
+        }
+        core_timing.AddTicks(u64{1} << 30);
+        return core_timing.Advance();
+    };
+}
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/crypto/aes_bulk.h"
+#include "core/crypto/aes_util.h"
+
+namespace {
+using namespace Core::Crypto;
+
+using IVData = std::array<u8, 0x10>;
+
+template <typename T>
+T MakeRandom(std::mt19937& rng) {
+    T out;
+    for (auto& value : out) {
+        value = static_cast<u8>(rng());
+    }
+    return out;
+}
+
+std::vector<u8> MakeData(std::mt19937& rng, std::size_t size) {
+    std::vector<u8> out(size);
+    for (auto& value : out) {
+        value = static_cast<u8>(rng());
+    }
+    return out;
+}
+
+void AddToIV(IVData& iv, u64 value) {
+    for (std::size_t i = iv.size(); i-- > 0 && value != 0;) {
+        const u64 sum = iv[i] + (value & 0xFF);
+        iv[i] = static_cast<u8>(sum);
+        value = (value >> 8) + (sum >> 8);
+    }
+}
+
+std::vector<u8> ReferenceCTR(const Key128& key, IVData iv, const std::vector<u8>& data) {
+    std::vector<u8> out(data.size());
+    AESCipher<Key128> cipher(key, Mode::CTR);
+    cipher.SetIV(iv);
+    cipher.Transcode(data.data(), data.size(), out.data(), Op::Decrypt);
+    return out;
+}
+
+std::vector<u8> ReferenceXTS(const Key256& key, IVData iv, std::size_t sector_size,
+                             const std::vector<u8>& data) {
+    std::vector<u8> out(data.size());
+    AESCipher<Key256> cipher(key, Mode::XTS);
+    for (std::size_t offset = 0; offset < data.size(); offset += sector_size) {
+        cipher.SetIV(iv);
+        cipher.Transcode(data.data() + offset, std::min(sector_size, data.size() - offset),
+                         out.data() + offset, Op::Decrypt);
+        AddToIV(iv, 1);
+    }
+    return out;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AES: Bulk CTR matches mbedtls", "[core]") {
+    if (!IsBulkAESSupported()) {
+        return;
+    }
+    std::mt19937 rng{1};
+    // Includes partial blocks, a counter that carries into the upper half and a parallel request
+    for (const std::size_t size : {0x10U, 0x35U, 0x1000U, 0x12345U, 0x180010U}) {
+        const auto key = MakeRandom<Key128>(rng);
+        auto iv = MakeRandom<IVData>(rng);
+        std::fill(iv.begin() + 8, iv.end(), u8{0xFF});
+        const auto data = MakeData(rng, size);
+
+        std::vector<u8> out(size);
+        BulkCTRCipher(key).Transcode(data.data(), size, out.data(), iv);
+        REQUIRE(out == ReferenceCTR(key, iv, data));
+    }
+}
+
+TEST_CASE("AES: Bulk XTS matches mbedtls", "[core]") {
+    if (!IsBulkAESSupported()) {
+        return;
+    }
+    std::mt19937 rng{2};
+    for (const std::size_t sector_size : {0x200U, 0x4000U}) {
+        // The last sector of the smaller requests is partial
+        for (const std::size_t size : {0x200U, 0x4200U, 0x180000U}) {
+            const auto key = MakeRandom<Key256>(rng);
+            const auto iv = MakeRandom<IVData>(rng);
+            auto data = MakeData(rng, size);
+            const auto expected = ReferenceXTS(key, iv, sector_size, data);
+
+            BulkXTSCipher(key).Decrypt(data.data(), size, data.data(), sector_size, iv);
+            REQUIRE(data == expected);
+        }
+    }
+}
+
+TEST_CASE("AES: Decryption throughput", "[.][core][benchmark]") {
+    constexpr std::size_t SIZE = 0x800000;
+    constexpr std::size_t SECTOR_SIZE = 0x4000;
+    std::mt19937 rng{3};
+    const auto key128 = MakeRandom<Key128>(rng);
+    const auto key256 = MakeRandom<Key256>(rng);
+    const auto iv = MakeRandom<IVData>(rng);
+    std::vector<u8> data = MakeData(rng, SIZE);
+
+    AESCipher<Key128> ctr_cipher(key128, Mode::CTR);
+    AESCipher<Key256> xts_cipher(key256, Mode::XTS);
+    BENCHMARK("CTR mbedtls 8 MiB") {
+        ctr_cipher.SetIV(iv);
+        ctr_cipher.Transcode(data.data(), SIZE, data.data(), Op::Decrypt);
+        return data[0];
+    };
+    BENCHMARK("XTS mbedtls 8 MiB") {
+        xts_cipher.XTSTranscode(data.data(), SIZE, data.data(), 0, SECTOR_SIZE, Op::Decrypt);
+        return data[0];
+    };
+    if (!IsBulkAESSupported()) {
+        return;
+    }
+
+    const BulkCTRCipher bulk_ctr(key128);
+    const BulkXTSCipher bulk_xts(key256);
+    BENCHMARK("CTR bulk 8 MiB") {
+        bulk_ctr.Transcode(data.data(), SIZE, data.data(), iv);
+        return data[0];
+    };
+    BENCHMARK("XTS bulk 8 MiB") {
+        bulk_xts.Decrypt(data.data(), SIZE, data.data(), SECTOR_SIZE, iv);
+        return data[0];
+    };
+}
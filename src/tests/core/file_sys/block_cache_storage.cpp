@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/file_sys/fssystem/fssystem_block_cache_storage.h"
+
+namespace {
+using FileSys::BlockCacheStorage;
+
+// Storage over a vector that counts the reads reaching it.
+class CountingStorage : public FileSys::IReadOnlyStorage {
+public:
+    explicit CountingStorage(size_t size) : data(size) {
+        std::mt19937 rng{1};
+        for (auto& value : data) {
+            value = static_cast<u8>(rng());
+        }
+    }
+
+    size_t Read(u8* buffer, size_t size, size_t offset) const override {
+        ++num_reads;
+        bytes_read += size;
+        std::memcpy(buffer, data.data() + offset, size);
+        return size;
+    }
+
+    size_t GetSize() const override {
+        return data.size();
+    }
+
+    std::vector<u8> data;
+    mutable size_t num_reads{};
+    mutable size_t bytes_read{};
+};
+
+bool ReadMatches(const BlockCacheStorage& storage, const CountingStorage& base, size_t size,
+                 size_t offset) {
+    std::vector<u8> buffer(size);
+    return storage.Read(buffer.data(), size, offset) == size &&
+           std::memcmp(buffer.data(), base.data.data() + offset, size) == 0;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BlockCacheStorage: Repeated reads hit the cache", "[core]") {
+    BlockCacheStorage::SetCacheSize(0x1000000);
+    const auto base = std::make_shared<CountingStorage>(0x100123);
+    const BlockCacheStorage storage{base};
+
+    // Unaligned reads spanning block boundaries, including the partial last block
+    REQUIRE(ReadMatches(storage, *base, 0x100, 0x3F80));
+    REQUIRE(ReadMatches(storage, *base, 0x123, 0x100000));
+    const size_t reads = base->num_reads;
+
+    REQUIRE(ReadMatches(storage, *base, 0x80, 0x3F80));
+    REQUIRE(ReadMatches(storage, *base, 0x10, 0x4010));
+    REQUIRE(ReadMatches(storage, *base, 0x23, 0x100100));
+    REQUIRE(base->num_reads == reads);
+
+    // Out of range reads are clamped
+    std::vector<u8> buffer(0x100);
+    REQUIRE(storage.Read(buffer.data(), buffer.size(), 0x100100) == 0x23);
+    REQUIRE(storage.Read(buffer.data(), buffer.size(), 0x200000) == 0);
+}
+
+TEST_CASE("BlockCacheStorage: Sequential reads are batched", "[core]") {
+    BlockCacheStorage::SetCacheSize(0x1000000);
+    const auto base = std::make_shared<CountingStorage>(0x200000);
+    const BlockCacheStorage storage{base};
+
+    for (size_t offset = 0; offset < 0x100000; offset += 0x1000) {
+        REQUIRE(ReadMatches(storage, *base, 0x1000, offset));
+    }
+    // 256 small reads only reach the base storage a handful of times
+    REQUIRE(base->num_reads < 16);
+}
+
+TEST_CASE("BlockCacheStorage: Disabled cache reads through", "[core]") {
+    BlockCacheStorage::SetCacheSize(0);
+    const auto base = std::make_shared<CountingStorage>(0x10000);
+    const BlockCacheStorage storage{base};
+
+    REQUIRE(ReadMatches(storage, *base, 0x100, 0x10));
+    REQUIRE(ReadMatches(storage, *base, 0x100, 0x10));
+    REQUIRE(base->num_reads == 2);
+    REQUIRE(base->bytes_read == 0x200);
+}
+
+TEST_CASE("BlockCacheStorage: Cache size is bounded", "[core]") {
+    BlockCacheStorage::SetCacheSize(BlockCacheStorage::BlockSize * 16);
+    const auto base = std::make_shared<CountingStorage>(0x400000);
+    const BlockCacheStorage storage{base};
+
+    // Random reads over a range far larger than the cache still return the right data
+    std::mt19937 rng{2};
+    for (int i = 0; i < 1000; ++i) {
+        const size_t offset = rng() % (base->data.size() - 0x2000);
+        REQUIRE(ReadMatches(storage, *base, 0x2000, offset));
+    }
+    BlockCacheStorage::SetCacheSize(0);
+}
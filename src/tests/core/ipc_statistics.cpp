@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+
+#include "core/hle/service/ipc_statistics.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("IpcStatistics: Latency percentiles", "[core]") {
+    Service::LatencyHistogram histogram;
+    REQUIRE(histogram.Percentile(50.0) == 0);
+
+    for (u64 i = 1; i <= 1000; ++i) {
+        histogram.Add(i * 1000);
+    }
+    REQUIRE(histogram.Count() == 1000);
+    REQUIRE(histogram.Max() == 1'000'000);
+
+    // Bounds are never below the exact percentile and at most 25% above it
+    const auto check = [&](double percentile, u64 exact) {
+        const u64 bound = histogram.Percentile(percentile);
+        REQUIRE(bound >= exact);
+        REQUIRE(bound <= exact + exact / 4);
+    };
+    check(50.0, 500'000);
+    check(90.0, 900'000);
+    check(99.0, 990'000);
+    REQUIRE(histogram.Percentile(100.0) == 1'000'000);
+
+    Service::LatencyHistogram small;
+    small.Add(0);
+    small.Add(3);
+    REQUIRE(small.Percentile(50.0) == 0);
+    REQUIRE(small.Percentile(100.0) == 3);
+
+    Service::LatencyHistogram huge;
+    huge.Add(~u64{0});
+    REQUIRE(huge.Percentile(50.0) == ~u64{0});
+}
+
+TEST_CASE("IpcStatistics: Summary", "[core]") {
+    Service::IpcStatistics statistics{std::chrono::hours{1}};
+    statistics.Record("fsp-srv", 1, "Read", 100us, 0, 0x1000);
+    statistics.Record("fsp-srv", 1, "Read", 300us, 0, 0x1000);
+    statistics.Record("audren:u", 4, "RequestUpdate", 1ms, 0x100, 0x200);
+    statistics.Record("fsp-srv", 2, "Write", 10us, 0x80, 0);
+
+    const auto summary = statistics.GetSummary();
+    REQUIRE(summary.size() == 3);
+
+    REQUIRE(summary[0].service_name == "audren:u");
+    REQUIRE(summary[0].command_id == 4);
+    REQUIRE(summary[0].calls == 1);
+    REQUIRE(summary[0].bytes_in == 0x100);
+    REQUIRE(summary[0].bytes_out == 0x200);
+
+    REQUIRE(summary[1].service_name == "fsp-srv");
+    REQUIRE(summary[1].command_name == "Read");
+    REQUIRE(summary[1].calls == 2);
+    REQUIRE(summary[1].total_ns == 400'000);
+    REQUIRE(summary[1].max_ns == 300'000);
+    REQUIRE(summary[1].bytes_out == 0x2000);
+
+    REQUIRE(summary[2].command_name == "Write");
+}
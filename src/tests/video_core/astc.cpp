@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/textures/astc.h"
+
+namespace {
+using Tegra::Texture::ASTC::DecodePath;
+using Tegra::Texture::ASTC::Decompress;
+
+constexpr u32 WIDTH = 64;
+constexpr u32 HEIGHT = 48;
+
+// Block mode for a 4x4 weight grid of 2-bit weights, bit 10 enables dual plane
+constexpr u64 MODE_4X4_WEIGHTS = 0x42;
+constexpr u64 MODE_DUAL_PLANE = 0x400;
+constexpr u64 CEM_RGB_DIRECT = 8;
+constexpr u64 CEM_RGBA_DIRECT = 12;
+
+/// Builds random blocks whose headers are always valid, so every texel goes through interpolation
+std::vector<u8> MakeBlocks(u32 block_width, u32 block_height, u32 seed) {
+    std::mt19937 rng{seed};
+    const u32 num_blocks = ((WIDTH + block_width - 1) / block_width) *
+                           ((HEIGHT + block_height - 1) / block_height);
+    std::vector<u8> data(num_blocks * 16);
+    for (u32 block = 0; block < num_blocks; ++block) {
+        std::array<u32, 4> words;
+        for (u32& word : words) {
+            word = static_cast<u32>(rng());
+        }
+        u64 low;
+        std::memcpy(&low, words.data(), sizeof(low));
+
+        u64 header;
+        u32 header_bits = 17;
+        switch (block % 4) {
+        case 0:
+            header = MODE_4X4_WEIGHTS | (CEM_RGBA_DIRECT << 13);
+            break;
+        case 1:
+            header = MODE_4X4_WEIGHTS | (CEM_RGB_DIRECT << 13);
+            break;
+        case 2:
+            header = MODE_4X4_WEIGHTS | MODE_DUAL_PLANE | (CEM_RGBA_DIRECT << 13);
+            break;
+        default:
+            // Two partitions sharing the same endpoint mode with a random partition pattern
+            header = MODE_4X4_WEIGHTS | (1ULL << 11) | (static_cast<u64>(rng() & 0x3ff) << 13) |
+                     ((CEM_RGB_DIRECT << 2) << 23);
+            header_bits = 29;
+            break;
+        }
+        low = (low & ~((1ULL << header_bits) - 1)) | header;
+        std::memcpy(words.data(), &low, sizeof(low));
+        std::memcpy(data.data() + block * 16, words.data(), 16);
+    }
+    return data;
+}
+
+std::vector<u8> DecodeImage(const std::vector<u8>& blocks, u32 block_width, u32 block_height,
+                            DecodePath path) {
+    std::vector<u8> output(WIDTH * HEIGHT * 4);
+    Decompress(blocks, WIDTH, HEIGHT, 1, block_width, block_height, output, path);
+    return output;
+}
+
+constexpr std::array<std::array<u32, 2>, 5> FOOTPRINTS{{
+    {4, 4},
+    {5, 5},
+    {6, 6},
+    {8, 8},
+    {10, 6},
+}};
+
+} // Anonymous namespace
+
+TEST_CASE("ASTC: Decoder paths match", "[video_core]") {
+    for (const auto& [block_width, block_height] : FOOTPRINTS) {
+        for (u32 seed = 0; seed < 8; ++seed) {
+            const std::vector<u8> blocks = MakeBlocks(block_width, block_height, seed);
+            const std::vector<u8> fast = DecodeImage(blocks, block_width, block_height,
+                                                     DecodePath::Fast);
+            const std::vector<u8> generic = DecodeImage(blocks, block_width, block_height,
+                                                        DecodePath::Generic);
+            REQUIRE(fast == generic);
+        }
+    }
+}
+
+TEST_CASE("ASTC: Valid blocks are not decoded as errors", "[video_core]") {
+    const std::vector<u8> blocks = MakeBlocks(8, 8, 0);
+    const std::vector<u8> output = DecodeImage(blocks, 8, 8, DecodePath::Fast);
+    for (size_t texel = 0; texel < WIDTH * HEIGHT; ++texel) {
+        u32 value;
+        std::memcpy(&value, output.data() + texel * 4, sizeof(value));
+        REQUIRE(value != 0);
+    }
+}
+
+TEST_CASE("ASTC: Decoder benchmark", "[.][video_core][benchmark]") {
+    const std::vector<u8> blocks_4x4 = MakeBlocks(4, 4, 0);
+    const std::vector<u8> blocks_8x8 = MakeBlocks(8, 8, 0);
+    std::vector<u8> output(WIDTH * HEIGHT * 4);
+
+    BENCHMARK("4x4 generic") {
+        Decompress(blocks_4x4, WIDTH, HEIGHT, 1, 4, 4, output, DecodePath::Generic);
+        return output[0];
+    };
+    BENCHMARK("4x4 fast") {
+        Decompress(blocks_4x4, WIDTH, HEIGHT, 1, 4, 4, output, DecodePath::Fast);
+        return output[0];
+    };
+    BENCHMARK("8x8 generic") {
+        Decompress(blocks_8x8, WIDTH, HEIGHT, 1, 8, 8, output, DecodePath::Generic);
+        return output[0];
+    };
+    BENCHMARK("8x8 fast") {
+        Decompress(blocks_8x8, WIDTH, HEIGHT, 1, 8, 8, output, DecodePath::Fast);
+        return output[0];
+    };
+}
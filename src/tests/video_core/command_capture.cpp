@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <filesystem>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/command_capture.h"
+
+namespace {
+using namespace Tegra::CommandCapture;
+
+std::vector<u8> Serialize(const std::vector<Record>& records) {
+    // File header: magic and version
+    std::vector<u8> data{'S', 'G', 'P', 'U', 2, 0, 0, 0};
+    for (const Record& record : records) {
+        SerializeRecord(data, record);
+    }
+    return data;
+}
+
+Tegra::CommandHeader Word(u32 value) {
+    Tegra::CommandHeader header{};
+    header.argument = value;
+    return header;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CommandCapture: Round trip", "[video_core]") {
+    const std::vector<Record> records{
+        CommandListRecord{3, {Word(0x20018040), Word(0xCAFE), Word(0xBEEF)}},
+        MemoryRecord{0x12345000, {1, 2, 3, 4, 5}},
+        AddressSpaceRecord{9, 40, 1ULL << 34, 16, 12},
+        ChannelRecord{3, 9},
+        MapRecord{9, 0x4'0000'0000, 0x12345000, 0x10000, Tegra::PTEKind::PITCH, true, false},
+        UnmapRecord{9, 0x4'0000'0000, 0x10000},
+        FenceRecord{17, 0x1234},
+        FrameEndRecord{},
+        CommandListRecord{0, {}},
+    };
+    const auto parsed = ParseCapture(Serialize(records));
+    REQUIRE(parsed.has_value());
+    REQUIRE(parsed->size() == records.size());
+
+    const auto& command_list = std::get<CommandListRecord>((*parsed)[0]);
+    REQUIRE(command_list.channel == 3);
+    REQUIRE(command_list.commands.size() == 3);
+    REQUIRE(command_list.commands[0].argument == 0x20018040);
+    REQUIRE(command_list.commands[2].argument == 0xBEEF);
+
+    const auto& memory = std::get<MemoryRecord>((*parsed)[1]);
+    REQUIRE(memory.address == 0x12345000);
+    REQUIRE(memory.data == std::vector<u8>{1, 2, 3, 4, 5});
+
+    const auto& address_space = std::get<AddressSpaceRecord>((*parsed)[2]);
+    REQUIRE(address_space.address_space == 9);
+    REQUIRE(address_space.split_address == 1ULL << 34);
+    REQUIRE(address_space.big_page_bits == 16);
+
+    const auto& channel = std::get<ChannelRecord>((*parsed)[3]);
+    REQUIRE(channel.channel == 3);
+    REQUIRE(channel.address_space == 9);
+
+    const auto& map = std::get<MapRecord>((*parsed)[4]);
+    REQUIRE(map.gpu_addr == 0x4'0000'0000);
+    REQUIRE(map.device_addr == 0x12345000);
+    REQUIRE(map.kind == Tegra::PTEKind::PITCH);
+    REQUIRE(map.is_big_pages);
+    REQUIRE(!map.is_sparse);
+
+    const auto& unmap = std::get<UnmapRecord>((*parsed)[5]);
+    REQUIRE(unmap.size == 0x10000);
+
+    const auto& fence = std::get<FenceRecord>((*parsed)[6]);
+    REQUIRE(fence.syncpoint == 17);
+    REQUIRE(fence.value == 0x1234);
+
+    REQUIRE(std::holds_alternative<FrameEndRecord>((*parsed)[7]));
+    REQUIRE(std::get<CommandListRecord>((*parsed)[8]).commands.empty());
+}
+
+TEST_CASE("CommandCapture: Invalid captures are rejected", "[video_core]") {
+    auto data = Serialize({UnmapRecord{1, 0x10000, 0x1000}, MemoryRecord{0x1000, {1, 2, 3}}});
+    REQUIRE(ParseCapture(data).has_value());
+
+    // Truncated record
+    auto truncated = data;
+    truncated.pop_back();
+    REQUIRE(!ParseCapture(truncated).has_value());
+
+    // Wrong magic
+    auto bad_magic = data;
+    bad_magic[0] = 'X';
+    REQUIRE(!ParseCapture(bad_magic).has_value());
+
+    // Unknown record type
+    auto bad_type = data;
+    bad_type[8] = 0xFF;
+    REQUIRE(!ParseCapture(bad_type).has_value());
+}
+
+TEST_CASE("CommandCapture: Mapped memory is recorded once", "[video_core]") {
+    constexpr u64 PageSize = 0x1000;
+    constexpr DAddr BaseAddress = 0x20'0000;
+
+    // Fills memory with the page number of every byte
+    const Recorder::MemoryReader read = [](DAddr address, std::span<u8> data) {
+        for (size_t offset = 0; offset < data.size(); ++offset) {
+            data[offset] = static_cast<u8>((address + offset) / PageSize);
+        }
+    };
+    const auto path = std::filesystem::temp_directory_path() / "suyu_command_capture_test.bin";
+    {
+        Recorder recorder{path};
+        REQUIRE(recorder.IsOpen());
+        recorder.RecordMappedMemory(BaseAddress, 4 * PageSize, read);
+        // Only the last two pages are new
+        recorder.RecordMappedMemory(BaseAddress + 2 * PageSize, 4 * PageSize, read);
+        // Pages already recorded are not recorded again
+        recorder.RecordMappedMemory(BaseAddress + PageSize, PageSize, read);
+        // Unmapped pages may hold other memory when mapped again, unaligned ranges cover the page
+        recorder.ForgetMappedMemory(BaseAddress + PageSize, 1);
+        recorder.RecordMappedMemory(BaseAddress, 2 * PageSize, read);
+    }
+    const auto records = LoadCapture(path);
+    std::filesystem::remove(path);
+    REQUIRE(records.has_value());
+
+    std::vector<std::pair<DAddr, size_t>> ranges;
+    for (const Record& record : *records) {
+        const auto& memory = std::get<MemoryRecord>(record);
+        REQUIRE(std::ranges::all_of(memory.data, [&, offset = size_t{0}](u8 value) mutable {
+            return value == static_cast<u8>((memory.address + offset++) / PageSize);
+        }));
+        ranges.emplace_back(memory.address, memory.data.size());
+    }
+    REQUIRE(ranges == std::vector<std::pair<DAddr, size_t>>{
+                          {BaseAddress, 4 * PageSize},
+                          {BaseAddress + 4 * PageSize, 2 * PageSize},
+                          {BaseAddress + PageSize, PageSize},
+                      });
+}
@@ -0,0 +1,555 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/command_capture.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/puller.h"
+#include "video_core/macro/macro_interpreter.h"
+
+namespace {
+using namespace Tegra::Macro;
+using Tegra::Engines::Maxwell3D;
+
+using Send = std::pair<u32, u32>;
+
+constexpr u32 MacroRegistersStart = 0xE00;
+
+class RecordingContext final : public MacroContext {
+public:
+    void CallMethod(u32 method, u32 argument) override {
+        sends.emplace_back(method, argument);
+    }
+
+    u32 GetRegisterValue(u32 method) const override {
+        return method * 3 + 1;
+    }
+
+    std::vector<Send> sends;
+};
+
+class NullContext final : public MacroContext {
+public:
+    void CallMethod(u32 method, u32 argument) override {
+        sum += method ^ argument;
+    }
+
+    u32 GetRegisterValue(u32 method) const override {
+        return method;
+    }
+
+    u32 sum{};
+};
+
+/// Keeps the registers written by macros, so captured macros read the state they set up
+class RegisterFileContext final : public MacroContext {
+public:
+    void CallMethod(u32 method, u32 argument) override {
+        if (method < registers.size()) {
+            registers[method] = argument;
+        }
+    }
+
+    u32 GetRegisterValue(u32 method) const override {
+        return method < registers.size() ? registers[method] : 0;
+    }
+
+    std::vector<u32> registers = std::vector<u32>(MacroRegistersStart);
+};
+
+Opcode MakeOpcode(Operation operation, ResultOperation result_operation, u32 dst, u32 src_a,
+                  bool exit) {
+    Opcode opcode{};
+    opcode.operation.Assign(operation);
+    opcode.result_operation.Assign(result_operation);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.is_exit.Assign(exit ? 1 : 0);
+    return opcode;
+}
+
+u32 AddImmediate(ResultOperation result_operation, u32 dst, u32 src_a, s32 immediate,
+                 bool exit = false) {
+    Opcode opcode = MakeOpcode(Operation::AddImmediate, result_operation, dst, src_a, exit);
+    opcode.immediate.Assign(immediate);
+    return opcode.raw;
+}
+
+u32 Read(ResultOperation result_operation, u32 dst, u32 src_a, s32 immediate) {
+    Opcode opcode = MakeOpcode(Operation::Read, result_operation, dst, src_a, false);
+    opcode.immediate.Assign(immediate);
+    return opcode.raw;
+}
+
+u32 ALU(ALUOperation alu_operation, ResultOperation result_operation, u32 dst, u32 src_a,
+        u32 src_b, bool exit = false) {
+    Opcode opcode = MakeOpcode(Operation::ALU, result_operation, dst, src_a, exit);
+    opcode.src_b.Assign(src_b);
+    opcode.alu_operation.Assign(alu_operation);
+    return opcode.raw;
+}
+
+u32 ExtractInsert(ResultOperation result_operation, u32 dst, u32 src_a, u32 src_b, u32 src_bit,
+                  u32 size, u32 dst_bit) {
+    Opcode opcode = MakeOpcode(Operation::ExtractInsert, result_operation, dst, src_a, false);
+    opcode.src_b.Assign(src_b);
+    opcode.bf_src_bit.Assign(src_bit);
+    opcode.bf_size.Assign(size);
+    opcode.bf_dst_bit.Assign(dst_bit);
+    return opcode.raw;
+}
+
+u32 Branch(BranchCondition condition, u32 src_a, s32 offset, bool annul = false,
+           bool exit = false) {
+    Opcode opcode = MakeOpcode(Operation::Branch, {}, 0, src_a, exit);
+    opcode.branch_condition.Assign(condition);
+    opcode.branch_annul.Assign(annul ? 1 : 0);
+    opcode.immediate.Assign(offset);
+    return opcode.raw;
+}
+
+u32 Nop(bool exit = false) {
+    return AddImmediate(ResultOperation::Move, 0, 0, 0, exit);
+}
+
+constexpr u32 MakeMethodAddress(u32 address, u32 increment) {
+    return address | (increment << 12);
+}
+
+/// Sends the parameters following the count in the first parameter to consecutive methods, then
+/// sends the count, the way games upload constant buffer data.
+std::vector<u32> UploadMacro() {
+    return {
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, MakeMethodAddress(0x100, 1)),
+        AddImmediate(ResultOperation::IgnoreAndFetch, 2, 0, 0),
+        // Loop: send $r2 and fetch the next parameter, decrement the count
+        AddImmediate(ResultOperation::FetchAndSend, 2, 2, 0),
+        AddImmediate(ResultOperation::Move, 1, 1, -1),
+        Branch(BranchCondition::NotZero, 1, -2),
+        // Delay slot, also executed when the loop ends
+        AddImmediate(ResultOperation::Move, 3, 3, 1),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 3, 0, true),
+        Nop(),
+    };
+}
+
+/// Reads registers, combines them with bitfield operations and sends the results.
+std::vector<u32> StateMacro() {
+    return {
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, MakeMethodAddress(0x200, 1)),
+        // Read a register, add the first parameter and send the result
+        Read(ResultOperation::Move, 2, 0, 0x10),
+        ALU(ALUOperation::Add, ResultOperation::MoveAndSend, 3, 2, 1),
+        ExtractInsert(ResultOperation::MoveAndSend, 4, 3, 1, 4, 8, 16),
+        Read(ResultOperation::Move, 5, 1, 2),
+        AddImmediate(ResultOperation::MoveAndSend, 5, 5, 7),
+        ALU(ALUOperation::Xor, ResultOperation::MoveAndSend, 0, 4, 5, true),
+        AddImmediate(ResultOperation::IgnoreAndFetch, 6, 0, 0),
+    };
+}
+
+std::vector<Send> Run(const std::vector<u32>& code, const std::vector<u32>& parameters,
+                      std::size_t* num_fused = nullptr) {
+    const DecodedMacro program{code};
+    if (num_fused) {
+        *num_fused = program.NumFusedInstructions();
+    }
+    RecordingContext context;
+    program.Execute(context, parameters);
+    return context.sends;
+}
+
+/// Macro code uploaded to the 3D engine and the calls made to it, in submission order
+struct MacroTrace {
+    std::vector<std::vector<u32>> codes;
+    std::vector<std::pair<std::size_t, std::vector<u32>>> calls;
+};
+
+/**
+ * Follows the macro uploads and calls of captured command lists, like the DMA pusher and the 3D
+ * engine do when they run them.
+ */
+class MacroTraceBuilder {
+public:
+    void Process(s32 channel_id, std::span<const Tegra::CommandHeader> commands) {
+        Channel& channel = channels[channel_id];
+        for (const Tegra::CommandHeader& header : commands) {
+            if (channel.method_count > 0) {
+                --channel.method_count;
+                CallMethod(channel, channel.method, header.argument, channel.method_count == 0);
+                if (!channel.non_incrementing) {
+                    ++channel.method;
+                }
+                if (channel.increment_once) {
+                    channel.non_incrementing = true;
+                }
+                continue;
+            }
+            switch (header.mode) {
+            case Tegra::SubmissionMode::Increasing:
+            case Tegra::SubmissionMode::NonIncreasing:
+            case Tegra::SubmissionMode::IncreaseOnce:
+                channel.method = header.method;
+                channel.subchannel = header.subchannel;
+                channel.method_count = header.method_count;
+                channel.non_incrementing = header.mode == Tegra::SubmissionMode::NonIncreasing;
+                channel.increment_once = header.mode == Tegra::SubmissionMode::IncreaseOnce;
+                break;
+            case Tegra::SubmissionMode::Inline:
+                channel.subchannel = header.subchannel;
+                CallMethod(channel, header.method, header.arg_count, true);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    MacroTrace trace;
+
+private:
+    struct Channel {
+        std::array<bool, 8> is_3d{};
+        u32 subchannel{};
+        u32 method{};
+        u32 method_count{};
+        bool non_incrementing{};
+        bool increment_once{};
+        u32 instruction_ptr{};
+        u32 start_address_ptr{};
+        std::array<u32, 0x80> positions{};
+        /// Index in the trace of the code uploaded at an instruction pointer
+        std::map<u32, std::size_t> uploads;
+        u32 executing_macro{};
+        std::vector<u32> parameters;
+    };
+
+    void CallMethod(Channel& channel, u32 method, u32 argument, bool is_last_call) {
+        if (method == static_cast<u32>(Tegra::BufferMethods::BindObject)) {
+            channel.is_3d[channel.subchannel] =
+                argument == static_cast<u32>(Tegra::EngineID::MAXWELL_B);
+            return;
+        }
+        if (!channel.is_3d[channel.subchannel]) {
+            return;
+        }
+        if (method >= MacroRegistersStart) {
+            if (channel.executing_macro == 0) {
+                channel.executing_macro = method;
+            }
+            channel.parameters.push_back(argument);
+            if (is_last_call) {
+                CallMacro(channel);
+            }
+            return;
+        }
+        switch (method) {
+        case MAXWELL3D_REG_INDEX(load_mme.instruction_ptr):
+            channel.instruction_ptr = argument;
+            channel.uploads.erase(argument);
+            break;
+        case MAXWELL3D_REG_INDEX(load_mme.instruction): {
+            const auto [it, is_new] =
+                channel.uploads.try_emplace(channel.instruction_ptr, trace.codes.size());
+            if (is_new) {
+                trace.codes.emplace_back();
+            }
+            trace.codes[it->second].push_back(argument);
+            break;
+        }
+        case MAXWELL3D_REG_INDEX(load_mme.start_address_ptr):
+            channel.start_address_ptr = argument;
+            break;
+        case MAXWELL3D_REG_INDEX(load_mme.start_address):
+            channel.positions[channel.start_address_ptr++ % channel.positions.size()] = argument;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void CallMacro(Channel& channel) {
+        const u32 entry = (channel.executing_macro - MacroRegistersStart) >> 1;
+        const u32 position = channel.positions[entry % channel.positions.size()];
+        channel.executing_macro = 0;
+        if (const auto code = FindCode(channel, position)) {
+            trace.calls.emplace_back(*code, std::move(channel.parameters));
+        }
+        channel.parameters.clear();
+    }
+
+    /// Finds the code starting at a position, macros may start in the middle of an upload
+    std::optional<std::size_t> FindCode(Channel& channel, u32 position) {
+        if (const auto it = channel.uploads.find(position); it != channel.uploads.end()) {
+            return it->second;
+        }
+        for (const auto& [base, index] : channel.uploads) {
+            const std::vector<u32>& code = trace.codes[index];
+            if (position >= base && position - base < code.size()) {
+                const std::size_t rebased_index = trace.codes.size();
+                trace.codes.emplace_back(code.begin() + (position - base), code.end());
+                channel.uploads.emplace(position, rebased_index);
+                return rebased_index;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::unordered_map<s32, Channel> channels;
+};
+
+MacroTrace TraceMacros(std::span<const Tegra::CommandCapture::Record> records) {
+    MacroTraceBuilder builder;
+    for (const auto& record : records) {
+        if (const auto* list = std::get_if<Tegra::CommandCapture::CommandListRecord>(&record)) {
+            builder.Process(list->channel, list->commands);
+        }
+    }
+    return std::move(builder.trace);
+}
+
+/// Macros of the GPU command capture in SUYU_GPU_CAPTURE
+std::optional<MacroTrace> LoadCapturedMacros() {
+    const char* const filename{std::getenv("SUYU_GPU_CAPTURE")};
+    if (!filename) {
+        return std::nullopt;
+    }
+    const auto records{Tegra::CommandCapture::LoadCapture(filename)};
+    REQUIRE(records.has_value());
+    MacroTrace trace{TraceMacros(*records)};
+    REQUIRE(!trace.calls.empty());
+    return trace;
+}
+
+Tegra::CommandHeader MethodHeader(Tegra::SubmissionMode mode, u32 method, u32 subchannel,
+                                  u32 count) {
+    Tegra::CommandHeader header{};
+    header.method.Assign(method);
+    header.subchannel.Assign(subchannel);
+    header.method_count.Assign(count);
+    header.mode.Assign(mode);
+    return header;
+}
+
+Tegra::CommandHeader Argument(u32 value) {
+    Tegra::CommandHeader header{};
+    header.argument = value;
+    return header;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Macro: Upload loop", "[video_core]") {
+    std::size_t num_fused{};
+    const auto sends = Run(UploadMacro(), {3, 10, 11, 12, 13}, &num_fused);
+    REQUIRE(sends == std::vector<Send>{{0x100, 10}, {0x101, 11}, {0x102, 12}, {0x103, 3}});
+    // The counter decrement and the loop branch
+    REQUIRE(num_fused == 1);
+}
+
+TEST_CASE("Macro: Register reads and bitfields", "[video_core]") {
+    std::size_t num_fused{};
+    const auto sends = Run(StateMacro(), {0x1234, 0x55}, &num_fused);
+
+    const u32 sum = (0x10 * 3 + 1) + 0x1234;
+    const u32 inserted = (sum & ~(0xFFU << 16)) | (((0x1234U >> 4) & 0xFF) << 16);
+    const u32 read = ((0x1234 + 2) * 3 + 1) + 7;
+    REQUIRE(sends == std::vector<Send>{
+                         {0x200, sum}, {0x201, inserted}, {0x202, read}, {0x203, inserted ^ read}});
+    // Read and add-send, read and add immediate-send
+    REQUIRE(num_fused == 2);
+}
+
+TEST_CASE("Macro: Delay slots", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, MakeMethodAddress(0x300, 1)),
+        AddImmediate(ResultOperation::Move, 2, 0, 5),
+        // Annulled branches skip their delay slot
+        Branch(BranchCondition::Zero, 0, 3, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 100),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 101),
+        // Exit flags are ignored inside delay slots
+        Branch(BranchCondition::NotZero, 2, 2),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 2, 0, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 2, 1),
+        // Taken branches ignore their own exit flag, and may jump into a fused pair
+        Branch(BranchCondition::NotZero, 2, 3, false, true),
+        Nop(),
+        Read(ResultOperation::Move, 3, 0, 0x10),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 3, 1),
+        // Not taken branches exit after their delay slot
+        Branch(BranchCondition::Zero, 2, 4, false, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 2, 2),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 102),
+    };
+    std::size_t num_fused{};
+    const auto sends = Run(code, {0}, &num_fused);
+    REQUIRE(sends == std::vector<Send>{{0x300, 5}, {0x301, 6}, {0x302, 1}, {0x303, 7}});
+    // The register read and add-send pair, and the move followed by the first branch
+    REQUIRE(num_fused == 2);
+}
+
+TEST_CASE("Macro: Carry flag", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, MakeMethodAddress(0x400, 1)),
+        AddImmediate(ResultOperation::IgnoreAndFetch, 2, 0, 0),
+        ALU(ALUOperation::Add, ResultOperation::MoveAndSend, 3, 1, 2),
+        ALU(ALUOperation::AddWithCarry, ResultOperation::MoveAndSend, 4, 0, 0),
+        ALU(ALUOperation::Subtract, ResultOperation::MoveAndSend, 5, 0, 1),
+        ALU(ALUOperation::SubtractWithBorrow, ResultOperation::MoveAndSend, 6, 0, 0, true),
+        Nop(),
+    };
+    const auto sends = Run(code, {0xFFFFFFFF, 2});
+    REQUIRE(sends == std::vector<Send>{{0x400, 1}, {0x401, 1}, {0x402, 1}, {0x403, 0xFFFFFFFF}});
+}
+
+TEST_CASE("Macro: HLE comparison", "[video_core]") {
+    // Writes the first parameter masked with register 0x20 to register 0x21
+    const std::vector<u32> code{
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, MakeMethodAddress(0x21, 0)),
+        Read(ResultOperation::Move, 2, 0, 0x20),
+        ALU(ALUOperation::And, ResultOperation::MoveAndSend, 0, 1, 2, true),
+        Nop(),
+    };
+    const std::vector<u32> parameters{0xFF00FF};
+    std::vector<u32> registers(0x40, 0);
+    registers[0x20] = 0x0F0F0F;
+
+    // An HLE implementation matching the macro
+    auto hle_registers = registers;
+    hle_registers[0x21] = parameters[0] & hle_registers[0x20];
+    REQUIRE(CompareWithHLE(code, parameters, registers, hle_registers).empty());
+
+    // One that forgot the mask and wrote an extra register
+    hle_registers[0x21] = parameters[0];
+    hle_registers[0x22] = 1;
+    const auto mismatches = CompareWithHLE(code, parameters, registers, hle_registers);
+    REQUIRE(mismatches.size() == 2);
+    REQUIRE(mismatches[0].method == 0x21);
+    REQUIRE(mismatches[0].lle_value == 0x0F000F);
+    REQUIRE(mismatches[0].hle_value == 0xFF00FF);
+    REQUIRE(mismatches[1].method == 0x22);
+}
+
+TEST_CASE("Macro: Interpreter throughput", "[.][video_core][benchmark]") {
+    // Synthetic parameter lists shaped like the calls games make to the macros above
+    std::vector<u32> upload_parameters{256};
+    for (u32 i = 0; i <= 256; ++i) {
+        upload_parameters.push_back(i * 0x01010101);
+    }
+    const std::vector<u32> state_parameters{0x1234, 0x55};
+
+    const auto upload_code = UploadMacro();
+    const auto state_code = StateMacro();
+    const DecodedMacro upload{upload_code};
+    const DecodedMacro state{state_code};
+    NullContext context;
+
+    BENCHMARK("Decode") {
+        return DecodedMacro{upload_code}.NumFusedInstructions();
+    };
+    BENCHMARK("Upload 256 words") {
+        upload.Execute(context, upload_parameters);
+        return context.sum;
+    };
+    BENCHMARK("State x256") {
+        for (int i = 0; i < 256; ++i) {
+            state.Execute(context, state_parameters);
+        }
+        return context.sum;
+    };
+}
+
+TEST_CASE("Macro: Captured calls", "[video_core]") {
+    using Tegra::SubmissionMode;
+    constexpr u32 Subchannel = 2;
+    const std::vector<u32> code = StateMacro();
+
+    std::vector<Tegra::CommandHeader> commands{
+        MethodHeader(SubmissionMode::Increasing, 0, Subchannel, 1),
+        Argument(static_cast<u32>(Tegra::EngineID::MAXWELL_B)),
+        // Upload the macro after another one, and bind both
+        MethodHeader(SubmissionMode::Increasing, MAXWELL3D_REG_INDEX(load_mme.instruction_ptr),
+                     Subchannel, 1),
+        Argument(0),
+        MethodHeader(SubmissionMode::NonIncreasing, MAXWELL3D_REG_INDEX(load_mme.instruction),
+                     Subchannel, static_cast<u32>(code.size() + 1)),
+        Argument(Nop(true)),
+    };
+    for (const u32 word : code) {
+        commands.push_back(Argument(word));
+    }
+    commands.push_back(MethodHeader(SubmissionMode::Increasing,
+                                    MAXWELL3D_REG_INDEX(load_mme.start_address_ptr), Subchannel,
+                                    1));
+    commands.push_back(Argument(4));
+    commands.push_back(MethodHeader(SubmissionMode::NonIncreasing,
+                                    MAXWELL3D_REG_INDEX(load_mme.start_address), Subchannel, 2));
+    commands.push_back(Argument(0));
+    commands.push_back(Argument(1));
+    // Call the second macro with two parameters, the call is split across command lists
+    commands.push_back(MethodHeader(SubmissionMode::IncreaseOnce, MacroRegistersStart + 2 * 5,
+                                    Subchannel, 2));
+    commands.push_back(Argument(0x1234));
+    const std::vector<Tegra::CommandHeader> next_commands{
+        Argument(0x55),
+        // Methods of engines other than the 3D one are not macro calls
+        MethodHeader(SubmissionMode::Inline, MacroRegistersStart, Subchannel + 1, 7),
+        MethodHeader(SubmissionMode::Inline, MacroRegistersStart + 2 * 4, Subchannel, 9),
+    };
+
+    const MacroTrace trace = TraceMacros(std::vector<Tegra::CommandCapture::Record>{
+        Tegra::CommandCapture::CommandListRecord{1, std::move(commands)},
+        Tegra::CommandCapture::CommandListRecord{1, next_commands},
+    });
+    REQUIRE(trace.calls.size() == 2);
+    const auto& [state_index, state_parameters] = trace.calls[0];
+    REQUIRE(trace.codes[state_index] == code);
+    REQUIRE(state_parameters == std::vector<u32>{0x1234, 0x55});
+    const auto& [upload_index, upload_parameters] = trace.calls[1];
+    REQUIRE(trace.codes[upload_index].size() == code.size() + 1);
+    REQUIRE(upload_parameters == std::vector<u32>{9});
+}
+
+// Runs the macro calls of a GPU command capture, set SUYU_GPU_CAPTURE to its path
+TEST_CASE("Macro: Captured interpreter throughput", "[.][video_core][benchmark]") {
+    const auto trace{LoadCapturedMacros()};
+    if (!trace) {
+        WARN("SUYU_GPU_CAPTURE is not set, skipping");
+        return;
+    }
+    std::vector<std::unique_ptr<DecodedMacro>> macros;
+    macros.reserve(trace->codes.size());
+    for (const std::vector<u32>& code : trace->codes) {
+        macros.push_back(std::make_unique<DecodedMacro>(code));
+    }
+    RegisterFileContext context;
+
+    BENCHMARK("Decode") {
+        std::size_t num_fused{};
+        for (const std::vector<u32>& code : trace->codes) {
+            num_fused += DecodedMacro{code}.NumFusedInstructions();
+        }
+        return num_fused;
+    };
+    BENCHMARK("Captured calls") {
+        for (const auto& [index, parameters] : trace->calls) {
+            macros[index]->Execute(context, parameters);
+        }
+        return context.registers[0];
+    };
+}
@@ -0,0 +1,215 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "video_core/shader_environment.h"
+
+namespace {
+constexpr u32 CACHE_VERSION = 7;
+
+struct GraphicsKey {
+    u64 unique_hashes[2];
+};
+
+struct ComputeKey {
+    u64 unique_hash;
+};
+
+/// Environment with a fixed program, serialized exactly like the environments of the renderers
+class TestEnvironment final : public VideoCommon::GenericEnvironment {
+public:
+    explicit TestEnvironment(Shader::Stage stage_, u64 seed) {
+        stage = stage_;
+        code.resize(16);
+        for (size_t i = 0; i < code.size(); ++i) {
+            code[i] = seed * 0x100 + i;
+        }
+        cached_lowest = 0;
+        cached_highest = static_cast<u32>((code.size() - 1) * sizeof(u64));
+        local_memory_size = static_cast<u32>(seed);
+        cbuf_values.emplace(seed, static_cast<u32>(seed * 3));
+    }
+
+    u32 ReadCbufValue(u32, u32) override {
+        return 0;
+    }
+
+    Shader::TextureType ReadTextureType(u32) override {
+        return Shader::TextureType::Color2D;
+    }
+
+    Shader::TexturePixelFormat ReadTexturePixelFormat(u32) override {
+        return Shader::TexturePixelFormat::A8B8G8R8_UNORM;
+    }
+
+    bool IsTexturePixelFormatInteger(u32) override {
+        return false;
+    }
+
+    u32 ReadViewportTransformState() override {
+        return 1;
+    }
+
+    std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(u32, u32) override {
+        return std::nullopt;
+    }
+};
+
+/// Checks a decoded environment against the TestEnvironment it was stored from
+void CheckEnvironment(VideoCommon::FileEnvironment& env, Shader::Stage stage, u64 seed) {
+    REQUIRE(env.ShaderStage() == stage);
+    REQUIRE(env.LocalMemorySize() == seed);
+    REQUIRE(env.ReadCbufValue(0, static_cast<u32>(seed)) == seed * 3);
+    for (u32 i = 0; i < 16; ++i) {
+        REQUIRE(env.ReadInstruction(i * static_cast<u32>(sizeof(u64))) == seed * 0x100 + i);
+    }
+}
+
+/// Pipelines loaded from a cache, keyed by the first hash of their key
+struct LoadedPipelines {
+    std::map<u64, std::vector<VideoCommon::FileEnvironment>> graphics;
+    std::map<u64, std::vector<VideoCommon::FileEnvironment>> compute;
+    std::map<u64, u64> record_hashes;
+};
+
+LoadedPipelines Load(const std::filesystem::path& path) {
+    LoadedPipelines loaded;
+    const auto load{[&](auto& pipelines) {
+        return [&](std::span<const char> key, VideoCommon::CachedEnvironments envs) {
+            u64 hash{};
+            std::memcpy(&hash, key.data(), sizeof(hash));
+            loaded.record_hashes.emplace(hash, envs.RecordHash(key));
+            pipelines.emplace(hash, envs.Decode());
+        };
+    }};
+    VideoCommon::LoadPipelines(std::stop_token{}, path, CACHE_VERSION, sizeof(ComputeKey),
+                               sizeof(GraphicsKey), load(loaded.compute), load(loaded.graphics));
+    return loaded;
+}
+
+/// Stores the pipelines used by the tests and returns their record hashes
+std::array<u64, 2> StorePipelines(const std::filesystem::path& path) {
+    TestEnvironment vertex{Shader::Stage::VertexB, 1};
+    TestEnvironment fragment{Shader::Stage::Fragment, 2};
+    TestEnvironment compute{Shader::Stage::Compute, 3};
+    const std::array<const VideoCommon::GenericEnvironment*, 2> graphics_envs{&vertex, &fragment};
+    const std::array<const VideoCommon::GenericEnvironment*, 1> compute_envs{&compute};
+    return {
+        VideoCommon::SerializePipeline(GraphicsKey{{10, 11}}, graphics_envs, path, CACHE_VERSION),
+        VideoCommon::SerializePipeline(ComputeKey{20}, compute_envs, path, CACHE_VERSION),
+    };
+}
+
+void CheckPipelines(LoadedPipelines& loaded) {
+    REQUIRE(loaded.graphics.size() == 1);
+    REQUIRE(loaded.compute.size() == 1);
+    auto& graphics{loaded.graphics.at(10)};
+    REQUIRE(graphics.size() == 2);
+    CheckEnvironment(graphics[0], Shader::Stage::VertexB, 1);
+    CheckEnvironment(graphics[1], Shader::Stage::Fragment, 2);
+    auto& compute{loaded.compute.at(20)};
+    REQUIRE(compute.size() == 1);
+    CheckEnvironment(compute[0], Shader::Stage::Compute, 3);
+}
+
+std::filesystem::path TestPath(const char* name) {
+    const std::filesystem::path path{std::filesystem::temp_directory_path() / name};
+    std::filesystem::remove(path);
+    return path;
+}
+} // Anonymous namespace
+
+TEST_CASE("Pipeline cache: Indexed container round trip", "[video_core]") {
+    const auto path{TestPath("suyu_pipeline_cache_test.bin")};
+    const auto record_hashes{StorePipelines(path)};
+    REQUIRE(record_hashes[0] != 0);
+    REQUIRE(record_hashes[1] != 0);
+
+    LoadedPipelines loaded{Load(path)};
+    CheckPipelines(loaded);
+    REQUIRE(loaded.record_hashes.at(10) == record_hashes[0]);
+    REQUIRE(loaded.record_hashes.at(20) == record_hashes[1]);
+
+    // Another renderer version discards the file
+    VideoCommon::LoadPipelines(
+        std::stop_token{}, path, CACHE_VERSION + 1, sizeof(ComputeKey), sizeof(GraphicsKey),
+        [](std::span<const char>, VideoCommon::CachedEnvironments) { FAIL(); },
+        [](std::span<const char>, VideoCommon::CachedEnvironments) { FAIL(); });
+    REQUIRE(!std::filesystem::exists(path));
+}
+
+TEST_CASE("Pipeline cache: Legacy format conversion", "[video_core]") {
+    const auto path{TestPath("suyu_pipeline_cache_legacy_test.bin")};
+    {
+        // Sequential format: a header, then the environments and key of every pipeline
+        TestEnvironment vertex{Shader::Stage::VertexB, 1};
+        TestEnvironment fragment{Shader::Stage::Fragment, 2};
+        TestEnvironment compute{Shader::Stage::Compute, 3};
+        const GraphicsKey graphics_key{{10, 11}};
+        const ComputeKey compute_key{20};
+        const u32 num_graphics_envs{2};
+        const u32 num_compute_envs{1};
+
+        std::ofstream file(path, std::ios::binary);
+        file.write("yuzucach", 8).write(reinterpret_cast<const char*>(&CACHE_VERSION), 4);
+        file.write(reinterpret_cast<const char*>(&num_graphics_envs), 4);
+        vertex.Serialize(file);
+        fragment.Serialize(file);
+        file.write(reinterpret_cast<const char*>(&graphics_key), sizeof(graphics_key));
+        file.write(reinterpret_cast<const char*>(&num_compute_envs), 4);
+        compute.Serialize(file);
+        file.write(reinterpret_cast<const char*>(&compute_key), sizeof(compute_key));
+    }
+
+    LoadedPipelines converted{Load(path)};
+    CheckPipelines(converted);
+
+    // The file is replaced by the indexed container, which loads the same pipelines
+    std::array<char, 8> magic{};
+    std::ifstream{path, std::ios::binary}.read(magic.data(), magic.size());
+    REQUIRE(magic == std::array{'s', 'u', 'y', 'u', 'p', 'i', 'd', 'x'});
+    REQUIRE(!std::filesystem::exists(path.string() + ".convert"));
+
+    LoadedPipelines reloaded{Load(path)};
+    CheckPipelines(reloaded);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Pipeline cache: Torn tail truncation", "[video_core]") {
+    const auto path{TestPath("suyu_pipeline_cache_torn_test.bin")};
+    StorePipelines(path);
+    const auto valid_size{std::filesystem::file_size(path)};
+    {
+        // Half of a record header, as left behind by an interrupted write
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        const std::array<u32, 3> partial_header{1, 0, sizeof(GraphicsKey)};
+        file.write(reinterpret_cast<const char*>(partial_header.data()), sizeof(partial_header));
+    }
+
+    LoadedPipelines loaded{Load(path)};
+    CheckPipelines(loaded);
+    REQUIRE(std::filesystem::file_size(path) == valid_size);
+
+    // New pipelines are appended after the valid records
+    TestEnvironment vertex{Shader::Stage::VertexB, 4};
+    const std::array<const VideoCommon::GenericEnvironment*, 1> envs{&vertex};
+    REQUIRE(VideoCommon::SerializePipeline(GraphicsKey{{30, 31}}, envs, path, CACHE_VERSION) != 0);
+
+    LoadedPipelines appended{Load(path)};
+    REQUIRE(appended.graphics.size() == 2);
+    CheckEnvironment(appended.graphics.at(30).at(0), Shader::Stage::VertexB, 4);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,514 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/thread_worker.h"
+#include "shader_recompiler/arena.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/ir_emitter.h"
+#include "shader_recompiler/frontend/ir/post_order.h"
+#include "shader_recompiler/frontend/ir/program.h"
+#include "shader_recompiler/frontend/maxwell/control_flow.h"
+#include "shader_recompiler/frontend/maxwell/structured_control_flow.h"
+#include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "shader_recompiler/host_translate_info.h"
+#include "shader_recompiler/ir_opt/passes.h"
+#include "shader_recompiler/object_pool.h"
+#include "shader_recompiler/program_header.h"
+#include "video_core/shader_environment.h"
+#include "video_core/translated_shader_cache.h"
+
+namespace {
+struct ShaderPools {
+    void ReleaseContents() {
+        flow_block.ReleaseContents();
+        block.ReleaseContents();
+        inst.ReleaseContents();
+        arena.Release();
+    }
+
+    Shader::Arena arena;
+    Shader::ObjectPool<Shader::IR::Inst> inst{8192};
+    Shader::ObjectPool<Shader::IR::Block> block{32};
+    Shader::ObjectPool<Shader::Maxwell::Flow::Block> flow_block{32};
+};
+
+constexpr Shader::HostTranslateInfo HOST_INFO{
+    .support_float64 = true,
+    .support_float16 = true,
+    .support_int64 = true,
+    .needs_demote_reorder = false,
+    .support_snorm_render_buffer = true,
+    .support_viewport_index_layer = true,
+    .min_ssbo_alignment = 16,
+    .support_geometry_shader_passthrough = true,
+    .support_conditional_barrier = true,
+};
+
+Shader::Info TranslateStage(ShaderPools& pools, Shader::Environment& env,
+                            const Shader::HostTranslateInfo& host_info) {
+    Shader::ArenaScope arena_scope{pools.arena};
+    const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+    const bool is_vertex_a{env.ShaderStage() == Shader::Stage::VertexA};
+    Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, is_vertex_a);
+    return Shader::Maxwell::TranslateProgram(pools.inst, pools.block, env, cfg, host_info).info;
+}
+
+/// Fragment shader writing a bound texture sample to the first render target
+class TextureEnvironment final : public VideoCommon::GenericEnvironment {
+public:
+    explicit TextureEnvironment(u32 cbuf_offset_) : cbuf_offset{cbuf_offset_} {
+        stage = Shader::Stage::Fragment;
+        sph.ps.omap.target = 0xf;
+        code.resize(16);
+        // The program starts after the header, every fourth word holds scheduling information
+        code[10] = 0xc000'0000'0000'0000ULL | (u64{cbuf_offset / 4} << 36) | (0xfULL << 31) |
+                   (2ULL << 28) | (0xffULL << 20) | (7ULL << 16); // TEX.2D R0, R0, bound
+        code[11] = 0xe300'0000'0007'000fULL;                        // EXIT
+        cached_lowest = 0;
+        cached_highest = static_cast<u32>((code.size() - 1) * sizeof(u64));
+    }
+
+    u32 ReadCbufValue(u32, u32 offset) override {
+        return offset * 3;
+    }
+
+    Shader::TextureType ReadTextureType(u32 handle) override {
+        read_handle = handle;
+        return Shader::TextureType::Color2D;
+    }
+
+    Shader::TexturePixelFormat ReadTexturePixelFormat(u32) override {
+        return Shader::TexturePixelFormat::A8B8G8R8_UNORM;
+    }
+
+    bool IsTexturePixelFormatInteger(u32) override {
+        return false;
+    }
+
+    u32 ReadViewportTransformState() override {
+        return 1;
+    }
+
+    std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(u32, u32) override {
+        return std::nullopt;
+    }
+
+    u32 cbuf_offset;
+    std::optional<u32> read_handle;
+};
+
+using SimplifyPass = void (*)(Shader::Environment&, Shader::IR::Program&);
+
+/// Program of a stage as the translation builds it before the SSA rewrite
+Shader::IR::Program BuildStage(ShaderPools& pools, Shader::Environment& env) {
+    const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+    const bool is_vertex_a{env.ShaderStage() == Shader::Stage::VertexA};
+    Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, is_vertex_a);
+    Shader::IR::Program program;
+    program.syntax_list = Shader::Maxwell::BuildASL(pools.inst, pools.block, env, cfg, HOST_INFO);
+    program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    program.stage = env.ShaderStage();
+    for (const auto& node : program.syntax_list) {
+        // Blocks without predecessors are unreachable, the translation removes them
+        if (node.type == Shader::IR::AbstractSyntaxNode::Type::Block &&
+            (program.blocks.empty() || !node.data.block->ImmPredecessors().empty())) {
+            program.blocks.push_back(node.data.block);
+        }
+    }
+    return program;
+}
+
+/// Loop counting up to a folded bound, with pseudo operations and chains of dead instructions.
+/// Blocks are laid out like the structured control flow of the translation.
+Shader::IR::Program BuildLoop(ShaderPools& pools) {
+    using namespace Shader::IR;
+    Program program;
+    for (size_t index = 0; index < 5; ++index) {
+        Block* const block{pools.block.Create(pools.inst)};
+        block->SetOrder(static_cast<u32>(index));
+        program.blocks.push_back(block);
+        auto& node{program.syntax_list.emplace_back()};
+        node.type = AbstractSyntaxNode::Type::Block;
+        node.data.block = block;
+    }
+    Block* const entry{program.blocks[0]};
+    Block* const header{program.blocks[1]};
+    Block* const body{program.blocks[2]};
+    Block* const continue_block{program.blocks[3]};
+    Block* const merge{program.blocks[4]};
+    entry->AddBranch(header);
+    header->AddBranch(body);
+    body->AddBranch(continue_block);
+    continue_block->AddBranch(header);
+    continue_block->AddBranch(merge);
+    {
+        IREmitter ir{*entry};
+        ir.SetReg(Reg::R0, ir.Imm32(0));
+        ir.SetReg(Reg::R1, U32{ir.IAdd(ir.Imm32(2), ir.Imm32(3))});
+        ir.SetReg(Reg::R2, ir.Imm32(0));
+        const U32 lane{ir.LaneId()};
+        const U32 dead_product{ir.IMul(U32{ir.IAdd(lane, ir.Imm32(7))}, ir.Imm32(3))};
+        (void)ir.ShiftLeftLogical(ir.BitwiseAnd(dead_product, ir.Imm32(0xff)), ir.Imm32(2));
+
+        // Additions with pseudo operations are not folded, the unused ones die with them
+        ir.SetPred(Pred::P0, ir.GetZeroFromOp(ir.IAdd(lane, ir.Imm32(1))));
+        ir.SetPred(Pred::P1, ir.GetCarryFromOp(ir.IAdd(ir.Imm32(4), ir.Imm32(5))));
+        (void)ir.GetZeroFromOp(ir.IAdd(lane, ir.Imm32(9)));
+    }
+    {
+        // Back edge arguments resolving to an instruction, to an immediate and to the phi itself
+        IREmitter ir{*body};
+        const U32 counter{ir.IAdd(ir.GetReg(Reg::R0), ir.Imm32(1))};
+        ir.SetReg(Reg::R0, U32{ir.IAdd(counter, ir.GetReg(Reg::R2))});
+        ir.SetReg(Reg::R1, U32{ir.IAdd(ir.GetReg(Reg::R1), ir.Imm32(0))});
+        ir.SetReg(Reg::R2, ir.IMul(ir.Imm32(6), ir.Imm32(7)));
+    }
+    {
+        IREmitter ir{*continue_block};
+        ir.SetPred(Pred::P2, ir.ILessThan(ir.GetReg(Reg::R0), ir.GetReg(Reg::R1), false));
+    }
+    {
+        IREmitter ir{*merge};
+        const U32 vertex{ir.Imm32(0)};
+        const U32 flags{ir.Select(ir.GetPred(Pred::P0), ir.GetReg(Reg::R2),
+                                  U32{ir.Select(ir.GetPred(Pred::P1), ir.Imm32(1),
+                                                ir.GetReg(Reg::R1))})};
+        ir.SetAttribute(Attribute::Generic0X, ir.BitCast<F32>(ir.GetReg(Reg::R0)), vertex);
+        ir.SetAttribute(Attribute::Generic0Y, ir.BitCast<F32>(flags), vertex);
+        ir.SetAttribute(Attribute::Generic0Z,
+                        ir.BitCast<F32>(U32{ir.Select(ir.GetPred(Pred::P2), ir.Imm32(1),
+                                                      ir.Imm32(0))}),
+                        vertex);
+        ir.Epilogue();
+    }
+    program.post_order_blocks = PostOrder(program.syntax_list.front());
+    program.stage = Shader::Stage::Fragment;
+    return program;
+}
+
+/// Runs a simplification between the SSA rewrite and the dead code elimination
+void Optimize(Shader::Environment& env, Shader::IR::Program& program, SimplifyPass simplify) {
+    Shader::Optimization::SsaRewritePass(program);
+    simplify(env, program);
+    Shader::Optimization::DeadCodeEliminationPass(program);
+}
+
+/// Dump of a program without its instruction addresses, to compare programs built separately
+std::string Dump(const Shader::IR::Program& program) {
+    std::istringstream stream{Shader::IR::DumpProgram(program)};
+    std::string dump;
+    for (std::string line; std::getline(stream, line);) {
+        if (line.starts_with('[')) {
+            line.erase(0, line.find("] ") + 2);
+        }
+        dump += line;
+        dump += '\n';
+    }
+    return dump;
+}
+
+/// Optimizes a program with both simplifications and returns the simplified dump once they match
+std::string CheckSimplification(Shader::Environment& env,
+                                const std::function<Shader::IR::Program(ShaderPools&)>& build) {
+    ShaderPools pools;
+    Shader::ArenaScope arena_scope{pools.arena};
+    Shader::IR::Program propagated{build(pools)};
+    Optimize(env, propagated, Shader::Optimization::ConstantPropagationPass);
+    Shader::IR::Program simplified{build(pools)};
+    Optimize(env, simplified, Shader::Optimization::SimplificationPass);
+    const std::string simplified_dump{Dump(simplified)};
+
+    // Constant propagation leaves the identities it creates in place
+    Shader::Optimization::IdentityRemovalPass(propagated);
+    Shader::Optimization::DeadCodeEliminationPass(propagated);
+    Shader::Optimization::IdentityRemovalPass(simplified);
+    Shader::Optimization::DeadCodeEliminationPass(simplified);
+    REQUIRE(Dump(simplified) == Dump(propagated));
+    return simplified_dump;
+}
+
+/// Graphics pipelines of the pipeline cache in SUYU_PIPELINE_CACHE
+std::optional<std::vector<std::vector<VideoCommon::FileEnvironment>>> LoadStoredPipelines() {
+    const char* const filename{std::getenv("SUYU_PIPELINE_CACHE")};
+    if (!filename) {
+        return std::nullopt;
+    }
+    std::vector<std::vector<VideoCommon::FileEnvironment>> pipelines;
+    REQUIRE(VideoCommon::VisitStoredPipelines(
+        filename, [&](bool is_compute, std::span<const char>,
+                      VideoCommon::CachedEnvironments cached_envs) {
+            if (is_compute) {
+                return;
+            }
+            auto envs{cached_envs.Decode()};
+            if (!envs.empty()) {
+                pipelines.push_back(std::move(envs));
+            }
+        }));
+    REQUIRE(!pipelines.empty());
+    return pipelines;
+}
+} // Anonymous namespace
+
+TEST_CASE("Shader translation: Arena allocations", "[video_core]") {
+    Shader::Arena arena{256};
+    void* const small{arena.Allocate(3, 1)};
+    void* const aligned{arena.Allocate(8, 64)};
+    REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+    REQUIRE(static_cast<std::byte*>(aligned) > static_cast<std::byte*>(small));
+
+    void* const large{arena.Allocate(1024, 8)};
+    REQUIRE(large != nullptr);
+    REQUIRE(arena.GetCounters().num_allocations == 3);
+    REQUIRE(arena.GetCounters().allocated_bytes == 3 + 8 + 1024);
+    REQUIRE(arena.GetCounters().num_chunks == 1);
+
+    // Released memory is squashed into a single chunk large enough for the same workload
+    arena.Release();
+    REQUIRE(arena.GetCounters().num_allocations == 0);
+    (void)arena.Allocate(3, 1);
+    (void)arena.Allocate(8, 64);
+    (void)arena.Allocate(1024, 8);
+    REQUIRE(arena.GetCounters().num_chunks == 0);
+}
+
+TEST_CASE("Shader translation: Arena containers", "[video_core]") {
+    Shader::Arena arena;
+    {
+        Shader::ArenaVector<u32> heap_vector(16);
+        REQUIRE(arena.GetCounters().num_allocations == 0);
+    }
+    {
+        Shader::ArenaScope scope{arena};
+        Shader::ArenaVector<u32> vector(16);
+        Shader::ArenaUnorderedMap<u32, Shader::ArenaVector<u32>> map;
+        map[1].push_back(2);
+        {
+            Shader::Arena nested_arena;
+            Shader::ArenaScope nested_scope{nested_arena};
+            Shader::ArenaVector<u32> nested_vector(16);
+            REQUIRE(nested_arena.GetCounters().num_allocations == 1);
+        }
+        REQUIRE(Shader::Arena::Current() == &arena);
+        REQUIRE(map.at(1).front() == 2);
+    }
+    REQUIRE(Shader::Arena::Current() == nullptr);
+    REQUIRE(arena.GetCounters().num_allocations >= 3);
+}
+
+TEST_CASE("Shader translation: Translated shader cache", "[video_core]") {
+    VideoCommon::TranslatedStage stage{.index = 4, .code = {0x07230203, 0x00010000, 42}};
+    stage.info.uses_sample_id = true;
+    stage.info.uses_patches[29] = true;
+    stage.info.interpolation[3] = Shader::Interpolation::Flat;
+    stage.info.loads.Set(Shader::IR::Attribute::PositionW);
+    stage.info.stores.mask.set(511);
+    stage.info.legacy_stores_mapping.emplace(Shader::IR::Attribute::ColorFrontDiffuseR,
+                                             Shader::IR::Attribute::Generic0X);
+    stage.info.used_storage_buffer_types = Shader::IR::Type::U32 | Shader::IR::Type::U64;
+    stage.info.constant_buffer_used_sizes[17] = 0x100;
+    stage.info.nvn_buffer_used.set(15);
+    stage.info.storage_buffers_descriptors.push_back({
+        .cbuf_index = 0,
+        .cbuf_offset = 0x110,
+        .count = 1,
+        .is_written = true,
+    });
+    stage.info.texture_descriptors.resize(13);
+    stage.info.texture_descriptors.back().type = Shader::TextureType::ColorCube;
+    const std::array stages{stage};
+
+    const auto check{[&](const std::vector<VideoCommon::TranslatedStage>& decoded) {
+        REQUIRE(decoded.size() == 1);
+        const Shader::Info& info{decoded.front().info};
+        REQUIRE(decoded.front().index == stage.index);
+        REQUIRE(decoded.front().code == stage.code);
+        REQUIRE(info.uses_sample_id);
+        REQUIRE(!info.uses_workgroup_id);
+        REQUIRE(info.uses_patches == stage.info.uses_patches);
+        REQUIRE(info.interpolation == stage.info.interpolation);
+        REQUIRE(info.loads.mask == stage.info.loads.mask);
+        REQUIRE(info.stores.mask == stage.info.stores.mask);
+        REQUIRE(info.legacy_stores_mapping == stage.info.legacy_stores_mapping);
+        REQUIRE(info.used_storage_buffer_types == stage.info.used_storage_buffer_types);
+        REQUIRE(info.constant_buffer_used_sizes == stage.info.constant_buffer_used_sizes);
+        REQUIRE(info.nvn_buffer_used == stage.info.nvn_buffer_used);
+        REQUIRE(info.storage_buffers_descriptors == stage.info.storage_buffers_descriptors);
+        REQUIRE(info.texture_descriptors == stage.info.texture_descriptors);
+    }};
+
+    const std::vector<u8> encoded{VideoCommon::EncodeTranslatedStages(stages)};
+    const auto decoded{VideoCommon::DecodeTranslatedStages(encoded)};
+    REQUIRE(decoded.has_value());
+    check(*decoded);
+    REQUIRE(!VideoCommon::DecodeTranslatedStages(std::span(encoded).first(encoded.size() - 1)));
+
+    const std::filesystem::path path{std::filesystem::temp_directory_path() /
+                                     "suyu_translated_shader_cache_test.bin"};
+    std::filesystem::remove(path);
+    {
+        VideoCommon::TranslatedShaderCache cache;
+        cache.Open(path, 1, 0xcafe);
+        REQUIRE(cache.IsOpen());
+        cache.Store(0x1234, stages);
+        // Entries stored in this session are only visible after opening the file again
+        REQUIRE(!cache.Find(0x1234));
+    }
+    {
+        VideoCommon::TranslatedShaderCache cache;
+        cache.Open(path, 1, 0xcafe);
+        const auto found{cache.Find(0x1234)};
+        REQUIRE(found.has_value());
+        check(*found);
+        REQUIRE(!cache.Find(0x5678));
+    }
+    {
+        // A different host discards the stored shaders
+        VideoCommon::TranslatedShaderCache cache;
+        cache.Open(path, 1, 0xbeef);
+        REQUIRE(!cache.Find(0x1234));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Shader translation: Parallel graphics stages", "[video_core]") {
+    // Stages of a pipeline are translated on the workers with a pool each, like the pipeline cache
+    Common::ThreadWorker workers(2, "ShaderTranslationTest");
+    std::array<ShaderPools, 4> pools;
+    std::array<TextureEnvironment, 4> envs{TextureEnvironment{8}, TextureEnvironment{12},
+                                           TextureEnvironment{16}, TextureEnvironment{20}};
+    std::array<Shader::Info, 4> infos;
+    Common::ParallelFor(workers, envs.size(), [&](size_t stage) {
+        pools[stage].ReleaseContents();
+        infos[stage] = TranslateStage(pools[stage], envs[stage], HOST_INFO);
+    });
+
+    ShaderPools serial_pools;
+    for (size_t stage = 0; stage < envs.size(); ++stage) {
+        REQUIRE(envs[stage].read_handle == envs[stage].cbuf_offset * 3);
+        const Shader::Info& info{infos[stage]};
+        REQUIRE(info.texture_descriptors.size() == 1);
+        REQUIRE(info.texture_descriptors[0].type == Shader::TextureType::Color2D);
+        REQUIRE(info.texture_descriptors[0].cbuf_offset == envs[stage].cbuf_offset);
+        REQUIRE(info.stores_frag_color[0]);
+
+        serial_pools.ReleaseContents();
+        const Shader::Info serial_info{TranslateStage(serial_pools, envs[stage], HOST_INFO)};
+        REQUIRE(serial_info.texture_descriptors == info.texture_descriptors);
+    }
+}
+
+TEST_CASE("Shader translation: Simplification", "[video_core]") {
+    // The single pass simplification gives the program of constant propagation without identities
+    TextureEnvironment env{8};
+    const std::string loop{CheckSimplification(env, BuildLoop)};
+    REQUIRE(loop.find("Identity") == std::string::npos);
+    REQUIRE(loop.find("ShiftLeftLogical32") == std::string::npos);
+    REQUIRE(loop.find("IMul32") == std::string::npos);
+    REQUIRE(loop.find("GetZeroFromOp") != std::string::npos);
+    REQUIRE(loop.find("GetCarryFromOp") != std::string::npos);
+    REQUIRE(loop.find("[ #42, {Block $3} ]") != std::string::npos);
+
+    const std::string stage{CheckSimplification(
+        env, [&](ShaderPools& pools) { return BuildStage(pools, env); })};
+    REQUIRE(stage.find("Identity") == std::string::npos);
+    REQUIRE(stage.find("ImageSampleImplicitLod") != std::string::npos);
+}
+
+// Compares the simplifications on a pipeline cache, set SUYU_PIPELINE_CACHE to its path
+TEST_CASE("Shader translation: Stored pipeline simplification", "[.][video_core][benchmark]") {
+    auto stored_pipelines{LoadStoredPipelines()};
+    if (!stored_pipelines) {
+        WARN("SUYU_PIPELINE_CACHE is not set, skipping");
+        return;
+    }
+    std::vector<VideoCommon::FileEnvironment*> envs;
+    for (auto& pipeline : *stored_pipelines) {
+        for (auto& env : pipeline) {
+            envs.push_back(&env);
+        }
+    }
+    for (VideoCommon::FileEnvironment* const env : envs) {
+        CheckSimplification(*env, [&](ShaderPools& pools) { return BuildStage(pools, *env); });
+    }
+
+    // Building and rewriting the programs is measured alone, to subtract it from the other results
+    ShaderPools pools;
+    const auto run{[&](SimplifyPass simplify) {
+        for (VideoCommon::FileEnvironment* const env : envs) {
+            pools.ReleaseContents();
+            Shader::ArenaScope arena_scope{pools.arena};
+            Shader::IR::Program program{BuildStage(pools, *env)};
+            Optimize(*env, program, simplify);
+        }
+        return envs.size();
+    }};
+    BENCHMARK("Without simplification") {
+        return run([](Shader::Environment&, Shader::IR::Program&) {});
+    };
+    BENCHMARK("Constant propagation") {
+        return run(Shader::Optimization::ConstantPropagationPass);
+    };
+    BENCHMARK("Simplification") {
+        return run(Shader::Optimization::SimplificationPass);
+    };
+}
+
+// Translates the graphics pipelines of a pipeline cache, set SUYU_PIPELINE_CACHE to its path
+TEST_CASE("Shader translation: Stored graphics pipelines", "[.][video_core][benchmark]") {
+    auto stored_pipelines{LoadStoredPipelines()};
+    if (!stored_pipelines) {
+        WARN("SUYU_PIPELINE_CACHE is not set, skipping");
+        return;
+    }
+    auto& pipelines{*stored_pipelines};
+
+    const Shader::HostTranslateInfo& host_info{HOST_INFO};
+    const size_t num_workers{std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1};
+    Common::ThreadWorker workers(num_workers, "ShaderTranslationBenchmark");
+    std::array<ShaderPools, 6> pools;
+
+    BENCHMARK("Serial stages") {
+        for (auto& envs : pipelines) {
+            pools[0].ReleaseContents();
+            for (auto& env : envs) {
+                TranslateStage(pools[0], env, host_info);
+            }
+        }
+        return pipelines.size();
+    };
+    BENCHMARK("Parallel stages") {
+        for (auto& envs : pipelines) {
+            Common::ParallelFor(workers, envs.size(), [&](size_t stage) {
+                pools[stage].ReleaseContents();
+                TranslateStage(pools[stage], envs[stage], host_info);
+            });
+        }
+        return pipelines.size();
+    };
+
+    // Once warmed up, translating a program does not reach the global allocator
+    pools[0].ReleaseContents();
+    TranslateStage(pools[0], pipelines.front().front(), host_info);
+    pools[0].ReleaseContents();
+    TranslateStage(pools[0], pipelines.front().front(), host_info);
+    const Shader::Arena::Counters& counters{pools[0].arena.GetCounters()};
+    REQUIRE(counters.num_allocations > 0);
+    REQUIRE(counters.num_chunks == 0);
+}
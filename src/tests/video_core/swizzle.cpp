@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/textures/decoders.h"
+
+namespace {
+using namespace Tegra::Texture;
+
+constexpr SwizzleTable SWIZZLE_TABLE = MakeSwizzleTable();
+
+struct Extent {
+    u32 width;
+    u32 height;
+    u32 depth;
+};
+
+/// Straightforward block linear addressing of a byte, used as the reference for the fast paths
+u32 ReferenceOffset(u32 x, u32 y, u32 z, u32 stride, u32 height, u32 block_height,
+                    u32 block_depth) {
+    const u32 gobs_in_x = (stride + GOB_SIZE_X - 1) / GOB_SIZE_X;
+    const u32 gobs_per_block = 1U << (block_height + block_depth);
+    const u32 block_size = gobs_in_x * gobs_per_block * GOB_SIZE;
+    const u32 block_lines = GOB_SIZE_Y << block_height;
+    const u32 block_rows = (height + block_lines - 1) / block_lines;
+    const u32 slice_size = block_rows * block_size;
+
+    const u32 gob_y = y / GOB_SIZE_Y;
+    const u32 gob_z = z & ((1U << block_depth) - 1);
+    return (z >> block_depth) * slice_size + (gob_y >> block_height) * block_size +
+           (x / GOB_SIZE_X) * gobs_per_block * GOB_SIZE +
+           ((gob_z << block_height) + (gob_y & ((1U << block_height) - 1))) * GOB_SIZE +
+           SWIZZLE_TABLE[y % GOB_SIZE_Y][x % GOB_SIZE_X];
+}
+
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    for (u8& value : data) {
+        value = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Swizzle: Unswizzle matches reference", "[video_core]") {
+    static constexpr std::array<u32, 5> BYTES_PER_PIXEL{1, 2, 4, 8, 16};
+    static constexpr std::array<Extent, 4> EXTENTS{{
+        {64, 64, 1},
+        {37, 19, 1},
+        {130, 40, 3},
+        {8, 200, 2},
+    }};
+    for (const u32 bpp : BYTES_PER_PIXEL) {
+        for (const Extent& extent : EXTENTS) {
+            for (u32 block_height = 0; block_height < 4; ++block_height) {
+                const u32 block_depth = extent.depth > 1 ? 1 : 0;
+                const size_t swizzled_size = CalculateSize(true, bpp, extent.width, extent.height,
+                                                           extent.depth, block_height, block_depth);
+                const std::vector<u8> swizzled = RandomBytes(swizzled_size, block_height);
+                std::vector<u8> linear(extent.width * extent.height * extent.depth * bpp);
+                UnswizzleTexture(linear, swizzled, bpp, extent.width, extent.height, extent.depth,
+                                 block_height, block_depth);
+
+                const u32 pitch = extent.width * bpp;
+                bool matches = true;
+                for (u32 z = 0; z < extent.depth; ++z) {
+                    for (u32 y = 0; y < extent.height; ++y) {
+                        for (u32 x = 0; x < pitch; ++x) {
+                            const u32 offset = ReferenceOffset(x, y, z, pitch, extent.height,
+                                                               block_height, block_depth);
+                            matches &=
+                                linear[(z * extent.height + y) * pitch + x] == swizzled[offset];
+                        }
+                    }
+                }
+                REQUIRE(matches);
+            }
+        }
+    }
+}
+
+TEST_CASE("Swizzle: Subrect matches reference", "[video_core]") {
+    static constexpr u32 WIDTH = 200;
+    static constexpr u32 HEIGHT = 70;
+    static constexpr u32 BLOCK_HEIGHT = 2;
+    for (const u32 bpp : {1U, 4U, 16U}) {
+        const u32 origin_x = 13;
+        const u32 origin_y = 5;
+        const u32 extent_x = 150;
+        const u32 extent_y = 60;
+        const u32 pitch = extent_x * bpp + 32;
+        const u32 stride = WIDTH * bpp;
+        const size_t swizzled_size = CalculateSize(true, bpp, WIDTH, HEIGHT, 1, BLOCK_HEIGHT, 0);
+
+        const std::vector<u8> swizzled = RandomBytes(swizzled_size, bpp);
+        std::vector<u8> linear(pitch * HEIGHT);
+        UnswizzleSubrect(linear, swizzled, bpp, WIDTH, HEIGHT, 1, origin_x, origin_y, extent_x,
+                         extent_y, BLOCK_HEIGHT, 0, pitch);
+
+        const std::vector<u8> source = RandomBytes(pitch * HEIGHT, bpp + 1);
+        std::vector<u8> reswizzled = swizzled;
+        SwizzleSubrect(reswizzled, source, bpp, WIDTH, HEIGHT, 1, origin_x, origin_y, extent_x,
+                       extent_y, BLOCK_HEIGHT, 0, pitch);
+
+        bool matches = true;
+        for (u32 line = 0; line < extent_y; ++line) {
+            for (u32 x = 0; x < extent_x * bpp; ++x) {
+                const u32 offset =
+                    ReferenceOffset(origin_x * bpp + x, origin_y + line, 0, stride, HEIGHT,
+                                    BLOCK_HEIGHT, 0);
+                matches &= linear[line * pitch + x] == swizzled[offset];
+                matches &= reswizzled[offset] == source[line * pitch + x];
+            }
+        }
+        REQUIRE(matches);
+    }
+}
+
+TEST_CASE("Swizzle: Round trip", "[video_core]") {
+    static constexpr u32 WIDTH = 300;
+    static constexpr u32 HEIGHT = 90;
+    for (const u32 bpp : {1U, 2U, 3U, 4U, 6U, 8U, 12U, 16U}) {
+        const size_t swizzled_size = CalculateSize(true, bpp, WIDTH, HEIGHT, 1, 3, 0);
+        const std::vector<u8> linear = RandomBytes(WIDTH * HEIGHT * bpp, bpp);
+        std::vector<u8> swizzled(swizzled_size);
+        std::vector<u8> result(linear.size());
+        SwizzleTexture(swizzled, linear, bpp, WIDTH, HEIGHT, 1, 3, 0);
+        UnswizzleTexture(result, swizzled, bpp, WIDTH, HEIGHT, 1, 3, 0);
+        REQUIRE(result == linear);
+    }
+}
+
+TEST_CASE("Swizzle: Benchmark", "[.][video_core][benchmark]") {
+    static constexpr u32 WIDTH = 1024;
+    static constexpr u32 HEIGHT = 1024;
+    static constexpr u32 BPP = 4;
+    static constexpr u32 BLOCK_HEIGHT = 4;
+    const size_t swizzled_size = CalculateSize(true, BPP, WIDTH, HEIGHT, 1, BLOCK_HEIGHT, 0);
+    std::vector<u8> swizzled = RandomBytes(swizzled_size, 0);
+    std::vector<u8> linear = RandomBytes(WIDTH * HEIGHT * BPP, 1);
+
+    BENCHMARK("Unswizzle 1024x1024 RGBA8") {
+        UnswizzleTexture(linear, swizzled, BPP, WIDTH, HEIGHT, 1, BLOCK_HEIGHT, 0);
+        return linear[0];
+    };
+    BENCHMARK("Swizzle 1024x1024 RGBA8") {
+        SwizzleTexture(swizzled, linear, BPP, WIDTH, HEIGHT, 1, BLOCK_HEIGHT, 0);
+        return swizzled[0];
+    };
+    BENCHMARK("Unswizzle subrect 1024x1024 RGBA8") {
+        UnswizzleSubrect(linear, swizzled, BPP, WIDTH, HEIGHT, 1, 0, 0, WIDTH, HEIGHT,
+                         BLOCK_HEIGHT, 0, WIDTH * BPP);
+        return linear[0];
+    };
+    BENCHMARK("Swizzle subrect 1024x1024 RGBA8") {
+        SwizzleSubrect(swizzled, linear, BPP, WIDTH, HEIGHT, 1, 0, 0, WIDTH, HEIGHT, BLOCK_HEIGHT,
+                       0, WIDTH * BPP);
+        return swizzled[0];
+    };
+}
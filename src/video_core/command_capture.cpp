@@ -0,0 +1,560 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <type_traits>
+
+#include "common/alignment.h"
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/range_sets.h"
+#include "common/range_sets.inc"
+#include "core/core.h"
+#include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/svc_common.h"
+#include "core/hle/service/nvdrv/nvdata.h"
+#include "core/memory.h"
+#include "video_core/command_capture.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/gpu.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/host1x/syncpoint_manager.h"
+#include "video_core/memory_manager.h"
+
+namespace Tegra::CommandCapture {
+
+namespace {
+
+using namespace Common::Literals;
+
+constexpr u32 CaptureMagic = Common::MakeMagic('S', 'G', 'P', 'U');
+constexpr u32 CaptureVersion = 2;
+
+/// Records are buffered and written to the file once the buffer grows past this size.
+constexpr size_t FlushThreshold = 4_MiB;
+
+/// Snapshots of mapped memory are split in records of at most this size.
+constexpr u64 MaxSnapshotSize = 4_MiB;
+
+/// Time a replay waits for a captured fence before going on without it.
+constexpr std::chrono::seconds FenceTimeout{5};
+
+enum class RecordType : u32 {
+    CommandList,
+    Memory,
+    AddressSpace,
+    Channel,
+    Map,
+    Unmap,
+    FrameEnd,
+    Fence,
+};
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+static_assert(sizeof(FileHeader) == 8, "FileHeader has wrong size");
+
+struct RecordHeader {
+    RecordType type;
+    u32 size;
+};
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader has wrong size");
+
+template <typename T>
+void Append(std::vector<u8>& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+void AppendBytes(std::vector<u8>& out, const void* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    const size_t offset = out.size();
+    out.resize(offset + size);
+    std::memcpy(out.data() + offset, data, size);
+}
+
+template <typename T>
+bool Take(std::span<const u8>& data, T& value) {
+    if (data.size() < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data.data(), sizeof(T));
+    data = data.subspan(sizeof(T));
+    return true;
+}
+
+std::optional<Record> ParseRecord(RecordType type, std::span<const u8> payload) {
+    switch (type) {
+    case RecordType::CommandList: {
+        CommandListRecord record{};
+        if (!Take(payload, record.channel) || payload.size() % sizeof(CommandHeader) != 0) {
+            return std::nullopt;
+        }
+        record.commands.resize(payload.size() / sizeof(CommandHeader));
+        if (!payload.empty()) {
+            std::memcpy(record.commands.data(), payload.data(), payload.size());
+        }
+        return record;
+    }
+    case RecordType::Memory: {
+        MemoryRecord record{};
+        if (!Take(payload, record.address)) {
+            return std::nullopt;
+        }
+        record.data.assign(payload.begin(), payload.end());
+        return record;
+    }
+    case RecordType::AddressSpace: {
+        AddressSpaceRecord record{};
+        if (!Take(payload, record.address_space) || !Take(payload, record.address_space_bits) ||
+            !Take(payload, record.split_address) || !Take(payload, record.big_page_bits) ||
+            !Take(payload, record.page_bits) || !payload.empty()) {
+            return std::nullopt;
+        }
+        return record;
+    }
+    case RecordType::Channel: {
+        ChannelRecord record{};
+        if (!Take(payload, record.channel) || !Take(payload, record.address_space) ||
+            !payload.empty()) {
+            return std::nullopt;
+        }
+        return record;
+    }
+    case RecordType::Map: {
+        MapRecord record{};
+        u8 is_big_pages{};
+        u8 is_sparse{};
+        if (!Take(payload, record.address_space) || !Take(payload, record.gpu_addr) ||
+            !Take(payload, record.device_addr) || !Take(payload, record.size) ||
+            !Take(payload, record.kind) || !Take(payload, is_big_pages) ||
+            !Take(payload, is_sparse) || !payload.empty()) {
+            return std::nullopt;
+        }
+        record.is_big_pages = is_big_pages != 0;
+        record.is_sparse = is_sparse != 0;
+        return record;
+    }
+    case RecordType::Unmap: {
+        UnmapRecord record{};
+        if (!Take(payload, record.address_space) || !Take(payload, record.gpu_addr) ||
+            !Take(payload, record.size) || !payload.empty()) {
+            return std::nullopt;
+        }
+        return record;
+    }
+    case RecordType::Fence: {
+        FenceRecord record{};
+        if (!Take(payload, record.syncpoint) || !Take(payload, record.value) ||
+            !payload.empty()) {
+            return std::nullopt;
+        }
+        return record;
+    }
+    case RecordType::FrameEnd:
+        if (!payload.empty()) {
+            return std::nullopt;
+        }
+        return FrameEndRecord{};
+    }
+    return std::nullopt;
+}
+
+} // Anonymous namespace
+
+void SerializeRecord(std::vector<u8>& out, const Record& record) {
+    const size_t header_offset = out.size();
+    Append(out, RecordHeader{});
+
+    RecordType type{};
+    if (const auto* command_list = std::get_if<CommandListRecord>(&record)) {
+        type = RecordType::CommandList;
+        Append(out, command_list->channel);
+        AppendBytes(out, command_list->commands.data(),
+                    command_list->commands.size() * sizeof(CommandHeader));
+    } else if (const auto* memory = std::get_if<MemoryRecord>(&record)) {
+        type = RecordType::Memory;
+        Append(out, memory->address);
+        AppendBytes(out, memory->data.data(), memory->data.size());
+    } else if (const auto* address_space = std::get_if<AddressSpaceRecord>(&record)) {
+        type = RecordType::AddressSpace;
+        Append(out, address_space->address_space);
+        Append(out, address_space->address_space_bits);
+        Append(out, address_space->split_address);
+        Append(out, address_space->big_page_bits);
+        Append(out, address_space->page_bits);
+    } else if (const auto* channel = std::get_if<ChannelRecord>(&record)) {
+        type = RecordType::Channel;
+        Append(out, channel->channel);
+        Append(out, channel->address_space);
+    } else if (const auto* map = std::get_if<MapRecord>(&record)) {
+        type = RecordType::Map;
+        Append(out, map->address_space);
+        Append(out, map->gpu_addr);
+        Append(out, map->device_addr);
+        Append(out, map->size);
+        Append(out, map->kind);
+        Append(out, static_cast<u8>(map->is_big_pages));
+        Append(out, static_cast<u8>(map->is_sparse));
+    } else if (const auto* unmap = std::get_if<UnmapRecord>(&record)) {
+        type = RecordType::Unmap;
+        Append(out, unmap->address_space);
+        Append(out, unmap->gpu_addr);
+        Append(out, unmap->size);
+    } else if (const auto* fence = std::get_if<FenceRecord>(&record)) {
+        type = RecordType::Fence;
+        Append(out, fence->syncpoint);
+        Append(out, fence->value);
+    } else {
+        type = RecordType::FrameEnd;
+    }
+
+    const RecordHeader header{
+        .type = type,
+        .size = static_cast<u32>(out.size() - header_offset - sizeof(RecordHeader)),
+    };
+    std::memcpy(out.data() + header_offset, &header, sizeof(header));
+}
+
+std::optional<std::vector<Record>> ParseCapture(std::span<const u8> data) {
+    FileHeader file_header{};
+    if (!Take(data, file_header) || file_header.magic != CaptureMagic ||
+        file_header.version != CaptureVersion) {
+        return std::nullopt;
+    }
+    std::vector<Record> records;
+    while (!data.empty()) {
+        RecordHeader header{};
+        if (!Take(data, header) || data.size() < header.size) {
+            return std::nullopt;
+        }
+        auto record = ParseRecord(header.type, data.first(header.size));
+        if (!record) {
+            return std::nullopt;
+        }
+        records.push_back(std::move(*record));
+        data = data.subspan(header.size);
+    }
+    return records;
+}
+
+std::optional<std::vector<Record>> LoadCapture(const std::filesystem::path& path) {
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                                  Common::FS::FileType::BinaryFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Unable to open GPU command capture {}",
+                  Common::FS::PathToUTF8String(path));
+        return std::nullopt;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadSpan(std::span<u8>{data}) != data.size()) {
+        LOG_ERROR(HW_GPU, "Failed to read GPU command capture {}",
+                  Common::FS::PathToUTF8String(path));
+        return std::nullopt;
+    }
+    auto records = ParseCapture(data);
+    if (!records) {
+        LOG_ERROR(HW_GPU, "{} is not a valid GPU command capture",
+                  Common::FS::PathToUTF8String(path));
+    }
+    return records;
+}
+
+Recorder::Recorder(const std::filesystem::path& path)
+    : file{std::make_unique<Common::FS::IOFile>(path, Common::FS::FileAccessMode::Write,
+                                                Common::FS::FileType::BinaryFile)} {
+    if (!file->IsOpen()) {
+        LOG_ERROR(HW_GPU, "Unable to create GPU command capture {}",
+                  Common::FS::PathToUTF8String(path));
+        return;
+    }
+    Append(buffer, FileHeader{.magic = CaptureMagic, .version = CaptureVersion});
+}
+
+Recorder::~Recorder() {
+    if (file->IsOpen()) {
+        void(file->WriteSpan(std::span<const u8>{buffer}));
+    }
+}
+
+bool Recorder::IsOpen() const {
+    return file->IsOpen();
+}
+
+void Recorder::RecordCommandList(s32 channel, std::span<const CommandHeader> commands) {
+    Write(CommandListRecord{channel, {commands.begin(), commands.end()}});
+}
+
+void Recorder::RecordMemory(DAddr address, std::span<const u8> data) {
+    Write(MemoryRecord{address, {data.begin(), data.end()}});
+}
+
+void Recorder::RecordAddressSpace(const AddressSpaceRecord& address_space) {
+    Write(address_space);
+}
+
+void Recorder::RecordChannel(s32 channel, u64 address_space) {
+    Write(ChannelRecord{channel, address_space});
+}
+
+void Recorder::RecordMap(const MapRecord& map) {
+    Write(map);
+}
+
+void Recorder::RecordUnmap(u64 address_space, GPUVAddr gpu_addr, u64 size) {
+    Write(UnmapRecord{address_space, gpu_addr, size});
+}
+
+void Recorder::RecordFence(u32 syncpoint, u32 value) {
+    Write(FenceRecord{syncpoint, value});
+}
+
+void Recorder::RecordFrameEnd() {
+    Write(FrameEndRecord{});
+}
+
+void Recorder::RecordMappedMemory(DAddr address, u64 size, const MemoryReader& read) {
+    const DAddr begin = Common::AlignDown(address, Core::Memory::SUYU_PAGESIZE);
+    const DAddr end = Common::AlignUp(address + size, Core::Memory::SUYU_PAGESIZE);
+    std::vector<std::pair<DAddr, DAddr>> unrecorded;
+    {
+        std::scoped_lock lk{mutex};
+        DAddr cursor = begin;
+        recorded_pages.ForEachInRange(begin, end - begin, [&](DAddr range_begin, DAddr range_end) {
+            if (cursor < range_begin) {
+                unrecorded.emplace_back(cursor, range_begin);
+            }
+            cursor = range_end;
+        });
+        if (cursor < end) {
+            unrecorded.emplace_back(cursor, end);
+        }
+        recorded_pages.Add(begin, end - begin);
+    }
+    std::vector<u8> data;
+    for (const auto& [range_begin, range_end] : unrecorded) {
+        for (DAddr snapshot = range_begin; snapshot < range_end; snapshot += MaxSnapshotSize) {
+            data.resize(std::min(range_end - snapshot, MaxSnapshotSize));
+            read(snapshot, data);
+            RecordMemory(snapshot, data);
+        }
+    }
+}
+
+void Recorder::ForgetMappedMemory(DAddr address, u64 size) {
+    const DAddr begin = Common::AlignDown(address, Core::Memory::SUYU_PAGESIZE);
+    const DAddr end = Common::AlignUp(address + size, Core::Memory::SUYU_PAGESIZE);
+    std::scoped_lock lk{mutex};
+    recorded_pages.Subtract(begin, end - begin);
+}
+
+void Recorder::Write(const Record& record) {
+    std::scoped_lock lk{mutex};
+    if (!file->IsOpen()) {
+        return;
+    }
+    SerializeRecord(buffer, record);
+    if (buffer.size() < FlushThreshold) {
+        return;
+    }
+    if (file->WriteSpan(std::span<const u8>{buffer}) != buffer.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write GPU command capture, stopping the capture");
+        file->Close();
+    }
+    buffer.clear();
+}
+
+AddressSpaceReplayer::AddressSpaceReplayer(Factory factory_) : factory{std::move(factory_)} {}
+
+AddressSpaceReplayer::~AddressSpaceReplayer() = default;
+
+bool AddressSpaceReplayer::Apply(const Record& record) {
+    if (const auto* address_space = std::get_if<AddressSpaceRecord>(&record)) {
+        address_spaces.insert_or_assign(address_space->address_space, factory(*address_space));
+    } else if (const auto* channel = std::get_if<ChannelRecord>(&record)) {
+        channel_address_spaces.insert_or_assign(channel->channel, channel->address_space);
+    } else if (const auto* map = std::get_if<MapRecord>(&record)) {
+        if (MemoryManager* const memory_manager = GetAddressSpace(map->address_space)) {
+            if (map->is_sparse) {
+                memory_manager->MapSparse(map->gpu_addr, map->size, map->is_big_pages);
+            } else {
+                memory_manager->Map(map->gpu_addr, map->device_addr, map->size, map->kind,
+                                    map->is_big_pages);
+            }
+        }
+    } else if (const auto* unmap = std::get_if<UnmapRecord>(&record)) {
+        if (MemoryManager* const memory_manager = GetAddressSpace(unmap->address_space)) {
+            memory_manager->Unmap(unmap->gpu_addr, unmap->size);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<MemoryManager> AddressSpaceReplayer::GetChannelAddressSpace(s32 channel) const {
+    const auto it = channel_address_spaces.find(channel);
+    if (it == channel_address_spaces.end()) {
+        return nullptr;
+    }
+    const auto address_space = address_spaces.find(it->second);
+    return address_space != address_spaces.end() ? address_space->second : nullptr;
+}
+
+MemoryManager* AddressSpaceReplayer::GetAddressSpace(u64 address_space) const {
+    const auto it = address_spaces.find(address_space);
+    if (it == address_spaces.end()) {
+        LOG_WARNING(HW_GPU, "Mapping on unknown address space {}", address_space);
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+Replayer::Replayer(Core::System& system_)
+    : system{system_}, address_spaces{[this](const AddressSpaceRecord& record) {
+          auto memory_manager = std::make_shared<MemoryManager>(
+              system, record.address_space_bits, record.split_address, record.big_page_bits,
+              record.page_bits);
+          system.GPU().InitAddressSpace(*memory_manager);
+          return memory_manager;
+      }} {}
+
+Replayer::~Replayer() = default;
+
+std::vector<std::chrono::nanoseconds> Replayer::Run(std::span<const Record> records) {
+    auto& gpu = system.GPU();
+    auto& device_memory = system.Host1x().MemoryManager();
+    BackDeviceMemory(records);
+
+    std::vector<std::chrono::nanoseconds> frame_times;
+    std::optional<std::chrono::steady_clock::time_point> frame_start;
+    const auto start_frame = [&frame_start] {
+        if (!frame_start) {
+            frame_start = std::chrono::steady_clock::now();
+        }
+    };
+
+    for (const Record& record : records) {
+        if (const auto* command_list = std::get_if<CommandListRecord>(&record)) {
+            start_frame();
+            boost::container::small_vector<CommandHeader, 512> commands(
+                command_list->commands.begin(), command_list->commands.end());
+            gpu.PushGPUEntries(GetChannel(command_list->channel),
+                               CommandList{std::move(commands)});
+        } else if (const auto* memory = std::get_if<MemoryRecord>(&record)) {
+            start_frame();
+            device_memory.WriteBlock(memory->address, memory->data.data(), memory->data.size());
+            gpu.InvalidateRegion(memory->address, memory->data.size());
+        } else if (const auto* channel = std::get_if<ChannelRecord>(&record)) {
+            address_spaces.Apply(record);
+            GetChannel(channel->channel);
+        } else if (const auto* fence = std::get_if<FenceRecord>(&record)) {
+            WaitFence(*fence);
+        } else if (std::holds_alternative<FrameEndRecord>(record)) {
+            start_frame();
+            gpu.WaitForIdle();
+            frame_times.push_back(std::chrono::steady_clock::now() - *frame_start);
+            frame_start.reset();
+        } else {
+            address_spaces.Apply(record);
+        }
+    }
+    gpu.WaitForIdle();
+    return frame_times;
+}
+
+void Replayer::BackDeviceMemory(std::span<const Record> records) {
+    // Device memory only exists while the game has it pinned, back everything the capture touches
+    Common::RangeSet<DAddr> ranges;
+    const auto add_range = [&ranges](DAddr address, u64 size) {
+        const DAddr begin = Common::AlignDown(address, Core::Memory::SUYU_PAGESIZE);
+        const DAddr end = Common::AlignUp(address + size, Core::Memory::SUYU_PAGESIZE);
+        ranges.Add(begin, end - begin);
+    };
+    for (const Record& record : records) {
+        if (const auto* map = std::get_if<MapRecord>(&record); map && !map->is_sparse) {
+            add_range(map->device_addr, map->size);
+        } else if (const auto* memory = std::get_if<MemoryRecord>(&record)) {
+            add_range(memory->address, memory->data.size());
+        }
+    }
+    u64 total_size = 0;
+    ranges.ForEach([&total_size](DAddr begin, DAddr end) { total_size += end - begin; });
+    if (total_size == 0) {
+        return;
+    }
+    Kernel::KProcess* const process = system.ApplicationProcess();
+    Kernel::KProcessAddress heap{};
+    const u64 heap_size = Common::AlignUp(total_size, Kernel::Svc::HeapSizeAlignment);
+    if (process->GetPageTable().SetHeapSize(std::addressof(heap), heap_size).IsError()) {
+        LOG_ERROR(HW_GPU, "Unable to allocate 0x{:X} bytes to back the captured device memory",
+                  heap_size);
+        return;
+    }
+    auto& device_memory = system.Host1x().MemoryManager();
+    const Core::Asid asid = device_memory.RegisterProcess(std::addressof(process->GetMemory()));
+    VAddr backing = GetInteger(heap);
+    ranges.ForEach([&](DAddr begin, DAddr end) {
+        device_memory.AllocateFixed(begin, end - begin);
+        device_memory.Map(begin, backing, end - begin, asid);
+        backing += end - begin;
+    });
+}
+
+void Replayer::WaitFence(const FenceRecord& fence) {
+    if (fence.syncpoint >= Service::Nvidia::MaxSyncPoints) {
+        LOG_WARNING(HW_GPU, "Captured fence on invalid syncpoint {}", fence.syncpoint);
+        return;
+    }
+    // The guest only went on once the GPU finished the work signalling the fence
+    auto& syncpoint_manager = system.Host1x().GetSyncpointManager();
+    std::mutex fence_mutex;
+    std::condition_variable fence_cv;
+    bool is_signalled = false;
+    const auto handle = syncpoint_manager.RegisterHostAction(fence.syncpoint, fence.value, [&] {
+        std::scoped_lock lk{fence_mutex};
+        is_signalled = true;
+        fence_cv.notify_all();
+    });
+    {
+        std::unique_lock lk{fence_mutex};
+        if (fence_cv.wait_for(lk, FenceTimeout, [&] { return is_signalled; })) {
+            return;
+        }
+    }
+    // Increments done outside of the captured command lists are not replayed
+    syncpoint_manager.DeregisterHostAction(fence.syncpoint, handle);
+    LOG_WARNING(HW_GPU, "Syncpoint {} did not reach {} in time, continuing the replay",
+                fence.syncpoint, fence.value);
+}
+
+s32 Replayer::GetChannel(s32 captured_channel) {
+    if (const auto it = channels.find(captured_channel); it != channels.end()) {
+        return it->second->bind_id;
+    }
+    auto& gpu = system.GPU();
+    auto channel = gpu.AllocateChannel();
+    channel->memory_manager = address_spaces.GetChannelAddressSpace(captured_channel);
+    if (!channel->memory_manager) {
+        LOG_WARNING(HW_GPU, "Channel {} was captured without its address space",
+                    captured_channel);
+        channel->memory_manager = std::make_shared<MemoryManager>(system);
+        gpu.InitAddressSpace(*channel->memory_manager);
+    }
+    gpu.InitChannel(*channel, system.GetApplicationProcessProgramID());
+    channels.emplace(captured_channel, channel);
+    return channel->bind_id;
+}
+
+} // namespace Tegra::CommandCapture
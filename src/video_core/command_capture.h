@@ -0,0 +1,210 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/range_sets.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/pte_kind.h"
+
+namespace Common::FS {
+class IOFile;
+}
+
+namespace Core {
+class System;
+}
+
+namespace Tegra {
+class MemoryManager;
+}
+
+namespace Tegra::Control {
+struct ChannelState;
+}
+
+/**
+ * Recording of the command stream submitted to the GPU, used to replay a game's rendering without
+ * running the game. Command lists are stored with their pushbuffer words already read from guest
+ * memory, so they replay as prefetched lists. The GPU address spaces are recorded from their
+ * creation with every map and unmap, mappings followed by a snapshot of the memory the capture has
+ * not seen yet, so engines resolve the same addresses on replay. Guest memory written by the CPU is
+ * stored as snapshots of the written device memory ranges, and fences the guest waited for are
+ * waited for again on replay.
+ */
+namespace Tegra::CommandCapture {
+
+/// Command list pushed to a channel, with the words of all its pushbuffer segments.
+struct CommandListRecord {
+    s32 channel;
+    std::vector<CommandHeader> commands;
+};
+
+/// Contents of a device memory range after the CPU wrote to it.
+struct MemoryRecord {
+    DAddr address;
+    std::vector<u8> data;
+};
+
+/// GPU address space created by the guest, identified by the id of its memory manager.
+struct AddressSpaceRecord {
+    u64 address_space;
+    u64 address_space_bits;
+    GPUVAddr split_address;
+    u64 big_page_bits;
+    u64 page_bits;
+};
+
+/// Channel initialized on an address space.
+struct ChannelRecord {
+    s32 channel;
+    u64 address_space;
+};
+
+/// Range of an address space mapped to device memory, or reserved when sparse.
+struct MapRecord {
+    u64 address_space;
+    GPUVAddr gpu_addr;
+    DAddr device_addr;
+    u64 size;
+    PTEKind kind;
+    bool is_big_pages;
+    bool is_sparse;
+};
+
+/// Range of an address space unmapped.
+struct UnmapRecord {
+    u64 address_space;
+    GPUVAddr gpu_addr;
+    u64 size;
+};
+
+/// Syncpoint value the guest waited for, before submitting more work or presenting a frame.
+struct FenceRecord {
+    u32 syncpoint;
+    u32 value;
+};
+
+/// End of a presented frame.
+struct FrameEndRecord {};
+
+using Record = std::variant<CommandListRecord, MemoryRecord, AddressSpaceRecord, ChannelRecord,
+                            MapRecord, UnmapRecord, FenceRecord, FrameEndRecord>;
+
+/// Appends the serialized form of a record to a buffer.
+void SerializeRecord(std::vector<u8>& out, const Record& record);
+
+/// Parses a capture file, returns nullopt when it is not a valid capture.
+[[nodiscard]] std::optional<std::vector<Record>> ParseCapture(std::span<const u8> data);
+
+/// Loads a capture file from disk.
+[[nodiscard]] std::optional<std::vector<Record>> LoadCapture(const std::filesystem::path& path);
+
+/// Writes records to a capture file. Records may be written from any thread.
+class Recorder {
+public:
+    /// Fills the span with the contents of device memory starting at the address.
+    using MemoryReader = std::function<void(DAddr address, std::span<u8> data)>;
+
+    explicit Recorder(const std::filesystem::path& path);
+    ~Recorder();
+
+    [[nodiscard]] bool IsOpen() const;
+
+    void RecordCommandList(s32 channel, std::span<const CommandHeader> commands);
+    void RecordMemory(DAddr address, std::span<const u8> data);
+    void RecordAddressSpace(const AddressSpaceRecord& address_space);
+    void RecordChannel(s32 channel, u64 address_space);
+    void RecordMap(const MapRecord& map);
+    void RecordUnmap(u64 address_space, GPUVAddr gpu_addr, u64 size);
+    void RecordFence(u32 syncpoint, u32 value);
+    void RecordFrameEnd();
+
+    /**
+     * Records the pages of a newly mapped device memory range that were not recorded since they
+     * were last unmapped. Memory written before it was mapped is not part of the capture otherwise.
+     */
+    void RecordMappedMemory(DAddr address, u64 size, const MemoryReader& read);
+
+    /// Forgets the pages of an unmapped device memory range, they may hold other memory later.
+    void ForgetMappedMemory(DAddr address, u64 size);
+
+private:
+    void Write(const Record& record);
+
+    std::mutex mutex;
+    std::unique_ptr<Common::FS::IOFile> file;
+    std::vector<u8> buffer;
+    Common::RangeSet<DAddr> recorded_pages;
+};
+
+/**
+ * Recreates the captured address spaces and applies their mappings in capture order, so replayed
+ * commands resolve GPU addresses to the same device addresses the game's did.
+ */
+class AddressSpaceReplayer {
+public:
+    /// Creates the memory manager of a captured address space.
+    using Factory = std::function<std::shared_ptr<MemoryManager>(const AddressSpaceRecord&)>;
+
+    explicit AddressSpaceReplayer(Factory factory);
+    ~AddressSpaceReplayer();
+
+    /// Applies an address space, channel or mapping record, returns false for any other record.
+    bool Apply(const Record& record);
+
+    /// Returns the address space a captured channel was initialized on, null when unknown.
+    [[nodiscard]] std::shared_ptr<MemoryManager> GetChannelAddressSpace(s32 channel) const;
+
+private:
+    [[nodiscard]] MemoryManager* GetAddressSpace(u64 address_space) const;
+
+    Factory factory;
+    std::unordered_map<u64, std::shared_ptr<MemoryManager>> address_spaces;
+    std::unordered_map<s32, u64> channel_address_spaces;
+};
+
+/**
+ * Replays a capture through the GPU of a system whose application was loaded but is not running.
+ * The captured device memory is backed by heap memory of the application process before any
+ * record is replayed, and channels are created on their recreated address spaces.
+ */
+class Replayer {
+public:
+    explicit Replayer(Core::System& system);
+    ~Replayer();
+
+    /**
+     * Pushes the records to the GPU, waits for the captured fences and for the GPU at the end of
+     * every frame.
+     *
+     * @returns The time between the first submission of each frame and the GPU thread finishing
+     *          its work
+     */
+    std::vector<std::chrono::nanoseconds> Run(std::span<const Record> records);
+
+private:
+    void BackDeviceMemory(std::span<const Record> records);
+
+    void WaitFence(const FenceRecord& fence);
+
+    s32 GetChannel(s32 captured_channel);
+
+    Core::System& system;
+    AddressSpaceReplayer address_spaces;
+    std::unordered_map<s32, std::shared_ptr<Control::ChannelState>> channels;
+};
+
+} // namespace Tegra::CommandCapture
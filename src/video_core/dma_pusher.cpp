@@ -132,6 +132,19 @@ void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
                 index += max_write;
                 continue;
             } else {
+                if (!dma_increment_once) {
+                    const u32 max_write = static_cast<u32>(
+                        std::min<std::size_t>(index + dma_state.method_count, commands.size()) -
+                        index);
+                    const u32 num_sunk =
+                        SinkIncrementingMethods(&command_header.argument, max_write);
+                    if (num_sunk != 0) {
+                        dma_state.method += num_sunk;
+                        dma_state.method_count -= num_sunk;
+                        index += num_sunk;
+                        continue;
+                    }
+                }
                 dma_state.is_last_call = dma_state.method_count <= 1;
                 CallMethod(command_header.argument);
             }
@@ -212,6 +225,11 @@ void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
                                dma_state.method_count);
     } else {
         auto subchannel = subchannels[dma_state.subchannel];
+        if (!subchannel->execution_mask[dma_state.method]) [[likely]] {
+            // Writes to a plain register overwrite each other, only the last one is observable
+            subchannel->method_sink.emplace_back(dma_state.method, base_start[num_methods - 1]);
+            return;
+        }
         subchannel->ConsumeSink();
         subchannel->current_dma_segment = dma_state.dma_get + dma_state.dma_word_offset;
         subchannel->CallMultiMethod(dma_state.method, base_start, num_methods,
@@ -219,6 +237,31 @@ void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
     }
 }
 
+u32 DmaPusher::SinkIncrementingMethods(const u32* base_start, u32 num_methods) const {
+    if (dma_state.method < non_puller_methods) {
+        return 0;
+    }
+    auto subchannel = subchannels[dma_state.subchannel];
+    const auto& execution_mask = subchannel->execution_mask;
+    const u32 method = dma_state.method;
+    const u32 max_methods =
+        std::min<u32>(num_methods, static_cast<u32>(execution_mask.size()) - method);
+    u32 num_sunk = 0;
+    while (num_sunk < max_methods && !execution_mask[method + num_sunk]) {
+        ++num_sunk;
+    }
+    if (num_sunk == 0) {
+        return 0;
+    }
+    auto& method_sink = subchannel->method_sink;
+    const std::size_t sink_offset = method_sink.size();
+    method_sink.resize(sink_offset + num_sunk);
+    for (u32 i = 0; i < num_sunk; ++i) {
+        method_sink[sink_offset + i] = {method + i, base_start[i]};
+    }
+    return num_sunk;
+}
+
 void DmaPusher::BindRasterizer(VideoCore::RasterizerInterface* rasterizer) {
     puller.BindRasterizer(rasterizer);
 }
@@ -149,6 +149,10 @@ private:
     void CallMethod(u32 argument) const;
     void CallMultiMethod(const u32* base_start, u32 num_methods) const;
 
+    /// Queues the leading run of plain register writes of an incrementing method into the method
+    /// sink of the subchannel, returns the number of arguments queued.
+    u32 SinkIncrementingMethods(const u32* base_start, u32 num_methods) const;
+
     Common::ScratchBuffer<CommandHeader>
         command_headers; ///< Buffer for list of commands fetched at once
 
@@ -297,22 +297,29 @@ void Maxwell3D::ConsumeSinkImpl() {
     const auto control = shadow_state.shadow_ram_control;
     if (control == Regs::ShadowRamControl::Track ||
         control == Regs::ShadowRamControl::TrackWithFilter) {
-
         for (auto [method, value] : method_sink) {
             shadow_state.reg_array[method] = value;
-            ProcessDirtyRegisters(method, value);
         }
-        return;
-    }
-    if (control == Regs::ShadowRamControl::Replay) {
-        for (auto [method, value] : method_sink) {
-            ProcessDirtyRegisters(method, shadow_state.reg_array[method]);
+    } else if (control == Regs::ShadowRamControl::Replay) {
+        for (auto& [method, value] : method_sink) {
+            value = shadow_state.reg_array[method];
         }
-        return;
     }
-    for (auto [method, value] : method_sink) {
-        ProcessDirtyRegisters(method, value);
+
+    // Sunk methods are plain register writes, store them and gather the dirty flags they touch in
+    // a local set so the shared flags are only updated once for the whole batch.
+    const auto& [first_table, second_table] = dirty.tables;
+    DirtyState::Flags touched_flags;
+    for (const auto [method, value] : method_sink) {
+        u32& reg = regs.reg_array[method];
+        if (reg == value) {
+            continue;
+        }
+        reg = value;
+        touched_flags[first_table[method]] = true;
+        touched_flags[second_table[method]] = true;
     }
+    dirty.flags |= touched_flags;
 }
 
 void Maxwell3D::ProcessDirtyRegisters(u32 method, u32 argument) {
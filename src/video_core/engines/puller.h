@@ -18,6 +18,7 @@ class System;
 namespace Tegra {
 class MemoryManager;
 class DmaPusher;
+class GPU;
 
 enum class EngineID {
     FERMI_TWOD_A = 0x902D, // 2D Engine
@@ -5,10 +5,14 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <ctime>
 #include <list>
 #include <memory>
 
 #include "common/assert.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
 #include "core/core.h"
@@ -18,6 +22,7 @@
 #include "core/hle/service/nvdrv/nvdata.h"
 #include "core/perf_stats.h"
 #include "video_core/cdma_pusher.h"
+#include "video_core/command_capture.h"
 #include "video_core/control/channel_state.h"
 #include "video_core/control/scheduler.h"
 #include "video_core/dma_pusher.h"
@@ -68,6 +73,9 @@ struct GPU::Impl {
     }
 
     void InitChannel(Control::ChannelState& to_init, u64 program_id) {
+        if (command_capture && to_init.memory_manager) {
+            command_capture->RecordChannel(to_init.bind_id, to_init.memory_manager->GetID());
+        }
         to_init.Init(system, gpu, program_id);
         to_init.BindRasterizer(rasterizer);
         rasterizer->InitializeChannel(to_init);
@@ -75,6 +83,9 @@ struct GPU::Impl {
 
     void InitAddressSpace(Tegra::MemoryManager& memory_manager) {
         memory_manager.BindRasterizer(rasterizer);
+        if (command_capture) {
+            memory_manager.BindCommandCapture(command_capture.get());
+        }
     }
 
     void ReleaseChannel(Control::ChannelState& to_release) {
@@ -96,8 +107,10 @@ struct GPU::Impl {
 
     /// Synchronizes CPU writes with Host GPU memory.
     void InvalidateGPUCache() {
-        std::function<void(PAddr, size_t)> callback_writes(
-            [this](PAddr address, size_t size) { rasterizer->OnCacheInvalidation(address, size); });
+        std::function<void(PAddr, size_t)> callback_writes([this](PAddr address, size_t size) {
+            RecordMemory(address, size);
+            rasterizer->OnCacheInvalidation(address, size);
+        });
         system.GatherGPUDirtyMemory(callback_writes);
     }
 
@@ -223,9 +236,17 @@ struct GPU::Impl {
     /// core timing events.
     void Start() {
         Settings::UpdateGPUAccuracy();
+        if (Settings::values.record_gpu_commands) {
+            StartCommandCapture();
+        }
         gpu_thread.StartThread(*renderer, renderer->Context(), *scheduler);
     }
 
+    /// Blocks until the GPU thread has executed every command pushed so far.
+    void WaitForIdle() {
+        gpu_thread.WaitForIdle();
+    }
+
     void NotifyShutdown() {
         std::unique_lock lk{sync_mutex};
         shutting_down.store(true, std::memory_order::relaxed);
@@ -247,6 +268,9 @@ struct GPU::Impl {
 
     /// Push GPU command entries to be processed
     void PushGPUEntries(s32 channel, Tegra::CommandList&& entries) {
+        if (command_capture) {
+            RecordCommandList(channel, entries);
+        }
         gpu_thread.SubmitList(channel, std::move(entries));
     }
 
@@ -272,6 +296,7 @@ struct GPU::Impl {
 
     /// Notify rasterizer that any caches of the specified region should be invalidated
     void InvalidateRegion(DAddr addr, u64 size) {
+        RecordMemory(addr, size);
         gpu_thread.InvalidateRegion(addr, size);
     }
 
@@ -286,6 +311,12 @@ struct GPU::Impl {
 
     void RequestComposite(std::vector<Tegra::FramebufferConfig>&& layers,
                           std::vector<Service::Nvidia::NvFence>&& fences) {
+        if (command_capture) {
+            for (const Service::Nvidia::NvFence& fence : fences) {
+                RecordFenceWait(fence);
+            }
+            command_capture->RecordFrameEnd();
+        }
         size_t num_fences{fences.size()};
         size_t current_request_counter{};
         {
@@ -323,6 +354,57 @@ struct GPU::Impl {
         WaitForSyncOperation(wait_fence);
     }
 
+    void StartCommandCapture() {
+        const auto dump_dir{Common::FS::GetSuyuPath(Common::FS::SuyuPath::DumpDir)};
+        const auto capture_dir{dump_dir / "gpu_commands"};
+        if (!Common::FS::CreateDir(dump_dir) || !Common::FS::CreateDir(capture_dir)) {
+            LOG_ERROR(HW_GPU, "Failed to create GPU command capture directories");
+            return;
+        }
+        const auto path{capture_dir / fmt::format("{:016X}_{}.gpucapture",
+                                                  system.GetApplicationProcessProgramID(),
+                                                  std::time(nullptr))};
+        command_capture = std::make_unique<CommandCapture::Recorder>(path);
+        if (!command_capture->IsOpen()) {
+            command_capture.reset();
+            return;
+        }
+        LOG_INFO(HW_GPU, "Recording GPU commands to {}", Common::FS::PathToUTF8String(path));
+    }
+
+    void RecordCommandList(s32 channel, const Tegra::CommandList& entries) {
+        if (!entries.prefetch_command_list.empty()) {
+            const auto& commands = entries.prefetch_command_list;
+            command_capture->RecordCommandList(channel, {commands.data(), commands.size()});
+            return;
+        }
+        // Read the pushbuffer segments now, replays can't depend on the guest address space
+        auto& memory_manager = *channels.at(channel)->memory_manager;
+        std::vector<CommandHeader> commands;
+        for (const CommandListHeader& header : entries.command_lists) {
+            const size_t offset = commands.size();
+            commands.resize(offset + header.size);
+            memory_manager.ReadBlockUnsafe(header.addr, commands.data() + offset,
+                                           header.size * sizeof(CommandHeader));
+        }
+        command_capture->RecordCommandList(channel, commands);
+    }
+
+    void RecordMemory(DAddr addr, u64 size) {
+        if (!command_capture || size == 0) {
+            return;
+        }
+        std::vector<u8> data(size);
+        host1x.MemoryManager().ReadBlockUnsafe(addr, data.data(), data.size());
+        command_capture->RecordMemory(addr, data);
+    }
+
+    void RecordFenceWait(const Service::Nvidia::NvFence& fence) {
+        if (command_capture && fence.id >= 0) {
+            command_capture->RecordFence(static_cast<u32>(fence.id), fence.value);
+        }
+    }
+
     std::vector<u8> GetAppletCaptureBuffer() {
         std::vector<u8> out;
 
@@ -376,6 +458,8 @@ struct GPU::Impl {
     std::deque<size_t> free_swap_counters;
     std::deque<size_t> request_swap_counters;
     std::mutex request_swap_mutex;
+
+    std::unique_ptr<CommandCapture::Recorder> command_capture;
 };
 
 GPU::GPU(Core::System& system, bool is_async, bool use_nvdec)
@@ -491,6 +575,10 @@ void GPU::RequestComposite(std::vector<Tegra::FramebufferConfig>&& layers,
     impl->RequestComposite(std::move(layers), std::move(fences));
 }
 
+void GPU::RecordFenceWait(const Service::Nvidia::NvFence& fence) {
+    impl->RecordFenceWait(fence);
+}
+
 std::vector<u8> GPU::GetAppletCaptureBuffer() {
     return impl->GetAppletCaptureBuffer();
 }
@@ -527,6 +615,10 @@ void GPU::ReleaseContext() {
     impl->ReleaseContext();
 }
 
+void GPU::WaitForIdle() {
+    impl->WaitForIdle();
+}
+
 void GPU::PushGPUEntries(s32 channel, Tegra::CommandList&& entries) {
     impl->PushGPUEntries(channel, std::move(entries));
 }
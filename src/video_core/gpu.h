@@ -215,6 +215,9 @@ public:
     void RequestComposite(std::vector<Tegra::FramebufferConfig>&& layers,
                           std::vector<Service::Nvidia::NvFence>&& fences);
 
+    /// Records a fence the guest waits for on the CPU when commands are being captured.
+    void RecordFenceWait(const Service::Nvidia::NvFence& fence);
+
     std::vector<u8> GetAppletCaptureBuffer();
 
     /// Performs any additional setup necessary in order to begin GPU emulation.
@@ -231,6 +234,9 @@ public:
     /// Release the CPU Context
     void ReleaseContext();
 
+    /// Blocks until the GPU thread has executed every command pushed so far
+    void WaitForIdle();
+
     /// Push GPU command entries to be processed
     void PushGPUEntries(s32 channel, Tegra::CommandList&& entries);
 
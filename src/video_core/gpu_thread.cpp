@@ -1,7 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2019 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
@@ -15,8 +18,85 @@
 #include "video_core/host1x/host1x.h"
 #include "video_core/renderer_base.h"
 
+MICROPROFILE_DEFINE(GPU_WaitForQueue, "GPU", "Wait for command queue", MP_RGB(255, 128, 128));
+
 namespace VideoCommon::GPUThread {
 
+CommandQueue::CommandQueue()
+    : slots{std::make_unique<std::array<CommandDataContainer, CAPACITY>>()},
+      lists{std::make_unique<std::array<Tegra::CommandList, LIST_CAPACITY>>()} {}
+
+CommandQueue::~CommandQueue() = default;
+
+void CommandQueue::Push(std::stop_token stop_token, CommandDataContainer&& command) {
+    const size_t write = write_index.load(std::memory_order_relaxed);
+    if (write - read_index.load(std::memory_order_acquire) == CAPACITY) {
+        MICROPROFILE_SCOPE(GPU_WaitForQueue);
+        const auto start = std::chrono::steady_clock::now();
+        producer.Wait(stop_token, [this, write] {
+            return write - read_index.load(std::memory_order_acquire) < CAPACITY;
+        });
+        RecordStall(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - start)
+                                         .count()));
+        if (stop_token.stop_requested()) {
+            return;
+        }
+    }
+    (*slots)[write % CAPACITY] = std::move(command);
+    write_index.store(write + 1, std::memory_order_release);
+    consumer.Notify();
+
+    // Only producers update the counters and they are serialized, no read-modify-write needed
+    const u64 depth = write + 1 - read_index.load(std::memory_order_relaxed);
+    commands_pushed.store(commands_pushed.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    if (depth > max_depth.load(std::memory_order_relaxed)) {
+        max_depth.store(depth, std::memory_order_relaxed);
+    }
+}
+
+u32 CommandQueue::PushList(std::stop_token stop_token, Tegra::CommandList&& entries) {
+    const size_t index = lists_allocated;
+    if (index - lists_released.load(std::memory_order_acquire) == LIST_CAPACITY) {
+        MICROPROFILE_SCOPE(GPU_WaitForQueue);
+        const auto start = std::chrono::steady_clock::now();
+        producer.Wait(stop_token, [this, index] {
+            return index - lists_released.load(std::memory_order_acquire) < LIST_CAPACITY;
+        });
+        RecordStall(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - start)
+                                         .count()));
+    }
+    ++lists_allocated;
+    const u32 slot = static_cast<u32>(index % LIST_CAPACITY);
+    (*lists)[slot] = std::move(entries);
+    return slot;
+}
+
+Tegra::CommandList CommandQueue::TakeList(u32 index) {
+    Tegra::CommandList entries{std::move((*lists)[index])};
+    lists_released.fetch_add(1, std::memory_order_release);
+    producer.Notify();
+    return entries;
+}
+
+QueueStats CommandQueue::Stats() const {
+    return QueueStats{
+        .commands_pushed = commands_pushed.load(std::memory_order_relaxed),
+        .max_depth = max_depth.load(std::memory_order_relaxed),
+        .producer_stalls = producer_stalls.load(std::memory_order_relaxed),
+        .producer_stall_ns = producer_stall_ns.load(std::memory_order_relaxed),
+    };
+}
+
+void CommandQueue::RecordStall(u64 stall_ns) {
+    producer_stalls.store(producer_stalls.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    producer_stall_ns.store(producer_stall_ns.load(std::memory_order_relaxed) + stall_ns,
+                            std::memory_order_relaxed);
+}
+
 /// Runs the GPU thread
 static void RunThread(std::stop_token stop_token, Core::System& system,
                       VideoCore::RendererBase& renderer, Core::Frontend::GraphicsContext& context,
@@ -34,15 +114,9 @@ static void RunThread(std::stop_token stop_token, Core::System& system,
     auto current_context = context.Acquire();
     VideoCore::RasterizerInterface* const rasterizer = renderer.ReadRasterizer();
 
-    CommandDataContainer next;
-
-    while (!stop_token.stop_requested()) {
-        state.queue.PopWait(next, stop_token);
-        if (stop_token.stop_requested()) {
-            break;
-        }
+    const auto execute = [&](CommandDataContainer& next) {
         if (auto* submit_list = std::get_if<SubmitListCommand>(&next.data)) {
-            scheduler.Push(submit_list->channel, std::move(submit_list->entries));
+            scheduler.Push(submit_list->channel, state.queue.TakeList(submit_list->list_index));
         } else if (std::holds_alternative<GPUTickCommand>(next.data)) {
             system.GPU().TickWork();
         } else if (const auto* flush = std::get_if<FlushRegionCommand>(&next.data)) {
@@ -52,20 +126,27 @@ static void RunThread(std::stop_token stop_token, Core::System& system,
         } else {
             ASSERT(false);
         }
-        state.signaled_fence.store(next.fence);
+        state.signaled_fence.store(next.fence, std::memory_order_release);
         if (next.block) {
-            // We have to lock the write_lock to ensure that the condition_variable wait not get a
-            // race between the check and the lock itself.
-            std::scoped_lock lk{state.write_lock};
-            state.cv.notify_all();
+            state.fence_waiter.Notify();
         }
+    };
+
+    while (!stop_token.stop_requested()) {
+        state.queue.PopBatch(stop_token, execute);
     }
 }
 
 ThreadManager::ThreadManager(Core::System& system_, bool is_async_)
     : system{system_}, is_async{is_async_} {}
 
-ThreadManager::~ThreadManager() = default;
+ThreadManager::~ThreadManager() {
+    const QueueStats stats = state.queue.Stats();
+    LOG_INFO(HW_GPU,
+             "GPU thread queue: {} commands pushed, max depth {}, {} producer stalls ({} ms)",
+             stats.commands_pushed, stats.max_depth, stats.producer_stalls,
+             stats.producer_stall_ns / 1'000'000);
+}
 
 void ThreadManager::StartThread(VideoCore::RendererBase& renderer,
                                 Core::Frontend::GraphicsContext& context,
@@ -76,7 +157,13 @@ void ThreadManager::StartThread(VideoCore::RendererBase& renderer,
 }
 
 void ThreadManager::SubmitList(s32 channel, Tegra::CommandList&& entries) {
-    PushCommand(SubmitListCommand(channel, std::move(entries)));
+    // The arena entry has to be allocated under the write lock to keep it in push order
+    PushCommandLocked(
+        [this, channel, &entries] {
+            return SubmitListCommand(
+                channel, state.queue.PushList(thread.get_stop_token(), std::move(entries)));
+        },
+        false);
 }
 
 void ThreadManager::FlushRegion(DAddr addr, u64 size) {
@@ -98,6 +185,10 @@ void ThreadManager::TickGPU() {
     PushCommand(GPUTickCommand());
 }
 
+void ThreadManager::WaitForIdle() {
+    PushCommand(GPUTickCommand(), true);
+}
+
 void ThreadManager::InvalidateRegion(DAddr addr, u64 size) {
     rasterizer->OnCacheInvalidation(addr, size);
 }
@@ -107,19 +198,32 @@ void ThreadManager::FlushAndInvalidateRegion(DAddr addr, u64 size) {
     rasterizer->OnCacheInvalidation(addr, size);
 }
 
+QueueStats ThreadManager::GetQueueStats() const {
+    return state.queue.Stats();
+}
+
 u64 ThreadManager::PushCommand(CommandData&& command_data, bool block) {
+    return PushCommandLocked([&command_data] { return std::move(command_data); }, block);
+}
+
+template <typename MakeCommand>
+u64 ThreadManager::PushCommandLocked(MakeCommand&& make_command, bool block) {
     if (!is_async) {
         // In synchronous GPU mode, block the caller until the command has executed
         block = true;
     }
 
-    std::unique_lock lk(state.write_lock);
-    const u64 fence{++state.last_fence};
-    state.queue.EmplaceWait(std::move(command_data), fence, block);
+    const std::stop_token stop_token = thread.get_stop_token();
+    u64 fence;
+    {
+        std::scoped_lock lk{state.write_lock};
+        fence = ++state.last_fence;
+        state.queue.Push(stop_token, CommandDataContainer(make_command(), fence, block));
+    }
 
     if (block) {
-        Common::CondvarWait(state.cv, lk, thread.get_stop_token(), [this, fence] {
-            return fence <= state.signaled_fence.load(std::memory_order_relaxed);
+        state.fence_waiter.Wait(stop_token, [this, fence] {
+            return fence <= state.signaled_fence.load(std::memory_order_acquire);
         });
     }
 
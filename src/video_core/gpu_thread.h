@@ -3,18 +3,21 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <thread>
 #include <variant>
 
-#include "common/bounded_threadsafe_queue.h"
 #include "common/polyfill_thread.h"
 #include "video_core/framebuffer_config.h"
 
 namespace Tegra {
+struct CommandList;
 struct FramebufferConfig;
 namespace Control {
 class Scheduler;
@@ -37,11 +40,11 @@ namespace VideoCommon::GPUThread {
 
 /// Command to signal to the GPU thread that a command list is ready for processing
 struct SubmitListCommand final {
-    explicit SubmitListCommand(s32 channel_, Tegra::CommandList&& entries_)
-        : channel{channel_}, entries{std::move(entries_)} {}
+    explicit constexpr SubmitListCommand(s32 channel_, u32 list_index_)
+        : channel{channel_}, list_index{list_index_} {}
 
     s32 channel;
-    Tegra::CommandList entries;
+    u32 list_index; ///< Slot of the command list in the command list arena
 };
 
 /// Command to signal to the GPU thread to flush a region
@@ -87,14 +90,122 @@ struct CommandDataContainer {
     bool block{};
 };
 
+/// Counters describing the load of the command queue
+struct QueueStats {
+    u64 commands_pushed{};
+    u64 max_depth{};
+    u64 producer_stalls{};
+    u64 producer_stall_ns{};
+};
+
+/// Sleep and wake up protocol of the command queue, locks are only taken when a thread sleeps
+class QueueWaiter final {
+public:
+    template <typename Pred>
+    void Wait(std::stop_token stop_token, Pred&& pred) {
+        std::unique_lock lock{mutex};
+        num_waiting.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with the fence in Notify, either the waker sees the counter or we see its update
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        Common::CondvarWait(cv, lock, stop_token, std::forward<Pred>(pred));
+        num_waiting.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (num_waiting.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        std::scoped_lock lock{mutex};
+        cv.notify_all();
+    }
+
+private:
+    std::atomic<u32> num_waiting{};
+    std::mutex mutex;
+    std::condition_variable_any cv;
+};
+
+/**
+ * Bounded ring of preallocated command slots shared by the emulated CPU and the GPU thread.
+ * Producers must be serialized externally by SynchState::write_lock, the only consumer is the GPU
+ * thread. Command list payloads live in a separate arena so slots stay small, the arena is also a
+ * ring as lists are consumed in the same order they are pushed.
+ */
+class CommandQueue final {
+public:
+    static constexpr size_t CAPACITY = 0x1000;
+    static constexpr size_t LIST_CAPACITY = 0x400;
+    static constexpr size_t MAX_BATCH_SIZE = 64;
+
+    CommandQueue();
+    ~CommandQueue();
+
+    /// Pushes a command, waiting for a free slot when the ring is full
+    void Push(std::stop_token stop_token, CommandDataContainer&& command);
+
+    /// Stores a command list in the arena and returns its index, waits for a free entry if needed
+    u32 PushList(std::stop_token stop_token, Tegra::CommandList&& entries);
+
+    /// Takes ownership of the command list at the given arena index and releases the entry
+    Tegra::CommandList TakeList(u32 index);
+
+    /**
+     * Waits for commands and executes up to MAX_BATCH_SIZE of them in place with func.
+     * Slots are returned to the producers once per batch.
+     */
+    template <typename Func>
+    void PopBatch(std::stop_token stop_token, Func&& func) {
+        size_t read = read_index.load(std::memory_order_relaxed);
+        size_t write = write_index.load(std::memory_order_acquire);
+        if (read == write) {
+            consumer.Wait(stop_token, [&] {
+                write = write_index.load(std::memory_order_acquire);
+                return read != write;
+            });
+            if (read == write) {
+                return;
+            }
+        }
+        const size_t end = std::min(write, read + MAX_BATCH_SIZE);
+        for (; read != end; ++read) {
+            CommandDataContainer& command = (*slots)[read % CAPACITY];
+            func(command);
+            command.data = std::monostate{};
+        }
+        read_index.store(read, std::memory_order_release);
+        producer.Notify();
+    }
+
+    [[nodiscard]] QueueStats Stats() const;
+
+private:
+    void RecordStall(u64 stall_ns);
+
+    alignas(128) std::atomic<size_t> read_index{};
+    alignas(128) std::atomic<size_t> write_index{};
+    alignas(128) std::atomic<size_t> lists_released{};
+    size_t lists_allocated{};
+
+    std::unique_ptr<std::array<CommandDataContainer, CAPACITY>> slots;
+    std::unique_ptr<std::array<Tegra::CommandList, LIST_CAPACITY>> lists;
+
+    QueueWaiter consumer;
+    QueueWaiter producer;
+
+    std::atomic<u64> commands_pushed{};
+    std::atomic<u64> max_depth{};
+    std::atomic<u64> producer_stalls{};
+    std::atomic<u64> producer_stall_ns{};
+};
+
 /// Struct used to synchronize the GPU thread
 struct SynchState final {
-    using CommandQueue = Common::MPSCQueue<CommandDataContainer>;
     std::mutex write_lock;
     CommandQueue queue;
     u64 last_fence{};
     std::atomic<u64> signaled_fence{};
-    std::condition_variable_any cv;
+    QueueWaiter fence_waiter;
 };
 
 /// Class used to manage the GPU thread
@@ -121,10 +232,20 @@ public:
 
     void TickGPU();
 
+    /// Blocks until every command pushed so far has executed
+    void WaitForIdle();
+
+    /// Returns the counters of the command queue
+    [[nodiscard]] QueueStats GetQueueStats() const;
+
 private:
     /// Pushes a command to be executed by the GPU thread
     u64 PushCommand(CommandData&& command_data, bool block = false);
 
+    /// Pushes the command returned by make_command while holding the write lock
+    template <typename MakeCommand>
+    u64 PushCommandLocked(MakeCommand&& make_command, bool block);
+
     Core::System& system;
     const bool is_async;
     VideoCore::RasterizerInterface* rasterizer = nullptr;
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2020 yuzu Emulator Project & 2024 suyu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <fstream>
 #include <optional>
@@ -57,7 +59,11 @@ static void Dump(u64 hash, std::span<const u32> code, bool decompiled = false) {
 MacroEngine::MacroEngine(Engines::Maxwell3D& maxwell3d_)
     : hle_macros{std::make_unique<Tegra::HLEMacro>(maxwell3d_)}, maxwell3d{maxwell3d_} {}
 
-MacroEngine::~MacroEngine() = default;
+MacroEngine::~MacroEngine() {
+    if (!macro_profiles.empty()) {
+        ReportProfile();
+    }
+}
 
 void MacroEngine::AddCode(u32 method, u32 data) {
     uploaded_macro_code[method].push_back(data);
@@ -69,61 +75,152 @@ void MacroEngine::ClearCode(u32 method) {
 }
 
 void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
-    auto compiled_macro = macro_cache.find(method);
+    CacheInfo* const cache_info = GetCacheInfo(method);
+    if (!cache_info) {
+        return;
+    }
+    if (!Settings::values.profile_macros) {
+        ExecuteCached(*cache_info, method, parameters);
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    ExecuteCached(*cache_info, method, parameters);
+    RecordProfile(*cache_info, method, std::chrono::steady_clock::now() - start);
+}
+
+MacroEngine::CacheInfo* MacroEngine::GetCacheInfo(u32 method) {
+    const auto compiled_macro = macro_cache.find(method);
     if (compiled_macro != macro_cache.end()) {
-        const auto& cache_info = compiled_macro->second;
-        if (cache_info.has_hle_program) {
-            MICROPROFILE_SCOPE(MacroHLE);
-            cache_info.hle_program->Execute(parameters, method);
-        } else {
-            maxwell3d.RefreshParameters();
-            cache_info.lle_program->Execute(parameters, method);
-        }
-    } else {
-        // Macro not compiled, check if it's uploaded and if so, compile it
-        std::optional<u32> mid_method;
-        const auto macro_code = uploaded_macro_code.find(method);
-        if (macro_code == uploaded_macro_code.end()) {
-            for (const auto& [method_base, code] : uploaded_macro_code) {
-                if (method >= method_base && (method - method_base) < code.size()) {
-                    mid_method = method_base;
-                    break;
-                }
-            }
-            if (!mid_method.has_value()) {
-                ASSERT_MSG(false, "Macro 0x{0:x} was not uploaded", method);
-                return;
+        return &compiled_macro->second;
+    }
+
+    // Macro not compiled, check if it's uploaded and if so, compile it
+    std::optional<u32> mid_method;
+    const auto macro_code = uploaded_macro_code.find(method);
+    if (macro_code == uploaded_macro_code.end()) {
+        for (const auto& [method_base, code] : uploaded_macro_code) {
+            if (method >= method_base && (method - method_base) < code.size()) {
+                mid_method = method_base;
+                break;
             }
         }
-        auto& cache_info = macro_cache[method];
-
         if (!mid_method.has_value()) {
-            cache_info.lle_program = Compile(macro_code->second);
-            cache_info.hash = Common::HashValue(macro_code->second);
-        } else {
-            const auto& macro_cached = uploaded_macro_code[mid_method.value()];
-            const auto rebased_method = method - mid_method.value();
-            auto& code = uploaded_macro_code[method];
-            code.resize(macro_cached.size() - rebased_method);
-            std::memcpy(code.data(), macro_cached.data() + rebased_method,
-                        code.size() * sizeof(u32));
-            cache_info.hash = Common::HashValue(code);
-            cache_info.lle_program = Compile(code);
+            ASSERT_MSG(false, "Macro 0x{0:x} was not uploaded", method);
+            return nullptr;
         }
+    }
+    auto& cache_info = macro_cache[method];
+
+    if (mid_method.has_value()) {
+        const auto& macro_cached = uploaded_macro_code[mid_method.value()];
+        const auto rebased_method = method - mid_method.value();
+        std::vector<u32> code(macro_cached.size() - rebased_method);
+        std::memcpy(code.data(), macro_cached.data() + rebased_method, code.size() * sizeof(u32));
+        uploaded_macro_code[method] = std::move(code);
+    }
+    const auto& code = uploaded_macro_code[method];
+    cache_info.hash = Common::HashValue(code);
+    cache_info.lle_program = Compile(code);
+
+    auto hle_program = hle_macros->GetHLEProgram(cache_info.hash);
+    if (hle_program && !Settings::values.disable_macro_hle) {
+        cache_info.has_hle_program = true;
+        cache_info.hle_program = std::move(hle_program);
+    }
 
-        auto hle_program = hle_macros->GetHLEProgram(cache_info.hash);
-        if (!hle_program || Settings::values.disable_macro_hle) {
-            maxwell3d.RefreshParameters();
-            cache_info.lle_program->Execute(parameters, method);
-        } else {
-            cache_info.has_hle_program = true;
-            cache_info.hle_program = std::move(hle_program);
-            MICROPROFILE_SCOPE(MacroHLE);
-            cache_info.hle_program->Execute(parameters, method);
-        }
+    if (Settings::values.dump_macros) {
+        Dump(cache_info.hash, code, cache_info.has_hle_program);
+    }
+    return &cache_info;
+}
 
-        if (Settings::values.dump_macros) {
-            Dump(cache_info.hash, macro_code->second, cache_info.has_hle_program);
+void MacroEngine::ExecuteCached(CacheInfo& cache_info, u32 method,
+                                const std::vector<u32>& parameters) {
+    if (!cache_info.has_hle_program) {
+        maxwell3d.RefreshParameters();
+        cache_info.lle_program->Execute(parameters, method);
+        return;
+    }
+    // Parameters still in guest memory are only read by the interpreter after a refresh, and HLE
+    // macros handle them with indirect draws instead, so those calls are not compared
+    if (Settings::values.verify_macro_hle && !cache_info.reported_hle_mismatch &&
+        !maxwell3d.AnyParametersDirty()) {
+        ExecuteAndVerifyHLE(cache_info, method, parameters);
+        return;
+    }
+    MICROPROFILE_SCOPE(MacroHLE);
+    cache_info.hle_program->Execute(parameters, method);
+}
+
+void MacroEngine::ExecuteAndVerifyHLE(CacheInfo& cache_info, u32 method,
+                                      const std::vector<u32>& parameters) {
+    const auto& reg_array = maxwell3d.regs.reg_array;
+    const std::vector<u32> registers(reg_array.begin(), reg_array.end());
+    {
+        MICROPROFILE_SCOPE(MacroHLE);
+        cache_info.hle_program->Execute(parameters, method);
+    }
+
+    // Methods sent by the macro code are compared as plain register writes, any other effect of
+    // them (draws, uploads, ...) is not emulated by the comparison.
+    const auto code = uploaded_macro_code.find(method);
+    if (code == uploaded_macro_code.end()) {
+        return;
+    }
+    const auto mismatches = Macro::CompareWithHLE(code->second, parameters, registers, reg_array);
+    if (mismatches.empty()) {
+        return;
+    }
+    const auto& first = mismatches.front();
+    LOG_WARNING(HW_GPU,
+                "HLE macro {} ({:016x}) differs from its code in {} registers, first at method "
+                "0x{:x}: HLE 0x{:08x}, LLE 0x{:08x}",
+                hle_macros->GetName(cache_info.hash), cache_info.hash, mismatches.size(),
+                first.method, first.hle_value, first.lle_value);
+    cache_info.reported_hle_mismatch = true;
+}
+
+void MacroEngine::RecordProfile(const CacheInfo& cache_info, u32 method,
+                                std::chrono::nanoseconds time) {
+    auto [it, is_new] = macro_profiles.try_emplace(cache_info.hash);
+    MacroProfile& profile = it->second;
+    if (is_new) {
+        profile.code = uploaded_macro_code[method];
+        profile.has_hle_program = cache_info.has_hle_program;
+    }
+    ++profile.num_executions;
+    profile.time += time;
+}
+
+void MacroEngine::ReportProfile() const {
+    static constexpr std::size_t MaxReportedMacros = 20;
+    static constexpr std::size_t MaxDumpedMacros = 10;
+
+    std::vector<std::pair<u64, const MacroProfile*>> profiles;
+    profiles.reserve(macro_profiles.size());
+    for (const auto& [hash, profile] : macro_profiles) {
+        profiles.emplace_back(hash, &profile);
+    }
+    std::ranges::sort(profiles, [](const auto& lhs, const auto& rhs) {
+        return lhs.second->time > rhs.second->time;
+    });
+
+    LOG_INFO(HW_GPU, "Macro profile, {} macros executed:", profiles.size());
+    std::size_t num_dumped = 0;
+    for (std::size_t index = 0; index < profiles.size(); ++index) {
+        const auto& [hash, profile] = profiles[index];
+        if (index < MaxReportedMacros) {
+            const double total_ms =
+                std::chrono::duration<double, std::milli>(profile->time).count();
+            LOG_INFO(HW_GPU, "  {:016x} {} {:<32} {:>10} calls {:>10.3f} ms {:>8.3f} us/call", hash,
+                     profile->has_hle_program ? "HLE" : "LLE", hle_macros->GetName(hash),
+                     profile->num_executions, total_ms,
+                     total_ms * 1000.0 / static_cast<double>(profile->num_executions));
+        }
+        // The hottest macros without an HLE implementation are candidates for new ones
+        if (!profile->has_hle_program && num_dumped < MaxDumpedMacros) {
+            Dump(hash, profile->code);
+            ++num_dumped;
         }
     }
 }
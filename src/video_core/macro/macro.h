@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -132,9 +133,32 @@ private:
         std::unique_ptr<CachedMacro> hle_program{};
         u64 hash{};
         bool has_hle_program{};
+        bool reported_hle_mismatch{};
     };
 
+    struct MacroProfile {
+        std::vector<u32> code;
+        u64 num_executions{};
+        std::chrono::nanoseconds time{};
+        bool has_hle_program{};
+    };
+
+    // Returns the cache entry of a macro, compiling it first if necessary.
+    CacheInfo* GetCacheInfo(u32 method);
+
+    void ExecuteCached(CacheInfo& cache_info, u32 method, const std::vector<u32>& parameters);
+
+    // Executes an HLE macro and reports when its register writes differ from its macro code.
+    void ExecuteAndVerifyHLE(CacheInfo& cache_info, u32 method,
+                             const std::vector<u32>& parameters);
+
+    void RecordProfile(const CacheInfo& cache_info, u32 method, std::chrono::nanoseconds time);
+
+    // Logs the macros that took the most time and dumps the code of the hottest LLE ones.
+    void ReportProfile() const;
+
     std::unordered_map<u32, CacheInfo> macro_cache;
+    std::unordered_map<u64, MacroProfile> macro_profiles;
     std::unordered_map<u32, std::vector<u32>> uploaded_macro_code;
     std::unique_ptr<HLEMacro> hle_macros;
     Engines::Maxwell3D& maxwell3d;
@@ -509,95 +509,60 @@ public:
     }
 };
 
+template <typename T>
+std::unique_ptr<CachedMacro> Build(Maxwell3D& maxwell3d) {
+    return std::make_unique<T>(maxwell3d);
+}
+
+/// Macros replaced by C++ implementations, identified by the hash of their code. New HLE macros
+/// only have to be added here; running with verify_macro_hle compares them against their code.
+constexpr std::array HLE_MACROS{
+    HLEMacroInfo{0x0D61FC9FAAC9FCADULL, "DrawArraysIndirect",
+                 &Build<HLE_DrawArraysIndirect<false>>},
+    HLEMacroInfo{0x8A4D173EB99A8603ULL, "DrawArraysIndirectExtended",
+                 &Build<HLE_DrawArraysIndirect<true>>},
+    HLEMacroInfo{0x771BB18C62444DA0ULL, "DrawIndexedIndirect",
+                 &Build<HLE_DrawIndexedIndirect<false>>},
+    HLEMacroInfo{0x0217920100488FF7ULL, "DrawIndexedIndirectExtended",
+                 &Build<HLE_DrawIndexedIndirect<true>>},
+    HLEMacroInfo{0x3F5E74B9C9A50164ULL, "MultiDrawIndexedIndirectCount",
+                 &Build<HLE_MultiDrawIndexedIndirectCount>},
+    HLEMacroInfo{0xEAD26C3E2109B06BULL, "MultiLayerClear", &Build<HLE_MultiLayerClear>},
+    HLEMacroInfo{0xC713C83D8F63CCF3ULL, "C713C83D8F63CCF3", &Build<HLE_C713C83D8F63CCF3>},
+    HLEMacroInfo{0xD7333D26E0A93EDEULL, "D7333D26E0A93EDE", &Build<HLE_D7333D26E0A93EDE>},
+    HLEMacroInfo{0xEB29B2A09AA06D38ULL, "BindShader", &Build<HLE_BindShader>},
+    HLEMacroInfo{0xDB1341DBEB4C8AF7ULL, "SetRasterBoundingBox", &Build<HLE_SetRasterBoundingBox>},
+    HLEMacroInfo{0x6C97861D891EDf7EULL, "ClearConstBuffer5F00",
+                 &Build<HLE_ClearConstBuffer<0x5F00>>},
+    HLEMacroInfo{0xD246FDDF3A6173D7ULL, "ClearConstBuffer7000",
+                 &Build<HLE_ClearConstBuffer<0x7000>>},
+    HLEMacroInfo{0xEE4D0004BEC8ECF4ULL, "ClearMemory", &Build<HLE_ClearMemory>},
+    HLEMacroInfo{0xFC0CF27F5FFAA661ULL, "TransformFeedbackSetup",
+                 &Build<HLE_TransformFeedbackSetup>},
+    HLEMacroInfo{0xB5F74EDB717278ECULL, "DrawIndirectByteCount", &Build<HLE_DrawIndirectByteCount>},
+};
+
 } // Anonymous namespace
 
 HLEMacro::HLEMacro(Maxwell3D& maxwell3d_) : maxwell3d{maxwell3d_} {
-    builders.emplace(0x0D61FC9FAAC9FCADULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_DrawArraysIndirect<false>>(maxwell3d__);
-                         }));
-    builders.emplace(0x8A4D173EB99A8603ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_DrawArraysIndirect<true>>(maxwell3d__);
-                         }));
-    builders.emplace(0x771BB18C62444DA0ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_DrawIndexedIndirect<false>>(maxwell3d__);
-                         }));
-    builders.emplace(0x0217920100488FF7ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_DrawIndexedIndirect<true>>(maxwell3d__);
-                         }));
-    builders.emplace(0x3F5E74B9C9A50164ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_MultiDrawIndexedIndirectCount>(
-                                 maxwell3d__);
-                         }));
-    builders.emplace(0xEAD26C3E2109B06BULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_MultiLayerClear>(maxwell3d__);
-                         }));
-    builders.emplace(0xC713C83D8F63CCF3ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_C713C83D8F63CCF3>(maxwell3d__);
-                         }));
-    builders.emplace(0xD7333D26E0A93EDEULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_D7333D26E0A93EDE>(maxwell3d__);
-                         }));
-    builders.emplace(0xEB29B2A09AA06D38ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_BindShader>(maxwell3d__);
-                         }));
-    builders.emplace(0xDB1341DBEB4C8AF7ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_SetRasterBoundingBox>(maxwell3d__);
-                         }));
-    builders.emplace(0x6C97861D891EDf7EULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_ClearConstBuffer<0x5F00>>(maxwell3d__);
-                         }));
-    builders.emplace(0xD246FDDF3A6173D7ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_ClearConstBuffer<0x7000>>(maxwell3d__);
-                         }));
-    builders.emplace(0xEE4D0004BEC8ECF4ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_ClearMemory>(maxwell3d__);
-                         }));
-    builders.emplace(0xFC0CF27F5FFAA661ULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_TransformFeedbackSetup>(maxwell3d__);
-                         }));
-    builders.emplace(0xB5F74EDB717278ECULL,
-                     std::function<std::unique_ptr<CachedMacro>(Maxwell3D&)>(
-                         [](Maxwell3D& maxwell3d__) -> std::unique_ptr<CachedMacro> {
-                             return std::make_unique<HLE_DrawIndirectByteCount>(maxwell3d__);
-                         }));
+    for (const HLEMacroInfo& info : HLE_MACROS) {
+        macros.emplace(info.hash, &info);
+    }
 }
 
 HLEMacro::~HLEMacro() = default;
 
 std::unique_ptr<CachedMacro> HLEMacro::GetHLEProgram(u64 hash) const {
-    const auto it = builders.find(hash);
-    if (it == builders.end()) {
+    const auto it = macros.find(hash);
+    if (it == macros.end()) {
         return nullptr;
     }
-    return it->second(maxwell3d);
+    return it->second->build(maxwell3d);
+}
+
+std::string_view HLEMacro::GetName(u64 hash) const {
+    const auto it = macros.find(hash);
+    return it != macros.end() ? it->second->name : std::string_view{};
 }
 
 } // namespace Tegra
@@ -3,8 +3,8 @@
 
 #pragma once
 
-#include <functional>
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 
 #include "common/common_types.h"
@@ -15,6 +15,16 @@ namespace Engines {
 class Maxwell3D;
 }
 
+class CachedMacro;
+
+/// Describes a macro replaced by a C++ implementation.
+struct HLEMacroInfo {
+    /// Hash of the macro's code.
+    u64 hash;
+    const char* name;
+    std::unique_ptr<CachedMacro> (*build)(Engines::Maxwell3D& maxwell3d);
+};
+
 class HLEMacro {
 public:
     explicit HLEMacro(Engines::Maxwell3D& maxwell3d_);
@@ -24,10 +34,12 @@ public:
     // Returns nullptr otherwise.
     [[nodiscard]] std::unique_ptr<CachedMacro> GetHLEProgram(u64 hash) const;
 
+    // Returns the name of the HLE implementation of a macro, or an empty string if there is none.
+    [[nodiscard]] std::string_view GetName(u64 hash) const;
+
 private:
     Engines::Maxwell3D& maxwell3d;
-    std::unordered_map<u64, std::function<std::unique_ptr<CachedMacro>(Engines::Maxwell3D&)>>
-        builders;
+    std::unordered_map<u64, const HLEMacroInfo*> macros;
 };
 
 } // namespace Tegra
@@ -2,7 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <array>
-#include <optional>
+#include <utility>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -13,344 +13,582 @@
 MICROPROFILE_DEFINE(MacroInterp, "GPU", "Execute macro interpreter", MP_RGB(128, 128, 192));
 
 namespace Tegra {
+namespace Macro {
 namespace {
-class MacroInterpreterImpl final : public CachedMacro {
-public:
-    explicit MacroInterpreterImpl(Engines::Maxwell3D& maxwell3d_, const std::vector<u32>& code_)
-        : maxwell3d{maxwell3d_}, code{code_} {}
+/// Register written by instructions targeting $r0, which is hardwired to zero. Redirecting the
+/// writes when decoding spares a check on every register write.
+constexpr std::size_t DISCARD_REGISTER = NUM_MACRO_REGISTERS;
 
-    void Execute(const std::vector<u32>& params, u32 method) override;
+/// Number of valid ALU operation encodings, all larger encodings are invalid.
+constexpr std::size_t NUM_ALU_OPERATIONS = 13;
+constexpr std::size_t NUM_RESULT_OPERATIONS = 8;
 
-private:
-    /// Resets the execution engine state, zeroing registers, etc.
-    void Reset();
+struct ExecutionState {
+    /// General purpose macro registers, followed by the discard register.
+    std::array<u32, NUM_MACRO_REGISTERS + 1> registers{};
+    /// Method address to use for the next Send instruction.
+    MethodAddress method_address{};
+    bool carry_flag{};
 
-    /**
-     * Executes a single macro instruction located at the current program counter. Returns whether
-     * the interpreter should keep running.
-     *
-     * @param is_delay_slot Whether the current step is being executed due to a delay slot in a
-     *                      previous instruction.
-     */
-    bool Step(bool is_delay_slot);
+    /// Input parameters of the current macro.
+    const u32* parameters{};
+    std::size_t num_parameters{};
+    /// Index of the next parameter that will be fetched by the 'parm' instruction.
+    std::size_t next_parameter_index{};
 
-    /// Calculates the result of an ALU operation. src_a OP src_b;
-    u32 GetALUResult(Macro::ALUOperation operation, u32 src_a, u32 src_b);
+    MacroContext* context{};
+};
 
-    /// Performs the result operation on the input result and stores it in the specified register
-    /// (if necessary).
-    void ProcessResult(Macro::ResultOperation operation, u32 reg, u32 result);
+using HandlerFn = const DecodedInstruction* (*)(ExecutionState&, const DecodedInstruction*);
+using OperationFn = void (*)(ExecutionState&, const DecodedInstruction&);
+} // Anonymous namespace
 
-    /// Evaluates the branch condition and returns whether the branch should be taken or not.
-    bool EvaluateBranchCondition(Macro::BranchCondition cond, u32 value) const;
+struct DecodedInstruction {
+    /// Executes the instruction and returns the next one to execute, or null to stop.
+    HandlerFn handler{};
+    /// Executes only the instruction's effects, used when it runs in a delay slot.
+    OperationFn operation{};
+
+    /// Branch target relative to this instruction.
+    s32 branch_offset{};
+    u32 immediate{};
+    u32 bitfield_mask{};
+    u8 dst{};
+    u8 src_a{};
+    u8 src_b{};
+    u8 bf_src_bit{};
+    u8 bf_dst_bit{};
+};
 
-    /// Reads an opcode at the current program counter location.
-    Macro::Opcode GetOpcode() const;
+namespace {
+u32 FetchParameter(ExecutionState& state) {
+    if (state.next_parameter_index >= state.num_parameters) [[unlikely]] {
+        ASSERT_MSG(false, "Macro fetched more parameters than it was given");
+        return 0;
+    }
+    return state.parameters[state.next_parameter_index++];
+}
 
-    /// Returns the specified register's value. Register 0 is hardcoded to always return 0.
-    u32 GetRegister(u32 register_id) const;
+void SetMethodAddress(ExecutionState& state, u32 address) {
+    state.method_address.raw = address;
+}
 
-    /// Sets the register to the input value.
-    void SetRegister(u32 register_id, u32 value);
+void Send(ExecutionState& state, u32 value) {
+    auto& method_address = state.method_address;
+    state.context->CallMethod(method_address.address, value);
+    // Increment the method address by the method increment.
+    method_address.address.Assign(method_address.address.Value() +
+                                  method_address.increment.Value());
+}
 
-    /// Sets the method address to use for the next Send instruction.
-    void SetMethodAddress(u32 address);
+template <ResultOperation result_operation>
+void ProcessResult(ExecutionState& state, const DecodedInstruction& inst, u32 result) {
+    u32& dst = state.registers[inst.dst];
+    if constexpr (result_operation == ResultOperation::IgnoreAndFetch) {
+        dst = FetchParameter(state);
+    } else if constexpr (result_operation == ResultOperation::Move) {
+        dst = result;
+    } else if constexpr (result_operation == ResultOperation::MoveAndSetMethod) {
+        dst = result;
+        SetMethodAddress(state, result);
+    } else if constexpr (result_operation == ResultOperation::FetchAndSend) {
+        dst = FetchParameter(state);
+        Send(state, result);
+    } else if constexpr (result_operation == ResultOperation::MoveAndSend) {
+        dst = result;
+        Send(state, result);
+    } else if constexpr (result_operation == ResultOperation::FetchAndSetMethod) {
+        dst = FetchParameter(state);
+        SetMethodAddress(state, result);
+    } else if constexpr (result_operation == ResultOperation::MoveAndSetMethodFetchAndSend) {
+        dst = result;
+        SetMethodAddress(state, result);
+        Send(state, FetchParameter(state));
+    } else if constexpr (result_operation == ResultOperation::MoveAndSetMethodSend) {
+        // Send bits 12:17 of the result.
+        dst = result;
+        SetMethodAddress(state, result);
+        Send(state, (result >> 12) & 0b111111);
+    }
+}
 
-    /// Calls a GPU Engine method with the input parameter.
-    void Send(u32 value);
+template <ALUOperation alu_operation>
+u32 GetALUResult(ExecutionState& state, u32 src_a, u32 src_b) {
+    if constexpr (alu_operation == ALUOperation::Add) {
+        const u64 result{static_cast<u64>(src_a) + src_b};
+        state.carry_flag = result > 0xffffffff;
+        return static_cast<u32>(result);
+    } else if constexpr (alu_operation == ALUOperation::AddWithCarry) {
+        const u64 result{static_cast<u64>(src_a) + src_b + (state.carry_flag ? 1ULL : 0ULL)};
+        state.carry_flag = result > 0xffffffff;
+        return static_cast<u32>(result);
+    } else if constexpr (alu_operation == ALUOperation::Subtract) {
+        const u64 result{static_cast<u64>(src_a) - src_b};
+        state.carry_flag = result < 0x100000000;
+        return static_cast<u32>(result);
+    } else if constexpr (alu_operation == ALUOperation::SubtractWithBorrow) {
+        const u64 result{static_cast<u64>(src_a) - src_b - (state.carry_flag ? 0ULL : 1ULL)};
+        state.carry_flag = result < 0x100000000;
+        return static_cast<u32>(result);
+    } else if constexpr (alu_operation == ALUOperation::Xor) {
+        return src_a ^ src_b;
+    } else if constexpr (alu_operation == ALUOperation::Or) {
+        return src_a | src_b;
+    } else if constexpr (alu_operation == ALUOperation::And) {
+        return src_a & src_b;
+    } else if constexpr (alu_operation == ALUOperation::AndNot) {
+        return src_a & ~src_b;
+    } else if constexpr (alu_operation == ALUOperation::Nand) {
+        return ~(src_a & src_b);
+    } else {
+        // Invalid encodings are reported when decoding and produce zero.
+        return 0;
+    }
+}
 
-    /// Reads a GPU register located at the method address.
-    u32 Read(u32 method) const;
+template <ALUOperation alu_operation, ResultOperation result_operation>
+void ExecuteALU(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 result = GetALUResult<alu_operation>(state, state.registers[inst.src_a],
+                                                   state.registers[inst.src_b]);
+    ProcessResult<result_operation>(state, inst, result);
+}
 
-    /// Returns the next parameter in the parameter queue.
-    u32 FetchParameter();
+template <ResultOperation result_operation>
+void ExecuteAddImmediate(ExecutionState& state, const DecodedInstruction& inst) {
+    ProcessResult<result_operation>(state, inst, state.registers[inst.src_a] + inst.immediate);
+}
 
-    Engines::Maxwell3D& maxwell3d;
+template <ResultOperation result_operation>
+void ExecuteExtractInsert(ExecutionState& state, const DecodedInstruction& inst) {
+    u32 dst = state.registers[inst.src_a];
+    u32 src = state.registers[inst.src_b];
 
-    /// Current program counter
-    u32 pc{};
-    /// Program counter to execute at after the delay slot is executed.
-    std::optional<u32> delayed_pc;
+    src = (src >> inst.bf_src_bit) & inst.bitfield_mask;
+    dst &= ~(inst.bitfield_mask << inst.bf_dst_bit);
+    dst |= src << inst.bf_dst_bit;
+    ProcessResult<result_operation>(state, inst, dst);
+}
 
-    /// General purpose macro registers.
-    std::array<u32, Macro::NUM_MACRO_REGISTERS> registers = {};
+template <ResultOperation result_operation>
+void ExecuteExtractShiftLeftImmediate(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 dst = state.registers[inst.src_a];
+    const u32 src = state.registers[inst.src_b];
+    ProcessResult<result_operation>(state, inst,
+                                    ((src >> dst) & inst.bitfield_mask) << inst.bf_dst_bit);
+}
 
-    /// Method address to use for the next Send instruction.
-    Macro::MethodAddress method_address = {};
+template <ResultOperation result_operation>
+void ExecuteExtractShiftLeftRegister(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 dst = state.registers[inst.src_a];
+    const u32 src = state.registers[inst.src_b];
+    ProcessResult<result_operation>(state, inst,
+                                    ((src >> inst.bf_src_bit) & inst.bitfield_mask) << dst);
+}
 
-    /// Input parameters of the current macro.
-    std::unique_ptr<u32[]> parameters;
-    std::size_t num_parameters = 0;
-    std::size_t parameters_capacity = 0;
-    /// Index of the next parameter that will be fetched by the 'parm' instruction.
-    u32 next_parameter_index = 0;
+template <ResultOperation result_operation>
+void ExecuteRead(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 method = state.registers[inst.src_a] + inst.immediate;
+    ProcessResult<result_operation>(state, inst, state.context->GetRegisterValue(method));
+}
 
-    bool carry_flag = false;
-    const std::vector<u32>& code;
-};
+void ExecuteNothing(ExecutionState&, const DecodedInstruction&) {}
 
-void MacroInterpreterImpl::Execute(const std::vector<u32>& params, u32 method) {
-    MICROPROFILE_SCOPE(MacroInterp);
-    Reset();
+void ExecuteBranchInDelaySlot(ExecutionState&, const DecodedInstruction&) {
+    ASSERT_MSG(false, "Executing a branch in a delay slot is not valid");
+}
 
-    registers[1] = params[0];
-    num_parameters = params.size();
+void ExecutePastEnd(ExecutionState&, const DecodedInstruction&) {
+    ASSERT_MSG(false, "Macro executed past the end of its code");
+}
+
+void ExecuteDelaySlot(ExecutionState& state, const DecodedInstruction* inst) {
+    // An instruction with the Exit flag will not actually cause an exit if it's executed inside a
+    // delay slot, so only its effects are executed.
+    inst->operation(state, *inst);
+}
 
-    if (num_parameters > parameters_capacity) {
-        parameters_capacity = num_parameters;
-        parameters = std::make_unique<u32[]>(num_parameters);
+template <OperationFn operation>
+const DecodedInstruction* Next(ExecutionState& state, const DecodedInstruction* inst) {
+    operation(state, *inst);
+    return inst + 1;
+}
+
+template <OperationFn operation>
+const DecodedInstruction* Exit(ExecutionState& state, const DecodedInstruction* inst) {
+    operation(state, *inst);
+    // Exit has a delay slot, execute the next instruction
+    ExecuteDelaySlot(state, inst + 1);
+    return nullptr;
+}
+
+template <BranchCondition condition, bool annul, bool exit>
+const DecodedInstruction* Branch(ExecutionState& state, const DecodedInstruction* inst) {
+    const u32 value = state.registers[inst->src_a];
+    const bool taken = condition == BranchCondition::Zero ? value == 0 : value != 0;
+    if (taken) {
+        // Ignore the delay slot if the branch has the annul bit.
+        if constexpr (!annul) {
+            ExecuteDelaySlot(state, inst + 1);
+        }
+        return inst + inst->branch_offset;
     }
-    std::memcpy(parameters.get(), params.data(), num_parameters * sizeof(u32));
+    if constexpr (exit) {
+        ExecuteDelaySlot(state, inst + 1);
+        return nullptr;
+    }
+    return inst + 1;
+}
 
-    // Execute the code until we hit an exit condition.
-    bool keep_executing = true;
-    while (keep_executing) {
-        keep_executing = Step(false);
+const DecodedInstruction* PastEnd(ExecutionState& state, const DecodedInstruction* inst) {
+    ExecutePastEnd(state, *inst);
+    return nullptr;
+}
+
+/// Superinstruction executing two consecutive instructions.
+template <OperationFn first, OperationFn second, bool exit>
+const DecodedInstruction* FusedPair(ExecutionState& state, const DecodedInstruction* inst) {
+    first(state, inst[0]);
+    second(state, inst[1]);
+    if constexpr (exit) {
+        ExecuteDelaySlot(state, inst + 2);
+        return nullptr;
     }
+    return inst + 2;
+}
 
-    // Assert the the macro used all the input parameters
-    ASSERT(next_parameter_index == num_parameters);
+/// Superinstruction executing an instruction followed by a branch.
+template <OperationFn first, BranchCondition condition, bool annul, bool exit>
+const DecodedInstruction* FusedBranch(ExecutionState& state, const DecodedInstruction* inst) {
+    first(state, inst[0]);
+    return Branch<condition, annul, exit>(state, inst + 1);
 }
 
-void MacroInterpreterImpl::Reset() {
-    registers = {};
-    pc = 0;
-    delayed_pc = {};
-    method_address.raw = 0;
-    num_parameters = 0;
-    // The next parameter index starts at 1, because $r1 already has the value of the first
-    // parameter.
-    next_parameter_index = 1;
-    carry_flag = false;
+struct OperationHandlers {
+    OperationFn operation;
+    HandlerFn next;
+    HandlerFn exit;
+};
+
+template <OperationFn operation>
+constexpr OperationHandlers MakeHandlers() {
+    return {operation, &Next<operation>, &Exit<operation>};
 }
 
-bool MacroInterpreterImpl::Step(bool is_delay_slot) {
-    u32 base_address = pc;
+template <typename MakeEntry, std::size_t... indices>
+constexpr auto MakeTable(MakeEntry make_entry, std::index_sequence<indices...>) {
+    return std::array{make_entry(std::integral_constant<std::size_t, indices>{})...};
+}
 
-    Macro::Opcode opcode = GetOpcode();
-    pc += 4;
+template <template <ResultOperation> typename MakeOperation>
+constexpr auto MakeResultTable() {
+    return MakeTable(
+        [](auto index) {
+            constexpr auto result_operation = static_cast<ResultOperation>(decltype(index)::value);
+            return MakeHandlers<MakeOperation<result_operation>::value>();
+        },
+        std::make_index_sequence<NUM_RESULT_OPERATIONS>{});
+}
 
-    // Update the program counter if we were delayed
-    if (delayed_pc) {
-        ASSERT(is_delay_slot);
-        pc = *delayed_pc;
-        delayed_pc = {};
-    }
+template <ResultOperation result_operation>
+struct AddImmediateOperation
+    : std::integral_constant<OperationFn, &ExecuteAddImmediate<result_operation>> {};
+template <ResultOperation result_operation>
+struct ExtractInsertOperation
+    : std::integral_constant<OperationFn, &ExecuteExtractInsert<result_operation>> {};
+template <ResultOperation result_operation>
+struct ExtractShiftLeftImmediateOperation
+    : std::integral_constant<OperationFn, &ExecuteExtractShiftLeftImmediate<result_operation>> {};
+template <ResultOperation result_operation>
+struct ExtractShiftLeftRegisterOperation
+    : std::integral_constant<OperationFn, &ExecuteExtractShiftLeftRegister<result_operation>> {};
+template <ResultOperation result_operation>
+struct ReadOperation : std::integral_constant<OperationFn, &ExecuteRead<result_operation>> {};
+
+/// Handlers of ALU instructions, indexed by ALU operation and then by result operation.
+constexpr auto ALU_HANDLERS = MakeTable(
+    [](auto index) {
+        constexpr std::size_t value = decltype(index)::value;
+        return MakeHandlers<&ExecuteALU<static_cast<ALUOperation>(value / NUM_RESULT_OPERATIONS),
+                                        static_cast<ResultOperation>(value %
+                                                                     NUM_RESULT_OPERATIONS)>>();
+    },
+    std::make_index_sequence<NUM_ALU_OPERATIONS * NUM_RESULT_OPERATIONS>{});
+
+constexpr auto ADD_IMMEDIATE_HANDLERS = MakeResultTable<AddImmediateOperation>();
+constexpr auto EXTRACT_INSERT_HANDLERS = MakeResultTable<ExtractInsertOperation>();
+constexpr auto EXTRACT_SHIFT_LEFT_IMMEDIATE_HANDLERS =
+    MakeResultTable<ExtractShiftLeftImmediateOperation>();
+constexpr auto EXTRACT_SHIFT_LEFT_REGISTER_HANDLERS =
+    MakeResultTable<ExtractShiftLeftRegisterOperation>();
+constexpr auto READ_HANDLERS = MakeResultTable<ReadOperation>();
+
+/// Branch handlers, indexed by the condition, annul and exit bits.
+constexpr std::array<HandlerFn, 8> BRANCH_HANDLERS{
+    &Branch<BranchCondition::Zero, false, false>,   &Branch<BranchCondition::Zero, false, true>,
+    &Branch<BranchCondition::Zero, true, false>,    &Branch<BranchCondition::Zero, true, true>,
+    &Branch<BranchCondition::NotZero, false, false>, &Branch<BranchCondition::NotZero, false, true>,
+    &Branch<BranchCondition::NotZero, true, false>,  &Branch<BranchCondition::NotZero, true, true>,
+};
 
-    switch (opcode.operation) {
-    case Macro::Operation::ALU: {
-        u32 result = GetALUResult(opcode.alu_operation, GetRegister(opcode.src_a),
-                                  GetRegister(opcode.src_b));
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::AddImmediate: {
-        ProcessResult(opcode.result_operation, opcode.dst,
-                      GetRegister(opcode.src_a) + opcode.immediate);
-        break;
-    }
-    case Macro::Operation::ExtractInsert: {
-        u32 dst = GetRegister(opcode.src_a);
-        u32 src = GetRegister(opcode.src_b);
-
-        src = (src >> opcode.bf_src_bit) & opcode.GetBitfieldMask();
-        dst &= ~(opcode.GetBitfieldMask() << opcode.bf_dst_bit);
-        dst |= src << opcode.bf_dst_bit;
-        ProcessResult(opcode.result_operation, opcode.dst, dst);
-        break;
-    }
-    case Macro::Operation::ExtractShiftLeftImmediate: {
-        u32 dst = GetRegister(opcode.src_a);
-        u32 src = GetRegister(opcode.src_b);
+constexpr std::size_t BranchHandlerIndex(Opcode opcode) {
+    return static_cast<std::size_t>(opcode.branch_condition.Value()) * 4 +
+           opcode.branch_annul * 2 + opcode.is_exit;
+}
 
-        u32 result = ((src >> dst) & opcode.GetBitfieldMask()) << opcode.bf_dst_bit;
+struct FusedPairHandlers {
+    OperationFn first;
+    OperationFn second;
+    HandlerFn next;
+    HandlerFn exit;
+};
 
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::ExtractShiftLeftRegister: {
-        u32 dst = GetRegister(opcode.src_a);
-        u32 src = GetRegister(opcode.src_b);
+template <OperationFn first, OperationFn second>
+constexpr FusedPairHandlers MakeFusedPair() {
+    return {first, second, &FusedPair<first, second, false>, &FusedPair<first, second, true>};
+}
 
-        u32 result = ((src >> opcode.bf_src_bit) & opcode.GetBitfieldMask()) << dst;
+/// Instruction pairs common in games' macros that are executed by a single handler.
+constexpr std::array FUSED_PAIRS{
+    // Read a register, add to it and send the result
+    MakeFusedPair<&ExecuteRead<ResultOperation::Move>,
+                  &ExecuteALU<ALUOperation::Add, ResultOperation::MoveAndSend>>(),
+    MakeFusedPair<&ExecuteRead<ResultOperation::Move>,
+                  &ExecuteAddImmediate<ResultOperation::MoveAndSend>>(),
+    // Set the method address and send a parameter
+    MakeFusedPair<&ExecuteAddImmediate<ResultOperation::MoveAndSetMethod>,
+                  &ExecuteAddImmediate<ResultOperation::FetchAndSend>>(),
+    // Send consecutive parameters
+    MakeFusedPair<&ExecuteAddImmediate<ResultOperation::FetchAndSend>,
+                  &ExecuteAddImmediate<ResultOperation::FetchAndSend>>(),
+    // Fetch a parameter and set it as the method address
+    MakeFusedPair<&ExecuteAddImmediate<ResultOperation::IgnoreAndFetch>,
+                  &ExecuteAddImmediate<ResultOperation::MoveAndSetMethodFetchAndSend>>(),
+};
 
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::Read: {
-        u32 result = Read(GetRegister(opcode.src_a) + opcode.immediate);
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::Branch: {
-        ASSERT_MSG(!is_delay_slot, "Executing a branch in a delay slot is not valid");
-        u32 value = GetRegister(opcode.src_a);
-        bool taken = EvaluateBranchCondition(opcode.branch_condition, value);
-        if (taken) {
-            // Ignore the delay slot if the branch has the annul bit.
-            if (opcode.branch_annul) {
-                pc = base_address + opcode.GetBranchTarget();
-                return true;
-            }
+template <OperationFn first>
+constexpr std::array<HandlerFn, 8> MakeFusedBranch() {
+    return {
+        &FusedBranch<first, BranchCondition::Zero, false, false>,
+        &FusedBranch<first, BranchCondition::Zero, false, true>,
+        &FusedBranch<first, BranchCondition::Zero, true, false>,
+        &FusedBranch<first, BranchCondition::Zero, true, true>,
+        &FusedBranch<first, BranchCondition::NotZero, false, false>,
+        &FusedBranch<first, BranchCondition::NotZero, false, true>,
+        &FusedBranch<first, BranchCondition::NotZero, true, false>,
+        &FusedBranch<first, BranchCondition::NotZero, true, true>,
+    };
+}
 
-            delayed_pc = base_address + opcode.GetBranchTarget();
-            // Execute one more instruction due to the delay slot.
-            return Step(true);
+/// Loop counter updates and loop bodies followed by the loop's branch.
+constexpr std::array FUSED_BRANCHES{
+    std::pair{&ExecuteAddImmediate<ResultOperation::Move>,
+              MakeFusedBranch<&ExecuteAddImmediate<ResultOperation::Move>>()},
+    std::pair{&ExecuteALU<ALUOperation::Subtract, ResultOperation::Move>,
+              MakeFusedBranch<&ExecuteALU<ALUOperation::Subtract, ResultOperation::Move>>()},
+    std::pair{&ExecuteAddImmediate<ResultOperation::FetchAndSend>,
+              MakeFusedBranch<&ExecuteAddImmediate<ResultOperation::FetchAndSend>>()},
+};
+
+OperationHandlers GetHandlers(Opcode opcode) {
+    const auto result = static_cast<std::size_t>(opcode.result_operation.Value());
+    switch (opcode.operation) {
+    case Macro::Operation::ALU: {
+        auto alu_operation = static_cast<std::size_t>(opcode.alu_operation.Value());
+        if (alu_operation >= NUM_ALU_OPERATIONS ||
+            (alu_operation > static_cast<std::size_t>(ALUOperation::SubtractWithBorrow) &&
+             alu_operation < static_cast<std::size_t>(ALUOperation::Xor))) {
+            UNIMPLEMENTED_MSG("Unimplemented ALU operation {}", alu_operation);
+            // Use one of the invalid encodings inside the table, they all produce zero.
+            alu_operation = 4;
         }
-        break;
+        return ALU_HANDLERS[alu_operation * NUM_RESULT_OPERATIONS + result];
     }
+    case Macro::Operation::AddImmediate:
+        return ADD_IMMEDIATE_HANDLERS[result];
+    case Macro::Operation::ExtractInsert:
+        return EXTRACT_INSERT_HANDLERS[result];
+    case Macro::Operation::ExtractShiftLeftImmediate:
+        return EXTRACT_SHIFT_LEFT_IMMEDIATE_HANDLERS[result];
+    case Macro::Operation::ExtractShiftLeftRegister:
+        return EXTRACT_SHIFT_LEFT_REGISTER_HANDLERS[result];
+    case Macro::Operation::Read:
+        return READ_HANDLERS[result];
+    case Macro::Operation::Branch:
+        return {&ExecuteBranchInDelaySlot, BRANCH_HANDLERS[BranchHandlerIndex(opcode)],
+                BRANCH_HANDLERS[BranchHandlerIndex(opcode)]};
     default:
         UNIMPLEMENTED_MSG("Unimplemented macro operation {}", opcode.operation.Value());
-        break;
+        return MakeHandlers<&ExecuteNothing>();
     }
-
-    // An instruction with the Exit flag will not actually
-    // cause an exit if it's executed inside a delay slot.
-    if (opcode.is_exit && !is_delay_slot) {
-        // Exit has a delay slot, execute the next instruction
-        Step(true);
-        return false;
-    }
-
-    return true;
 }
+} // Anonymous namespace
 
-u32 MacroInterpreterImpl::GetALUResult(Macro::ALUOperation operation, u32 src_a, u32 src_b) {
-    switch (operation) {
-    case Macro::ALUOperation::Add: {
-        const u64 result{static_cast<u64>(src_a) + src_b};
-        carry_flag = result > 0xffffffff;
-        return static_cast<u32>(result);
-    }
-    case Macro::ALUOperation::AddWithCarry: {
-        const u64 result{static_cast<u64>(src_a) + src_b + (carry_flag ? 1ULL : 0ULL)};
-        carry_flag = result > 0xffffffff;
-        return static_cast<u32>(result);
-    }
-    case Macro::ALUOperation::Subtract: {
-        const u64 result{static_cast<u64>(src_a) - src_b};
-        carry_flag = result < 0x100000000;
-        return static_cast<u32>(result);
-    }
-    case Macro::ALUOperation::SubtractWithBorrow: {
-        const u64 result{static_cast<u64>(src_a) - src_b - (carry_flag ? 0ULL : 1ULL)};
-        carry_flag = result < 0x100000000;
-        return static_cast<u32>(result);
-    }
-    case Macro::ALUOperation::Xor:
-        return src_a ^ src_b;
-    case Macro::ALUOperation::Or:
-        return src_a | src_b;
-    case Macro::ALUOperation::And:
-        return src_a & src_b;
-    case Macro::ALUOperation::AndNot:
-        return src_a & ~src_b;
-    case Macro::ALUOperation::Nand:
-        return ~(src_a & src_b);
-
-    default:
-        UNIMPLEMENTED_MSG("Unimplemented ALU operation {}", operation);
-        return 0;
-    }
+DecodedMacro::DecodedMacro(std::span<const u32> code) {
+    Decode(code);
+    Fuse(code);
 }
 
-void MacroInterpreterImpl::ProcessResult(Macro::ResultOperation operation, u32 reg, u32 result) {
-    switch (operation) {
-    case Macro::ResultOperation::IgnoreAndFetch:
-        // Fetch parameter and ignore result.
-        SetRegister(reg, FetchParameter());
-        break;
-    case Macro::ResultOperation::Move:
-        // Move result.
-        SetRegister(reg, result);
-        break;
-    case Macro::ResultOperation::MoveAndSetMethod:
-        // Move result and use as Method Address.
-        SetRegister(reg, result);
-        SetMethodAddress(result);
-        break;
-    case Macro::ResultOperation::FetchAndSend:
-        // Fetch parameter and send result.
-        SetRegister(reg, FetchParameter());
-        Send(result);
-        break;
-    case Macro::ResultOperation::MoveAndSend:
-        // Move and send result.
-        SetRegister(reg, result);
-        Send(result);
-        break;
-    case Macro::ResultOperation::FetchAndSetMethod:
-        // Fetch parameter and use result as Method Address.
-        SetRegister(reg, FetchParameter());
-        SetMethodAddress(result);
-        break;
-    case Macro::ResultOperation::MoveAndSetMethodFetchAndSend:
-        // Move result and use as Method Address, then fetch and send parameter.
-        SetRegister(reg, result);
-        SetMethodAddress(result);
-        Send(FetchParameter());
-        break;
-    case Macro::ResultOperation::MoveAndSetMethodSend:
-        // Move result and use as Method Address, then send bits 12:17 of result.
-        SetRegister(reg, result);
-        SetMethodAddress(result);
-        Send((result >> 12) & 0b111111);
-        break;
-    default:
-        UNIMPLEMENTED_MSG("Unimplemented result operation {}", operation);
-        break;
+DecodedMacro::~DecodedMacro() = default;
+
+void DecodedMacro::Decode(std::span<const u32> code) {
+    // The instruction past the end stops execution, it also is the target of invalid branches.
+    const auto num_instructions = static_cast<s64>(code.size());
+    instructions.resize(code.size() + 1);
+    instructions.back() = DecodedInstruction{
+        .handler = &PastEnd,
+        .operation = &ExecutePastEnd,
+    };
+
+    for (s64 index = 0; index < num_instructions; ++index) {
+        const Opcode opcode{code[index]};
+        const OperationHandlers handlers = GetHandlers(opcode);
+
+        s64 target = index + opcode.immediate;
+        if (opcode.operation == Macro::Operation::Branch &&
+            (target < 0 || target > num_instructions)) {
+            LOG_ERROR(HW_GPU, "Macro branch at {} targets {} outside of the macro", index, target);
+            target = num_instructions;
+        }
+        instructions[index] = DecodedInstruction{
+            .handler = opcode.is_exit ? handlers.exit : handlers.next,
+            .operation = handlers.operation,
+            .branch_offset = static_cast<s32>(target - index),
+            .immediate = static_cast<u32>(opcode.immediate.Value()),
+            .bitfield_mask = opcode.GetBitfieldMask(),
+            .dst = static_cast<u8>(opcode.dst == 0 ? DISCARD_REGISTER : opcode.dst.Value()),
+            .src_a = static_cast<u8>(opcode.src_a),
+            .src_b = static_cast<u8>(opcode.src_b),
+            .bf_src_bit = static_cast<u8>(opcode.bf_src_bit),
+            .bf_dst_bit = static_cast<u8>(opcode.bf_dst_bit),
+        };
     }
 }
 
-bool MacroInterpreterImpl::EvaluateBranchCondition(Macro::BranchCondition cond, u32 value) const {
-    switch (cond) {
-    case Macro::BranchCondition::Zero:
-        return value == 0;
-    case Macro::BranchCondition::NotZero:
-        return value != 0;
+void DecodedMacro::Fuse(std::span<const u32> code) {
+    // The second instruction of a pair keeps its own handler, so branches to it and delay slots
+    // still execute it alone.
+    for (std::size_t index = 0; index + 1 < code.size(); ++index) {
+        const Opcode opcode{code[index]};
+        const Opcode next_opcode{code[index + 1]};
+        if (opcode.is_exit || opcode.operation == Macro::Operation::Branch) {
+            continue;
+        }
+        auto& inst = instructions[index];
+        const auto& next_inst = instructions[index + 1];
+        if (next_opcode.operation == Macro::Operation::Branch) {
+            for (const auto& [first, handlers] : FUSED_BRANCHES) {
+                if (inst.operation == first) {
+                    inst.handler = handlers[BranchHandlerIndex(next_opcode)];
+                    ++num_fused_instructions;
+                    break;
+                }
+            }
+            continue;
+        }
+        for (const auto& pair : FUSED_PAIRS) {
+            if (inst.operation == pair.first && next_inst.operation == pair.second) {
+                inst.handler = next_opcode.is_exit ? pair.exit : pair.next;
+                ++num_fused_instructions;
+                break;
+            }
+        }
     }
-    UNREACHABLE();
 }
 
-Macro::Opcode MacroInterpreterImpl::GetOpcode() const {
-    ASSERT((pc % sizeof(u32)) == 0);
-    ASSERT(pc < code.size() * sizeof(u32));
-    return {code[pc / sizeof(u32)]};
+std::size_t DecodedMacro::NumFusedInstructions() const {
+    return num_fused_instructions;
 }
 
-u32 MacroInterpreterImpl::GetRegister(u32 register_id) const {
-    return registers.at(register_id);
+void DecodedMacro::Execute(MacroContext& context, std::span<const u32> parameters) const {
+    ExecutionState state{
+        .parameters = parameters.data(),
+        .num_parameters = parameters.size(),
+        // The next parameter index starts at 1, because $r1 already has the value of the first
+        // parameter.
+        .next_parameter_index = 1,
+        .context = &context,
+    };
+    state.registers[1] = parameters[0];
+
+    // Execute the code until we hit an exit condition.
+    const DecodedInstruction* inst = instructions.data();
+    do {
+        inst = inst->handler(state, inst);
+    } while (inst != nullptr);
+
+    // Assert the the macro used all the input parameters
+    ASSERT(state.next_parameter_index == state.num_parameters);
 }
 
-void MacroInterpreterImpl::SetRegister(u32 register_id, u32 value) {
-    // Register 0 is hardwired as the zero register.
-    // Ensure no writes to it actually occur.
-    if (register_id == 0) {
-        return;
+namespace {
+/// Applies the methods sent by a macro to a register file, without any other side effect.
+class RegisterFileContext final : public MacroContext {
+public:
+    explicit RegisterFileContext(std::span<const u32> registers_)
+        : registers(registers_.begin(), registers_.end()) {}
+
+    void CallMethod(u32 method, u32 argument) override {
+        if (method < registers.size()) {
+            registers[method] = argument;
+        }
     }
 
-    registers.at(register_id) = value;
-}
+    u32 GetRegisterValue(u32 method) const override {
+        return method < registers.size() ? registers[method] : 0;
+    }
 
-void MacroInterpreterImpl::SetMethodAddress(u32 address) {
-    method_address.raw = address;
-}
+    std::span<const u32> Registers() const {
+        return registers;
+    }
 
-void MacroInterpreterImpl::Send(u32 value) {
-    maxwell3d.CallMethod(method_address.address, value, true);
-    // Increment the method address by the method increment.
-    method_address.address.Assign(method_address.address.Value() +
-                                  method_address.increment.Value());
-}
+private:
+    std::vector<u32> registers;
+};
+} // Anonymous namespace
 
-u32 MacroInterpreterImpl::Read(u32 method) const {
-    return maxwell3d.GetRegisterValue(method);
+std::vector<RegisterMismatch> CompareWithHLE(std::span<const u32> code,
+                                             std::span<const u32> parameters,
+                                             std::span<const u32> registers,
+                                             std::span<const u32> hle_registers) {
+    ASSERT(registers.size() == hle_registers.size());
+    RegisterFileContext context{registers};
+    DecodedMacro{code}.Execute(context, parameters);
+
+    std::vector<RegisterMismatch> mismatches;
+    const auto lle_registers = context.Registers();
+    for (u32 method = 0; method < lle_registers.size(); ++method) {
+        if (lle_registers[method] != hle_registers[method]) {
+            mismatches.push_back({method, lle_registers[method], hle_registers[method]});
+        }
+    }
+    return mismatches;
 }
 
-u32 MacroInterpreterImpl::FetchParameter() {
-    ASSERT(next_parameter_index < num_parameters);
-    return parameters[next_parameter_index++];
-}
+} // namespace Macro
+
+namespace {
+class MacroInterpreterImpl final : public CachedMacro, public Macro::MacroContext {
+public:
+    explicit MacroInterpreterImpl(Engines::Maxwell3D& maxwell3d_, const std::vector<u32>& code)
+        : maxwell3d{maxwell3d_}, program{code} {}
+
+    void Execute(const std::vector<u32>& parameters, u32 method) override {
+        MICROPROFILE_SCOPE(MacroInterp);
+        program.Execute(*this, parameters);
+    }
+
+    void CallMethod(u32 method, u32 argument) override {
+        maxwell3d.CallMethod(method, argument, true);
+    }
+
+    u32 GetRegisterValue(u32 method) const override {
+        return maxwell3d.GetRegisterValue(method);
+    }
+
+private:
+    Engines::Maxwell3D& maxwell3d;
+    Macro::DecodedMacro program;
+};
 } // Anonymous namespace
 
 MacroInterpreter::MacroInterpreter(Engines::Maxwell3D& maxwell3d_)
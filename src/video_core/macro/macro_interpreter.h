@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <span>
 #include <vector>
 
 #include "common/common_types.h"
@@ -13,6 +14,78 @@ namespace Engines {
 class Maxwell3D;
 }
 
+namespace Macro {
+
+struct DecodedInstruction;
+
+/// Engine accesses performed by running macro code.
+class MacroContext {
+public:
+    virtual ~MacroContext() = default;
+
+    /// Calls an engine method with the given argument.
+    virtual void CallMethod(u32 method, u32 argument) = 0;
+
+    /// Reads the engine register of the given method.
+    virtual u32 GetRegisterValue(u32 method) const = 0;
+};
+
+/**
+ * Macro code translated once into an array of pre-decoded instructions. Every instruction stores a
+ * pointer to a handler specialized for its operation, which executes it and returns the next
+ * instruction to run, so executing the macro never decodes an opcode again. Common instruction
+ * pairs, such as a register read followed by an add that sends the result, are fused into a
+ * single handler.
+ */
+class DecodedMacro {
+public:
+    explicit DecodedMacro(std::span<const u32> code);
+    ~DecodedMacro();
+
+    /**
+     * Executes the macro with the given parameters.
+     *
+     * @param context    Engine the macro sends methods to and reads registers from
+     * @param parameters The parameters of the macro
+     */
+    void Execute(MacroContext& context, std::span<const u32> parameters) const;
+
+    /// Returns the number of instructions whose handler also executes the next instruction.
+    [[nodiscard]] std::size_t NumFusedInstructions() const;
+
+private:
+    void Decode(std::span<const u32> code);
+    void Fuse(std::span<const u32> code);
+
+    std::vector<DecodedInstruction> instructions;
+    std::size_t num_fused_instructions{};
+};
+
+/// Register whose value differs after running a macro and its HLE implementation.
+struct RegisterMismatch {
+    u32 method;
+    u32 lle_value;
+    u32 hle_value;
+};
+
+/**
+ * Runs macro code over a copy of the engine registers, applying the methods it sends as plain
+ * register writes, and compares the result with the registers left by an HLE implementation.
+ *
+ * @param code          The macro code
+ * @param parameters    The parameters of the macro
+ * @param registers     Engine registers before the macro ran
+ * @param hle_registers Engine registers after the HLE implementation ran
+ *
+ * @returns The registers whose values differ
+ */
+[[nodiscard]] std::vector<RegisterMismatch> CompareWithHLE(std::span<const u32> code,
+                                                           std::span<const u32> parameters,
+                                                           std::span<const u32> registers,
+                                                           std::span<const u32> hle_registers);
+
+} // namespace Macro
+
 class MacroInterpreter final : public MacroEngine {
 public:
     explicit MacroInterpreter(Engines::Maxwell3D& maxwell3d_);
@@ -9,6 +9,7 @@
 #include "core/core.h"
 #include "core/hle/kernel/k_page_table.h"
 #include "core/hle/kernel/k_process.h"
+#include "video_core/command_capture.h"
 #include "video_core/guest_memory.h"
 #include "video_core/host1x/host1x.h"
 #include "video_core/invalidation_accumulator.h"
@@ -179,8 +180,33 @@ void MemoryManager::BindRasterizer(VideoCore::RasterizerInterface* rasterizer_)
     rasterizer = rasterizer_;
 }
 
+void MemoryManager::BindCommandCapture(CommandCapture::Recorder* recorder) {
+    command_capture = recorder;
+    command_capture->RecordAddressSpace({
+        .address_space = unique_identifier,
+        .address_space_bits = address_space_bits,
+        .split_address = split_address,
+        .big_page_bits = big_page_bits,
+        .page_bits = page_bits,
+    });
+}
+
 GPUVAddr MemoryManager::Map(GPUVAddr gpu_addr, DAddr dev_addr, std::size_t size, PTEKind kind,
                             bool is_big_pages) {
+    if (command_capture) {
+        command_capture->RecordMap({
+            .address_space = unique_identifier,
+            .gpu_addr = gpu_addr,
+            .device_addr = dev_addr,
+            .size = size,
+            .kind = kind,
+            .is_big_pages = is_big_pages,
+            .is_sparse = false,
+        });
+        command_capture->RecordMappedMemory(dev_addr, size, [this](DAddr addr, std::span<u8> data) {
+            memory.ReadBlockUnsafe(addr, data.data(), data.size());
+        });
+    }
     if (is_big_pages) [[likely]] {
         return BigPageTableOp<EntryType::Mapped>(gpu_addr, dev_addr, size, kind);
     }
@@ -188,6 +214,17 @@ GPUVAddr MemoryManager::Map(GPUVAddr gpu_addr, DAddr dev_addr, std::size_t size,
 }
 
 GPUVAddr MemoryManager::MapSparse(GPUVAddr gpu_addr, std::size_t size, bool is_big_pages) {
+    if (command_capture) {
+        command_capture->RecordMap({
+            .address_space = unique_identifier,
+            .gpu_addr = gpu_addr,
+            .device_addr = 0,
+            .size = size,
+            .kind = PTEKind::INVALID,
+            .is_big_pages = is_big_pages,
+            .is_sparse = true,
+        });
+    }
     if (is_big_pages) [[likely]] {
         return BigPageTableOp<EntryType::Reserved>(gpu_addr, 0, size, PTEKind::INVALID);
     }
@@ -198,10 +235,16 @@ void MemoryManager::Unmap(GPUVAddr gpu_addr, std::size_t size) {
     if (size == 0) {
         return;
     }
+    if (command_capture) {
+        command_capture->RecordUnmap(unique_identifier, gpu_addr, size);
+    }
     GetSubmappedRangeImpl<false>(gpu_addr, size, page_stash);
 
     for (const auto& [map_addr, map_size] : page_stash) {
         rasterizer->UnmapMemory(map_addr, map_size);
+        if (command_capture) {
+            command_capture->ForgetMappedMemory(map_addr, map_size);
+        }
     }
     page_stash.clear();
 
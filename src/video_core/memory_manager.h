@@ -27,6 +27,10 @@ namespace VideoCommon {
 class InvalidationAccumulator;
 }
 
+namespace Tegra::CommandCapture {
+class Recorder;
+}
+
 namespace Core {
 class System;
 } // namespace Core
@@ -52,6 +56,9 @@ public:
     /// Binds a renderer to the memory manager.
     void BindRasterizer(VideoCore::RasterizerInterface* rasterizer);
 
+    /// Records the address space and its mappings, with the memory they newly map, to a capture.
+    void BindCommandCapture(CommandCapture::Recorder* recorder);
+
     [[nodiscard]] std::optional<DAddr> GpuToCpuAddress(GPUVAddr addr) const;
 
     [[nodiscard]] std::optional<DAddr> GpuToCpuAddress(GPUVAddr addr, std::size_t size) const;
@@ -209,6 +216,7 @@ private:
     u64 big_page_table_mask;
 
     VideoCore::RasterizerInterface* rasterizer = nullptr;
+    CommandCapture::Recorder* command_capture = nullptr;
 
     enum class EntryType : u64 {
         Free = 0,
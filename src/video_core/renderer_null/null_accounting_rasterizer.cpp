@@ -0,0 +1,548 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/alignment.h"
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/engines/draw_manager.h"
+#include "video_core/engines/kepler_compute.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/gpu.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+#include "video_core/renderer_null/null_accounting_rasterizer.h"
+
+namespace Null {
+
+namespace {
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+double ToMilliseconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration_cast<Milliseconds>(time).count();
+}
+
+} // Anonymous namespace
+
+FrameStats& FrameStats::operator+=(const FrameStats& rhs) {
+    frame_time += rhs.frame_time;
+    draw_time += rhs.draw_time;
+    clear_time += rhs.clear_time;
+    dispatch_time += rhs.dispatch_time;
+    flush_time += rhs.flush_time;
+    invalidation_time += rhs.invalidation_time;
+    translation_time += rhs.translation_time;
+    num_draws += rhs.num_draws;
+    num_clears += rhs.num_clears;
+    num_dispatches += rhs.num_dispatches;
+    num_translated_programs += rhs.num_translated_programs;
+    num_bindings += rhs.num_bindings;
+    num_gpu_operations += rhs.num_gpu_operations;
+    uploaded_bytes += rhs.uploaded_bytes;
+    downloaded_bytes += rhs.downloaded_bytes;
+    copied_bytes += rhs.copied_bytes;
+    return *this;
+}
+
+AccountingAccelerateDMA::AccountingAccelerateDMA(BufferCache& buffer_cache_)
+    : buffer_cache{buffer_cache_} {}
+
+bool AccountingAccelerateDMA::BufferCopy(GPUVAddr src_address, GPUVAddr dest_address,
+                                         u64 amount) {
+    std::scoped_lock lock{buffer_cache.mutex};
+    return buffer_cache.DMACopy(src_address, dest_address, amount);
+}
+
+bool AccountingAccelerateDMA::BufferClear(GPUVAddr src_address, u64 amount, u32 value) {
+    std::scoped_lock lock{buffer_cache.mutex};
+    return buffer_cache.DMAClear(src_address, amount, value);
+}
+
+RasterizerAccounting::RasterizerAccounting(Tegra::GPU& gpu_,
+                                           Tegra::MaxwellDeviceMemoryManager& device_memory_)
+    : gpu{gpu_}, device_memory{device_memory_}, texture_cache_runtime{staging_pool},
+      texture_cache(texture_cache_runtime, device_memory), buffer_cache_runtime{staging_pool},
+      buffer_cache(device_memory, buffer_cache_runtime),
+      pipeline_cache(device_memory, texture_cache, buffer_cache), accelerate_dma(buffer_cache),
+      frame_start{std::chrono::steady_clock::now()} {}
+
+RasterizerAccounting::~RasterizerAccounting() {
+    if (num_frames == 0) {
+        return;
+    }
+    const double frames = static_cast<double>(num_frames);
+    LOG_INFO(Render,
+             "Accounting renderer: {} frames, {:.3f} ms draws, {:.3f} ms clears, {:.3f} ms "
+             "dispatches, {:.3f} ms flushes, {:.3f} ms invalidations per frame, {} programs "
+             "translated in {:.3f} ms",
+             num_frames, ToMilliseconds(totals.draw_time) / frames,
+             ToMilliseconds(totals.clear_time) / frames,
+             ToMilliseconds(totals.dispatch_time) / frames,
+             ToMilliseconds(totals.flush_time) / frames,
+             ToMilliseconds(totals.invalidation_time) / frames, totals.num_translated_programs,
+             ToMilliseconds(totals.translation_time));
+}
+
+template <typename Func>
+void RasterizerAccounting::Measure(std::chrono::nanoseconds FrameStats::*time, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    std::scoped_lock lock{stats_mutex};
+    current_frame.*time += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+}
+
+template <typename Func>
+void RasterizerAccounting::PrepareDraw(bool is_indexed, Func&& draw_func) {
+    SCOPE_EXIT {
+        gpu.TickWork();
+    };
+    Measure(&FrameStats::draw_time, [&] {
+        gpu_memory->FlushCaching();
+
+        GraphicsPipeline* const pipeline{pipeline_cache.CurrentGraphicsPipeline()};
+        if (!pipeline) {
+            return;
+        }
+        std::scoped_lock lock{buffer_cache.mutex, texture_cache.mutex};
+        pipeline->Configure(*maxwell3d, *gpu_memory, is_indexed);
+        draw_func();
+    });
+    std::scoped_lock lock{stats_mutex};
+    ++current_frame.num_draws;
+}
+
+void RasterizerAccounting::Draw(bool is_indexed, u32 instance_count) {
+    PrepareDraw(is_indexed, [] {});
+}
+
+void RasterizerAccounting::DrawIndirect() {
+    const auto& params = maxwell3d->draw_manager->GetIndirectParams();
+    buffer_cache.SetDrawIndirect(&params);
+    PrepareDraw(params.is_indexed, [this, &params] {
+        [[maybe_unused]] const auto indirect_buffer = buffer_cache.GetDrawIndirectBuffer();
+        if (!params.is_byte_count && params.include_count) {
+            [[maybe_unused]] const auto count = buffer_cache.GetDrawIndirectCount();
+        }
+    });
+    buffer_cache.SetDrawIndirect(nullptr);
+}
+
+void RasterizerAccounting::DrawTexture() {
+    SCOPE_EXIT {
+        gpu.TickWork();
+    };
+    Measure(&FrameStats::draw_time, [this] {
+        std::scoped_lock lock{texture_cache.mutex};
+        texture_cache.SynchronizeGraphicsDescriptors();
+        texture_cache.UpdateRenderTargets(false);
+
+        const auto& draw_texture_state = maxwell3d->draw_manager->GetDrawTextureState();
+        [[maybe_unused]] const auto* sampler =
+            texture_cache.GetGraphicsSampler(draw_texture_state.src_sampler);
+        [[maybe_unused]] const auto& texture =
+            texture_cache.GetImageView(draw_texture_state.src_texture);
+        [[maybe_unused]] const auto* framebuffer = texture_cache.GetFramebuffer();
+    });
+    std::scoped_lock lock{stats_mutex};
+    ++current_frame.num_draws;
+}
+
+void RasterizerAccounting::Clear(u32 layer_count) {
+    Measure(&FrameStats::clear_time, [this] {
+        gpu_memory->FlushCaching();
+
+        const auto& regs = maxwell3d->regs;
+        const bool use_color = regs.clear_surface.R || regs.clear_surface.G ||
+                               regs.clear_surface.B || regs.clear_surface.A;
+        const bool use_depth = regs.clear_surface.Z;
+        const bool use_stencil = regs.clear_surface.S;
+        if (!use_color && !use_depth && !use_stencil) {
+            return;
+        }
+        std::scoped_lock lock{texture_cache.mutex};
+        texture_cache.UpdateRenderTargets(true);
+        [[maybe_unused]] const Framebuffer* const framebuffer = texture_cache.GetFramebuffer();
+    });
+    std::scoped_lock lock{stats_mutex};
+    ++current_frame.num_clears;
+}
+
+void RasterizerAccounting::DispatchCompute() {
+    Measure(&FrameStats::dispatch_time, [this] {
+        gpu_memory->FlushCaching();
+
+        ComputePipeline* const pipeline{pipeline_cache.CurrentComputePipeline()};
+        if (!pipeline) {
+            return;
+        }
+        std::scoped_lock lock{texture_cache.mutex, buffer_cache.mutex};
+        pipeline->Configure(*kepler_compute, *gpu_memory);
+
+        const auto indirect_address = kepler_compute->GetIndirectComputeAddress();
+        if (indirect_address) {
+            static constexpr auto sync_info = VideoCommon::ObtainBufferSynchronize::FullSynchronize;
+            const auto post_op = VideoCommon::ObtainBufferOperation::DiscardWrite;
+            [[maybe_unused]] const auto indirect_buffer =
+                buffer_cache.ObtainBuffer(*indirect_address, 12, sync_info, post_op);
+        }
+    });
+    std::scoped_lock lock{stats_mutex};
+    ++current_frame.num_dispatches;
+}
+
+void RasterizerAccounting::ResetCounter(VideoCommon::QueryType type) {}
+
+void RasterizerAccounting::Query(GPUVAddr gpu_addr, VideoCommon::QueryType type,
+                                 VideoCommon::QueryPropertiesFlags flags, u32 payload,
+                                 u32 subreport) {
+    if (!gpu_memory) {
+        return;
+    }
+    if (True(flags & VideoCommon::QueryPropertiesFlags::HasTimeout)) {
+        const u64 ticks = gpu.GetTicks();
+        gpu_memory->Write<u64>(gpu_addr + 8, ticks);
+        gpu_memory->Write<u64>(gpu_addr, static_cast<u64>(payload));
+    } else {
+        gpu_memory->Write<u32>(gpu_addr, payload);
+    }
+}
+
+void RasterizerAccounting::BindGraphicsUniformBuffer(size_t stage, u32 index, GPUVAddr gpu_addr,
+                                                     u32 size) {
+    buffer_cache.BindGraphicsUniformBuffer(stage, index, gpu_addr, size);
+}
+
+void RasterizerAccounting::DisableGraphicsUniformBuffer(size_t stage, u32 index) {
+    buffer_cache.DisableGraphicsUniformBuffer(stage, index);
+}
+
+void RasterizerAccounting::FlushAll() {}
+
+void RasterizerAccounting::FlushRegion(DAddr addr, u64 size, VideoCommon::CacheType which) {
+    if (addr == 0 || size == 0) {
+        return;
+    }
+    Measure(&FrameStats::flush_time, [&] {
+        if (True(which & VideoCommon::CacheType::TextureCache)) {
+            std::scoped_lock lock{texture_cache.mutex};
+            texture_cache.DownloadMemory(addr, size);
+        }
+        if (True(which & VideoCommon::CacheType::BufferCache)) {
+            std::scoped_lock lock{buffer_cache.mutex};
+            buffer_cache.DownloadMemory(addr, size);
+        }
+    });
+}
+
+bool RasterizerAccounting::MustFlushRegion(DAddr addr, u64 size, VideoCommon::CacheType which) {
+    if (True(which & VideoCommon::CacheType::BufferCache)) {
+        std::scoped_lock lock{buffer_cache.mutex};
+        if (buffer_cache.IsRegionGpuModified(addr, size)) {
+            return true;
+        }
+    }
+    if (!Settings::IsGPULevelHigh()) {
+        return false;
+    }
+    if (True(which & VideoCommon::CacheType::TextureCache)) {
+        std::scoped_lock lock{texture_cache.mutex};
+        return texture_cache.IsRegionGpuModified(addr, size);
+    }
+    return false;
+}
+
+void RasterizerAccounting::InvalidateRegion(DAddr addr, u64 size, VideoCommon::CacheType which) {
+    if (addr == 0 || size == 0) {
+        return;
+    }
+    Measure(&FrameStats::invalidation_time, [&] {
+        if (True(which & VideoCommon::CacheType::TextureCache)) {
+            std::scoped_lock lock{texture_cache.mutex};
+            texture_cache.WriteMemory(addr, size);
+        }
+        if (True(which & VideoCommon::CacheType::BufferCache)) {
+            std::scoped_lock lock{buffer_cache.mutex};
+            buffer_cache.WriteMemory(addr, size);
+        }
+        if (True(which & VideoCommon::CacheType::ShaderCache)) {
+            pipeline_cache.InvalidateRegion(addr, size);
+        }
+    });
+}
+
+void RasterizerAccounting::InnerInvalidation(
+    std::span<const std::pair<DAddr, std::size_t>> sequences) {
+    Measure(&FrameStats::invalidation_time, [&] {
+        {
+            std::scoped_lock lock{texture_cache.mutex};
+            for (const auto& [addr, size] : sequences) {
+                texture_cache.WriteMemory(addr, size);
+            }
+        }
+        {
+            std::scoped_lock lock{buffer_cache.mutex};
+            for (const auto& [addr, size] : sequences) {
+                buffer_cache.WriteMemory(addr, size);
+            }
+        }
+        for (const auto& [addr, size] : sequences) {
+            pipeline_cache.InvalidateRegion(addr, size);
+        }
+    });
+}
+
+bool RasterizerAccounting::OnCPUWrite(DAddr addr, u64 size) {
+    if (addr == 0 || size == 0) {
+        return false;
+    }
+    bool is_buffer_write = false;
+    Measure(&FrameStats::invalidation_time, [&] {
+        {
+            std::scoped_lock lock{buffer_cache.mutex};
+            if (buffer_cache.OnCPUWrite(addr, size)) {
+                is_buffer_write = true;
+                return;
+            }
+        }
+        {
+            std::scoped_lock lock{texture_cache.mutex};
+            texture_cache.WriteMemory(addr, size);
+        }
+        pipeline_cache.InvalidateRegion(addr, size);
+    });
+    return is_buffer_write;
+}
+
+void RasterizerAccounting::OnCacheInvalidation(DAddr addr, u64 size) {
+    if (addr == 0 || size == 0) {
+        return;
+    }
+    Measure(&FrameStats::invalidation_time, [&] {
+        {
+            std::scoped_lock lock{texture_cache.mutex};
+            texture_cache.WriteMemory(addr, size);
+        }
+        {
+            std::scoped_lock lock{buffer_cache.mutex};
+            buffer_cache.WriteMemory(addr, size);
+        }
+        pipeline_cache.InvalidateRegion(addr, size);
+    });
+}
+
+VideoCore::RasterizerDownloadArea RasterizerAccounting::GetFlushArea(DAddr addr, u64 size) {
+    {
+        std::scoped_lock lock{texture_cache.mutex};
+        auto area = texture_cache.GetFlushArea(addr, size);
+        if (area) {
+            return *area;
+        }
+    }
+    VideoCore::RasterizerDownloadArea new_area{
+        .start_address = Common::AlignDown(addr, Core::DEVICE_PAGESIZE),
+        .end_address = Common::AlignUp(addr + size, Core::DEVICE_PAGESIZE),
+        .preemtive = true,
+    };
+    return new_area;
+}
+
+void RasterizerAccounting::InvalidateGPUCache() {
+    gpu.InvalidateGPUCache();
+}
+
+void RasterizerAccounting::UnmapMemory(DAddr addr, u64 size) {
+    {
+        std::scoped_lock lock{texture_cache.mutex};
+        texture_cache.UnmapMemory(addr, size);
+    }
+    {
+        std::scoped_lock lock{buffer_cache.mutex};
+        buffer_cache.WriteMemory(addr, size);
+    }
+    pipeline_cache.OnCacheInvalidation(addr, size);
+}
+
+void RasterizerAccounting::ModifyGPUMemory(size_t as_id, GPUVAddr addr, u64 size) {
+    std::scoped_lock lock{texture_cache.mutex};
+    texture_cache.UnmapGPUMemory(as_id, addr, size);
+}
+
+void RasterizerAccounting::ResolveAsyncFlushes() {
+    Measure(&FrameStats::flush_time, [this] {
+        std::scoped_lock lock{buffer_cache.mutex, texture_cache.mutex};
+        texture_cache.CommitAsyncFlushes();
+        buffer_cache.CommitAsyncFlushes();
+        texture_cache.PopAsyncFlushes();
+        buffer_cache.PopAsyncFlushes();
+    });
+}
+
+void RasterizerAccounting::SignalFence(std::function<void()>&& func) {
+    ResolveAsyncFlushes();
+    func();
+    InvalidateGPUCache();
+}
+
+void RasterizerAccounting::SyncOperation(std::function<void()>&& func) {
+    func();
+}
+
+void RasterizerAccounting::SignalSyncPoint(u32 value) {
+    ResolveAsyncFlushes();
+    auto& syncpoint_manager = gpu.Host1x().GetSyncpointManager();
+    syncpoint_manager.IncrementGuest(value);
+    syncpoint_manager.IncrementHost(value);
+}
+
+void RasterizerAccounting::SignalReference() {}
+
+void RasterizerAccounting::ReleaseFences(bool) {}
+
+void RasterizerAccounting::FlushAndInvalidateRegion(DAddr addr, u64 size,
+                                                    VideoCommon::CacheType which) {
+    if (Settings::IsGPULevelExtreme()) {
+        FlushRegion(addr, size, which);
+    }
+    InvalidateRegion(addr, size, which);
+}
+
+void RasterizerAccounting::WaitForIdle() {
+    std::scoped_lock lock{buffer_cache.mutex};
+    buffer_cache.AccumulateFlushes();
+}
+
+void RasterizerAccounting::FragmentBarrier() {}
+
+void RasterizerAccounting::TiledCacheBarrier() {}
+
+void RasterizerAccounting::FlushCommands() {}
+
+void RasterizerAccounting::TickFrame() {
+    const auto now = std::chrono::steady_clock::now();
+    FrameStats frame;
+    {
+        std::scoped_lock lock{stats_mutex};
+        frame = std::exchange(current_frame, FrameStats{});
+    }
+    frame.frame_time = std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame_start);
+    frame_start = now;
+    {
+        std::scoped_lock lock{texture_cache.mutex};
+        frame.num_gpu_operations += std::exchange(texture_cache_runtime.num_gpu_operations, 0);
+        const TransferCounters counters = std::exchange(texture_cache_runtime.counters, {});
+        frame.uploaded_bytes += counters.uploaded_bytes;
+        frame.downloaded_bytes += counters.downloaded_bytes;
+        frame.copied_bytes += counters.copied_bytes;
+    }
+    {
+        std::scoped_lock lock{buffer_cache.mutex};
+        frame.num_bindings += std::exchange(buffer_cache_runtime.num_bindings, 0);
+        const TransferCounters counters = std::exchange(buffer_cache_runtime.counters, {});
+        frame.uploaded_bytes += counters.uploaded_bytes;
+        frame.downloaded_bytes += counters.downloaded_bytes;
+        frame.copied_bytes += counters.copied_bytes;
+    }
+    frame.num_translated_programs = std::exchange(pipeline_cache.num_translated_programs, 0);
+    frame.translation_time = std::exchange(pipeline_cache.translation_time, {});
+
+    LOG_DEBUG(Render,
+              "Frame {}: {:.3f} ms, {} draws in {:.3f} ms, {} clears in {:.3f} ms, {} dispatches "
+              "in {:.3f} ms, flushes {:.3f} ms, invalidations {:.3f} ms, {} programs translated "
+              "in {:.3f} ms, {} bindings, {} GPU operations, {} bytes uploaded, {} bytes "
+              "downloaded, {} bytes copied",
+              num_frames, ToMilliseconds(frame.frame_time), frame.num_draws,
+              ToMilliseconds(frame.draw_time), frame.num_clears, ToMilliseconds(frame.clear_time),
+              frame.num_dispatches, ToMilliseconds(frame.dispatch_time),
+              ToMilliseconds(frame.flush_time), ToMilliseconds(frame.invalidation_time),
+              frame.num_translated_programs, ToMilliseconds(frame.translation_time),
+              frame.num_bindings, frame.num_gpu_operations, frame.uploaded_bytes,
+              frame.downloaded_bytes, frame.copied_bytes);
+    {
+        std::scoped_lock lock{stats_mutex};
+        totals += frame;
+        ++num_frames;
+    }
+
+    staging_pool.TickFrame();
+    {
+        std::scoped_lock lock{texture_cache.mutex};
+        texture_cache.TickFrame();
+    }
+    {
+        std::scoped_lock lock{buffer_cache.mutex};
+        buffer_cache.TickFrame();
+    }
+}
+
+bool RasterizerAccounting::AccelerateSurfaceCopy(
+    const Tegra::Engines::Fermi2D::Surface& src, const Tegra::Engines::Fermi2D::Surface& dst,
+    const Tegra::Engines::Fermi2D::Config& copy_config) {
+    std::scoped_lock lock{texture_cache.mutex};
+    return texture_cache.BlitImage(dst, src, copy_config);
+}
+
+Tegra::Engines::AccelerateDMAInterface& RasterizerAccounting::AccessAccelerateDMA() {
+    return accelerate_dma;
+}
+
+void RasterizerAccounting::AccelerateInlineToMemory(GPUVAddr address, size_t copy_size,
+                                                    std::span<const u8> memory) {
+    auto cpu_addr = gpu_memory->GpuToCpuAddress(address);
+    if (!cpu_addr) [[unlikely]] {
+        gpu_memory->WriteBlock(address, memory.data(), copy_size);
+        return;
+    }
+    gpu_memory->WriteBlockUnsafe(address, memory.data(), copy_size);
+    {
+        std::unique_lock<std::recursive_mutex> lock{buffer_cache.mutex};
+        if (!buffer_cache.InlineMemory(*cpu_addr, copy_size, memory)) {
+            buffer_cache.WriteMemory(*cpu_addr, copy_size);
+        }
+    }
+    {
+        std::scoped_lock lock_texture{texture_cache.mutex};
+        texture_cache.WriteMemory(*cpu_addr, copy_size);
+    }
+    pipeline_cache.InvalidateRegion(*cpu_addr, copy_size);
+}
+
+void RasterizerAccounting::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
+                                             const VideoCore::DiskResourceLoadCallback& callback) {
+    texture_cache.LoadDiskResources(title_id);
+}
+
+void RasterizerAccounting::InitializeChannel(Tegra::Control::ChannelState& channel) {
+    CreateChannel(channel);
+    {
+        std::scoped_lock lock{buffer_cache.mutex, texture_cache.mutex};
+        texture_cache.CreateChannel(channel);
+        buffer_cache.CreateChannel(channel);
+    }
+    pipeline_cache.CreateChannel(channel);
+}
+
+void RasterizerAccounting::BindChannel(Tegra::Control::ChannelState& channel) {
+    const s32 channel_id = channel.bind_id;
+    BindToChannel(channel_id);
+    {
+        std::scoped_lock lock{buffer_cache.mutex, texture_cache.mutex};
+        texture_cache.BindToChannel(channel_id);
+        buffer_cache.BindToChannel(channel_id);
+    }
+    pipeline_cache.BindToChannel(channel_id);
+}
+
+void RasterizerAccounting::ReleaseChannel(s32 channel_id) {
+    EraseChannel(channel_id);
+    {
+        std::scoped_lock lock{buffer_cache.mutex, texture_cache.mutex};
+        texture_cache.EraseChannel(channel_id);
+        buffer_cache.EraseChannel(channel_id);
+    }
+    pipeline_cache.EraseChannel(channel_id);
+}
+
+} // namespace Null
@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+#include "common/common_types.h"
+#include "video_core/control/channel_state_cache.h"
+#include "video_core/engines/maxwell_dma.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_null/null_buffer_cache.h"
+#include "video_core/renderer_null/null_pipeline_cache.h"
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+#include "video_core/renderer_null/null_texture_cache.h"
+
+namespace Null {
+
+/// CPU time spent by the caches and the work they did during a frame.
+struct FrameStats {
+    std::chrono::nanoseconds frame_time{};
+    std::chrono::nanoseconds draw_time{};
+    std::chrono::nanoseconds clear_time{};
+    std::chrono::nanoseconds dispatch_time{};
+    std::chrono::nanoseconds flush_time{};
+    std::chrono::nanoseconds invalidation_time{};
+    std::chrono::nanoseconds translation_time{};
+    u64 num_draws{};
+    u64 num_clears{};
+    u64 num_dispatches{};
+    u64 num_translated_programs{};
+    u64 num_bindings{};
+    u64 num_gpu_operations{};
+    u64 uploaded_bytes{};
+    u64 downloaded_bytes{};
+    u64 copied_bytes{};
+
+    FrameStats& operator+=(const FrameStats& rhs);
+};
+
+class AccountingAccelerateDMA : public Tegra::Engines::AccelerateDMAInterface {
+public:
+    explicit AccountingAccelerateDMA(BufferCache& buffer_cache);
+
+    bool BufferCopy(GPUVAddr start_address, GPUVAddr end_address, u64 amount) override;
+    bool BufferClear(GPUVAddr src_address, u64 amount, u32 value) override;
+    bool ImageToBuffer(const Tegra::DMA::ImageCopy& copy_info, const Tegra::DMA::ImageOperand& src,
+                       const Tegra::DMA::BufferOperand& dst) override {
+        return false;
+    }
+    bool BufferToImage(const Tegra::DMA::ImageCopy& copy_info, const Tegra::DMA::BufferOperand& src,
+                       const Tegra::DMA::ImageOperand& dst) override {
+        return false;
+    }
+
+private:
+    BufferCache& buffer_cache;
+};
+
+/**
+ * Rasterizer running the real texture, buffer and shader caches against host memory resources.
+ * Nothing is rendered, but all the CPU work a hardware backend does around its API calls is, which
+ * makes it possible to profile the caches in isolation. The time spent in each entry point is
+ * accumulated into per frame statistics.
+ */
+class RasterizerAccounting final
+    : public VideoCore::RasterizerInterface,
+      protected VideoCommon::ChannelSetupCaches<VideoCommon::ChannelInfo> {
+public:
+    explicit RasterizerAccounting(Tegra::GPU& gpu,
+                                  Tegra::MaxwellDeviceMemoryManager& device_memory);
+    ~RasterizerAccounting() override;
+
+    void Draw(bool is_indexed, u32 instance_count) override;
+    void DrawIndirect() override;
+    void DrawTexture() override;
+    void Clear(u32 layer_count) override;
+    void DispatchCompute() override;
+    void ResetCounter(VideoCommon::QueryType type) override;
+    void Query(GPUVAddr gpu_addr, VideoCommon::QueryType type,
+               VideoCommon::QueryPropertiesFlags flags, u32 payload, u32 subreport) override;
+    void BindGraphicsUniformBuffer(size_t stage, u32 index, GPUVAddr gpu_addr, u32 size) override;
+    void DisableGraphicsUniformBuffer(size_t stage, u32 index) override;
+    void FlushAll() override;
+    void FlushRegion(DAddr addr, u64 size,
+                     VideoCommon::CacheType which = VideoCommon::CacheType::All) override;
+    bool MustFlushRegion(DAddr addr, u64 size,
+                         VideoCommon::CacheType which = VideoCommon::CacheType::All) override;
+    void InvalidateRegion(DAddr addr, u64 size,
+                          VideoCommon::CacheType which = VideoCommon::CacheType::All) override;
+    void InnerInvalidation(std::span<const std::pair<DAddr, std::size_t>> sequences) override;
+    void OnCacheInvalidation(DAddr addr, u64 size) override;
+    bool OnCPUWrite(DAddr addr, u64 size) override;
+    VideoCore::RasterizerDownloadArea GetFlushArea(DAddr addr, u64 size) override;
+    void InvalidateGPUCache() override;
+    void UnmapMemory(DAddr addr, u64 size) override;
+    void ModifyGPUMemory(size_t as_id, GPUVAddr addr, u64 size) override;
+    void SignalFence(std::function<void()>&& func) override;
+    void SyncOperation(std::function<void()>&& func) override;
+    void SignalSyncPoint(u32 value) override;
+    void SignalReference() override;
+    void ReleaseFences(bool force) override;
+    void FlushAndInvalidateRegion(
+        DAddr addr, u64 size, VideoCommon::CacheType which = VideoCommon::CacheType::All) override;
+    void WaitForIdle() override;
+    void FragmentBarrier() override;
+    void TiledCacheBarrier() override;
+    void FlushCommands() override;
+    void TickFrame() override;
+    bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Surface& src,
+                               const Tegra::Engines::Fermi2D::Surface& dst,
+                               const Tegra::Engines::Fermi2D::Config& copy_config) override;
+    Tegra::Engines::AccelerateDMAInterface& AccessAccelerateDMA() override;
+    void AccelerateInlineToMemory(GPUVAddr address, size_t copy_size,
+                                  std::span<const u8> memory) override;
+    void LoadDiskResources(u64 title_id, std::stop_token stop_loading,
+                           const VideoCore::DiskResourceLoadCallback& callback) override;
+    void InitializeChannel(Tegra::Control::ChannelState& channel) override;
+    void BindChannel(Tegra::Control::ChannelState& channel) override;
+    void ReleaseChannel(s32 channel_id) override;
+
+private:
+    /// Runs a function and adds its duration to a member of the current frame's statistics
+    template <typename Func>
+    void Measure(std::chrono::nanoseconds FrameStats::*time, Func&& func);
+
+    template <typename Func>
+    void PrepareDraw(bool is_indexed, Func&& draw_func);
+
+    /// Completes pending asynchronous downloads, fences are signalled as soon as they are queued
+    void ResolveAsyncFlushes();
+
+    Tegra::GPU& gpu;
+    Tegra::MaxwellDeviceMemoryManager& device_memory;
+
+    StagingBufferPool staging_pool;
+    TextureCacheRuntime texture_cache_runtime;
+    TextureCache texture_cache;
+    BufferCacheRuntime buffer_cache_runtime;
+    BufferCache buffer_cache;
+    PipelineCache pipeline_cache;
+    AccountingAccelerateDMA accelerate_dma;
+
+    std::mutex stats_mutex;
+    FrameStats current_frame;
+    FrameStats totals;
+    u64 num_frames = 0;
+    std::chrono::steady_clock::time_point frame_start;
+};
+
+} // namespace Null
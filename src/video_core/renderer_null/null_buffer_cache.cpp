@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+
+#include "video_core/renderer_null/null_buffer_cache.h"
+
+namespace Null {
+
+Buffer::Buffer(BufferCacheRuntime&, VideoCommon::NullBufferParams null_params)
+    : VideoCommon::BufferBase(null_params) {}
+
+Buffer::Buffer(BufferCacheRuntime& runtime, VAddr cpu_addr_, u64 size_bytes_)
+    : VideoCommon::BufferBase(cpu_addr_, size_bytes_), storage(SizeBytes()) {}
+
+BufferCacheRuntime::BufferCacheRuntime(StagingBufferPool& staging_pool_)
+    : staging_pool{staging_pool_} {}
+
+StagingBufferRef BufferCacheRuntime::UploadStagingBuffer(size_t size) {
+    counters.uploaded_bytes += size;
+    return staging_pool.Request(size);
+}
+
+StagingBufferRef BufferCacheRuntime::DownloadStagingBuffer(size_t size, bool deferred) {
+    counters.downloaded_bytes += size;
+    return staging_pool.Request(size, deferred);
+}
+
+void BufferCacheRuntime::FreeDeferredStagingBuffer(StagingBufferRef& ref) {
+    staging_pool.FreeDeferred(ref);
+}
+
+void BufferCacheRuntime::CopyBuffer(u8* dst_buffer, u8* src_buffer,
+                                    std::span<const VideoCommon::BufferCopy> copies, bool barrier,
+                                    bool can_reorder_upload) {
+    if (dst_buffer == nullptr || src_buffer == nullptr) {
+        return;
+    }
+    for (const VideoCommon::BufferCopy& copy : copies) {
+        std::memmove(dst_buffer + copy.dst_offset, src_buffer + copy.src_offset, copy.size);
+        counters.copied_bytes += copy.size;
+    }
+}
+
+void BufferCacheRuntime::ClearBuffer(u8* dest_buffer, u32 offset, size_t size, u32 value) {
+    if (dest_buffer == nullptr) {
+        return;
+    }
+    u8* const begin = dest_buffer + offset;
+    for (size_t i = 0; i + sizeof(u32) <= size; i += sizeof(u32)) {
+        std::memcpy(begin + i, &value, sizeof(u32));
+    }
+}
+
+} // namespace Null
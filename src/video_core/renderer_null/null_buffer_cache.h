@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "video_core/buffer_cache/buffer_cache_base.h"
+#include "video_core/buffer_cache/memory_tracker_base.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+#include "video_core/surface.h"
+
+namespace Null {
+
+class BufferCacheRuntime;
+
+/// Buffer whose device storage is host memory.
+class Buffer : public VideoCommon::BufferBase {
+public:
+    explicit Buffer(BufferCacheRuntime&, VideoCommon::NullBufferParams null_params);
+    explicit Buffer(BufferCacheRuntime& runtime, VAddr cpu_addr_, u64 size_bytes_);
+
+    [[nodiscard]] u8* Handle() noexcept {
+        return storage.data();
+    }
+
+    void MarkUsage(u64 offset, u64 size) noexcept {}
+
+    operator u8*() noexcept {
+        return storage.data();
+    }
+
+private:
+    std::vector<u8> storage;
+};
+
+/**
+ * Buffer cache runtime executing transfers with memcpy on host memory. Bindings have no host API
+ * to go to, they are only counted.
+ */
+class BufferCacheRuntime {
+    using PrimitiveTopology = Tegra::Engines::Maxwell3D::Regs::PrimitiveTopology;
+    using IndexFormat = Tegra::Engines::Maxwell3D::Regs::IndexFormat;
+
+public:
+    explicit BufferCacheRuntime(StagingBufferPool& staging_pool_);
+
+    void TickFrame(Common::SlotVector<Buffer>& slot_buffers) noexcept {}
+
+    void Finish() {}
+
+    u64 GetDeviceLocalMemory() const {
+        return 0;
+    }
+
+    u64 GetDeviceMemoryUsage() const {
+        return 0;
+    }
+
+    bool CanReportMemoryUsage() const {
+        return false;
+    }
+
+    u32 GetStorageBufferAlignment() const {
+        return 16;
+    }
+
+    [[nodiscard]] StagingBufferRef UploadStagingBuffer(size_t size);
+
+    [[nodiscard]] StagingBufferRef DownloadStagingBuffer(size_t size, bool deferred = false);
+
+    bool CanReorderUpload(const Buffer& buffer, std::span<const VideoCommon::BufferCopy> copies) {
+        return false;
+    }
+
+    void FreeDeferredStagingBuffer(StagingBufferRef& ref);
+
+    void PreCopyBarrier() {}
+
+    void CopyBuffer(u8* dst_buffer, u8* src_buffer, std::span<const VideoCommon::BufferCopy> copies,
+                    bool barrier, bool can_reorder_upload = false);
+
+    void PostCopyBarrier() {}
+
+    void ClearBuffer(u8* dest_buffer, u32 offset, size_t size, u32 value);
+
+    void BindIndexBuffer(PrimitiveTopology topology, IndexFormat index_format, u32 num_indices,
+                         u32 base_vertex, u8* buffer, u32 offset, u32 size) {
+        ++num_bindings;
+    }
+
+    void BindQuadIndexBuffer(PrimitiveTopology topology, u32 first, u32 count) {
+        ++num_bindings;
+    }
+
+    void BindVertexBuffers(VideoCommon::HostBindings<Buffer>& bindings) {
+        num_bindings += bindings.buffers.size();
+    }
+
+    void BindTransformFeedbackBuffers(VideoCommon::HostBindings<Buffer>& bindings) {
+        num_bindings += bindings.buffers.size();
+    }
+
+    std::span<u8> BindMappedUniformBuffer([[maybe_unused]] size_t stage,
+                                          [[maybe_unused]] u32 binding_index, u32 size) {
+        ++num_bindings;
+        return UploadStagingBuffer(size).mapped_span;
+    }
+
+    void BindUniformBuffer(u8* buffer, u32 offset, u32 size) {
+        ++num_bindings;
+    }
+
+    void BindStorageBuffer(u8* buffer, u32 offset, u32 size, [[maybe_unused]] bool is_written) {
+        ++num_bindings;
+    }
+
+    void BindTextureBuffer(Buffer& buffer, u32 offset, u32 size,
+                           VideoCore::Surface::PixelFormat format) {
+        ++num_bindings;
+    }
+
+    TransferCounters counters;
+    u64 num_bindings = 0;
+
+private:
+    StagingBufferPool& staging_pool;
+};
+
+struct BufferCacheParams {
+    using Runtime = Null::BufferCacheRuntime;
+    using Buffer = Null::Buffer;
+    using Async_Buffer = Null::StagingBufferRef;
+    using MemoryTracker = VideoCommon::MemoryTrackerBase<Tegra::MaxwellDeviceMemoryManager>;
+
+    static constexpr bool IS_OPENGL = false;
+    static constexpr bool HAS_PERSISTENT_UNIFORM_BUFFER_BINDINGS = false;
+    static constexpr bool HAS_FULL_INDEX_AND_PRIMITIVE_SUPPORT = false;
+    static constexpr bool NEEDS_BIND_UNIFORM_INDEX = false;
+    static constexpr bool NEEDS_BIND_STORAGE_INDEX = false;
+    static constexpr bool USE_MEMORY_MAPS = true;
+    static constexpr bool SEPARATE_IMAGE_BUFFER_BINDINGS = false;
+    static constexpr bool USE_MEMORY_MAPS_FOR_UPLOADS = true;
+};
+
+using BufferCache = VideoCommon::BufferCache<BufferCacheParams>;
+
+} // namespace Null
@@ -0,0 +1,355 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <vector>
+
+#include "common/cityhash.h"
+#include "common/logging/log.h"
+#include "shader_recompiler/exception.h"
+#include "shader_recompiler/frontend/ir/program.h"
+#include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "video_core/buffer_cache/buffer_cache.h"
+#include "video_core/engines/kepler_compute.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/memory_manager.h"
+#include "video_core/renderer_null/null_pipeline_cache.h"
+#include "video_core/shader_environment.h"
+#include "video_core/texture_cache/texture_cache.h"
+#include "video_core/textures/texture.h"
+
+namespace Null {
+
+namespace {
+
+using Shader::ImageBufferDescriptor;
+using Shader::Maxwell::MergeDualVertexPrograms;
+using Shader::Maxwell::TranslateProgram;
+using Tegra::Texture::TexturePair;
+using VideoCommon::ComputeEnvironment;
+using VideoCommon::GenericEnvironment;
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+/// Reads the texture handle of a descriptor, cbuf_address returns the address of a const buffer
+template <typename Descriptor, typename Func>
+std::pair<u32, u32> ReadHandle(Tegra::MemoryManager& gpu_memory, const Descriptor& desc, u32 index,
+                               bool via_header_index, Func&& cbuf_address) {
+    const u32 index_offset{index << desc.size_shift};
+    const GPUVAddr addr{cbuf_address(desc.cbuf_index) + desc.cbuf_offset + index_offset};
+    if constexpr (std::is_same_v<Descriptor, Shader::TextureDescriptor> ||
+                  std::is_same_v<Descriptor, Shader::TextureBufferDescriptor>) {
+        if (desc.has_secondary) {
+            const GPUVAddr separate_addr{cbuf_address(desc.secondary_cbuf_index) +
+                                         desc.secondary_cbuf_offset + index_offset};
+            const u32 lhs_raw{gpu_memory.Read<u32>(addr) << desc.shift_left};
+            const u32 rhs_raw{gpu_memory.Read<u32>(separate_addr) << desc.secondary_shift_left};
+            return TexturePair(lhs_raw | rhs_raw, via_header_index);
+        }
+    }
+    return TexturePair(gpu_memory.Read<u32>(addr), via_header_index);
+}
+
+/// Collects the image views and samplers used by a stage, in the order the texture cache expects
+template <typename Func, typename GetSampler>
+void CollectDescriptors(Tegra::MemoryManager& gpu_memory, const Shader::Info& info,
+                        bool via_header_index, Func&& cbuf_address, GetSampler&& get_sampler,
+                        std::vector<VideoCommon::ImageViewInOut>& views,
+                        std::vector<VideoCommon::SamplerId>& samplers) {
+    const auto add_image{[&](const auto& desc, bool blacklist) {
+        for (u32 index = 0; index < desc.count; ++index) {
+            const auto handle{ReadHandle(gpu_memory, desc, index, via_header_index, cbuf_address)};
+            views.push_back({
+                .index = handle.first,
+                .blacklist = blacklist,
+                .id = {},
+            });
+        }
+    }};
+    for (const auto& desc : info.texture_buffer_descriptors) {
+        for (u32 index = 0; index < desc.count; ++index) {
+            const auto handle{ReadHandle(gpu_memory, desc, index, via_header_index, cbuf_address)};
+            views.push_back({handle.first});
+        }
+    }
+    for (const auto& desc : info.image_buffer_descriptors) {
+        add_image(desc, false);
+    }
+    for (const auto& desc : info.texture_descriptors) {
+        for (u32 index = 0; index < desc.count; ++index) {
+            const auto handle{ReadHandle(gpu_memory, desc, index, via_header_index, cbuf_address)};
+            views.push_back({handle.first});
+            samplers.push_back(get_sampler(handle.second));
+        }
+    }
+    for (const auto& desc : info.image_descriptors) {
+        add_image(desc, desc.is_written);
+    }
+}
+
+/// Binds the texture buffers of a stage and marks written images as modified
+template <typename BindBuffer>
+const VideoCommon::ImageViewInOut* BindStageViews(TextureCache& texture_cache,
+                                                  const Shader::Info& info,
+                                                  const VideoCommon::ImageViewInOut* views_it,
+                                                  BindBuffer&& bind_buffer) {
+    u32 index{};
+    const auto add_buffer{[&](const auto& desc) {
+        constexpr bool is_image = std::is_same_v<decltype(desc), const ImageBufferDescriptor&>;
+        for (u32 i = 0; i < desc.count; ++i) {
+            bool is_written{false};
+            if constexpr (is_image) {
+                is_written = desc.is_written;
+            }
+            ImageView& image_view{texture_cache.GetImageView((views_it++)->id)};
+            bind_buffer(index++, image_view, is_written, is_image);
+        }
+    }};
+    std::ranges::for_each(info.texture_buffer_descriptors, add_buffer);
+    std::ranges::for_each(info.image_buffer_descriptors, add_buffer);
+    views_it += Shader::NumDescriptors(info.texture_descriptors);
+    for (const auto& desc : info.image_descriptors) {
+        for (u32 i = 0; i < desc.count; ++i) {
+            const ImageView& image_view{texture_cache.GetImageView((views_it++)->id)};
+            if (desc.is_written) {
+                texture_cache.MarkModification(image_view.image_id);
+            }
+        }
+    }
+    return views_it;
+}
+
+} // Anonymous namespace
+
+size_t GraphicsPipelineKey::Hash() const noexcept {
+    return static_cast<size_t>(
+        Common::CityHash64(reinterpret_cast<const char*>(this), sizeof *this));
+}
+
+GraphicsPipeline::GraphicsPipeline(TextureCache& texture_cache_, BufferCache& buffer_cache_,
+                                   const std::array<const Shader::Info*, 5>& infos)
+    : texture_cache{texture_cache_}, buffer_cache{buffer_cache_} {
+    for (size_t stage = 0; stage < infos.size(); ++stage) {
+        if (!infos[stage]) {
+            continue;
+        }
+        stage_infos[stage] = *infos[stage];
+        enabled_stages_mask |= 1u << stage;
+        enabled_uniform_buffer_masks[stage] = stage_infos[stage].constant_buffer_mask;
+        std::ranges::copy(stage_infos[stage].constant_buffer_used_sizes,
+                          uniform_buffer_sizes[stage].begin());
+    }
+}
+
+void GraphicsPipeline::Configure(Tegra::Engines::Maxwell3D& maxwell3d,
+                                 Tegra::MemoryManager& gpu_memory, bool is_indexed) {
+    std::vector<VideoCommon::ImageViewInOut> views;
+    std::vector<VideoCommon::SamplerId> samplers;
+
+    texture_cache.SynchronizeGraphicsDescriptors();
+    buffer_cache.SetUniformBuffersState(enabled_uniform_buffer_masks, &uniform_buffer_sizes);
+
+    const bool via_header_index{maxwell3d.regs.sampler_binding ==
+                                Maxwell::SamplerBinding::ViaHeaderBinding};
+    const auto get_sampler{
+        [this](u32 index) { return texture_cache.GetGraphicsSamplerId(index); }};
+    for (size_t stage = 0; stage < stage_infos.size(); ++stage) {
+        if (((enabled_stages_mask >> stage) & 1) == 0) {
+            continue;
+        }
+        const Shader::Info& info{stage_infos[stage]};
+        buffer_cache.UnbindGraphicsStorageBuffers(stage);
+        size_t ssbo_index{};
+        for (const auto& desc : info.storage_buffers_descriptors) {
+            buffer_cache.BindGraphicsStorageBuffer(stage, ssbo_index, desc.cbuf_index,
+                                                   desc.cbuf_offset, desc.is_written);
+            ++ssbo_index;
+        }
+        const auto& cbufs{maxwell3d.state.shader_stages[stage].const_buffers};
+        const auto cbuf_address{[&cbufs](u32 index) { return cbufs[index].address; }};
+        CollectDescriptors(gpu_memory, info, via_header_index, cbuf_address, get_sampler, views,
+                           samplers);
+    }
+    texture_cache.FillGraphicsImageViews<true>(views);
+
+    const VideoCommon::ImageViewInOut* views_it{views.data()};
+    for (size_t stage = 0; stage < stage_infos.size(); ++stage) {
+        if (((enabled_stages_mask >> stage) & 1) == 0) {
+            continue;
+        }
+        buffer_cache.UnbindGraphicsTextureBuffers(stage);
+        views_it = BindStageViews(
+            texture_cache, stage_infos[stage], views_it,
+            [&](u32 index, const ImageView& image_view, bool is_written, bool is_image) {
+                buffer_cache.BindGraphicsTextureBuffer(stage, index, image_view.GpuAddr(),
+                                                       image_view.BufferSize(), image_view.format,
+                                                       is_written, is_image);
+            });
+    }
+    buffer_cache.UpdateGraphicsBuffers(is_indexed);
+    buffer_cache.BindHostGeometryBuffers(is_indexed);
+    for (size_t stage = 0; stage < stage_infos.size(); ++stage) {
+        if (((enabled_stages_mask >> stage) & 1) != 0) {
+            buffer_cache.BindHostStageBuffers(stage);
+        }
+    }
+    texture_cache.UpdateRenderTargets(false);
+    texture_cache.CheckFeedbackLoop(views);
+    void(texture_cache.GetFramebuffer());
+}
+
+ComputePipeline::ComputePipeline(TextureCache& texture_cache_, BufferCache& buffer_cache_,
+                                 const Shader::Info& info_)
+    : texture_cache{texture_cache_}, buffer_cache{buffer_cache_}, info{info_} {
+    std::copy_n(info.constant_buffer_used_sizes.begin(), uniform_buffer_sizes.size(),
+                uniform_buffer_sizes.begin());
+}
+
+void ComputePipeline::Configure(Tegra::Engines::KeplerCompute& kepler_compute,
+                                Tegra::MemoryManager& gpu_memory) {
+    std::vector<VideoCommon::ImageViewInOut> views;
+    std::vector<VideoCommon::SamplerId> samplers;
+
+    buffer_cache.SetComputeUniformBufferState(info.constant_buffer_mask, &uniform_buffer_sizes);
+    buffer_cache.UnbindComputeStorageBuffers();
+    size_t ssbo_index{};
+    for (const auto& desc : info.storage_buffers_descriptors) {
+        buffer_cache.BindComputeStorageBuffer(ssbo_index, desc.cbuf_index, desc.cbuf_offset,
+                                              desc.is_written);
+        ++ssbo_index;
+    }
+    texture_cache.SynchronizeComputeDescriptors();
+
+    const auto& qmd{kepler_compute.launch_description};
+    const auto& cbufs{qmd.const_buffer_config};
+    const auto cbuf_address{[&cbufs](u32 index) { return cbufs[index].Address(); }};
+    const auto get_sampler{[this](u32 index) { return texture_cache.GetComputeSamplerId(index); }};
+    CollectDescriptors(gpu_memory, info, qmd.linked_tsc != 0, cbuf_address, get_sampler, views,
+                       samplers);
+    texture_cache.FillComputeImageViews(views);
+
+    buffer_cache.UnbindComputeTextureBuffers();
+    BindStageViews(texture_cache, info, views.data(),
+                   [&](u32 index, const ImageView& image_view, bool is_written, bool is_image) {
+                       buffer_cache.BindComputeTextureBuffer(
+                           index, image_view.GpuAddr(), image_view.BufferSize(), image_view.format,
+                           is_written, is_image);
+                   });
+    buffer_cache.UpdateComputeBuffers();
+    buffer_cache.BindHostComputeBuffers();
+}
+
+PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
+                             TextureCache& texture_cache_, BufferCache& buffer_cache_)
+    : VideoCommon::ShaderCache{device_memory_}, texture_cache{texture_cache_},
+      buffer_cache{buffer_cache_}, host_info{
+                                       .support_float64 = true,
+                                       .support_float16 = true,
+                                       .support_int64 = true,
+                                       .needs_demote_reorder = false,
+                                       .support_snorm_render_buffer = true,
+                                       .support_viewport_index_layer = true,
+                                       .min_ssbo_alignment = 16,
+                                       .support_geometry_shader_passthrough = true,
+                                       .support_conditional_barrier = true,
+                                   } {}
+
+PipelineCache::~PipelineCache() = default;
+
+GraphicsPipeline* PipelineCache::CurrentGraphicsPipeline() {
+    if (!RefreshStages(graphics_key.unique_hashes)) {
+        current_pipeline = nullptr;
+        return nullptr;
+    }
+    const auto [pair, is_new]{graphics_cache.try_emplace(graphics_key)};
+    auto& pipeline{pair->second};
+    if (is_new) {
+        pipeline = CreateGraphicsPipeline(graphics_key);
+    }
+    current_pipeline = pipeline.get();
+    return current_pipeline;
+}
+
+ComputePipeline* PipelineCache::CurrentComputePipeline() {
+    const VideoCommon::ShaderInfo* const shader{ComputeShader()};
+    if (!shader) {
+        return nullptr;
+    }
+    const auto [pair, is_new]{compute_cache.try_emplace(shader->unique_hash)};
+    auto& pipeline{pair->second};
+    if (is_new) {
+        pipeline = CreateComputePipeline(shader);
+    }
+    return pipeline.get();
+}
+
+std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
+    const GraphicsPipelineKey& key) try {
+    GraphicsEnvironments environments;
+    GetGraphicsEnvironments(environments, key.unique_hashes);
+
+    const auto start = std::chrono::steady_clock::now();
+    main_pools.ReleaseContents();
+    Shader::ArenaScope arena_scope{main_pools.arena};
+
+    const bool uses_vertex_a{key.unique_hashes[0] != 0};
+    std::array<Shader::IR::Program, Maxwell::MaxShaderProgram> programs;
+    size_t env_index{};
+    for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
+        if (key.unique_hashes[index] == 0) {
+            continue;
+        }
+        Shader::Environment& env{*environments.Span()[env_index]};
+        ++env_index;
+
+        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+        Shader::Maxwell::Flow::CFG cfg(env, main_pools.flow_block, cfg_offset, index == 0);
+        if (!uses_vertex_a || index != 1) {
+            programs[index] =
+                TranslateProgram(main_pools.inst, main_pools.block, env, cfg, host_info);
+        } else {
+            auto program_vb{
+                TranslateProgram(main_pools.inst, main_pools.block, env, cfg, host_info)};
+            programs[index] = MergeDualVertexPrograms(programs[0], program_vb, env);
+        }
+        ++num_translated_programs;
+    }
+    std::array<const Shader::Info*, Maxwell::MaxShaderStage> infos{};
+    for (size_t index = 1; index < Maxwell::MaxShaderProgram; ++index) {
+        if (key.unique_hashes[index] != 0) {
+            infos[index - 1] = &programs[index].info;
+        }
+    }
+    auto pipeline{std::make_unique<GraphicsPipeline>(texture_cache, buffer_cache, infos)};
+    translation_time += std::chrono::steady_clock::now() - start;
+    return pipeline;
+
+} catch (Shader::Exception& exception) {
+    LOG_ERROR(Render, "{}", exception.what());
+    return nullptr;
+}
+
+std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
+    const VideoCommon::ShaderInfo* shader) try {
+    const GPUVAddr program_base{kepler_compute->regs.code_loc.Address()};
+    const auto& qmd{kepler_compute->launch_description};
+    ComputeEnvironment env{*kepler_compute, *gpu_memory, program_base, qmd.program_start};
+    env.SetCachedSize(shader->size_bytes);
+
+    const auto start = std::chrono::steady_clock::now();
+    main_pools.ReleaseContents();
+    Shader::ArenaScope arena_scope{main_pools.arena};
+    Shader::Maxwell::Flow::CFG cfg{env, main_pools.flow_block, env.StartAddress()};
+    const auto program{TranslateProgram(main_pools.inst, main_pools.block, env, cfg, host_info)};
+    ++num_translated_programs;
+
+    auto pipeline{std::make_unique<ComputePipeline>(texture_cache, buffer_cache, program.info)};
+    translation_time += std::chrono::steady_clock::now() - start;
+    return pipeline;
+
+} catch (Shader::Exception& exception) {
+    LOG_ERROR(Render, "{}", exception.what());
+    return nullptr;
+}
+
+} // namespace Null
@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
+#include "common/common_types.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/maxwell/control_flow.h"
+#include "shader_recompiler/host_translate_info.h"
+#include "shader_recompiler/object_pool.h"
+#include "shader_recompiler/shader_info.h"
+#include "video_core/renderer_null/null_buffer_cache.h"
+#include "video_core/renderer_null/null_texture_cache.h"
+#include "video_core/shader_cache.h"
+
+namespace Null {
+
+struct GraphicsPipelineKey {
+    std::array<u64, 6> unique_hashes;
+
+    size_t Hash() const noexcept;
+
+    bool operator==(const GraphicsPipelineKey&) const noexcept = default;
+};
+static_assert(std::has_unique_object_representations_v<GraphicsPipelineKey>);
+
+} // namespace Null
+
+namespace std {
+template <>
+struct hash<Null::GraphicsPipelineKey> {
+    size_t operator()(const Null::GraphicsPipelineKey& k) const noexcept {
+        return k.Hash();
+    }
+};
+} // namespace std
+
+namespace Null {
+
+/// Graphics shaders translated to IR, configures the caches the way a host pipeline would.
+class GraphicsPipeline {
+public:
+    explicit GraphicsPipeline(TextureCache& texture_cache_, BufferCache& buffer_cache_,
+                              const std::array<const Shader::Info*, 5>& infos);
+
+    void Configure(Tegra::Engines::Maxwell3D& maxwell3d, Tegra::MemoryManager& gpu_memory,
+                   bool is_indexed);
+
+private:
+    TextureCache& texture_cache;
+    BufferCache& buffer_cache;
+
+    std::array<Shader::Info, 5> stage_infos;
+    u32 enabled_stages_mask{};
+    std::array<u32, 5> enabled_uniform_buffer_masks{};
+    VideoCommon::UniformBufferSizes uniform_buffer_sizes{};
+};
+
+/// Compute shader translated to IR, configures the caches the way a host pipeline would.
+class ComputePipeline {
+public:
+    explicit ComputePipeline(TextureCache& texture_cache_, BufferCache& buffer_cache_,
+                             const Shader::Info& info_);
+
+    void Configure(Tegra::Engines::KeplerCompute& kepler_compute, Tegra::MemoryManager& gpu_memory);
+
+private:
+    TextureCache& texture_cache;
+    BufferCache& buffer_cache;
+
+    Shader::Info info;
+    VideoCommon::ComputeUniformBufferSizes uniform_buffer_sizes{};
+};
+
+/**
+ * Shader cache translating guest programs to IR without emitting host code. It runs the same
+ * frontend work as the OpenGL and Vulkan backends, so its cost shows up in the frame timings.
+ */
+class PipelineCache : public VideoCommon::ShaderCache {
+public:
+    explicit PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
+                           TextureCache& texture_cache_, BufferCache& buffer_cache_);
+    ~PipelineCache();
+
+    [[nodiscard]] GraphicsPipeline* CurrentGraphicsPipeline();
+
+    [[nodiscard]] ComputePipeline* CurrentComputePipeline();
+
+    /// Number of programs translated and the time spent translating them
+    u64 num_translated_programs = 0;
+    std::chrono::nanoseconds translation_time{};
+
+private:
+    struct ShaderPools {
+        void ReleaseContents() {
+            flow_block.ReleaseContents();
+            block.ReleaseContents();
+            inst.ReleaseContents();
+            arena.Release();
+        }
+
+        Shader::Arena arena;
+        Shader::ObjectPool<Shader::IR::Inst> inst{8192};
+        Shader::ObjectPool<Shader::IR::Block> block{32};
+        Shader::ObjectPool<Shader::Maxwell::Flow::Block> flow_block{32};
+    };
+
+    std::unique_ptr<GraphicsPipeline> CreateGraphicsPipeline(const GraphicsPipelineKey& key);
+
+    std::unique_ptr<ComputePipeline> CreateComputePipeline(const VideoCommon::ShaderInfo* shader);
+
+    TextureCache& texture_cache;
+    BufferCache& buffer_cache;
+
+    GraphicsPipelineKey graphics_key{};
+    GraphicsPipeline* current_pipeline{};
+
+    std::unordered_map<GraphicsPipelineKey, std::unique_ptr<GraphicsPipeline>> graphics_cache;
+    std::unordered_map<u64, std::unique_ptr<ComputePipeline>> compute_cache;
+
+    ShaderPools main_pools;
+    Shader::HostTranslateInfo host_info;
+};
+
+} // namespace Null
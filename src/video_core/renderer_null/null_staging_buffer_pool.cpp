@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+
+#include "common/alignment.h"
+#include "common/literals.h"
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+
+namespace Null {
+
+namespace {
+
+using namespace Common::Literals;
+
+constexpr size_t STREAM_CHUNK_SIZE = 16_MiB;
+constexpr size_t STREAM_ALIGNMENT = 256;
+
+} // Anonymous namespace
+
+StagingBufferRef StagingBufferPool::Request(size_t size, bool deferred) {
+    if (!deferred) {
+        return RequestStream(size);
+    }
+    const u64 index = next_deferred_index++;
+    auto& storage = deferred_buffers[index];
+    storage.resize(size);
+    return StagingBufferRef{
+        .buffer = storage.data(),
+        .offset = 0,
+        .mapped_span = std::span<u8>(storage),
+        .index = index,
+    };
+}
+
+void StagingBufferPool::FreeDeferred(StagingBufferRef& ref) {
+    deferred_buffers.erase(ref.index);
+}
+
+void StagingBufferPool::TickFrame() {
+    current_chunk = 0;
+    chunk_offset = 0;
+}
+
+u64 StagingBufferPool::UsedMemory() const noexcept {
+    u64 total = 0;
+    for (const auto& chunk : stream_chunks) {
+        total += chunk.size();
+    }
+    for (const auto& [index, storage] : deferred_buffers) {
+        total += storage.size();
+    }
+    return total;
+}
+
+StagingBufferRef StagingBufferPool::RequestStream(size_t size) {
+    if (current_chunk < stream_chunks.size() &&
+        chunk_offset + size > stream_chunks[current_chunk].size()) {
+        ++current_chunk;
+        chunk_offset = 0;
+    }
+    if (current_chunk == stream_chunks.size()) {
+        stream_chunks.emplace_back(std::max(size, STREAM_CHUNK_SIZE));
+    } else if (stream_chunks[current_chunk].size() < size) {
+        // Chunks past the current one are not in use this frame, they can be reallocated
+        stream_chunks[current_chunk].resize(size);
+    }
+    auto& chunk = stream_chunks[current_chunk];
+    const size_t offset = chunk_offset;
+    chunk_offset = Common::AlignUp(offset + size, STREAM_ALIGNMENT);
+    return StagingBufferRef{
+        .buffer = chunk.data(),
+        .offset = offset,
+        .mapped_span = std::span<u8>(chunk.data() + offset, size),
+        .index = 0,
+    };
+}
+
+} // namespace Null
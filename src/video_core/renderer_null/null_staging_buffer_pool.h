@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Null {
+
+/// Host memory standing in for a mapped staging buffer.
+/// buffer is the base of the allocation the copies are relative to, like a Vulkan buffer handle.
+struct StagingBufferRef {
+    u8* buffer;
+    size_t offset;
+    std::span<u8> mapped_span;
+    u64 index;
+};
+
+/// Bytes moved by a cache runtime, reset by the rasterizer every frame.
+struct TransferCounters {
+    u64 uploaded_bytes = 0;
+    u64 downloaded_bytes = 0;
+    u64 copied_bytes = 0;
+};
+
+/**
+ * Hands out host memory for uploads and downloads. Regular requests are carved from stream chunks
+ * that are recycled every frame, deferred requests live until they are explicitly freed.
+ */
+class StagingBufferPool {
+public:
+    StagingBufferRef Request(size_t size, bool deferred = false);
+
+    void FreeDeferred(StagingBufferRef& ref);
+
+    void TickFrame();
+
+    /// Returns the host memory currently held by the pool
+    [[nodiscard]] u64 UsedMemory() const noexcept;
+
+private:
+    StagingBufferRef RequestStream(size_t size);
+
+    std::vector<std::vector<u8>> stream_chunks;
+    size_t current_chunk = 0;
+    size_t chunk_offset = 0;
+
+    std::unordered_map<u64, std::vector<u8>> deferred_buffers;
+    u64 next_deferred_index = 1;
+};
+
+} // namespace Null
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "video_core/renderer_null/null_texture_cache.h"
+#include "video_core/texture_cache/util.h"
+
+namespace Null {
+
+namespace {
+
+/// Copies the bytes of each buffer image copy between two buffers with the same layout
+void CopyRegions(u8* dst, const u8* src, size_t size,
+                 std::span<const VideoCommon::BufferImageCopy> copies) {
+    for (const VideoCommon::BufferImageCopy& copy : copies) {
+        if (copy.buffer_offset >= size) {
+            continue;
+        }
+        const size_t copy_size = std::min(copy.buffer_size, size - copy.buffer_offset);
+        std::memcpy(dst + copy.buffer_offset, src + copy.buffer_offset, copy_size);
+    }
+}
+
+} // Anonymous namespace
+
+TextureCacheRuntime::TextureCacheRuntime(StagingBufferPool& staging_pool_)
+    : staging_pool{staging_pool_} {}
+
+StagingBufferRef TextureCacheRuntime::UploadStagingBuffer(size_t size) {
+    counters.uploaded_bytes += size;
+    return staging_pool.Request(size);
+}
+
+StagingBufferRef TextureCacheRuntime::DownloadStagingBuffer(size_t size, bool deferred) {
+    counters.downloaded_bytes += size;
+    return staging_pool.Request(size, deferred);
+}
+
+void TextureCacheRuntime::FreeDeferredStagingBuffer(StagingBufferRef& ref) {
+    staging_pool.FreeDeferred(ref);
+}
+
+Image::Image(TextureCacheRuntime&, const VideoCommon::ImageInfo& info_, GPUVAddr gpu_addr_,
+             VAddr cpu_addr_)
+    : VideoCommon::ImageBase(info_, gpu_addr_, cpu_addr_), storage(unswizzled_size_bytes) {}
+
+Image::Image(const VideoCommon::NullImageParams& params) : VideoCommon::ImageBase{params} {}
+
+Image::~Image() = default;
+
+void Image::UploadMemory(const StagingBufferRef& map,
+                         std::span<const VideoCommon::BufferImageCopy> copies) {
+    const size_t size = std::min(storage.size(), map.mapped_span.size());
+    CopyRegions(storage.data(), map.mapped_span.data(), size, copies);
+}
+
+void Image::DownloadMemory(u8* buffer, size_t offset,
+                           std::span<const VideoCommon::BufferImageCopy> copies) {
+    CopyRegions(buffer + offset, storage.data(), storage.size(), copies);
+}
+
+void Image::DownloadMemory(const StagingBufferRef& map,
+                           std::span<const VideoCommon::BufferImageCopy> copies) {
+    const size_t size = std::min(storage.size(), map.mapped_span.size());
+    CopyRegions(map.mapped_span.data(), storage.data(), size, copies);
+}
+
+ImageView::ImageView(TextureCacheRuntime&, const VideoCommon::ImageViewInfo& info,
+                     ImageId image_id_, Image& image)
+    : VideoCommon::ImageViewBase{info, image.info, image_id_, image.gpu_addr} {}
+
+ImageView::ImageView(TextureCacheRuntime& runtime, const VideoCommon::ImageViewInfo& info,
+                     ImageId image_id_, Image& image, const SlotVector<Image>&)
+    : ImageView{runtime, info, image_id_, image} {}
+
+ImageView::ImageView(TextureCacheRuntime&, const VideoCommon::ImageInfo& info,
+                     const VideoCommon::ImageViewInfo& view_info, GPUVAddr gpu_addr_)
+    : VideoCommon::ImageViewBase{info, view_info, gpu_addr_},
+      buffer_size{VideoCommon::CalculateGuestSizeInBytes(info)} {}
+
+ImageView::ImageView(TextureCacheRuntime&, const VideoCommon::NullImageViewParams& params)
+    : VideoCommon::ImageViewBase{params} {}
+
+} // namespace Null
@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "video_core/texture_cache/texture_cache_base.h"
+
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+#include "video_core/texture_cache/image_view_base.h"
+
+namespace Null {
+
+using Common::SlotVector;
+using VideoCommon::ImageId;
+using VideoCommon::NUM_RT;
+using VideoCommon::Region2D;
+using VideoCommon::RenderTargets;
+using VideoCore::Surface::PixelFormat;
+
+class Image;
+class ImageView;
+class Framebuffer;
+
+/**
+ * Texture cache runtime for the accounting renderer. Uploads and downloads move bytes between
+ * host memory images and staging memory, operations that would run on the GPU are only counted.
+ */
+class TextureCacheRuntime {
+public:
+    explicit TextureCacheRuntime(StagingBufferPool& staging_pool_);
+
+    void Finish() {}
+
+    StagingBufferRef UploadStagingBuffer(size_t size);
+
+    StagingBufferRef DownloadStagingBuffer(size_t size, bool deferred = false);
+
+    void FreeDeferredStagingBuffer(StagingBufferRef& ref);
+
+    void TickFrame() {}
+
+    u64 GetDeviceLocalMemory() const {
+        return 0;
+    }
+
+    u64 GetDeviceMemoryUsage() const {
+        return 0;
+    }
+
+    bool CanReportMemoryUsage() const {
+        return false;
+    }
+
+    void BlitImage(Framebuffer* dst_framebuffer, ImageView& dst, ImageView& src,
+                   const Region2D& dst_region, const Region2D& src_region,
+                   Tegra::Engines::Fermi2D::Filter filter,
+                   Tegra::Engines::Fermi2D::Operation operation) {
+        ++num_gpu_operations;
+    }
+
+    void CopyImage(Image& dst, Image& src, std::span<const VideoCommon::ImageCopy> copies) {
+        ++num_gpu_operations;
+    }
+
+    void CopyImageMSAA(Image& dst, Image& src, std::span<const VideoCommon::ImageCopy> copies) {
+        ++num_gpu_operations;
+    }
+
+    bool ShouldReinterpret(Image& dst, Image& src) {
+        return false;
+    }
+
+    void ReinterpretImage(Image& dst, Image& src, std::span<const VideoCommon::ImageCopy> copies) {
+        ++num_gpu_operations;
+    }
+
+    void ConvertImage(Framebuffer* dst, ImageView& dst_view, ImageView& src_view) {
+        ++num_gpu_operations;
+    }
+
+    bool CanAccelerateImageUpload(Image&) const noexcept {
+        return false;
+    }
+
+    bool CanUploadMSAA() const noexcept {
+        return true;
+    }
+
+    void AccelerateImageUpload(Image&, const StagingBufferRef&,
+                               std::span<const VideoCommon::SwizzleParameters>) {}
+
+    void InsertUploadMemoryBarrier() {}
+
+    void TransitionImageLayout(Image& image) {}
+
+    bool HasBrokenTextureViewFormats() const noexcept {
+        return false;
+    }
+
+    bool HasNativeBgr() const noexcept {
+        return true;
+    }
+
+    void BarrierFeedbackLoop() {}
+
+    TransferCounters counters;
+    u64 num_gpu_operations = 0;
+
+private:
+    StagingBufferPool& staging_pool;
+};
+
+/// Image whose contents are kept in host memory with the unswizzled layout of the guest image.
+class Image : public VideoCommon::ImageBase {
+public:
+    explicit Image(TextureCacheRuntime&, const VideoCommon::ImageInfo& info, GPUVAddr gpu_addr,
+                   VAddr cpu_addr);
+    explicit Image(const VideoCommon::NullImageParams&);
+
+    ~Image();
+
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    Image(Image&&) = default;
+    Image& operator=(Image&&) = default;
+
+    void UploadMemory(const StagingBufferRef& map,
+                      std::span<const VideoCommon::BufferImageCopy> copies);
+
+    void DownloadMemory(u8* buffer, size_t offset,
+                        std::span<const VideoCommon::BufferImageCopy> copies);
+
+    void DownloadMemory(const StagingBufferRef& map,
+                        std::span<const VideoCommon::BufferImageCopy> copies);
+
+    bool IsRescaled() const noexcept {
+        return false;
+    }
+
+    bool ScaleUp(bool ignore = false) {
+        return false;
+    }
+
+    bool ScaleDown(bool ignore = false) {
+        return false;
+    }
+
+private:
+    std::vector<u8> storage;
+};
+
+class ImageView : public VideoCommon::ImageViewBase {
+public:
+    explicit ImageView(TextureCacheRuntime&, const VideoCommon::ImageViewInfo&, ImageId, Image&);
+    explicit ImageView(TextureCacheRuntime&, const VideoCommon::ImageViewInfo&, ImageId, Image&,
+                       const SlotVector<Image>&);
+    explicit ImageView(TextureCacheRuntime&, const VideoCommon::ImageInfo&,
+                       const VideoCommon::ImageViewInfo&, GPUVAddr);
+    explicit ImageView(TextureCacheRuntime&, const VideoCommon::NullImageViewParams&);
+
+    [[nodiscard]] GPUVAddr GpuAddr() const noexcept {
+        return gpu_addr;
+    }
+
+    [[nodiscard]] u32 BufferSize() const noexcept {
+        return buffer_size;
+    }
+
+private:
+    u32 buffer_size = 0;
+};
+
+class ImageAlloc : public VideoCommon::ImageAllocBase {};
+
+class Sampler {
+public:
+    explicit Sampler(TextureCacheRuntime&, const Tegra::Texture::TSCEntry&) {}
+
+    [[nodiscard]] bool HasAddedAnisotropy() const noexcept {
+        return false;
+    }
+};
+
+class Framebuffer {
+public:
+    explicit Framebuffer(TextureCacheRuntime&, std::span<ImageView*, NUM_RT> color_buffers,
+                         ImageView* depth_buffer, const VideoCommon::RenderTargets& key)
+        : render_area{key.size} {}
+
+    [[nodiscard]] VideoCommon::Extent2D RenderArea() const noexcept {
+        return render_area;
+    }
+
+private:
+    VideoCommon::Extent2D render_area{};
+};
+
+struct TextureCacheParams {
+    static constexpr bool ENABLE_VALIDATION = true;
+    static constexpr bool FRAMEBUFFER_BLITS = false;
+    static constexpr bool HAS_EMULATED_COPIES = false;
+    static constexpr bool HAS_DEVICE_MEMORY_INFO = false;
+    static constexpr bool IMPLEMENTS_ASYNC_DOWNLOADS = false;
+
+    using Runtime = Null::TextureCacheRuntime;
+    using Image = Null::Image;
+    using ImageAlloc = Null::ImageAlloc;
+    using ImageView = Null::ImageView;
+    using Sampler = Null::Sampler;
+    using Framebuffer = Null::Framebuffer;
+    using AsyncBuffer = Null::StagingBufferRef;
+    using BufferType = u8*;
+};
+
+using TextureCache = VideoCommon::TextureCache<TextureCacheParams>;
+
+} // namespace Null
@@ -1,16 +1,26 @@
 // SPDX-FileCopyrightText: Copyright 2022 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/settings.h"
 #include "core/frontend/emu_window.h"
 #include "core/frontend/graphics_context.h"
 #include "video_core/capture.h"
+#include "video_core/renderer_null/null_accounting_rasterizer.h"
+#include "video_core/renderer_null/null_rasterizer.h"
 #include "video_core/renderer_null/renderer_null.h"
 
 namespace Null {
 
-RendererNull::RendererNull(Core::Frontend::EmuWindow& emu_window, Tegra::GPU& gpu,
+RendererNull::RendererNull(Core::Frontend::EmuWindow& emu_window,
+                           Tegra::MaxwellDeviceMemoryManager& device_memory, Tegra::GPU& gpu,
                            std::unique_ptr<Core::Frontend::GraphicsContext> context_)
-    : RendererBase(emu_window, std::move(context_)), m_gpu(gpu), m_rasterizer(gpu) {}
+    : RendererBase(emu_window, std::move(context_)), m_gpu(gpu) {
+    if (Settings::values.null_renderer_accounting.GetValue()) {
+        m_rasterizer = std::make_unique<RasterizerAccounting>(gpu, device_memory);
+    } else {
+        m_rasterizer = std::make_unique<RasterizerNull>(gpu);
+    }
+}
 
 RendererNull::~RendererNull() = default;
 
@@ -20,6 +30,7 @@ void RendererNull::Composite(std::span<const Tegra::FramebufferConfig> framebuff
     }
 
     m_gpu.RendererFrameEndNotify();
+    m_rasterizer->TickFrame();
     render_window.OnFrameDisplayed();
 }
 
@@ -14,6 +14,7 @@
 #include "video_core/renderer_vulkan/vk_descriptor_pool.h"
 #include "video_core/renderer_vulkan/vk_texture_cache.h"
 #include "video_core/renderer_vulkan/vk_update_descriptor.h"
+#include "video_core/shader_environment.h"
 #include "video_core/vulkan_common/vulkan_wrapper.h"
 
 namespace VideoCore {
@@ -45,6 +46,10 @@ public:
     void Configure(Tegra::Engines::KeplerCompute& kepler_compute, Tegra::MemoryManager& gpu_memory,
                    Scheduler& scheduler, BufferCache& buffer_cache, TextureCache& texture_cache);
 
+    [[nodiscard]] VideoCommon::PipelineUsageTracker& UsageTracker() noexcept {
+        return usage_tracker;
+    }
+
 private:
     const Device& device;
     vk::PipelineCache& pipeline_cache;
@@ -63,6 +68,8 @@ private:
     std::condition_variable build_condvar;
     std::mutex build_mutex;
     std::atomic_bool is_built{false};
+
+    VideoCommon::PipelineUsageTracker usage_tracker;
 };
 
 } // namespace Vulkan
@@ -17,6 +17,7 @@
 #include "video_core/renderer_vulkan/vk_buffer_cache.h"
 #include "video_core/renderer_vulkan/vk_descriptor_pool.h"
 #include "video_core/renderer_vulkan/vk_texture_cache.h"
+#include "video_core/shader_environment.h"
 #include "video_core/vulkan_common/vulkan_wrapper.h"
 
 namespace VideoCore {
@@ -103,6 +104,10 @@ public:
         return is_built.load(std::memory_order::relaxed);
     }
 
+    [[nodiscard]] VideoCommon::PipelineUsageTracker& UsageTracker() noexcept {
+        return usage_tracker;
+    }
+
     template <typename Spec>
     static auto MakeConfigureSpecFunc() {
         return [](GraphicsPipeline* pl, bool is_indexed) { pl->ConfigureImpl<Spec>(is_indexed); };
@@ -156,6 +161,8 @@ private:
     std::mutex build_mutex;
     std::atomic_bool is_built{false};
     bool uses_push_descriptor{false};
+
+    VideoCommon::PipelineUsageTracker usage_tracker;
 };
 
 } // namespace Vulkan
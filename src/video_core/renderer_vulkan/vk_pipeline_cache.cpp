@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <thread>
@@ -13,6 +14,8 @@
 #include "common/fs/fs.h"
 #include "common/fs/path_util.h"
 #include "common/microprofile.h"
+#include "common/scm_rev.h"
+#include "common/settings.h"
 #include "common/thread_worker.h"
 #include "core/core.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
@@ -48,10 +51,12 @@ using Shader::Maxwell::ConvertLegacyToGeneric;
 using Shader::Maxwell::GenerateGeometryPassthrough;
 using Shader::Maxwell::MergeDualVertexPrograms;
 using Shader::Maxwell::TranslateProgram;
+using VideoCommon::CachedEnvironments;
 using VideoCommon::ComputeEnvironment;
 using VideoCommon::FileEnvironment;
 using VideoCommon::GenericEnvironment;
 using VideoCommon::GraphicsEnvironment;
+using VideoCommon::TranslatedStage;
 
 constexpr u32 CACHE_VERSION = 11;
 constexpr std::array<char, 8> VULKAN_CACHE_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'v', 'k', 'c', 'h'};
@@ -278,6 +283,18 @@ size_t GetTotalPipelineWorkers() {
 #endif
 }
 
+/// Hashes what the emitted SPIR-V depends on besides the guest shaders and the pipeline key
+u64 TranslatedShaderHostHash(const Device& device) {
+    const auto& resolution{Settings::values.resolution_info};
+    const std::string host{fmt::format(
+        "{}:{}:{}:{}:{}:{}:{}:{}:{}:{}", Common::g_scm_rev, device.GetModelName(),
+        static_cast<u32>(device.GetDriverID()), device.GetDriverVersion(), device.ApiVersion(),
+        resolution.active, resolution.up_scale, resolution.down_shift,
+        Settings::values.renderer_debug.GetValue(),
+        Settings::values.disable_shader_loop_safety_checks.GetValue())};
+    return Common::CityHash64(host.data(), host.size());
+}
+
 } // Anonymous namespace
 
 size_t ComputePipelineCacheKey::Hash() const noexcept {
@@ -312,7 +329,9 @@ PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
       use_vulkan_pipeline_cache{Settings::values.use_vulkan_driver_pipeline_cache.GetValue()},
       workers(device.HasBrokenParallelShaderCompiling() ? 1ULL : GetTotalPipelineWorkers(),
               "VkPipelineBuilder"),
-      serialization_thread(1, "VkPipelineSerialization") {
+      serialization_thread(1, "VkPipelineSerialization"),
+      background_workers(std::max<size_t>(GetTotalPipelineWorkers() / 4, 1ULL),
+                         "VkPipelineBackground") {
     const auto& float_control{device.FloatControlProperties()};
     const VkDriverId driver_id{device.GetDriverID()};
     profile = Shader::Profile{
@@ -412,6 +431,9 @@ PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
 }
 
 PipelineCache::~PipelineCache() {
+    if (!pipeline_usage_filename.empty()) {
+        SavePipelineUsage();
+    }
     if (use_vulkan_pipeline_cache && !vulkan_pipeline_cache_filename.empty()) {
         SerializeVulkanPipelineCache(vulkan_pipeline_cache_filename, vulkan_pipeline_cache,
                                      CACHE_VERSION);
@@ -431,6 +453,7 @@ GraphicsPipeline* PipelineCache::CurrentGraphicsPipeline() {
         GraphicsPipeline* const next{current_pipeline->Next(graphics_key)};
         if (next) {
             current_pipeline = next;
+            current_pipeline->UsageTracker().MarkUsed(frame_number);
             return BuiltPipeline(current_pipeline);
         }
     }
@@ -450,12 +473,17 @@ ComputePipeline* PipelineCache::CurrentComputePipeline() {
         .shared_memory_size = qmd.shared_alloc,
         .workgroup_size{qmd.block_dim_x, qmd.block_dim_y, qmd.block_dim_z},
     };
+    if (has_deferred_pipelines.load(std::memory_order::relaxed)) {
+        MergeDeferredPipelines();
+    }
     const auto [pair, is_new]{compute_cache.try_emplace(key)};
     auto& pipeline{pair->second};
-    if (!is_new) {
-        return pipeline.get();
+    if (is_new) {
+        pipeline = CreateComputePipeline(key, shader);
+    }
+    if (pipeline) {
+        pipeline->UsageTracker().MarkUsed(frame_number);
     }
-    pipeline = CreateComputePipeline(key, shader);
     return pipeline.get();
 }
 
@@ -478,6 +506,18 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
             LoadVulkanPipelineCache(vulkan_pipeline_cache_filename, CACHE_VERSION);
     }
 
+    if (Settings::values.use_translated_shader_cache.GetValue()) {
+        translated_shader_cache.Open(base_dir / "vulkan_translated.bin", CACHE_VERSION,
+                                     TranslatedShaderHostHash(device));
+    }
+
+    pipeline_usage_filename = base_dir / "vulkan_usage.bin";
+    pipeline_usage = VideoCommon::LoadPipelineUsage(pipeline_usage_filename, CACHE_VERSION);
+
+    // Without recorded usage every pipeline is treated as hot and built before booting
+    const bool use_warmup{Settings::values.use_pipeline_cache_warmup.GetValue() &&
+                          !pipeline_usage.empty() && !device.HasBrokenParallelShaderCompiling()};
+
     struct {
         std::mutex mutex;
         size_t total{};
@@ -486,30 +526,53 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
         std::unique_ptr<PipelineStatistics> statistics;
     } state;
 
+    // Builds the pipeline, the argument tells whether it is built in the background after boot
+    struct PendingPipeline {
+        VideoCommon::PipelineUsage usage;
+        Common::UniqueFunction<void, bool> build;
+    };
+    std::vector<PendingPipeline> pending;
+
+    const auto find_usage{[this](u64 hash) {
+        const auto it{pipeline_usage.find(hash)};
+        return it != pipeline_usage.end() ? it->second : VideoCommon::PipelineUsage{};
+    }};
+
     if (device.IsKhrPipelineExecutablePropertiesEnabled()) {
         state.statistics = std::make_unique<PipelineStatistics>(device);
     }
-    const auto load_compute{[&](std::ifstream& file, FileEnvironment env) {
+    const auto load_compute{[&](std::span<const char> key_data, CachedEnvironments cached_envs) {
         ComputePipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-
-        workers.QueueWork([this, key, env_ = std::move(env), &state, &callback]() mutable {
-            ShaderPools pools;
-            auto pipeline{CreateComputePipeline(pools, key, env_, state.statistics.get(), false)};
-            std::scoped_lock lock{state.mutex};
-            if (pipeline) {
-                compute_cache.emplace(key, std::move(pipeline));
-            }
-            ++state.built;
-            if (state.has_loaded) {
-                callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
-            }
+        std::memcpy(&key, key_data.data(), sizeof(key));
+
+        pending.push_back({
+            .usage = find_usage(key.Hash()),
+            .build = [this, key, cached_envs_ = std::move(cached_envs), &state,
+                      &callback](bool in_background) mutable {
+                std::unique_ptr<ComputePipeline> pipeline{LoadComputePipeline(
+                    key, cached_envs_, in_background ? nullptr : state.statistics.get())};
+                if (in_background) {
+                    if (pipeline) {
+                        std::scoped_lock lock{deferred_mutex};
+                        deferred_compute.emplace_back(key, std::move(pipeline));
+                        has_deferred_pipelines.store(true, std::memory_order::relaxed);
+                    }
+                    return;
+                }
+                std::scoped_lock lock{state.mutex};
+                if (pipeline) {
+                    compute_cache.emplace(key, std::move(pipeline));
+                }
+                ++state.built;
+                if (state.has_loaded) {
+                    callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
+                }
+            },
         });
-        ++state.total;
     }};
-    const auto load_graphics{[&](std::ifstream& file, std::vector<FileEnvironment> envs) {
+    const auto load_graphics{[&](std::span<const char> key_data, CachedEnvironments cached_envs) {
         GraphicsPipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
+        std::memcpy(&key, key_data.data(), sizeof(key));
 
         if ((key.state.extended_dynamic_state != 0) !=
                 dynamic_features.has_extended_dynamic_state ||
@@ -524,29 +587,49 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
             (key.state.dynamic_vertex_input != 0) != dynamic_features.has_dynamic_vertex_input) {
             return;
         }
-        workers.QueueWork([this, key, envs_ = std::move(envs), &state, &callback]() mutable {
-            ShaderPools pools;
-            boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
-            for (auto& env : envs_) {
-                env_ptrs.push_back(&env);
-            }
-            auto pipeline{CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs),
-                                                 state.statistics.get(), false)};
-
-            std::scoped_lock lock{state.mutex};
-            if (pipeline) {
-                graphics_cache.emplace(key, std::move(pipeline));
-            }
-            ++state.built;
-            if (state.has_loaded) {
-                callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
-            }
+        pending.push_back({
+            .usage = find_usage(key.Hash()),
+            .build = [this, key, cached_envs_ = std::move(cached_envs), &state,
+                      &callback](bool in_background) mutable {
+                std::unique_ptr<GraphicsPipeline> pipeline{LoadGraphicsPipeline(
+                    key, cached_envs_, in_background ? nullptr : state.statistics.get())};
+                if (in_background) {
+                    if (pipeline) {
+                        std::scoped_lock lock{deferred_mutex};
+                        deferred_graphics.emplace_back(key, std::move(pipeline));
+                        has_deferred_pipelines.store(true, std::memory_order::relaxed);
+                    }
+                    return;
+                }
+                std::scoped_lock lock{state.mutex};
+                if (pipeline) {
+                    graphics_cache.emplace(key, std::move(pipeline));
+                }
+                ++state.built;
+                if (state.has_loaded) {
+                    callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
+                }
+            },
         });
-        ++state.total;
     }};
-    VideoCommon::LoadPipelines(stop_loading, pipeline_cache_filename, CACHE_VERSION, load_compute,
-                               load_graphics);
-
+    VideoCommon::LoadPipelines(stop_loading, pipeline_cache_filename, CACHE_VERSION,
+                               sizeof(ComputePipelineCacheKey), sizeof(GraphicsPipelineCacheKey),
+                               load_compute, load_graphics);
+
+    auto deferred_begin{pending.end()};
+    if (use_warmup) {
+        std::ranges::stable_sort(pending, VideoCommon::HasHigherWarmupPriority,
+                                 &PendingPipeline::usage);
+        deferred_begin = std::ranges::find_if_not(pending, VideoCommon::IsWarmupPipeline,
+                                                  &PendingPipeline::usage);
+    }
+    {
+        std::scoped_lock lock{state.mutex};
+        for (auto it = pending.begin(); it != deferred_begin; ++it) {
+            workers.QueueWork([build = std::move(it->build)]() mutable { build(false); });
+            ++state.total;
+        }
+    }
     LOG_INFO(Render_Vulkan, "Total Pipeline Count: {}", state.total);
 
     std::unique_lock lock{state.mutex};
@@ -564,9 +647,122 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     if (state.statistics) {
         state.statistics->Report();
     }
+
+    if (stop_loading.stop_requested() || deferred_begin == pending.end()) {
+        return;
+    }
+    LOG_INFO(Render_Vulkan, "Building {} pipelines in the background",
+             std::distance(deferred_begin, pending.end()));
+    for (auto it = deferred_begin; it != pending.end(); ++it) {
+        background_workers.QueueWork([build = std::move(it->build)]() mutable { build(true); });
+    }
+}
+
+void PipelineCache::MergeDeferredPipelines() {
+    std::vector<std::pair<ComputePipelineCacheKey, std::unique_ptr<ComputePipeline>>> compute;
+    std::vector<std::pair<GraphicsPipelineCacheKey, std::unique_ptr<GraphicsPipeline>>> graphics;
+    {
+        std::scoped_lock lock{deferred_mutex};
+        compute.swap(deferred_compute);
+        graphics.swap(deferred_graphics);
+        has_deferred_pipelines.store(false, std::memory_order::relaxed);
+    }
+    // Pipelines that were already built on demand keep their existing instance
+    for (auto& [key, pipeline] : compute) {
+        compute_cache.try_emplace(key, std::move(pipeline));
+    }
+    for (auto& [key, pipeline] : graphics) {
+        graphics_cache.try_emplace(key, std::move(pipeline));
+    }
+}
+
+void PipelineCache::SavePipelineUsage() {
+    VideoCommon::PipelineUsageMap usage{pipeline_usage};
+    const auto merge{[&usage](u64 hash, const VideoCommon::PipelineUsage& session) {
+        if (session.hit_count == 0) {
+            return;
+        }
+        const auto [it, is_new]{usage.try_emplace(hash, session)};
+        if (!is_new) {
+            it->second = VideoCommon::MergePipelineUsage(it->second, session);
+        }
+    }};
+    for (const auto& [key, pipeline] : compute_cache) {
+        if (pipeline) {
+            merge(key.Hash(), pipeline->UsageTracker().Usage());
+        }
+    }
+    for (const auto& [key, pipeline] : graphics_cache) {
+        if (pipeline) {
+            merge(key.Hash(), pipeline->UsageTracker().Usage());
+        }
+    }
+    VideoCommon::SerializePipelineUsage(pipeline_usage_filename, usage, CACHE_VERSION);
+}
+
+std::unique_ptr<GraphicsPipeline> PipelineCache::LoadGraphicsPipeline(
+    const GraphicsPipelineCacheKey& key, const CachedEnvironments& cached_envs,
+    PipelineStatistics* statistics) {
+    u64 record_hash{};
+    if (translated_shader_cache.IsOpen()) {
+        record_hash = cached_envs.RecordHash(std::span(reinterpret_cast<const char*>(&key),
+                                                       sizeof(key)));
+        if (const auto translated_stages{translated_shader_cache.Find(record_hash)}) {
+            if (auto pipeline{CreateGraphicsPipeline(key, *translated_stages, statistics)}) {
+                return pipeline;
+            }
+        }
+    }
+    std::vector<FileEnvironment> envs{cached_envs.Decode()};
+    if (envs.empty()) {
+        return nullptr;
+    }
+    ShaderPools pools;
+    boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
+    for (auto& env : envs) {
+        env_ptrs.push_back(&env);
+    }
+    std::vector<TranslatedStage> translated_stages;
+    auto pipeline{CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs), statistics, false,
+                                         record_hash != 0 ? &translated_stages : nullptr)};
+    if (pipeline && record_hash != 0) {
+        translated_shader_cache.Store(record_hash, translated_stages);
+    }
+    return pipeline;
+}
+
+std::unique_ptr<ComputePipeline> PipelineCache::LoadComputePipeline(
+    const ComputePipelineCacheKey& key, const CachedEnvironments& cached_envs,
+    PipelineStatistics* statistics) {
+    u64 record_hash{};
+    if (translated_shader_cache.IsOpen()) {
+        record_hash = cached_envs.RecordHash(std::span(reinterpret_cast<const char*>(&key),
+                                                       sizeof(key)));
+        const auto translated_stages{translated_shader_cache.Find(record_hash)};
+        if (translated_stages && translated_stages->size() == 1) {
+            if (auto pipeline{CreateComputePipeline(key, translated_stages->front(), statistics)}) {
+                return pipeline;
+            }
+        }
+    }
+    std::vector<FileEnvironment> envs{cached_envs.Decode()};
+    if (envs.empty()) {
+        return nullptr;
+    }
+    ShaderPools pools;
+    std::vector<TranslatedStage> translated_stages;
+    auto pipeline{CreateComputePipeline(pools, key, envs.front(), statistics, false,
+                                        record_hash != 0 ? &translated_stages : nullptr)};
+    if (pipeline && record_hash != 0) {
+        translated_shader_cache.Store(record_hash, translated_stages);
+    }
+    return pipeline;
 }
 
 GraphicsPipeline* PipelineCache::CurrentGraphicsPipelineSlowPath() {
+    if (has_deferred_pipelines.load(std::memory_order::relaxed)) {
+        MergeDeferredPipelines();
+    }
     const auto [pair, is_new]{graphics_cache.try_emplace(graphics_key)};
     auto& pipeline{pair->second};
     if (is_new) {
@@ -579,6 +775,7 @@ GraphicsPipeline* PipelineCache::CurrentGraphicsPipelineSlowPath() {
         current_pipeline->AddTransition(pipeline.get());
     }
     current_pipeline = pipeline.get();
+    current_pipeline->UsageTracker().MarkUsed(frame_number);
     return BuiltPipeline(current_pipeline);
 }
 
@@ -607,14 +804,55 @@ GraphicsPipeline* PipelineCache::BuiltPipeline(GraphicsPipeline* pipeline) const
 std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     ShaderPools& pools, const GraphicsPipelineCacheKey& key,
     std::span<Shader::Environment* const> envs, PipelineStatistics* statistics,
-    bool build_in_parallel) try {
+    bool build_in_parallel, std::vector<TranslatedStage>* translated_stages) try {
     auto hash = key.Hash();
     LOG_INFO(Render_Vulkan, "0x{:016x}", hash);
-    size_t env_index{0};
+    Shader::ArenaScope arena_scope{pools.arena};
     std::array<Shader::IR::Program, Maxwell::MaxShaderProgram> programs;
     const bool uses_vertex_a{key.unique_hashes[0] != 0};
     const bool uses_vertex_b{key.unique_hashes[1] != 0};
 
+    std::array<Shader::Environment*, Maxwell::MaxShaderProgram> stage_envs{};
+    boost::container::static_vector<size_t, Maxwell::MaxShaderProgram> stages;
+    for (size_t index = 0, env_index = 0; index < Maxwell::MaxShaderProgram; ++index) {
+        if (key.unique_hashes[index] != 0) {
+            stage_envs[index] = envs[env_index++];
+            stages.push_back(index);
+        }
+    }
+
+    // Stages are translated independently, each parallel task uses its own object pools
+    const bool translate_in_parallel{build_in_parallel && stages.size() > 1};
+    const auto translate_stage{[&](size_t stage) {
+        const size_t index{stages[stage]};
+        ShaderPools& stage_pools{translate_in_parallel ? parallel_pools[index] : pools};
+        Shader::ArenaScope stage_arena_scope{stage_pools.arena};
+        Shader::Environment& env{*stage_envs[index]};
+
+        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+        Shader::Maxwell::Flow::CFG cfg(env, stage_pools.flow_block, cfg_offset, index == 0);
+        programs[index] =
+            TranslateProgram(stage_pools.inst, stage_pools.block, env, cfg, host_info);
+
+        if (Settings::values.dump_shaders) {
+            env.Dump(hash, key.unique_hashes[index]);
+        }
+    }};
+    if (translate_in_parallel) {
+        for (size_t index : stages) {
+            parallel_pools[index].ReleaseContents();
+        }
+        Common::ParallelFor(workers, stages.size(), translate_stage);
+    } else {
+        for (size_t stage = 0; stage < stages.size(); ++stage) {
+            translate_stage(stage);
+        }
+    }
+    if (uses_vertex_a && uses_vertex_b) {
+        // VertexB path when VertexA is present.
+        programs[1] = MergeDualVertexPrograms(programs[0], programs[1], *stage_envs[1]);
+    }
+
     // Layer passthrough generation for devices without VK_EXT_shader_viewport_index_layer
     Shader::IR::Program* layer_source_program{};
 
@@ -630,25 +868,6 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
         if (key.unique_hashes[index] == 0) {
             continue;
         }
-        Shader::Environment& env{*envs[env_index]};
-        ++env_index;
-
-        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
-        Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, index == 0);
-        if (!uses_vertex_a || index != 1) {
-            // Normal path
-            programs[index] = TranslateProgram(pools.inst, pools.block, env, cfg, host_info);
-        } else {
-            // VertexB path when VertexA is present.
-            auto& program_va{programs[0]};
-            auto program_vb{TranslateProgram(pools.inst, pools.block, env, cfg, host_info)};
-            programs[index] = MergeDualVertexPrograms(program_va, program_vb, env);
-        }
-
-        if (Settings::values.dump_shaders) {
-            env.Dump(hash, key.unique_hashes[index]);
-        }
-
         if (programs[index].info.requires_layer_emulation) {
             layer_source_program = &programs[index];
         }
@@ -680,8 +899,17 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
             const std::string name{fmt::format("Shader {:016x}", key.unique_hashes[index])};
             modules[stage_index].SetObjectNameEXT(name.c_str());
         }
+        if (translated_stages) {
+            translated_stages->push_back({.index = static_cast<u32>(stage_index), .code = code});
+        }
         previous_stage = &program;
     }
+    if (translated_stages) {
+        // Emitting later stages can still update the info of the previous ones
+        for (TranslatedStage& stage : *translated_stages) {
+            stage.info = *infos[stage.index];
+        }
+    }
     Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
     return std::make_unique<GraphicsPipeline>(
         scheduler, buffer_cache, texture_cache, vulkan_pipeline_cache, &shader_notify, device,
@@ -706,17 +934,51 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     return nullptr;
 }
 
+std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
+    const GraphicsPipelineCacheKey& key, std::span<const TranslatedStage> translated_stages,
+    PipelineStatistics* statistics) {
+    LOG_INFO(Render_Vulkan, "0x{:016x} (translated)", key.Hash());
+    std::array<const Shader::Info*, Maxwell::MaxShaderStage> infos{};
+    std::array<vk::ShaderModule, Maxwell::MaxShaderStage> modules;
+    for (const TranslatedStage& stage : translated_stages) {
+        if (stage.index >= Maxwell::MaxShaderStage || stage.code.empty() || infos[stage.index]) {
+            return nullptr;
+        }
+        infos[stage.index] = &stage.info;
+        device.SaveShader(stage.code);
+        modules[stage.index] = BuildShader(device, stage.code);
+        if (device.HasDebuggingToolAttached()) {
+            const u64 unique_hash{key.unique_hashes[stage.index + 1]};
+            const std::string name{fmt::format("Shader {:016x}", unique_hash)};
+            modules[stage.index].SetObjectNameEXT(name.c_str());
+        }
+    }
+    return std::make_unique<GraphicsPipeline>(
+        scheduler, buffer_cache, texture_cache, vulkan_pipeline_cache, &shader_notify, device,
+        descriptor_pool, guest_descriptor_queue, nullptr, statistics, render_pass_cache, key,
+        std::move(modules), infos);
+}
+
 std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline() {
     GraphicsEnvironments environments;
     GetGraphicsEnvironments(environments, graphics_key.unique_hashes);
+    // Stages are translated on the workers, which must not flush guest memory
+    for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
+        if (graphics_key.unique_hashes[index] != 0) {
+            environments.envs[index].FlushTextureDescriptors();
+        }
+    }
 
     main_pools.ReleaseContents();
-    auto pipeline{
-        CreateGraphicsPipeline(main_pools, graphics_key, environments.Span(), nullptr, true)};
+    std::vector<TranslatedStage> translated_stages;
+    auto pipeline{CreateGraphicsPipeline(
+        main_pools, graphics_key, environments.Span(), nullptr, true,
+        translated_shader_cache.IsOpen() ? &translated_stages : nullptr)};
     if (!pipeline || pipeline_cache_filename.empty()) {
         return pipeline;
     }
-    serialization_thread.QueueWork([this, key = graphics_key, envs = std::move(environments.envs)] {
+    serialization_thread.QueueWork([this, key = graphics_key, envs = std::move(environments.envs),
+                                    stages = std::move(translated_stages)] {
         boost::container::static_vector<const GenericEnvironment*, Maxwell::MaxShaderProgram>
             env_ptrs;
         for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
@@ -724,7 +986,11 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline() {
                 env_ptrs.push_back(&envs[index]);
             }
         }
-        SerializePipeline(key, env_ptrs, pipeline_cache_filename, CACHE_VERSION);
+        const u64 record_hash{
+            SerializePipeline(key, env_ptrs, pipeline_cache_filename, CACHE_VERSION)};
+        if (record_hash != 0 && !stages.empty()) {
+            translated_shader_cache.Store(record_hash, stages);
+        }
     });
     return pipeline;
 }
@@ -737,20 +1003,29 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
     env.SetCachedSize(shader->size_bytes);
 
     main_pools.ReleaseContents();
-    auto pipeline{CreateComputePipeline(main_pools, key, env, nullptr, true)};
+    std::vector<TranslatedStage> translated_stages;
+    auto pipeline{CreateComputePipeline(
+        main_pools, key, env, nullptr, true,
+        translated_shader_cache.IsOpen() ? &translated_stages : nullptr)};
     if (!pipeline || pipeline_cache_filename.empty()) {
         return pipeline;
     }
-    serialization_thread.QueueWork([this, key, env_ = std::move(env)] {
-        SerializePipeline(key, std::array<const GenericEnvironment*, 1>{&env_},
-                          pipeline_cache_filename, CACHE_VERSION);
-    });
+    serialization_thread.QueueWork(
+        [this, key, env_ = std::move(env), stages = std::move(translated_stages)] {
+            const std::array<const GenericEnvironment*, 1> env_ptrs{&env_};
+            const u64 record_hash{
+                SerializePipeline(key, env_ptrs, pipeline_cache_filename, CACHE_VERSION)};
+            if (record_hash != 0 && !stages.empty()) {
+                translated_shader_cache.Store(record_hash, stages);
+            }
+        });
     return pipeline;
 }
 
 std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
     ShaderPools& pools, const ComputePipelineCacheKey& key, Shader::Environment& env,
-    PipelineStatistics* statistics, bool build_in_parallel) try {
+    PipelineStatistics* statistics, bool build_in_parallel,
+    std::vector<TranslatedStage>* translated_stages) try {
     auto hash = key.Hash();
     if (device.HasBrokenCompute()) {
         LOG_ERROR(Render_Vulkan, "Skipping 0x{:016x}", hash);
@@ -758,6 +1033,7 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
     }
 
     LOG_INFO(Render_Vulkan, "0x{:016x}", hash);
+    Shader::ArenaScope arena_scope{pools.arena};
 
     Shader::Maxwell::Flow::CFG cfg{env, pools.flow_block, env.StartAddress()};
 
@@ -774,6 +1050,9 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
         const auto name{fmt::format("Shader {:016x}", key.unique_hash)};
         spv_module.SetObjectNameEXT(name.c_str());
     }
+    if (translated_stages) {
+        translated_stages->push_back({.index = 0, .info = program.info, .code = code});
+    }
     Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
     return std::make_unique<ComputePipeline>(device, vulkan_pipeline_cache, descriptor_pool,
                                              guest_descriptor_queue, thread_worker, statistics,
@@ -784,6 +1063,25 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
     return nullptr;
 }
 
+std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
+    const ComputePipelineCacheKey& key, const TranslatedStage& translated_stage,
+    PipelineStatistics* statistics) {
+    if (device.HasBrokenCompute() || translated_stage.code.empty()) {
+        return nullptr;
+    }
+    LOG_INFO(Render_Vulkan, "0x{:016x} (translated)", key.Hash());
+    device.SaveShader(translated_stage.code);
+    vk::ShaderModule spv_module{BuildShader(device, translated_stage.code)};
+    if (device.HasDebuggingToolAttached()) {
+        const auto name{fmt::format("Shader {:016x}", key.unique_hash)};
+        spv_module.SetObjectNameEXT(name.c_str());
+    }
+    return std::make_unique<ComputePipeline>(device, vulkan_pipeline_cache, descriptor_pool,
+                                             guest_descriptor_queue, nullptr, statistics,
+                                             &shader_notify, translated_stage.info,
+                                             std::move(spv_module));
+}
+
 void PipelineCache::SerializeVulkanPipelineCache(const std::filesystem::path& filename,
                                                  const vk::PipelineCache& pipeline_cache,
                                                  u32 cache_version) try {
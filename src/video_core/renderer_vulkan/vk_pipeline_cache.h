@@ -4,11 +4,14 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/common_types.h"
@@ -27,6 +30,8 @@
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_texture_cache.h"
 #include "video_core/shader_cache.h"
+#include "video_core/shader_environment.h"
+#include "video_core/translated_shader_cache.h"
 
 namespace Core {
 class System;
@@ -90,8 +95,11 @@ struct ShaderPools {
         flow_block.ReleaseContents();
         block.ReleaseContents();
         inst.ReleaseContents();
+        arena.Release();
     }
 
+    // Declared first, containers of the pooled objects may point into it
+    Shader::Arena arena;
     Shader::ObjectPool<Shader::IR::Inst> inst{8192};
     Shader::ObjectPool<Shader::IR::Block> block{32};
     Shader::ObjectPool<Shader::Maxwell::Flow::Block> flow_block{32};
@@ -113,7 +121,16 @@ public:
     void LoadDiskResources(u64 title_id, std::stop_token stop_loading,
                            const VideoCore::DiskResourceLoadCallback& callback);
 
+    void TickFrame() noexcept {
+        ++frame_number;
+    }
+
 private:
+    /// Moves pipelines built in the background into the caches, called from the GPU thread
+    void MergeDeferredPipelines();
+
+    void SavePipelineUsage();
+
     [[nodiscard]] GraphicsPipeline* CurrentGraphicsPipelineSlowPath();
 
     [[nodiscard]] GraphicsPipeline* BuiltPipeline(GraphicsPipeline* pipeline) const noexcept;
@@ -123,16 +140,35 @@ private:
     std::unique_ptr<GraphicsPipeline> CreateGraphicsPipeline(
         ShaderPools& pools, const GraphicsPipelineCacheKey& key,
         std::span<Shader::Environment* const> envs, PipelineStatistics* statistics,
-        bool build_in_parallel);
+        bool build_in_parallel, std::vector<VideoCommon::TranslatedStage>* translated_stages);
+
+    /// Builds a pipeline from shaders translated in a previous session
+    std::unique_ptr<GraphicsPipeline> CreateGraphicsPipeline(
+        const GraphicsPipelineCacheKey& key,
+        std::span<const VideoCommon::TranslatedStage> translated_stages,
+        PipelineStatistics* statistics);
 
     std::unique_ptr<ComputePipeline> CreateComputePipeline(const ComputePipelineCacheKey& key,
                                                            const ShaderInfo* shader);
 
-    std::unique_ptr<ComputePipeline> CreateComputePipeline(ShaderPools& pools,
-                                                           const ComputePipelineCacheKey& key,
-                                                           Shader::Environment& env,
-                                                           PipelineStatistics* statistics,
-                                                           bool build_in_parallel);
+    std::unique_ptr<ComputePipeline> CreateComputePipeline(
+        ShaderPools& pools, const ComputePipelineCacheKey& key, Shader::Environment& env,
+        PipelineStatistics* statistics, bool build_in_parallel,
+        std::vector<VideoCommon::TranslatedStage>* translated_stages);
+
+    /// Builds a pipeline from a shader translated in a previous session
+    std::unique_ptr<ComputePipeline> CreateComputePipeline(
+        const ComputePipelineCacheKey& key, const VideoCommon::TranslatedStage& translated_stage,
+        PipelineStatistics* statistics);
+
+    /// Builds a pipeline stored in the pipeline cache, reusing its translated shaders if possible
+    std::unique_ptr<GraphicsPipeline> LoadGraphicsPipeline(
+        const GraphicsPipelineCacheKey& key, const VideoCommon::CachedEnvironments& cached_envs,
+        PipelineStatistics* statistics);
+
+    std::unique_ptr<ComputePipeline> LoadComputePipeline(
+        const ComputePipelineCacheKey& key, const VideoCommon::CachedEnvironments& cached_envs,
+        PipelineStatistics* statistics);
 
     void SerializeVulkanPipelineCache(const std::filesystem::path& filename,
                                       const vk::PipelineCache& pipeline_cache, u32 cache_version);
@@ -158,6 +194,7 @@ private:
     std::unordered_map<GraphicsPipelineCacheKey, std::unique_ptr<GraphicsPipeline>> graphics_cache;
 
     ShaderPools main_pools;
+    std::array<ShaderPools, Maxwell::MaxShaderProgram> parallel_pools;
 
     Shader::Profile profile;
     Shader::HostTranslateInfo host_info;
@@ -167,9 +204,25 @@ private:
     std::filesystem::path vulkan_pipeline_cache_filename;
     vk::PipelineCache vulkan_pipeline_cache;
 
+    VideoCommon::TranslatedShaderCache translated_shader_cache;
+
+    std::filesystem::path pipeline_usage_filename;
+    VideoCommon::PipelineUsageMap pipeline_usage;
+    u32 frame_number{};
+
+    std::mutex deferred_mutex;
+    std::vector<std::pair<ComputePipelineCacheKey, std::unique_ptr<ComputePipeline>>>
+        deferred_compute;
+    std::vector<std::pair<GraphicsPipelineCacheKey, std::unique_ptr<GraphicsPipeline>>>
+        deferred_graphics;
+    std::atomic_bool has_deferred_pipelines{};
+
     Common::ThreadWorker workers;
     Common::ThreadWorker serialization_thread;
     DynamicFeatures dynamic_features;
+
+    /// Builds cached pipelines that were not needed to start the game, destroyed first
+    Common::ThreadWorker background_workers;
 };
 
 } // namespace Vulkan
@@ -20,23 +20,24 @@
 namespace VideoCommon {
 
 void ShaderCache::InvalidateRegion(VAddr addr, size_t size) {
-    std::scoped_lock lock{invalidation_mutex};
     InvalidatePagesInRegion(addr, size);
+
+    std::scoped_lock lock{removal_mutex};
     RemovePendingShaders();
 }
 
 void ShaderCache::OnCacheInvalidation(VAddr addr, size_t size) {
-    std::scoped_lock lock{invalidation_mutex};
     InvalidatePagesInRegion(addr, size);
 }
 
 void ShaderCache::SyncGuestHost() {
-    std::scoped_lock lock{invalidation_mutex};
+    std::scoped_lock lock{removal_mutex};
     RemovePendingShaders();
 }
 
 ShaderCache::ShaderCache(Tegra::MaxwellDeviceMemoryManager& device_memory_)
-    : device_memory{device_memory_} {}
+    : device_memory{device_memory_},
+      page_bitmap{std::make_unique<std::atomic<u64>[]>(NUM_PAGES / 64)} {}
 
 bool ShaderCache::RefreshStages(std::array<u64, 6>& unique_hashes) {
     auto& dirty{maxwell3d->dirty.flags};
@@ -122,42 +123,74 @@ ShaderInfo* ShaderCache::TryGet(VAddr addr) const {
 }
 
 void ShaderCache::Register(std::unique_ptr<ShaderInfo> data, VAddr addr, size_t size) {
-    std::scoped_lock lock{invalidation_mutex, lookup_mutex};
+    // Locks are always taken in this order: lookup_mutex, then one region mutex at a time.
+    // Invalidations release their region lock before touching removal_mutex and lookup_mutex.
+    device_memory.UpdatePagesCachedCount(addr, size, 1);
+
+    std::scoped_lock lock{lookup_mutex};
 
     const VAddr addr_end = addr + size;
     Entry* const entry = NewEntry(addr, addr_end, data.get());
 
     const u64 page_end = (addr_end + SUYU_PAGESIZE - 1) >> SUYU_PAGEBITS;
-    for (u64 page = addr >> SUYU_PAGEBITS; page < page_end; ++page) {
-        invalidation_cache[page].push_back(entry);
+    u64 page = addr >> SUYU_PAGEBITS;
+    while (page < page_end) {
+        Region& region = GetOrCreateRegion(page);
+        const u64 region_end = std::min(((page >> REGION_BITS) + 1) << REGION_BITS, page_end);
+
+        std::scoped_lock region_lock{region.mutex};
+        for (; page < region_end; ++page) {
+            region.pages[page % PAGES_PER_REGION].push_back(entry);
+            UpdatePageBit(region, page);
+        }
     }
 
     storage.push_back(std::move(data));
-
-    device_memory.UpdatePagesCachedCount(addr, size, 1);
 }
 
 void ShaderCache::InvalidatePagesInRegion(VAddr addr, size_t size) {
     const VAddr addr_end = addr + size;
-    const u64 page_end = (addr_end + SUYU_PAGESIZE - 1) >> SUYU_PAGEBITS;
-    for (u64 page = addr >> SUYU_PAGEBITS; page < page_end; ++page) {
-        auto it = invalidation_cache.find(page);
-        if (it == invalidation_cache.end()) {
+    const u64 page_end = std::min((addr_end + SUYU_PAGESIZE - 1) >> SUYU_PAGEBITS, NUM_PAGES);
+
+    boost::container::small_vector<Entry*, 16> claimed;
+    u64 page = addr >> SUYU_PAGEBITS;
+    while (page < page_end) {
+        const u64 region_index = page >> REGION_BITS;
+        const u64 region_end = std::min((region_index + 1) << REGION_BITS, page_end);
+
+        // Fast path, most writes land on pages without shaders
+        while (page < region_end && !IsPageMarked(page)) {
+            ++page;
+        }
+        if (page == region_end) {
             continue;
         }
-        InvalidatePageEntries(it->second, addr, addr_end);
+        Region* const region = regions[region_index].load(std::memory_order_acquire);
+        if (!region) {
+            page = region_end;
+            continue;
+        }
+        std::scoped_lock lock{region->mutex};
+        for (; page < region_end; ++page) {
+            if (IsPageMarked(page)) {
+                InvalidatePageEntries(*region, page, addr, addr_end, claimed);
+            }
+        }
+    }
+    if (claimed.empty()) {
+        return;
+    }
+    for (const Entry* const entry : claimed) {
+        RemoveEntryFromInvalidationCache(entry);
     }
+    std::scoped_lock lock{removal_mutex};
+    marked_for_removal.insert(marked_for_removal.end(), claimed.begin(), claimed.end());
 }
 
 void ShaderCache::RemovePendingShaders() {
     if (marked_for_removal.empty()) {
         return;
     }
-    // Remove duplicates
-    std::ranges::sort(marked_for_removal);
-    marked_for_removal.erase(std::unique(marked_for_removal.begin(), marked_for_removal.end()),
-                             marked_for_removal.end());
-
     boost::container::small_vector<ShaderInfo*, 16> removed_shaders;
 
     std::scoped_lock lock{lookup_mutex};
@@ -175,7 +208,10 @@ void ShaderCache::RemovePendingShaders() {
     }
 }
 
-void ShaderCache::InvalidatePageEntries(std::vector<Entry*>& entries, VAddr addr, VAddr addr_end) {
+template <typename Container>
+void ShaderCache::InvalidatePageEntries(Region& region, u64 page, VAddr addr, VAddr addr_end,
+                                        Container& claimed) {
+    std::vector<Entry*>& entries = region.pages[page % PAGES_PER_REGION];
     size_t index = 0;
     while (index < entries.size()) {
         Entry* const entry = entries[index];
@@ -183,35 +219,46 @@ void ShaderCache::InvalidatePageEntries(std::vector<Entry*>& entries, VAddr addr
             ++index;
             continue;
         }
-
-        UnmarkMemory(entry);
-        RemoveEntryFromInvalidationCache(entry);
-        marked_for_removal.push_back(entry);
+        // Entries spanning several regions can be found by concurrent invalidations, only the
+        // one that unmarks the entry removes it from the rest of its pages
+        if (UnmarkMemory(entry)) {
+            claimed.push_back(entry);
+        }
+        entries.erase(entries.begin() + index);
     }
+    UpdatePageBit(region, page);
 }
 
 void ShaderCache::RemoveEntryFromInvalidationCache(const Entry* entry) {
     const u64 page_end = (entry->addr_end + SUYU_PAGESIZE - 1) >> SUYU_PAGEBITS;
-    for (u64 page = entry->addr_start >> SUYU_PAGEBITS; page < page_end; ++page) {
-        const auto entries_it = invalidation_cache.find(page);
-        ASSERT(entries_it != invalidation_cache.end());
-        std::vector<Entry*>& entries = entries_it->second;
-
-        const auto entry_it = std::ranges::find(entries, entry);
-        ASSERT(entry_it != entries.end());
-        entries.erase(entry_it);
+    u64 page = entry->addr_start >> SUYU_PAGEBITS;
+    while (page < page_end) {
+        Region* const region = regions[page >> REGION_BITS].load(std::memory_order_acquire);
+        ASSERT(region != nullptr);
+        const u64 region_end = std::min(((page >> REGION_BITS) + 1) << REGION_BITS, page_end);
+
+        std::scoped_lock lock{region->mutex};
+        for (; page < region_end; ++page) {
+            std::vector<Entry*>& entries = region->pages[page % PAGES_PER_REGION];
+            const auto entry_it = std::ranges::find(entries, entry);
+            if (entry_it == entries.end()) {
+                // Already removed by the invalidation that claimed the entry
+                continue;
+            }
+            entries.erase(entry_it);
+            UpdatePageBit(*region, page);
+        }
     }
 }
 
-void ShaderCache::UnmarkMemory(Entry* entry) {
-    if (!entry->is_memory_marked) {
-        return;
+bool ShaderCache::UnmarkMemory(Entry* entry) {
+    if (!entry->is_memory_marked.exchange(false, std::memory_order_relaxed)) {
+        return false;
     }
-    entry->is_memory_marked = false;
-
     const VAddr addr = entry->addr_start;
     const size_t size = entry->addr_end - addr;
     device_memory.UpdatePagesCachedCount(addr, size, -1);
+    return true;
 }
 
 void ShaderCache::RemoveShadersFromStorage(std::span<ShaderInfo*> removed_shaders) {
@@ -221,8 +268,32 @@ void ShaderCache::RemoveShadersFromStorage(std::span<ShaderInfo*> removed_shader
     });
 }
 
+ShaderCache::Region& ShaderCache::GetOrCreateRegion(u64 page) {
+    std::atomic<Region*>& slot = regions[page >> REGION_BITS];
+    if (Region* const region = slot.load(std::memory_order_acquire)) {
+        return *region;
+    }
+    std::scoped_lock lock{region_allocation_mutex};
+    if (Region* const region = slot.load(std::memory_order_relaxed)) {
+        return *region;
+    }
+    Region* const region = region_storage.emplace_back(std::make_unique<Region>()).get();
+    slot.store(region, std::memory_order_release);
+    return *region;
+}
+
+void ShaderCache::UpdatePageBit(const Region& region, u64 page) noexcept {
+    const u64 mask = u64(1) << (page % 64);
+    std::atomic<u64>& word = page_bitmap[page / 64];
+    if (region.pages[page % PAGES_PER_REGION].empty()) {
+        word.fetch_and(~mask, std::memory_order_relaxed);
+    } else {
+        word.fetch_or(mask, std::memory_order_relaxed);
+    }
+}
+
 ShaderCache::Entry* ShaderCache::NewEntry(VAddr addr, VAddr addr_end, ShaderInfo* data) {
-    auto entry = std::make_unique<Entry>(Entry{addr, addr_end, data});
+    std::unique_ptr<Entry> entry{new Entry{addr, addr_end, data}};
     Entry* const entry_pointer = entry.get();
 
     lookup_cache.emplace(addr, std::move(entry));
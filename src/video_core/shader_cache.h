@@ -4,6 +4,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <span>
@@ -39,6 +40,12 @@ class ShaderCache : public VideoCommon::ChannelSetupCaches<VideoCommon::ChannelI
     static constexpr u64 SUYU_PAGEBITS = 14;
     static constexpr u64 SUYU_PAGESIZE = u64(1) << SUYU_PAGEBITS;
 
+    static constexpr u64 NUM_PAGES =
+        u64(1) << (Tegra::MaxwellDeviceMemoryManager::AS_BITS - SUYU_PAGEBITS);
+    static constexpr u64 REGION_BITS = 8;
+    static constexpr u64 PAGES_PER_REGION = u64(1) << REGION_BITS;
+    static constexpr u64 NUM_REGIONS = NUM_PAGES / PAGES_PER_REGION;
+
     static constexpr size_t NUM_PROGRAMS = 6;
 
     struct Entry {
@@ -46,13 +53,20 @@ class ShaderCache : public VideoCommon::ChannelSetupCaches<VideoCommon::ChannelI
         VAddr addr_end;
         ShaderInfo* data;
 
-        bool is_memory_marked = true;
+        /// Cleared by the thread that claims the entry for removal
+        std::atomic_bool is_memory_marked = true;
 
         bool Overlaps(VAddr start, VAddr end) const noexcept {
             return start < addr_end && addr_start < end;
         }
     };
 
+    /// Second level of the invalidation page table, it owns the entry lists of its pages
+    struct Region {
+        std::mutex mutex;
+        std::array<std::vector<Entry*>, PAGES_PER_REGION> pages;
+    };
+
 public:
     /// @brief Removes shaders inside a given region
     /// @note Checks for ranges
@@ -110,35 +124,51 @@ private:
     void Register(std::unique_ptr<ShaderInfo> data, VAddr addr, size_t size);
 
     /// @brief Invalidate pages in a given region
-    /// @pre invalidation_mutex is locked
+    /// @note Pages without shaders are skipped without taking any lock
     void InvalidatePagesInRegion(VAddr addr, size_t size);
 
     /// @brief Remove shaders marked for deletion
-    /// @pre invalidation_mutex is locked
+    /// @pre removal_mutex is locked
     void RemovePendingShaders();
 
     /// @brief Invalidates entries in a given range for the passed page
-    /// @param entries         Vector of entries in the page, it will be modified on overlaps
+    /// @param region          Region owning the page
+    /// @param page            Page to invalidate
     /// @param addr            Start address of the invalidation
     /// @param addr_end        Non-inclusive end address of the invalidation
-    /// @pre invalidation_mutex is locked
-    void InvalidatePageEntries(std::vector<Entry*>& entries, VAddr addr, VAddr addr_end);
+    /// @param claimed         Entries claimed for removal by this call are appended here
+    /// @pre region.mutex is locked
+    template <typename Container>
+    void InvalidatePageEntries(Region& region, u64 page, VAddr addr, VAddr addr_end,
+                               Container& claimed);
 
     /// @brief Removes all references to an entry in the invalidation cache
     /// @param entry Entry to remove from the invalidation cache
-    /// @pre invalidation_mutex is locked
+    /// @pre No region mutex is locked by the caller
     void RemoveEntryFromInvalidationCache(const Entry* entry);
 
     /// @brief Unmarks an entry from the rasterizer cache
     /// @param entry Entry to unmark from memory
-    void UnmarkMemory(Entry* entry);
+    /// @return True when this call claimed the entry for removal
+    bool UnmarkMemory(Entry* entry);
 
     /// @brief Removes a vector of shaders from a list
     /// @param removed_shaders Shaders to be removed from the storage
-    /// @pre invalidation_mutex is locked
     /// @pre lookup_mutex is locked
     void RemoveShadersFromStorage(std::span<ShaderInfo*> removed_shaders);
 
+    /// @brief Returns the region covering a page, allocating it when it doesn't exist
+    Region& GetOrCreateRegion(u64 page);
+
+    /// @brief Returns true when the page may contain shaders
+    [[nodiscard]] bool IsPageMarked(u64 page) const noexcept {
+        return ((page_bitmap[page / 64].load(std::memory_order_relaxed) >> (page % 64)) & 1) != 0;
+    }
+
+    /// @brief Updates the bit of a page to reflect if its entry list is empty
+    /// @pre The mutex of the region owning the page is locked
+    void UpdatePageBit(const Region& region, u64 page) noexcept;
+
     /// @brief Creates a new entry in the lookup cache and returns its pointer
     /// @pre lookup_mutex is locked
     Entry* NewEntry(VAddr addr, VAddr addr_end, ShaderInfo* data);
@@ -149,12 +179,19 @@ private:
     Tegra::MaxwellDeviceMemoryManager& device_memory;
 
     mutable std::mutex lookup_mutex;
-    std::mutex invalidation_mutex;
+    std::mutex removal_mutex;
+    std::mutex region_allocation_mutex;
 
     std::unordered_map<u64, std::unique_ptr<Entry>> lookup_cache;
-    std::unordered_map<u64, std::vector<Entry*>> invalidation_cache;
     std::vector<std::unique_ptr<ShaderInfo>> storage;
     std::vector<Entry*> marked_for_removal;
+
+    /// Two-level page table of the entries overlapping each page, regions are allocated on demand
+    std::array<std::atomic<Region*>, NUM_REGIONS> regions{};
+    std::vector<std::unique_ptr<Region>> region_storage;
+
+    /// One bit per page, set when the page has at least one entry
+    std::unique_ptr<std::atomic<u64>[]> page_bitmap;
 };
 
 } // namespace VideoCommon
@@ -2,10 +2,13 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 #include <optional>
+#include <sstream>
+#include <streambuf>
 #include <utility>
 
 #include "common/assert.h"
@@ -13,9 +16,11 @@
 #include "common/common_types.h"
 #include "common/div_ceil.h"
 #include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
 #include "common/fs/path_util.h"
 #include "common/logging/log.h"
 #include "common/polyfill_ranges.h"
+#include "common/zstd_compression.h"
 #include "shader_recompiler/environment.h"
 #include "video_core/engines/kepler_compute.h"
 #include "video_core/memory_manager.h"
@@ -25,16 +30,114 @@
 
 namespace VideoCommon {
 
-constexpr std::array<char, 8> MAGIC_NUMBER{'y', 'u', 'z', 'u', 'c', 'a', 'c', 'h'};
+constexpr std::array<char, 8> LEGACY_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'c', 'a', 'c', 'h'};
+constexpr std::array<char, 8> MAGIC_NUMBER{'s', 'u', 'y', 'u', 'p', 'i', 'd', 'x'};
+constexpr std::array<char, 8> USAGE_MAGIC_NUMBER{'s', 'u', 'y', 'u', 'u', 's', 'a', 'g'};
+
+/// Version of the container layout, independent from the cache version of each renderer
+constexpr u32 FORMAT_VERSION = 1;
 
 constexpr size_t INST_SIZE = sizeof(u64);
 
+/// Pipelines first used within this many frames since boot are always warmed up
+constexpr u32 WARMUP_BOOT_FRAMES = 600;
+/// Pipelines used in at least this many frames are always warmed up
+constexpr u32 WARMUP_MIN_HIT_COUNT = 60;
+
 using Maxwell = Tegra::Engines::Maxwell3D::Regs;
 
+/// Header at the beginning of a pipeline cache file
+struct ContainerHeader {
+    std::array<char, 8> magic;
+    u32 format_version;
+    u32 cache_version;
+};
+static_assert(std::has_unique_object_representations_v<ContainerHeader>);
+
+/// Fixed size header preceding every pipeline, followed by the key and the compressed payload.
+/// Records are chained back to back, so the index of keys can be walked without decompressing.
+struct RecordHeader {
+    u32 num_envs;
+    u32 is_compute;
+    u32 key_size;
+    u32 compressed_size;
+    u32 uncompressed_size;
+    u32 reserved;
+};
+static_assert(std::has_unique_object_representations_v<RecordHeader>);
+
+/// Read-only stream buffer over a memory region, avoids copying decompressed entries
+class SpanStreamBuffer final : public std::streambuf {
+public:
+    explicit SpanStreamBuffer(std::span<u8> data) {
+        char* const begin{reinterpret_cast<char*>(data.data())};
+        setg(begin, begin, begin + data.size());
+    }
+};
+
 static u64 MakeCbufKey(u32 index, u32 offset) {
     return (static_cast<u64>(index) << 32) | offset;
 }
 
+static void WriteContainerHeader(std::ostream& file, u32 cache_version) {
+    const ContainerHeader header{
+        .magic = MAGIC_NUMBER,
+        .format_version = FORMAT_VERSION,
+        .cache_version = cache_version,
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+/// Identifies a stored pipeline by its key and the exact environments it was built from
+static u64 HashRecord(std::span<const char> key, std::span<const u8> compressed) {
+    const u64 key_hash{Common::CityHash64(key.data(), key.size())};
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(compressed.data()),
+                                      compressed.size(), key_hash);
+}
+
+/// Appends a pipeline to a pipeline cache and returns its record hash
+static u64 WriteRecord(std::ostream& file, std::span<const char> key, u32 num_envs,
+                       bool is_compute, std::span<const char> payload) {
+    const std::vector<u8> compressed{Common::Compression::CompressDataZSTDDefault(
+        reinterpret_cast<const u8*>(payload.data()), payload.size())};
+    if (compressed.empty()) {
+        throw std::ios_base::failure("Failed to compress pipeline cache entry");
+    }
+    const RecordHeader record{
+        .num_envs = num_envs,
+        .is_compute = is_compute ? 1U : 0U,
+        .key_size = static_cast<u32>(key.size()),
+        .compressed_size = static_cast<u32>(compressed.size()),
+        .uncompressed_size = static_cast<u32>(payload.size()),
+        .reserved = 0,
+    };
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record))
+        .write(key.data(), key.size())
+        .write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+    return HashRecord(key, compressed);
+}
+
+/// Returns the offset where the well formed records of a pipeline cache end, a shorter size
+/// than the file means the last write was interrupted
+static size_t FindRecordsEnd(std::span<const u8> data, size_t compute_key_size,
+                             size_t graphics_key_size) {
+    size_t offset{sizeof(ContainerHeader)};
+    while (data.size() - offset >= sizeof(RecordHeader)) {
+        RecordHeader record{};
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        const size_t expected_key_size{record.is_compute != 0 ? compute_key_size
+                                                              : graphics_key_size};
+        const size_t record_size{sizeof(record) + static_cast<size_t>(record.key_size) +
+                                 static_cast<size_t>(record.compressed_size)};
+        if (record.key_size != expected_key_size || record.num_envs == 0 ||
+            record_size > data.size() - offset) {
+            break;
+        }
+        offset += record_size;
+    }
+    return offset;
+}
+
 static Shader::TextureType ConvertTextureType(const Tegra::Texture::TICEntry& entry) {
     switch (entry.texture_type) {
     case Tegra::Texture::TextureType::Texture1D:
@@ -193,7 +296,7 @@ void GenericEnvironment::Dump(u64 pipeline_hash, u64 shader_hash) {
     DumpImpl(pipeline_hash, shader_hash, code, read_highest, read_lowest, initial_offset, stage);
 }
 
-void GenericEnvironment::Serialize(std::ofstream& file) const {
+void GenericEnvironment::Serialize(std::ostream& file) const {
     const u64 code_size{static_cast<u64>(CachedSizeBytes())};
     const u64 num_texture_types{static_cast<u64>(texture_types.size())};
     const u64 num_texture_pixel_formats{static_cast<u64>(texture_pixel_formats.size())};
@@ -277,7 +380,11 @@ Tegra::Texture::TICEntry GenericEnvironment::ReadTextureInfo(GPUVAddr tic_addr,
     ASSERT(handle.first <= tic_limit);
     const GPUVAddr descriptor_addr{tic_addr + handle.first * sizeof(Tegra::Texture::TICEntry)};
     Tegra::Texture::TICEntry entry;
-    gpu_memory->ReadBlock(descriptor_addr, &entry, sizeof(entry));
+    if (texture_descriptors_flushed) {
+        gpu_memory->ReadBlockUnsafe(descriptor_addr, &entry, sizeof(entry));
+    } else {
+        gpu_memory->ReadBlock(descriptor_addr, &entry, sizeof(entry));
+    }
     return entry;
 }
 
@@ -395,6 +502,14 @@ u32 GraphicsEnvironment::ReadViewportTransformState() {
     return viewport_transform_state;
 }
 
+void GraphicsEnvironment::FlushTextureDescriptors() {
+    const auto& regs{maxwell3d->regs};
+    const size_t size{(static_cast<size_t>(regs.tex_header.limit) + 1) *
+                      sizeof(Tegra::Texture::TICEntry)};
+    gpu_memory->FlushRegion(regs.tex_header.Address(), size);
+    texture_descriptors_flushed = true;
+}
+
 ComputeEnvironment::ComputeEnvironment(Tegra::Engines::KeplerCompute& kepler_compute_,
                                        Tegra::MemoryManager& gpu_memory_, GPUVAddr program_base_,
                                        u32 start_address_)
@@ -448,7 +563,7 @@ u32 ComputeEnvironment::ReadViewportTransformState() {
     return viewport_transform_state;
 }
 
-void FileEnvironment::Deserialize(std::ifstream& file) {
+void FileEnvironment::Deserialize(std::istream& file) {
     u64 code_size{};
     u64 num_texture_types{};
     u64 num_texture_pixel_formats{};
@@ -582,29 +697,154 @@ std::optional<Shader::ReplaceConstant> FileEnvironment::GetReplaceConstBuffer(u3
     return it->second;
 }
 
-void SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
-                       const std::filesystem::path& filename, u32 cache_version) try {
-    std::ofstream file(filename, std::ios::binary | std::ios::ate | std::ios::app);
-    file.exceptions(std::ifstream::failbit);
+CachedEnvironments::CachedEnvironments(std::shared_ptr<const Common::FS::MappedFile> file_,
+                                       size_t offset_, u32 compressed_size_,
+                                       u32 uncompressed_size_, u32 num_envs_)
+    : file{std::move(file_)}, offset{offset_}, compressed_size{compressed_size_},
+      uncompressed_size{uncompressed_size_}, num_envs{num_envs_} {}
+
+std::vector<FileEnvironment> CachedEnvironments::Decode() const try {
+    const std::span<const u8> compressed{file->Data().subspan(offset, compressed_size)};
+    std::vector<u8> payload{Common::Compression::DecompressDataZSTD(compressed)};
+    if (payload.size() != uncompressed_size) {
+        LOG_ERROR(Common_Filesystem, "Failed to decompress pipeline cache entry at offset {:#x}",
+                  offset);
+        return {};
+    }
+    SpanStreamBuffer buffer{payload};
+    std::istream stream{&buffer};
+    stream.exceptions(std::ios::failbit);
+
+    std::vector<FileEnvironment> envs(num_envs);
+    for (FileEnvironment& env : envs) {
+        env.Deserialize(stream);
+    }
+    return envs;
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "Corrupt pipeline cache entry at offset {:#x}: {}", offset,
+              e.what());
+    return {};
+}
+
+u64 CachedEnvironments::RecordHash(std::span<const char> key) const {
+    return HashRecord(key, file->Data().subspan(offset, compressed_size));
+}
+
+PipelineUsage MergePipelineUsage(const PipelineUsage& stored,
+                                 const PipelineUsage& session) noexcept {
+    const u32 remaining_hits{std::numeric_limits<u32>::max() - stored.hit_count};
+    return PipelineUsage{
+        .first_seen_frame = std::min(stored.first_seen_frame, session.first_seen_frame),
+        .hit_count = stored.hit_count + std::min(session.hit_count, remaining_hits),
+    };
+}
+
+bool IsWarmupPipeline(const PipelineUsage& usage) noexcept {
+    return usage.first_seen_frame < WARMUP_BOOT_FRAMES || usage.hit_count >= WARMUP_MIN_HIT_COUNT;
+}
+
+bool HasHigherWarmupPriority(const PipelineUsage& lhs, const PipelineUsage& rhs) noexcept {
+    const bool lhs_warmup{IsWarmupPipeline(lhs)};
+    if (lhs_warmup != IsWarmupPipeline(rhs)) {
+        return lhs_warmup;
+    }
+    if (lhs_warmup) {
+        // Pipelines needed earlier after boot come first
+        if (lhs.first_seen_frame != rhs.first_seen_frame) {
+            return lhs.first_seen_frame < rhs.first_seen_frame;
+        }
+        return lhs.hit_count > rhs.hit_count;
+    }
+    return lhs.hit_count > rhs.hit_count;
+}
+
+void SerializePipelineUsage(const std::filesystem::path& filename, const PipelineUsageMap& usage,
+                            u32 cache_version) try {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-        LOG_ERROR(Common_Filesystem, "Failed to open pipeline cache file {}",
+        LOG_ERROR(Common_Filesystem, "Failed to open pipeline usage file {}",
                   Common::FS::PathToUTF8String(filename));
         return;
     }
-    if (file.tellp() == 0) {
-        // Write header
-        file.write(MAGIC_NUMBER.data(), MAGIC_NUMBER.size())
-            .write(reinterpret_cast<const char*>(&cache_version), sizeof(cache_version));
+    file.exceptions(std::ofstream::failbit);
+    const u64 num_entries{static_cast<u64>(usage.size())};
+    file.write(USAGE_MAGIC_NUMBER.data(), USAGE_MAGIC_NUMBER.size())
+        .write(reinterpret_cast<const char*>(&cache_version), sizeof(cache_version))
+        .write(reinterpret_cast<const char*>(&num_entries), sizeof(num_entries));
+    for (const auto& [hash, entry] : usage) {
+        file.write(reinterpret_cast<const char*>(&hash), sizeof(hash))
+            .write(reinterpret_cast<const char*>(&entry.first_seen_frame),
+                   sizeof(entry.first_seen_frame))
+            .write(reinterpret_cast<const char*>(&entry.hit_count), sizeof(entry.hit_count));
+    }
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    if (!Common::FS::RemoveFile(filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline usage file {}",
+                  Common::FS::PathToUTF8String(filename));
     }
+}
+
+PipelineUsageMap LoadPipelineUsage(const std::filesystem::path& filename,
+                                   u32 expected_cache_version) try {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return {};
+    }
+    file.exceptions(std::ifstream::failbit);
+
+    std::array<char, 8> magic_number;
+    u32 cache_version;
+    u64 num_entries;
+    file.read(magic_number.data(), magic_number.size())
+        .read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version))
+        .read(reinterpret_cast<char*>(&num_entries), sizeof(num_entries));
+    if (magic_number != USAGE_MAGIC_NUMBER || cache_version != expected_cache_version) {
+        LOG_INFO(Common_Filesystem, "Ignoring outdated pipeline usage file");
+        return {};
+    }
+    PipelineUsageMap usage;
+    usage.reserve(std::min<u64>(num_entries, 0x10000));
+    for (u64 i = 0; i < num_entries; ++i) {
+        u64 hash;
+        PipelineUsage entry;
+        file.read(reinterpret_cast<char*>(&hash), sizeof(hash))
+            .read(reinterpret_cast<char*>(&entry.first_seen_frame), sizeof(entry.first_seen_frame))
+            .read(reinterpret_cast<char*>(&entry.hit_count), sizeof(entry.hit_count));
+        usage.emplace(hash, entry);
+    }
+    return usage;
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "Failed to load pipeline usage file: {}", e.what());
+    return {};
+}
+
+u64 SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
+                      const std::filesystem::path& filename, u32 cache_version) try {
     if (!std::ranges::all_of(envs, &GenericEnvironment::CanBeSerialized)) {
-        return;
+        return 0;
     }
-    const u32 num_envs{static_cast<u32>(envs.size())};
-    file.write(reinterpret_cast<const char*>(&num_envs), sizeof(num_envs));
+    std::ostringstream payload(std::ios::binary);
+    payload.exceptions(std::ios::failbit);
     for (const GenericEnvironment* const env : envs) {
-        env->Serialize(file);
+        env->Serialize(payload);
     }
-    file.write(key.data(), key.size_bytes());
+    const bool is_compute{envs.front()->ShaderStage() == Shader::Stage::Compute};
+
+    std::ofstream file(filename, std::ios::binary | std::ios::ate | std::ios::app);
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open pipeline cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+        return 0;
+    }
+    file.exceptions(std::ifstream::failbit);
+    if (file.tellp() == 0) {
+        WriteContainerHeader(file, cache_version);
+    }
+    return WriteRecord(file, key, static_cast<u32>(envs.size()), is_compute, payload.view());
 
 } catch (const std::ios_base::failure& e) {
     LOG_ERROR(Common_Filesystem, "{}", e.what());
@@ -612,63 +852,219 @@ void SerializePipeline(std::span<const char> key, std::span<const GenericEnviron
         LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
                   Common::FS::PathToUTF8String(filename));
     }
+    return 0;
+}
+
+bool ConvertLegacyPipelineCache(const std::filesystem::path& filename, u32 cache_version,
+                                size_t compute_key_size, size_t graphics_key_size) {
+    const std::filesystem::path converted_filename{Common::FS::PathToUTF8String(filename) +
+                                                   ".convert"};
+    try {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.exceptions(std::ifstream::failbit);
+        const auto end{file.tellg()};
+        file.seekg(0, std::ios::beg);
+
+        std::array<char, 8> magic_number;
+        u32 legacy_cache_version;
+        file.read(magic_number.data(), magic_number.size())
+            .read(reinterpret_cast<char*>(&legacy_cache_version), sizeof(legacy_cache_version));
+        if (magic_number != LEGACY_MAGIC_NUMBER || legacy_cache_version != cache_version) {
+            return false;
+        }
+
+        std::ofstream converted(converted_filename, std::ios::binary | std::ios::trunc);
+        if (!converted.is_open()) {
+            LOG_ERROR(Common_Filesystem, "Failed to create pipeline cache file {}",
+                      Common::FS::PathToUTF8String(converted_filename));
+            return false;
+        }
+        converted.exceptions(std::ofstream::failbit);
+        WriteContainerHeader(converted, cache_version);
+
+        std::vector<char> payload;
+        std::vector<char> key;
+        size_t num_pipelines{};
+        while (file.tellg() != end) {
+            u32 num_envs{};
+            file.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
+
+            // Environments are stored with the same encoding in both formats, parse them only to
+            // find where they end and copy the raw bytes into the compressed payload
+            const auto payload_begin{file.tellg()};
+            std::vector<FileEnvironment> envs(num_envs);
+            for (FileEnvironment& env : envs) {
+                env.Deserialize(file);
+            }
+            const auto payload_end{file.tellg()};
+            const bool is_compute{envs.front().ShaderStage() == Shader::Stage::Compute};
+
+            payload.resize(static_cast<size_t>(payload_end - payload_begin));
+            key.resize(is_compute ? compute_key_size : graphics_key_size);
+            file.seekg(payload_begin)
+                .read(payload.data(), payload.size())
+                .read(key.data(), key.size());
+
+            WriteRecord(converted, key, num_envs, is_compute, payload);
+            ++num_pipelines;
+        }
+        file.close();
+        converted.close();
+
+        // RenameFile refuses to overwrite, the legacy file has to go first
+        if (!Common::FS::RemoveFile(filename) ||
+            !Common::FS::RenameFile(converted_filename, filename)) {
+            LOG_ERROR(Common_Filesystem, "Failed to replace pipeline cache file {}",
+                      Common::FS::PathToUTF8String(filename));
+            Common::FS::RemoveFile(converted_filename);
+            return false;
+        }
+        LOG_INFO(Common_Filesystem, "Converted {} pipelines to the indexed pipeline cache format",
+                 num_pipelines);
+        return true;
+
+    } catch (const std::ios_base::failure& e) {
+        LOG_ERROR(Common_Filesystem, "Failed to convert pipeline cache: {}", e.what());
+        Common::FS::RemoveFile(converted_filename);
+        return false;
+    }
 }
 
 void LoadPipelines(
     std::stop_token stop_loading, const std::filesystem::path& filename, u32 expected_cache_version,
-    Common::UniqueFunction<void, std::ifstream&, FileEnvironment> load_compute,
-    Common::UniqueFunction<void, std::ifstream&, std::vector<FileEnvironment>> load_graphics) try {
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
+    size_t compute_key_size, size_t graphics_key_size,
+    Common::UniqueFunction<void, std::span<const char>, CachedEnvironments> load_compute,
+    Common::UniqueFunction<void, std::span<const char>, CachedEnvironments> load_graphics) {
+    if (!Common::FS::Exists(filename)) {
         return;
     }
-    file.exceptions(std::ifstream::failbit);
-    const auto end{file.tellg()};
-    file.seekg(0, std::ios::beg);
-
-    std::array<char, 8> magic_number;
-    u32 cache_version;
-    file.read(magic_number.data(), magic_number.size())
-        .read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version));
-    if (magic_number != MAGIC_NUMBER || cache_version != expected_cache_version) {
-        file.close();
+    const auto delete_cache{[&filename](std::string_view reason) {
         if (Common::FS::RemoveFile(filename)) {
-            if (magic_number != MAGIC_NUMBER) {
-                LOG_ERROR(Common_Filesystem, "Invalid pipeline cache file");
-            }
-            if (cache_version != expected_cache_version) {
-                LOG_INFO(Common_Filesystem, "Deleting old pipeline cache");
-            }
+            LOG_INFO(Common_Filesystem, "Deleting pipeline cache: {}", reason);
         } else {
             LOG_ERROR(Common_Filesystem,
                       "Invalid pipeline cache file and failed to delete it in \"{}\"",
                       Common::FS::PathToUTF8String(filename));
         }
+    }};
+
+    auto file{std::make_shared<Common::FS::MappedFile>(filename)};
+    if (!file->IsOpen()) {
         return;
     }
-    while (file.tellg() != end) {
-        if (stop_loading.stop_requested()) {
+    ContainerHeader header{};
+    if (file->Size() >= LEGACY_MAGIC_NUMBER.size()) {
+        std::memcpy(&header.magic, file->Data().data(), header.magic.size());
+    }
+    if (header.magic == LEGACY_MAGIC_NUMBER) {
+        file->Close();
+        if (!ConvertLegacyPipelineCache(filename, expected_cache_version, compute_key_size,
+                                        graphics_key_size)) {
+            delete_cache("unable to convert the legacy format");
+            return;
+        }
+        if (!file->Open(filename)) {
+            return;
+        }
+    }
+
+    std::span<const u8> data{file->Data()};
+    if (data.size() < sizeof(header)) {
+        file->Close();
+        delete_cache("truncated header");
+        return;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != MAGIC_NUMBER) {
+        file->Close();
+        delete_cache("invalid magic number");
+        return;
+    }
+    if (header.format_version != FORMAT_VERSION || header.cache_version != expected_cache_version) {
+        file->Close();
+        delete_cache("outdated version");
+        return;
+    }
+
+    const size_t valid_size{FindRecordsEnd(data, compute_key_size, graphics_key_size)};
+    if (valid_size != data.size()) {
+        // A write was interrupted, keep the valid records so new pipelines are appended after
+        // them. The file is trimmed before any record is handed out, as it can't be resized while
+        // it is mapped on Windows.
+        LOG_WARNING(Common_Filesystem, "Discarding {} bytes of corrupt pipeline cache data",
+                    data.size() - valid_size);
+        file->Close();
+        std::error_code ec;
+        std::filesystem::resize_file(filename, valid_size, ec);
+        if (ec) {
+            LOG_ERROR(Common_Filesystem, "Failed to resize pipeline cache file: {}", ec.message());
+            delete_cache("unable to discard corrupt data");
             return;
         }
-        u32 num_envs{};
-        file.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
-        std::vector<FileEnvironment> envs(num_envs);
-        for (FileEnvironment& env : envs) {
-            env.Deserialize(file);
+        if (!file->Open(filename)) {
+            return;
+        }
+        data = file->Data();
+    }
+
+    // Walk the record headers, payloads are only touched once a pipeline decodes its environments
+    const size_t records_end{FindRecordsEnd(data, compute_key_size, graphics_key_size)};
+    size_t offset{sizeof(header)};
+    while (offset != records_end) {
+        if (stop_loading.stop_requested()) {
+            return;
         }
-        if (envs.front().ShaderStage() == Shader::Stage::Compute) {
-            load_compute(file, std::move(envs.front()));
+        RecordHeader record{};
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        const size_t key_offset{offset + sizeof(record)};
+        const char* const key{reinterpret_cast<const char*>(data.data() + key_offset)};
+        CachedEnvironments envs{file, key_offset + record.key_size, record.compressed_size,
+                                record.uncompressed_size, record.num_envs};
+        if (record.is_compute != 0) {
+            load_compute(std::span(key, record.key_size), std::move(envs));
         } else {
-            load_graphics(file, std::move(envs));
+            load_graphics(std::span(key, record.key_size), std::move(envs));
         }
+        offset = key_offset + record.key_size + record.compressed_size;
     }
+}
 
-} catch (const std::ios_base::failure& e) {
-    LOG_ERROR(Common_Filesystem, "{}", e.what());
-    if (!Common::FS::RemoveFile(filename)) {
-        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
-                  Common::FS::PathToUTF8String(filename));
+bool VisitStoredPipelines(
+    const std::filesystem::path& filename,
+    Common::UniqueFunction<void, bool, std::span<const char>, CachedEnvironments> visit) {
+    auto file{std::make_shared<Common::FS::MappedFile>(filename)};
+    if (!file->IsOpen()) {
+        return false;
+    }
+    const std::span<const u8> data{file->Data()};
+    ContainerHeader header{};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != MAGIC_NUMBER || header.format_version != FORMAT_VERSION) {
+        return false;
+    }
+    size_t offset{sizeof(header)};
+    while (data.size() - offset >= sizeof(RecordHeader)) {
+        RecordHeader record{};
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        const size_t record_size{sizeof(record) + static_cast<size_t>(record.key_size) +
+                                 static_cast<size_t>(record.compressed_size)};
+        if (record.num_envs == 0 || record_size > data.size() - offset) {
+            break;
+        }
+        const size_t key_offset{offset + sizeof(record)};
+        const char* const key{reinterpret_cast<const char*>(data.data() + key_offset)};
+        visit(record.is_compute != 0, std::span(key, record.key_size),
+              CachedEnvironments{file, key_offset + record.key_size, record.compressed_size,
+                                 record.uncompressed_size, record.num_envs});
+        offset += record_size;
     }
+    return true;
 }
 
 } // namespace VideoCommon
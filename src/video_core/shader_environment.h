@@ -20,6 +20,10 @@
 #include "shader_recompiler/environment.h"
 #include "video_core/engines/maxwell_3d.h"
 
+namespace Common::FS {
+class MappedFile;
+}
+
 namespace Tegra {
 class Memorymanager;
 }
@@ -60,7 +64,7 @@ public:
 
     void Dump(u64 pipeline_hash, u64 shader_hash) override;
 
-    void Serialize(std::ofstream& file) const;
+    void Serialize(std::ostream& file) const;
 
     bool HasHLEMacroState() const override {
         return has_hle_engine_state;
@@ -97,6 +101,7 @@ protected:
 
     bool has_unbound_instructions = false;
     bool has_hle_engine_state = false;
+    bool texture_descriptors_flushed = false;
 };
 
 class GraphicsEnvironment final : public GenericEnvironment {
@@ -121,6 +126,10 @@ public:
 
     std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(u32 bank, u32 offset) override;
 
+    /// Flushes the bound texture descriptors, afterwards they are read without flushing so the
+    /// shader can be translated outside of the GPU thread
+    void FlushTextureDescriptors();
+
 private:
     Tegra::Engines::Maxwell3D* maxwell3d{};
     size_t stage_index{};
@@ -165,7 +174,7 @@ public:
     FileEnvironment& operator=(const FileEnvironment&) = delete;
     FileEnvironment(const FileEnvironment&) = delete;
 
-    void Deserialize(std::ifstream& file);
+    void Deserialize(std::istream& file);
 
     [[nodiscard]] u64 ReadInstruction(u32 address) override;
 
@@ -212,21 +221,109 @@ private:
     u32 viewport_transform_state = 1;
 };
 
-void SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
-                       const std::filesystem::path& filename, u32 cache_version);
+/// Appends a pipeline to a pipeline cache, returns the hash of the written record or zero when
+/// the pipeline can't be stored. The hash matches CachedEnvironments::RecordHash on later boots.
+u64 SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
+                      const std::filesystem::path& filename, u32 cache_version);
 
 template <typename Key, typename Envs>
-void SerializePipeline(const Key& key, const Envs& envs, const std::filesystem::path& filename,
-                       u32 cache_version) {
+u64 SerializePipeline(const Key& key, const Envs& envs, const std::filesystem::path& filename,
+                      u32 cache_version) {
     static_assert(std::is_trivially_copyable_v<Key>);
     static_assert(std::has_unique_object_representations_v<Key>);
-    SerializePipeline(std::span(reinterpret_cast<const char*>(&key), sizeof(key)),
+    return SerializePipeline(std::span(reinterpret_cast<const char*>(&key), sizeof(key)),
                       std::span(envs.data(), envs.size()), filename, cache_version);
 }
 
+/// Usage statistics of a cached pipeline, used to order pipelines when warming up the cache
+struct PipelineUsage {
+    /// Frame since boot in which the pipeline was first used, across all sessions
+    u32 first_seen_frame = std::numeric_limits<u32>::max();
+    /// Number of frames in which the pipeline has been used, across all sessions
+    u32 hit_count = 0;
+};
+
+/// Per-pipeline usage statistics keyed by the hash of the pipeline key
+using PipelineUsageMap = std::unordered_map<u64, PipelineUsage>;
+
+/// Counts the frames a pipeline is used in during the current session
+class PipelineUsageTracker {
+public:
+    void MarkUsed(u32 frame) noexcept {
+        if (last_used_frame == frame) {
+            return;
+        }
+        if (usage.hit_count == 0) {
+            usage.first_seen_frame = frame;
+        }
+        last_used_frame = frame;
+        ++usage.hit_count;
+    }
+
+    [[nodiscard]] const PipelineUsage& Usage() const noexcept {
+        return usage;
+    }
+
+private:
+    PipelineUsage usage;
+    u32 last_used_frame = std::numeric_limits<u32>::max();
+};
+
+/// Combines the statistics stored on disk with the ones recorded in this session
+[[nodiscard]] PipelineUsage MergePipelineUsage(const PipelineUsage& stored,
+                                               const PipelineUsage& session) noexcept;
+
+/// Returns true when a pipeline is hot enough to be built before the game starts
+[[nodiscard]] bool IsWarmupPipeline(const PipelineUsage& usage) noexcept;
+
+/// Returns true when lhs should be built before rhs
+[[nodiscard]] bool HasHigherWarmupPriority(const PipelineUsage& lhs,
+                                           const PipelineUsage& rhs) noexcept;
+
+void SerializePipelineUsage(const std::filesystem::path& filename, const PipelineUsageMap& usage,
+                            u32 cache_version);
+
+[[nodiscard]] PipelineUsageMap LoadPipelineUsage(const std::filesystem::path& filename,
+                                                 u32 expected_cache_version);
+
+/// Environments of a pipeline stored in the pipeline cache, decompressed and decoded on demand so
+/// pipelines can be deserialized in parallel from the worker building them.
+class CachedEnvironments {
+public:
+    explicit CachedEnvironments(std::shared_ptr<const Common::FS::MappedFile> file_,
+                                size_t offset_, u32 compressed_size_, u32 uncompressed_size_,
+                                u32 num_envs_);
+
+    /// Decodes the stored environments, returns an empty vector when the entry is corrupt
+    [[nodiscard]] std::vector<FileEnvironment> Decode() const;
+
+    /// Returns a hash identifying the stored pipeline, without decompressing its environments
+    [[nodiscard]] u64 RecordHash(std::span<const char> key) const;
+
+private:
+    std::shared_ptr<const Common::FS::MappedFile> file;
+    size_t offset{};
+    u32 compressed_size{};
+    u32 uncompressed_size{};
+    u32 num_envs{};
+};
+
+/// Rewrites a pipeline cache in the sequential format used before the indexed container.
+/// Returns false when the file can't be converted and should be discarded.
+bool ConvertLegacyPipelineCache(const std::filesystem::path& filename, u32 cache_version,
+                                size_t compute_key_size, size_t graphics_key_size);
+
 void LoadPipelines(
     std::stop_token stop_loading, const std::filesystem::path& filename, u32 expected_cache_version,
-    Common::UniqueFunction<void, std::ifstream&, FileEnvironment> load_compute,
-    Common::UniqueFunction<void, std::ifstream&, std::vector<FileEnvironment>> load_graphics);
+    size_t compute_key_size, size_t graphics_key_size,
+    Common::UniqueFunction<void, std::span<const char>, CachedEnvironments> load_compute,
+    Common::UniqueFunction<void, std::span<const char>, CachedEnvironments> load_graphics);
+
+/// Calls visit(is_compute, key, environments) for every pipeline stored in a pipeline cache.
+/// Unlike LoadPipelines, the cache version isn't checked and the file is never modified.
+/// Returns false when the file is not a pipeline cache in the current format.
+bool VisitStoredPipelines(
+    const std::filesystem::path& filename,
+    Common::UniqueFunction<void, bool, std::span<const char>, CachedEnvironments> visit);
 
 } // namespace VideoCommon
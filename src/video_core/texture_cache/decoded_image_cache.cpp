@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "video_core/texture_cache/decoded_image_cache.h"
+#include "video_core/texture_cache/image_info.h"
+#include "video_core/texture_cache/util.h"
+
+namespace VideoCommon {
+
+namespace {
+
+using namespace Common::Literals;
+
+constexpr std::array<char, 8> MAGIC_NUMBER{'s', 'u', 'y', 'u', 't', 'e', 'x', 'd'};
+constexpr u32 FORMAT_VERSION = 1;
+
+/// Images smaller than this are cheaper to convert again than to look up
+constexpr size_t MIN_CACHED_SIZE = 16_KiB;
+
+/// The cache stops growing past this size
+constexpr u64 MAX_FILE_SIZE = 2_GiB;
+
+struct FileHeader {
+    std::array<char, 8> magic;
+    u32 format_version;
+    u32 copy_size;
+};
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+
+struct RecordHeader {
+    u64 key;
+    u32 num_copies;
+    u32 data_size;
+};
+static_assert(std::is_trivially_copyable_v<RecordHeader>);
+static_assert(std::is_trivially_copyable_v<BufferImageCopy>);
+
+/// Fields of the image description that affect the converted data
+struct KeyInfo {
+    PixelFormat format;
+    ImageType type;
+    s32 levels;
+    s32 layers;
+    Extent3D size;
+    u32 block_or_pitch;
+    u32 layer_stride;
+    u32 num_samples;
+    u32 tile_width_spacing;
+    u32 astc_recompression;
+    u32 converted_size;
+};
+
+u64 ComputeKey(std::span<const u8> input, const ImageInfo& info) {
+    KeyInfo key_info;
+    std::memset(&key_info, 0, sizeof(key_info));
+    key_info.format = info.format;
+    key_info.type = info.type;
+    key_info.levels = info.resources.levels;
+    key_info.layers = info.resources.layers;
+    key_info.size = info.size;
+    key_info.block_or_pitch = info.pitch;
+    key_info.layer_stride = info.layer_stride;
+    key_info.num_samples = info.num_samples;
+    key_info.tile_width_spacing = info.tile_width_spacing;
+    key_info.astc_recompression =
+        static_cast<u32>(Settings::values.astc_recompression.GetValue());
+    key_info.converted_size = CalculateConvertedSizeBytes(info);
+
+    const u64 info_hash =
+        Common::CityHash64(reinterpret_cast<const char*>(&key_info), sizeof(key_info));
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(input.data()), input.size(),
+                                      info_hash);
+}
+
+} // Anonymous namespace
+
+DecodedImageCache::DecodedImageCache() : writer{1, "DecodedImageCache"} {}
+
+DecodedImageCache::~DecodedImageCache() {
+    writer.WaitForRequests();
+}
+
+void DecodedImageCache::LoadDiskResources(u64 title_id) {
+    if (title_id == 0 || !Settings::values.use_disk_texture_cache.GetValue()) {
+        return;
+    }
+    const auto shader_dir{Common::FS::GetSuyuPath(Common::FS::SuyuPath::ShaderDir)};
+    const auto base_dir{shader_dir / fmt::format("{:016x}", title_id)};
+    if (!Common::FS::CreateDir(shader_dir) || !Common::FS::CreateDir(base_dir)) {
+        LOG_ERROR(Common_Filesystem, "Failed to create decoded image cache directories");
+        return;
+    }
+    OpenFile(base_dir / "decoded_images.bin");
+}
+
+void DecodedImageCache::OpenFile(const std::filesystem::path& path) {
+    filename = path;
+
+    size_t valid_size = 0;
+    bool is_valid = false;
+    if (Common::FS::Exists(filename) && mapped_file.Open(filename)) {
+        const std::span<const u8> data = mapped_file.Data();
+        FileHeader header;
+        if (data.size() >= sizeof(header)) {
+            std::memcpy(&header, data.data(), sizeof(header));
+            is_valid = header.magic == MAGIC_NUMBER && header.format_version == FORMAT_VERSION &&
+                       header.copy_size == sizeof(BufferImageCopy);
+        }
+        if (is_valid) {
+            size_t offset = sizeof(header);
+            while (offset + sizeof(RecordHeader) <= data.size()) {
+                RecordHeader record;
+                std::memcpy(&record, data.data() + offset, sizeof(record));
+                const size_t copies_offset = offset + sizeof(record);
+                const size_t data_offset =
+                    copies_offset + size_t{record.num_copies} * sizeof(BufferImageCopy);
+                const size_t end = data_offset + record.data_size;
+                if (end > data.size()) {
+                    break;
+                }
+                entries.try_emplace(record.key, Entry{
+                                                    .copies_offset = copies_offset,
+                                                    .data_offset = data_offset,
+                                                    .num_copies = record.num_copies,
+                                                    .data_size = record.data_size,
+                                                });
+                offset = end;
+            }
+            valid_size = offset;
+        }
+    }
+
+    if (mapped_file.IsOpen() && (!is_valid || valid_size != mapped_file.Size())) {
+        LOG_WARNING(HW_GPU, "Discarding {} of the decoded image cache",
+                    is_valid ? "the corrupted tail" : "the contents");
+        // The mapping has to go before the file can be resized or removed
+        entries.clear();
+        mapped_file.Close();
+        std::error_code ec;
+        if (is_valid) {
+            std::filesystem::resize_file(filename, valid_size, ec);
+            if (!ec) {
+                // Offsets of the valid records did not change, index them again
+                OpenFile(filename);
+                return;
+            }
+        }
+        std::filesystem::remove(filename, ec);
+        valid_size = 0;
+    }
+
+    file.Open(filename, Common::FS::FileAccessMode::Append, Common::FS::FileType::BinaryFile);
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open decoded image cache at {}",
+                  Common::FS::PathToUTF8String(filename));
+        return;
+    }
+    if (valid_size == 0) {
+        const FileHeader header{
+            .magic = MAGIC_NUMBER,
+            .format_version = FORMAT_VERSION,
+            .copy_size = static_cast<u32>(sizeof(BufferImageCopy)),
+        };
+        file.WriteObject(header);
+        file.Flush();
+        valid_size = sizeof(header);
+    }
+    file_size = valid_size;
+
+    LOG_INFO(HW_GPU, "Loaded {} decoded images from disk", entries.size());
+    is_loaded.store(true, std::memory_order_release);
+}
+
+void DecodedImageCache::ConvertImage(std::span<const u8> input, const ImageInfo& info,
+                                     std::span<u8> output, std::span<BufferImageCopy> copies) {
+    if (!is_loaded.load(std::memory_order_acquire) || input.size() < MIN_CACHED_SIZE) {
+        VideoCommon::ConvertImage(input, info, output, copies);
+        return;
+    }
+    const u64 key = ComputeKey(input, info);
+    if (Load(key, output, copies)) {
+        return;
+    }
+    VideoCommon::ConvertImage(input, info, output, copies);
+
+    const size_t data_size = std::min<size_t>(output.size(), CalculateConvertedSizeBytes(info));
+    Store(key, output.first(data_size), copies);
+}
+
+bool DecodedImageCache::Load(u64 key, std::span<u8> output,
+                             std::span<BufferImageCopy> copies) const {
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    const Entry& entry = it->second;
+    if (entry.num_copies != copies.size() || entry.data_size > output.size()) {
+        return false;
+    }
+    const u8* const base = mapped_file.Data().data();
+    std::memcpy(copies.data(), base + entry.copies_offset, copies.size_bytes());
+    std::memcpy(output.data(), base + entry.data_offset, entry.data_size);
+    return true;
+}
+
+void DecodedImageCache::Store(u64 key, std::span<const u8> data,
+                              std::span<const BufferImageCopy> copies) {
+    const size_t record_size = sizeof(RecordHeader) + copies.size_bytes() + data.size();
+    if (entries.contains(key) ||
+        file_size.load(std::memory_order_relaxed) + record_size > MAX_FILE_SIZE) {
+        return;
+    }
+    {
+        std::scoped_lock lock{stored_keys_mutex};
+        if (!stored_keys.insert(key).second) {
+            return;
+        }
+    }
+    file_size.fetch_add(record_size, std::memory_order_relaxed);
+
+    std::vector<u8> record(record_size);
+    const RecordHeader header{
+        .key = key,
+        .num_copies = static_cast<u32>(copies.size()),
+        .data_size = static_cast<u32>(data.size()),
+    };
+    std::memcpy(record.data(), &header, sizeof(header));
+    std::memcpy(record.data() + sizeof(header), copies.data(), copies.size_bytes());
+    std::memcpy(record.data() + sizeof(header) + copies.size_bytes(), data.data(), data.size());
+
+    writer.QueueWork([this, record = std::move(record)] {
+        if (file.WriteSpan(std::span<const u8>(record)) != record.size()) {
+            LOG_ERROR(Common_Filesystem, "Failed to write decoded image cache entry");
+        }
+        file.Flush();
+    });
+}
+
+} // namespace VideoCommon
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/fs/mapped_file.h"
+#include "common/thread_worker.h"
+#include "video_core/texture_cache/types.h"
+
+namespace VideoCommon {
+
+struct ImageInfo;
+
+/**
+ * Persistent cache of images converted on the CPU because the host can not sample their format.
+ *
+ * Entries are keyed by a hash of the unswizzled guest data and the image description, so they
+ * remain valid across boots. The file is memory mapped when loaded and new entries are appended
+ * from a background thread, they become visible on the next boot.
+ */
+class DecodedImageCache {
+public:
+    DecodedImageCache();
+    ~DecodedImageCache();
+
+    DecodedImageCache(const DecodedImageCache&) = delete;
+    DecodedImageCache& operator=(const DecodedImageCache&) = delete;
+
+    /// Maps the cache of the given title, does nothing when the cache is disabled
+    void LoadDiskResources(u64 title_id);
+
+    /**
+     * Converts input like VideoCommon::ConvertImage, copying the result from the disk cache when
+     * the same image was converted before. Thread safe.
+     */
+    void ConvertImage(std::span<const u8> input, const ImageInfo& info, std::span<u8> output,
+                      std::span<BufferImageCopy> copies);
+
+private:
+    struct Entry {
+        size_t copies_offset;
+        size_t data_offset;
+        u32 num_copies;
+        u32 data_size;
+    };
+
+    bool Load(u64 key, std::span<u8> output, std::span<BufferImageCopy> copies) const;
+
+    void Store(u64 key, std::span<const u8> data, std::span<const BufferImageCopy> copies);
+
+    void OpenFile(const std::filesystem::path& path);
+
+    std::filesystem::path filename;
+    Common::FS::MappedFile mapped_file;
+    std::unordered_map<u64, Entry> entries;
+    std::atomic<bool> is_loaded{};
+
+    std::mutex stored_keys_mutex;
+    std::unordered_set<u64> stored_keys;
+    std::atomic<u64> file_size{};
+
+    Common::FS::IOFile file;
+    Common::ThreadWorker writer;
+};
+
+} // namespace VideoCommon
@@ -17,6 +17,7 @@
 #include "video_core/texture_cache/samples_helper.h"
 #include "video_core/texture_cache/texture_cache_base.h"
 #include "video_core/texture_cache/util.h"
+#include "video_core/textures/workers.h"
 
 namespace VideoCommon {
 
@@ -142,6 +143,11 @@ void TextureCache<P>::RunGarbageCollector() {
     }
 }
 
+template <class P>
+void TextureCache<P>::LoadDiskResources(u64 title_id) {
+    decoded_image_cache.LoadDiskResources(title_id);
+}
+
 template <class P>
 void TextureCache<P>::TickFrame() {
     // If we can obtain the memory info, use it instead of the estimate.
@@ -1090,7 +1096,7 @@ void TextureCache<P>::UploadImageContents(Image& image, StagingBuffer& staging)
         unswizzle_data_buffer.resize_destructive(image.unswizzled_size_bytes);
         auto copies =
             UnswizzleImage(*gpu_memory, gpu_addr, image.info, swizzle_data, unswizzle_data_buffer);
-        ConvertImage(unswizzle_data_buffer, image.info, mapped_span, copies);
+        decoded_image_cache.ConvertImage(unswizzle_data_buffer, image.info, mapped_span, copies);
         image.UploadMemory(staging, copies);
     } else {
         const auto copies =
@@ -1297,11 +1303,14 @@ void TextureCache<P>::QueueAsyncDecode(Image& image, ImageId image_id) {
     const size_t out_size = MapSizeBytes(image);
 
     auto func = [out_size, copies, info = image.info,
-                 input = std::move(local_unswizzle_data_buffer),
-                 async_decode = decode_ptr]() mutable {
+                 input = std::move(local_unswizzle_data_buffer), async_decode = decode_ptr,
+                 decoded_cache = &decoded_image_cache]() mutable {
+        // Streamed images must not hold back decodes the current draw is waiting on
+        const Tegra::Texture::ScopedDecodePriority priority{
+            Tegra::Texture::DecodePriority::Background};
         async_decode->decoded_data.resize_destructive(out_size);
         std::span copies_span{copies.data(), copies.size()};
-        ConvertImage(input, info, async_decode->decoded_data, copies_span);
+        decoded_cache->ConvertImage(input, info, async_decode->decoded_data, copies_span);
 
         // TODO: Do we need this lock?
         std::unique_lock lock{async_decode->mutex};
@@ -28,6 +28,7 @@
 #include "video_core/delayed_destruction_ring.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/surface.h"
+#include "video_core/texture_cache/decoded_image_cache.h"
 #include "video_core/texture_cache/descriptor_table.h"
 #include "video_core/texture_cache/image_base.h"
 #include "video_core/texture_cache/image_info.h"
@@ -134,6 +135,9 @@ public:
     /// Notify the cache that a new frame has been queued
     void TickFrame();
 
+    /// Load the persistent decoded image cache of the given title
+    void LoadDiskResources(u64 title_id);
+
     /// Return a constant reference to the given image view id
     [[nodiscard]] const ImageView& GetImageView(ImageViewId id) const noexcept;
 
@@ -489,6 +493,7 @@ private:
     u64 modification_tick = 0;
     u64 frame_tick = 0;
 
+    DecodedImageCache decoded_image_cache;
     Common::ThreadWorker texture_decode_worker{1, "TextureDecoder"};
     std::vector<std::unique_ptr<AsyncDecodeContext>> async_decodes;
 
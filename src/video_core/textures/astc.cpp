@@ -13,12 +13,29 @@
 
 #include <boost/container/static_vector.hpp>
 
+#if defined(ARCHITECTURE_x86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#elif defined(ARCHITECTURE_arm64)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#include <sse2neon.h>
+#pragma GCC diagnostic pop
+#endif
+
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/polyfill_ranges.h"
 #include "video_core/textures/astc.h"
 #include "video_core/textures/workers.h"
 
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
 class InputBitStream {
 public:
     constexpr explicit InputBitStream(std::span<const u8> data, size_t start_offset = 0)
@@ -43,20 +60,29 @@ public:
     }
 
     constexpr u32 ReadBits(std::size_t nBits) {
+        // Extract whole runs of bits from each byte, bits past the end of the stream read as zero
+        std::size_t count = std::min(nBits, total_bits * 8 - bits_read);
         u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
+        std::size_t shift = 0;
+        while (count > 0) {
+            const std::size_t chunk = std::min<std::size_t>(8 - next_bit, count);
+            const u32 bits = (static_cast<u32>(*cur_byte) >> next_bit) & ((1U << chunk) - 1);
+            ret |= bits << shift;
+            shift += chunk;
+            count -= chunk;
+            bits_read += chunk;
+            next_bit += chunk;
+            if (next_bit >= 8) {
+                next_bit -= 8;
+                ++cur_byte;
+            }
         }
         return ret;
     }
 
     template <std::size_t nBits>
     constexpr u32 ReadBits() {
-        u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
-        }
-        return ret;
+        return ReadBits(nBits);
     }
 
 private:
@@ -1075,9 +1101,15 @@ static u32 UnquantizeTexelWeight(const IntegerEncodedValue& val) {
     return result;
 }
 
+template <u32 FixedWidth, u32 FixedHeight>
 static void UnquantizeTexelWeights(u32 out[2][144], const IntegerEncodedVector& weights,
-                                   const TexelWeightParams& params, const u32 blockWidth,
-                                   const u32 blockHeight) {
+                                   const TexelWeightParams& params, u32 blockWidth,
+                                   u32 blockHeight) {
+    if constexpr (FixedWidth != 0 && FixedHeight != 0) {
+        // Let the compiler unroll the infill loops for the common footprints
+        blockWidth = FixedWidth;
+        blockHeight = FixedHeight;
+    }
     u32 weightIdx = 0;
     u32 unquantized[2][144];
 
@@ -1419,8 +1451,31 @@ static void FillError(std::span<u32> outBuf, u32 blockWidth, u32 blockHeight) {
     }
 }
 
-static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
-                            const u32 blockHeight, std::span<u32, 12 * 12> outBuf) {
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+// Interpolates the four channels of a texel at once, channels are laid out as in Pixel (ARGB)
+static u32 InterpolateTexelSIMD(__m128i c0, __m128i c1, __m128i weight) {
+    const __m128i inv_weight = _mm_sub_epi32(_mm_set1_epi32(64), weight);
+    __m128i c = _mm_add_epi32(_mm_mullo_epi32(c0, inv_weight), _mm_mullo_epi32(c1, weight));
+    c = _mm_srli_epi32(_mm_add_epi32(c, _mm_set1_epi32(32)), 6);
+
+    // Convert from UNORM16 to UNORM8 rounding to nearest
+    c = _mm_mullo_epi32(c, _mm_set1_epi32(255));
+    c = _mm_srli_epi32(_mm_add_epi32(c, _mm_set1_epi32(32768)), 16);
+
+    // Gather the low byte of each channel into R8G8B8A8 order
+    const __m128i pack_mask = _mm_setr_epi8(4, 8, 12, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            -1, -1);
+    return static_cast<u32>(_mm_cvtsi128_si32(_mm_shuffle_epi8(c, pack_mask)));
+}
+#endif
+
+template <u32 FixedWidth, u32 FixedHeight, bool UseSIMD>
+static void DecompressBlock(std::span<const u8, 16> inBuf, u32 blockWidth, u32 blockHeight,
+                            std::span<u32, 12 * 12> outBuf) {
+    if constexpr (FixedWidth != 0 && FixedHeight != 0) {
+        blockWidth = FixedWidth;
+        blockHeight = FixedHeight;
+    }
     InputBitStream strm(inBuf);
     TexelWeightParams weightParams = DecodeBlockInfo(strm);
 
@@ -1615,54 +1670,137 @@ static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
 
     // Blocks can be at most 12x12, so we can have as many as 144 weights
     u32 weights[2][144];
-    UnquantizeTexelWeights(weights, texelWeightValues, weightParams, blockWidth, blockHeight);
+    UnquantizeTexelWeights<FixedWidth, FixedHeight>(weights, texelWeightValues, weightParams,
+                                                    blockWidth, blockHeight);
+
+    // Channel that takes its weight from the second plane, in Pixel order
+    const u32 dualPlaneChannel = weightParams.m_bDualPlane ? ((planeIdx + 1) & 3) : 4;
+    const bool smallBlock = (blockHeight * blockWidth) < 32;
+
+    // Endpoints expanded to UNORM16, so each texel only has to interpolate them
+    std::array<std::array<u32, 4>, 4> endpointLow;
+    std::array<std::array<u32, 4>, 4> endpointHigh;
+    for (u32 partition = 0; partition < nPartitions; partition++) {
+        for (u32 c = 0; c < 4; c++) {
+            endpointLow[partition][c] = ReplicateByteTo16(endpoints[partition][0].Component(c));
+            endpointHigh[partition][c] = ReplicateByteTo16(endpoints[partition][1].Component(c));
+        }
+    }
 
     // Now that we have endpoints and weights, we can interpolate and generate
     // the proper decoding...
-    for (u32 j = 0; j < blockHeight; j++)
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+    if constexpr (UseSIMD) {
+        __m128i low[4];
+        __m128i high[4];
+        for (u32 partition = 0; partition < nPartitions; partition++) {
+            low[partition] =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(endpointLow[partition].data()));
+            high[partition] =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(endpointHigh[partition].data()));
+        }
+        const __m128i lane_index = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i plane_mask =
+            _mm_cmpeq_epi32(lane_index, _mm_set1_epi32(static_cast<s32>(dualPlaneChannel)));
+
+        for (u32 j = 0; j < blockHeight; j++) {
+            for (u32 i = 0; i < blockWidth; i++) {
+                const u32 partition =
+                    nPartitions == 1
+                        ? 0
+                        : Select2DPartition(partitionIndex, i, j, nPartitions, smallBlock);
+                assert(partition < nPartitions);
+
+                const u32 texel = j * blockWidth + i;
+                __m128i weight = _mm_set1_epi32(static_cast<s32>(weights[0][texel]));
+                if (weightParams.m_bDualPlane) {
+                    weight = _mm_blendv_epi8(
+                        weight, _mm_set1_epi32(static_cast<s32>(weights[1][texel])), plane_mask);
+                }
+                outBuf[texel] = InterpolateTexelSIMD(low[partition], high[partition], weight);
+            }
+        }
+        return;
+    }
+#endif
+
+    // Position of each Pixel channel in the packed R8G8B8A8 output
+    static constexpr std::array<u32, 4> CHANNEL_SHIFT{24, 0, 8, 16};
+
+    for (u32 j = 0; j < blockHeight; j++) {
         for (u32 i = 0; i < blockWidth; i++) {
-            u32 partition = Select2DPartition(partitionIndex, i, j, nPartitions,
-                                              (blockHeight * blockWidth) < 32);
+            const u32 partition =
+                nPartitions == 1 ? 0
+                                 : Select2DPartition(partitionIndex, i, j, nPartitions, smallBlock);
             assert(partition < nPartitions);
 
-            Pixel p;
+            const u32 texel = j * blockWidth + i;
+            u32 packed = 0;
             for (u32 c = 0; c < 4; c++) {
-                u32 C0 = endpoints[partition][0].Component(c);
-                C0 = ReplicateByteTo16(C0);
-                u32 C1 = endpoints[partition][1].Component(c);
-                C1 = ReplicateByteTo16(C1);
-
-                u32 plane = 0;
-                if (weightParams.m_bDualPlane && (((planeIdx + 1) & 3) == c)) {
-                    plane = 1;
-                }
+                const u32 C0 = endpointLow[partition][c];
+                const u32 C1 = endpointHigh[partition][c];
+                const u32 weight = weights[c == dualPlaneChannel ? 1 : 0][texel];
+                const u32 C = (C0 * (64 - weight) + C1 * weight + 32) / 64;
 
-                u32 weight = weights[plane][j * blockWidth + i];
-                u32 C = (C0 * (64 - weight) + C1 * weight + 32) / 64;
-                if (C == 65535) {
-                    p.Component(c) = 255;
-                } else {
-                    double Cf = static_cast<double>(C);
-                    p.Component(c) = static_cast<u16>(255.0 * (Cf / 65536.0) + 0.5);
-                }
+                // Same as rounding 255 * C / 65536 to nearest, without going through doubles
+                packed |= ((C * 255 + 32768) >> 16) << CHANNEL_SHIFT[c];
             }
-
-            outBuf[j * blockWidth + i] = p.Pack();
+            outBuf[texel] = packed;
         }
+    }
+}
+
+using BlockDecoder = void (*)(std::span<const u8, 16>, u32, u32, std::span<u32, 12 * 12>);
+
+template <bool UseSIMD>
+static BlockDecoder SelectBlockDecoder(u32 block_width, u32 block_height) {
+    if (block_width == 4 && block_height == 4) {
+        return &DecompressBlock<4, 4, UseSIMD>;
+    }
+    if (block_width == 6 && block_height == 6) {
+        return &DecompressBlock<6, 6, UseSIMD>;
+    }
+    if (block_width == 8 && block_height == 8) {
+        return &DecompressBlock<8, 8, UseSIMD>;
+    }
+    return &DecompressBlock<0, 0, UseSIMD>;
+}
+
+static BlockDecoder SelectBlockDecoder(u32 block_width, u32 block_height, DecodePath path) {
+    if (path == DecodePath::Generic) {
+        return &DecompressBlock<0, 0, false>;
+    }
+#if defined(ARCHITECTURE_x86_64)
+    static const bool has_sse41 = Common::GetCPUCaps().sse4_1;
+    if (has_sse41) {
+        return SelectBlockDecoder<true>(block_width, block_height);
+    }
+#elif defined(ARCHITECTURE_arm64)
+    return SelectBlockDecoder<true>(block_width, block_height);
+#endif
+    return SelectBlockDecoder<false>(block_width, block_height);
 }
 
 void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
-                uint32_t block_width, uint32_t block_height, std::span<uint8_t> output) {
+                uint32_t block_width, uint32_t block_height, std::span<uint8_t> output,
+                DecodePath path) {
     const u32 rows = Common::DivideUp(height, block_height);
     const u32 cols = Common::DivideUp(width, block_width);
-
-    Common::ThreadWorker& workers{GetThreadWorkers()};
-
-    for (u32 z = 0; z < depth; ++z) {
-        const u32 depth_offset = z * height * width * 4;
-        for (u32 y_index = 0; y_index < rows; ++y_index) {
-            auto decompress_stride = [data, width, height, block_width, block_height, output, rows,
-                                      cols, z, depth_offset, y_index] {
+    const BlockDecoder decompress_block = SelectBlockDecoder(block_width, block_height, path);
+
+    // Rows of blocks of every slice are split in ranges, so deep images spread over the pool
+    const u32 total_rows = rows * depth;
+    DecodeBatch batch{GetDecodeWorkers()};
+    const u32 rows_per_task = batch.TaskSize(total_rows);
+
+    for (u32 first_row = 0; first_row < total_rows; first_row += rows_per_task) {
+        const u32 last_row = std::min(first_row + rows_per_task, total_rows);
+        auto decompress_rows = [data, width, height, block_width, block_height, output, rows, cols,
+                                first_row, last_row, decompress_block] {
+            for (u32 row = first_row; row < last_row; ++row) {
+                const u32 z = row / rows;
+                const u32 y_index = row % rows;
+                const u32 depth_offset = z * height * width * 4;
                 const u32 y = y_index * block_height;
                 for (u32 x_index = 0; x_index < cols; ++x_index) {
                     const u32 block_index = (z * rows * cols) + (y_index * cols) + x_index;
@@ -1672,7 +1810,7 @@ void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height,
 
                     // Blocks can be at most 12x12
                     std::array<u32, 12 * 12> uncompData;
-                    DecompressBlock(blockPtr, block_width, block_height, uncompData);
+                    decompress_block(blockPtr, block_width, block_height, uncompData);
 
                     u32 decompWidth = std::min(block_width, width - x);
                     u32 decompHeight = std::min(block_height, height - y);
@@ -1683,11 +1821,11 @@ void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height,
                                     uncompData.data() + h * block_width, decompWidth * 4);
                     }
                 }
-            };
-            workers.QueueWork(std::move(decompress_stride));
-        }
-        workers.WaitForRequests();
+            }
+        };
+        batch.QueueWork(std::move(decompress_rows));
     }
+    batch.WaitForRequests();
 }
 
 } // namespace Tegra::Texture::ASTC
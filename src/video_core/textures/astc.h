@@ -3,9 +3,18 @@
 
 #pragma once
 
+#include <cstdint>
+#include <span>
+
 namespace Tegra::Texture::ASTC {
 
+enum class DecodePath {
+    Fast,    ///< Footprint specialized decoders, vectorized when the host supports it
+    Generic, ///< Portable scalar decoder for any footprint, used as a reference
+};
+
 void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
-                uint32_t block_width, uint32_t block_height, std::span<uint8_t> output);
+                uint32_t block_width, uint32_t block_height, std::span<uint8_t> output,
+                DecodePath path = DecodePath::Fast);
 
 } // namespace Tegra::Texture::ASTC
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <stb_dxt.h>
 #include <string.h>
 #include "common/alignment.h"
@@ -18,11 +19,18 @@ void CompressBCN(std::span<const uint8_t> data, uint32_t width, uint32_t height,
     constexpr u32 bytes_per_px = 4;
     const u32 plane_dim = width * height;
 
-    Common::ThreadWorker& workers{GetThreadWorkers()};
+    const u32 rows = Common::DivideUp(height, 4U);
+    const u32 total_rows = rows * depth;
+    DecodeBatch batch{GetDecodeWorkers()};
+    const u32 rows_per_task = batch.TaskSize(total_rows);
 
-    for (u32 z = 0; z < depth; z++) {
-        for (u32 y = 0; y < height; y += 4) {
-            auto compress_row = [z, y, width, height, plane_dim, f, data, output]() {
+    for (u32 first_row = 0; first_row < total_rows; first_row += rows_per_task) {
+        const u32 last_row = std::min(first_row + rows_per_task, total_rows);
+        auto compress_rows = [first_row, last_row, rows, width, height, plane_dim, f, data,
+                              output]() {
+            for (u32 row = first_row; row < last_row; ++row) {
+                const u32 z = row / rows;
+                const u32 y = (row % rows) * 4;
                 for (u32 x = 0; x < width; x += 4) {
                     // Gather 4x4 block of RGBA texels
                     u8 input_colors[4][4][4];
@@ -54,16 +62,16 @@ void CompressBCN(std::span<const uint8_t> data, uint32_t width, uint32_t height,
                     }
 
                     const u32 bytes_per_row = BytesPerBlock * Common::DivideUp(width, 4U);
-                    const u32 bytes_per_plane = bytes_per_row * Common::DivideUp(height, 4U);
+                    const u32 bytes_per_plane = bytes_per_row * rows;
                     f(output.data() + z * bytes_per_plane + (y / 4) * bytes_per_row +
                           (x / 4) * BytesPerBlock,
                       reinterpret_cast<u8*>(input_colors), any_alpha);
                 }
-            };
-            workers.QueueWork(std::move(compress_row));
-        }
-        workers.WaitForRequests();
+            }
+        };
+        batch.QueueWork(std::move(compress_rows));
     }
+    batch.WaitForRequests();
 }
 
 void CompressBC1(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
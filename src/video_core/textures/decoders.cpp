@@ -33,61 +33,144 @@ void incrpdep(u32& value) {
     value = ((value | ~mask) + swizzled_incr) & mask;
 }
 
-template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
-void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32 height, u32 depth,
-                 u32 block_height, u32 block_depth, u32 stride) {
-    // The origin of the transformation can be configured here, leave it as zero as the current API
-    // doesn't expose it.
-    static constexpr u32 origin_x = 0;
-    static constexpr u32 origin_y = 0;
-    static constexpr u32 origin_z = 0;
-
-    // We can configure here a custom pitch
-    // As it's not exposed 'width * BYTES_PER_PIXEL' will be the expected pitch.
-    const u32 pitch = width * BYTES_PER_PIXEL;
-
+struct BlockLinearLayout {
+    u32 block_size;
+    u32 slice_size;
+    u32 block_height;
+    u32 block_depth;
+    u32 x_shift;
+};
+
+BlockLinearLayout MakeBlockLinearLayout(u32 stride, u32 height, u32 block_height,
+                                        u32 block_depth) {
     const u32 gobs_in_x = Common::DivCeilLog2(stride, GOB_SIZE_X_SHIFT);
     const u32 block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
-    const u32 slice_size =
-        Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size;
+    return BlockLinearLayout{
+        .block_size = block_size,
+        .slice_size = Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size,
+        .block_height = block_height,
+        .block_depth = block_depth,
+        .x_shift = GOB_SIZE_SHIFT + block_height + block_depth,
+    };
+}
+
+/// Returns the offset of the first GOB of the given GOB row within a slice
+u32 GobRowOffset(const BlockLinearLayout& layout, u32 block_y) {
+    const u32 block_height_mask = (1U << layout.block_height) - 1;
+    return (block_y >> layout.block_height) * layout.block_size +
+           ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
+}
 
-    const u32 block_height_mask = (1U << block_height) - 1;
-    const u32 block_depth_mask = (1U << block_depth) - 1;
-    const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
+/// Copies a whole GOB, the swizzled side is contiguous and is walked one 16 byte sector at a time
+template <bool TO_LINEAR>
+void CopyGob(u8* dst, const u8* src, u32 pitch) {
+    static constexpr u32 SECTOR_SIZE = 16;
+    for (u32 sector = 0; sector < GOB_SIZE / SECTOR_SIZE; ++sector) {
+        const u32 x = ((sector >> 4) & 1) * 32 + ((sector >> 1) & 1) * 16;
+        const u32 y = ((sector >> 2) & 3) * 2 + (sector & 1);
+        const u32 swizzled_offset = sector * SECTOR_SIZE;
+        const u32 unswizzled_offset = y * pitch + x;
+        std::memcpy(dst + (TO_LINEAR ? swizzled_offset : unswizzled_offset),
+                    src + (TO_LINEAR ? unswizzled_offset : swizzled_offset), SECTOR_SIZE);
+    }
+}
 
-    for (u32 slice = 0; slice < depth; ++slice) {
-        const u32 z = slice + origin_z;
-        const u32 offset_z = (z >> block_depth) * slice_size +
-                             ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
-        for (u32 line = 0; line < height; ++line) {
-            const u32 y = line + origin_y;
-            const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
+template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
+void SwizzleLine(std::span<u8> output, std::span<const u8> input, const BlockLinearLayout& layout,
+                 u32 offset_z, u32 y, u32 origin_x, u32 column_begin, u32 column_end,
+                 u32 line_offset) {
+    const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
+    const u32 offset_y = GobRowOffset(layout, y >> GOB_SIZE_Y_SHIFT);
 
-            const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
-            const u32 offset_y = (block_y >> block_height) * block_size +
-                                 ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
+    u32 swizzled_x = pdep<SWIZZLE_X_BITS>((origin_x + column_begin) * BYTES_PER_PIXEL);
+    for (u32 column = column_begin; column < column_end;
+         ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
+        const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
+        const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << layout.x_shift;
 
-            u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
-            for (u32 column = 0; column < width;
-                 ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
-                const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
-                const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << x_shift;
+        const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
+        const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
 
-                const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
-                const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
+        const u32 unswizzled_offset = line_offset + column * BYTES_PER_PIXEL;
 
-                const u32 unswizzled_offset =
-                    slice * pitch * height + line * pitch + column * BYTES_PER_PIXEL;
+        u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
+        const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
 
-                u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
-                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
+        std::memcpy(dst, src, BYTES_PER_PIXEL);
+    }
+}
+
+template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
+void SwizzleSlice(std::span<u8> output, std::span<const u8> input, const BlockLinearLayout& layout,
+                  u32 z, u32 origin_x, u32 origin_y, u32 extent_x, u32 num_lines, u32 pitch,
+                  u32 slice_offset) {
+    const u32 block_depth_mask = (1U << layout.block_depth) - 1;
+    const u32 offset_z = (z >> layout.block_depth) * layout.slice_size +
+                         ((z & block_depth_mask) << (GOB_SIZE_SHIFT + layout.block_height));
+
+    // GOBs fully covered by the copy are moved as a whole. Pixels never straddle a sector when
+    // their size divides it, otherwise the whole slice goes through the per pixel path.
+    u32 gob_x_begin = 0;
+    u32 gob_x_end = 0;
+    u32 gob_y_begin = 0;
+    u32 gob_y_end = 0;
+    if constexpr (16 % BYTES_PER_PIXEL == 0) {
+        gob_x_begin = Common::DivCeilLog2(origin_x * BYTES_PER_PIXEL, GOB_SIZE_X_SHIFT);
+        gob_x_end = ((origin_x + extent_x) * BYTES_PER_PIXEL) >> GOB_SIZE_X_SHIFT;
+        gob_y_begin = Common::DivCeilLog2(origin_y, GOB_SIZE_Y_SHIFT);
+        gob_y_end = (origin_y + num_lines) >> GOB_SIZE_Y_SHIFT;
+        if (gob_x_begin >= gob_x_end || gob_y_begin >= gob_y_end) {
+            gob_x_begin = gob_x_end = gob_y_begin = gob_y_end = 0;
+        }
+    }
+    const u32 gob_column_begin = ((gob_x_begin << GOB_SIZE_X_SHIFT) / BYTES_PER_PIXEL) - origin_x;
+    const u32 gob_column_end = ((gob_x_end << GOB_SIZE_X_SHIFT) / BYTES_PER_PIXEL) - origin_x;
+    const u32 gob_line_begin = (gob_y_begin << GOB_SIZE_Y_SHIFT) - origin_y;
+    const u32 gob_line_end = (gob_y_end << GOB_SIZE_Y_SHIFT) - origin_y;
+
+    for (u32 line = 0; line < num_lines; ++line) {
+        const u32 y = line + origin_y;
+        const u32 line_offset = slice_offset + line * pitch;
+        if (gob_x_begin == gob_x_end || line < gob_line_begin || line >= gob_line_end) {
+            SwizzleLine<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z, y, origin_x,
+                                                    0, extent_x, line_offset);
+            continue;
+        }
+        SwizzleLine<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z, y, origin_x, 0,
+                                                gob_column_begin, line_offset);
+        SwizzleLine<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z, y, origin_x,
+                                                gob_column_end, extent_x, line_offset);
+    }
 
-                std::memcpy(dst, src, BYTES_PER_PIXEL);
-            }
+    for (u32 gob_y = gob_y_begin; gob_y < gob_y_end; ++gob_y) {
+        const u32 offset_y = GobRowOffset(layout, gob_y);
+        const u32 line_offset = slice_offset + ((gob_y << GOB_SIZE_Y_SHIFT) - origin_y) * pitch -
+                                origin_x * BYTES_PER_PIXEL;
+        for (u32 gob_x = gob_x_begin; gob_x < gob_x_end; ++gob_x) {
+            const u32 swizzled_offset = offset_z + offset_y + (gob_x << layout.x_shift);
+            const u32 unswizzled_offset = line_offset + (gob_x << GOB_SIZE_X_SHIFT);
+            u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
+            const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
+            CopyGob<TO_LINEAR>(dst, src, pitch);
         }
     }
 }
 
+template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
+void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32 height, u32 depth,
+                 u32 block_height, u32 block_depth, u32 stride) {
+    // We can configure here a custom pitch
+    // As it's not exposed 'width * BYTES_PER_PIXEL' will be the expected pitch.
+    const u32 pitch = width * BYTES_PER_PIXEL;
+    const BlockLinearLayout layout =
+        MakeBlockLinearLayout(stride, height, block_height, block_depth);
+
+    for (u32 slice = 0; slice < depth; ++slice) {
+        SwizzleSlice<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, slice, 0, 0, width, height,
+                                                 pitch, slice * pitch * height);
+    }
+}
+
 template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
 void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32 height,
                         u32 depth, u32 origin_x, u32 origin_y, u32 extent_x, u32 num_lines,
@@ -96,54 +179,20 @@ void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 wid
     // doesn't expose it.
     static constexpr u32 origin_z = 0;
 
-    // We can configure here a custom pitch
-    // As it's not exposed 'width * BYTES_PER_PIXEL' will be the expected pitch.
     const u32 pitch = pitch_linear;
     const u32 stride = Common::AlignUpLog2(width * BYTES_PER_PIXEL, GOB_SIZE_X_SHIFT);
-
-    const u32 gobs_in_x = Common::DivCeilLog2(stride, GOB_SIZE_X_SHIFT);
-    const u32 block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
-    const u32 slice_size =
-        Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size;
-
-    const u32 block_height_mask = (1U << block_height) - 1;
-    const u32 block_depth_mask = (1U << block_depth) - 1;
-    const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
+    const BlockLinearLayout layout =
+        MakeBlockLinearLayout(stride, height, block_height, block_depth);
 
     u32 unprocessed_lines = num_lines;
     u32 extent_y = std::min(num_lines, height - origin_y);
 
     for (u32 slice = 0; slice < depth; ++slice) {
         const u32 z = slice + origin_z;
-        const u32 offset_z = (z >> block_depth) * slice_size +
-                             ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
         const u32 lines_in_y = std::min(unprocessed_lines, extent_y);
-        for (u32 line = 0; line < lines_in_y; ++line) {
-            const u32 y = line + origin_y;
-            const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
-
-            const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
-            const u32 offset_y = (block_y >> block_height) * block_size +
-                                 ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
-
-            u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
-            for (u32 column = 0; column < extent_x;
-                 ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
-                const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
-                const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << x_shift;
-
-                const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
-                const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
-
-                const u32 unswizzled_offset =
-                    slice * pitch * height + line * pitch + column * BYTES_PER_PIXEL;
-
-                u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
-                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
-
-                std::memcpy(dst, src, BYTES_PER_PIXEL);
-            }
-        }
+        SwizzleSlice<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, z, origin_x, origin_y,
+                                                 extent_x, lines_in_y, pitch,
+                                                 slice * pitch * height);
         unprocessed_lines -= lines_in_y;
         if (unprocessed_lines == 0) {
             return;
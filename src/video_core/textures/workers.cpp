@@ -1,14 +1,148 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "common/div_ceil.h"
+#include "common/thread.h"
 #include "video_core/textures/workers.h"
 
 namespace Tegra::Texture {
 
-Common::ThreadWorker& GetThreadWorkers() {
-    static Common::ThreadWorker workers{std::max(std::thread::hardware_concurrency(), 2U) / 2,
-                                        "ImageTranscode"};
+namespace {
+// Tasks queued per worker when a range is split, leaves room for stealing without tiny tasks
+constexpr u32 TASKS_PER_WORKER = 4;
+
+thread_local DecodePriority current_priority = DecodePriority::High;
+} // Anonymous namespace
+
+DecodeWorkers::DecodeWorkers(size_t num_workers) {
+    queues.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    threads.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        threads.emplace_back([this, i](std::stop_token stop_token) { WorkerLoop(stop_token, i); });
+    }
+}
+
+DecodeWorkers::~DecodeWorkers() {
+    for (auto& thread : threads) {
+        thread.request_stop();
+    }
+    threads.clear();
+}
+
+void DecodeWorkers::Push(Task task, DecodePriority priority) {
+    const size_t index = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    WorkerQueue& queue = *queues[index];
+    {
+        std::scoped_lock lock{queue.mutex};
+        queue.tasks[static_cast<size_t>(priority)].push_back(std::move(task));
+    }
+    {
+        std::scoped_lock lock{sleep_mutex};
+        ++num_queued;
+    }
+    condition.notify_one();
+}
+
+bool DecodeWorkers::TryPop(size_t worker_index, DecodePriority lowest_priority, Task& task) {
+    if (num_queued.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    const size_t num_queues = queues.size();
+    for (size_t priority = 0; priority <= static_cast<size_t>(lowest_priority); ++priority) {
+        for (size_t offset = 0; offset < num_queues; ++offset) {
+            WorkerQueue& queue = *queues[(worker_index + offset) % num_queues];
+            std::scoped_lock lock{queue.mutex};
+            auto& tasks = queue.tasks[priority];
+            if (tasks.empty()) {
+                continue;
+            }
+            // Owners take the oldest task, thieves the newest one to keep contention low
+            if (offset == 0) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            } else {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+            --num_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void DecodeWorkers::WorkerLoop(std::stop_token stop_token, size_t worker_index) {
+    Common::SetCurrentThreadName("ImageTranscode");
+    while (!stop_token.stop_requested()) {
+        Task task;
+        if (TryPop(worker_index, DecodePriority::Background, task)) {
+            task.func();
+            task.batch->Complete();
+            continue;
+        }
+        std::unique_lock lock{sleep_mutex};
+        Common::CondvarWait(condition, lock, stop_token, [this] { return num_queued > 0; });
+    }
+}
+
+DecodeBatch::DecodeBatch(DecodeWorkers& pool_) : DecodeBatch(pool_, current_priority) {}
+
+DecodeBatch::DecodeBatch(DecodeWorkers& pool_, DecodePriority priority_)
+    : pool{pool_}, priority{priority_} {}
+
+DecodeBatch::~DecodeBatch() {
+    WaitForRequests();
+}
+
+void DecodeBatch::QueueWork(Common::UniqueFunction<void> work) {
+    ++pending;
+    pool.Push(DecodeWorkers::Task{std::move(work), this}, priority);
+}
+
+void DecodeBatch::WaitForRequests() {
+    // Help with the queued work instead of idling, without picking up lower priority tasks
+    const size_t worker_index = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    while (pending.load(std::memory_order_acquire) != 0) {
+        DecodeWorkers::Task task;
+        if (!pool.TryPop(worker_index, priority, task)) {
+            break;
+        }
+        task.func();
+        task.batch->Complete();
+    }
+    std::unique_lock lock{mutex};
+    condition.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+u32 DecodeBatch::TaskSize(u32 count) const noexcept {
+    const u32 num_tasks = static_cast<u32>(pool.NumWorkers()) * TASKS_PER_WORKER;
+    return std::max(Common::DivCeil(count, num_tasks), 1U);
+}
+
+void DecodeBatch::Complete() {
+    // Decrement under the lock, the batch may be destroyed as soon as the waiter observes zero
+    std::scoped_lock lock{mutex};
+    if (--pending == 0) {
+        condition.notify_all();
+    }
+}
+
+ScopedDecodePriority::ScopedDecodePriority(DecodePriority priority)
+    : previous{std::exchange(current_priority, priority)} {}
+
+ScopedDecodePriority::~ScopedDecodePriority() {
+    current_priority = previous;
+}
 
+DecodeWorkers& GetDecodeWorkers() {
+    static DecodeWorkers workers{std::max(std::thread::hardware_concurrency(), 2U) / 2};
     return workers;
 }
 
@@ -3,10 +3,122 @@
 
 #pragma once
 
-#include "common/thread_worker.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
 
 namespace Tegra::Texture {
 
-Common::ThreadWorker& GetThreadWorkers();
+/// Scheduling class of texture decode work, lower values run first
+enum class DecodePriority : u32 {
+    High,       ///< Images needed to render the current draw
+    Background, ///< Asynchronously streamed images
+};
+constexpr size_t NUM_DECODE_PRIORITIES = 2;
+
+class DecodeBatch;
+
+/**
+ * Thread pool shared by the CPU texture decoders.
+ *
+ * Every worker owns a queue per priority, idle workers steal from the others. High priority
+ * work queued anywhere in the pool runs before any background work.
+ */
+class DecodeWorkers {
+public:
+    explicit DecodeWorkers(size_t num_workers);
+    ~DecodeWorkers();
+
+    DecodeWorkers(const DecodeWorkers&) = delete;
+    DecodeWorkers& operator=(const DecodeWorkers&) = delete;
+
+    /// Returns the number of worker threads
+    [[nodiscard]] size_t NumWorkers() const noexcept {
+        return queues.size();
+    }
+
+private:
+    friend class DecodeBatch;
+
+    struct Task {
+        Common::UniqueFunction<void> func;
+        DecodeBatch* batch;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::array<std::deque<Task>, NUM_DECODE_PRIORITIES> tasks;
+    };
+
+    void Push(Task task, DecodePriority priority);
+
+    /// Pops a task from the given worker queue, stealing from the others when it is empty
+    bool TryPop(size_t worker_index, DecodePriority lowest_priority, Task& task);
+
+    void WorkerLoop(std::stop_token stop_token, size_t worker_index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<size_t> next_queue{};
+    std::atomic<size_t> num_queued{};
+    std::mutex sleep_mutex;
+    std::condition_variable_any condition;
+    std::vector<std::jthread> threads;
+};
+
+/**
+ * Group of decode tasks that is waited on independently from other users of the pool.
+ * The waiting thread executes queued tasks instead of idling.
+ */
+class DecodeBatch {
+public:
+    explicit DecodeBatch(DecodeWorkers& pool);
+    explicit DecodeBatch(DecodeWorkers& pool, DecodePriority priority);
+    ~DecodeBatch();
+
+    DecodeBatch(const DecodeBatch&) = delete;
+    DecodeBatch& operator=(const DecodeBatch&) = delete;
+
+    void QueueWork(Common::UniqueFunction<void> work);
+
+    void WaitForRequests();
+
+    /// Returns how many items of a range each task should process to spread it over the pool
+    [[nodiscard]] u32 TaskSize(u32 count) const noexcept;
+
+private:
+    friend class DecodeWorkers;
+
+    void Complete();
+
+    DecodeWorkers& pool;
+    DecodePriority priority;
+    std::atomic<size_t> pending{};
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+/// Sets the priority of the decodes started from this thread for the lifetime of the object
+class ScopedDecodePriority {
+public:
+    explicit ScopedDecodePriority(DecodePriority priority);
+    ~ScopedDecodePriority();
+
+    ScopedDecodePriority(const ScopedDecodePriority&) = delete;
+    ScopedDecodePriority& operator=(const ScopedDecodePriority&) = delete;
+
+private:
+    DecodePriority previous;
+};
+
+DecodeWorkers& GetDecodeWorkers();
 
-}
+} // namespace Tegra::Texture
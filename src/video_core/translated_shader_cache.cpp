@@ -0,0 +1,370 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <bitset>
+#include <cstring>
+#include <ios>
+#include <map>
+#include <type_traits>
+
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "video_core/translated_shader_cache.h"
+
+namespace VideoCommon {
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC_NUMBER{'s', 'u', 'y', 'u', 's', 'h', 'd', 'r'};
+
+/// Bump when the fields of Shader::Info or the layout of an entry change
+constexpr u32 FORMAT_VERSION = 1;
+
+struct FileHeader {
+    std::array<char, 8> magic;
+    u32 format_version;
+    u32 cache_version;
+    u64 host_hash;
+};
+static_assert(std::has_unique_object_representations_v<FileHeader>);
+
+struct RecordHeader {
+    u64 record_hash;
+    u32 compressed_size;
+    u32 uncompressed_size;
+};
+static_assert(std::has_unique_object_representations_v<RecordHeader>);
+
+template <typename T>
+struct IsBitset : std::false_type {};
+
+template <size_t N>
+struct IsBitset<std::bitset<N>> : std::true_type {};
+
+template <typename T>
+struct IsMap : std::false_type {};
+
+template <typename Key, typename Value>
+struct IsMap<std::map<Key, Value>> : std::true_type {};
+
+/// Contiguous containers of trivially copyable elements, stored as a size and the raw elements
+template <typename T>
+concept Sequence = requires(T& container) {
+    container.resize(size_t{});
+    container.data();
+} && std::is_trivially_copyable_v<typename T::value_type>;
+
+class Writer {
+public:
+    explicit Writer(std::vector<u8>& out_) : out{out_} {}
+
+    template <typename... Ts>
+    void operator()(const Ts&... values) {
+        (Field(values), ...);
+    }
+
+private:
+    template <typename T>
+    void Field(const T& value) {
+        if constexpr (IsBitset<T>::value) {
+            for (size_t word = 0; word < (value.size() + 63) / 64; ++word) {
+                u64 bits{};
+                for (size_t bit = 0; bit < 64 && word * 64 + bit < value.size(); ++bit) {
+                    bits |= static_cast<u64>(value[word * 64 + bit]) << bit;
+                }
+                Bytes(&bits, sizeof(bits));
+            }
+        } else if constexpr (std::is_same_v<T, Shader::VaryingState>) {
+            Field(value.mask);
+        } else if constexpr (IsMap<T>::value) {
+            Field(static_cast<u32>(value.size()));
+            for (const auto& [key, mapped] : value) {
+                Field(key);
+                Field(mapped);
+            }
+        } else if constexpr (Sequence<T>) {
+            Field(static_cast<u32>(value.size()));
+            Bytes(value.data(), value.size() * sizeof(typename T::value_type));
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Bytes(&value, sizeof(value));
+        }
+    }
+
+    void Bytes(const void* data, size_t size) {
+        const u8* const bytes{static_cast<const u8*>(data)};
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    std::vector<u8>& out;
+};
+
+class Reader {
+public:
+    explicit Reader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename... Ts>
+    void operator()(Ts&... values) {
+        (Field(values), ...);
+    }
+
+    [[nodiscard]] bool AtEnd() const noexcept {
+        return offset == data.size();
+    }
+
+private:
+    template <typename T>
+    void Field(T& value) {
+        if constexpr (IsBitset<T>::value) {
+            for (size_t word = 0; word < (value.size() + 63) / 64; ++word) {
+                u64 bits{};
+                Bytes(&bits, sizeof(bits));
+                for (size_t bit = 0; bit < 64 && word * 64 + bit < value.size(); ++bit) {
+                    value[word * 64 + bit] = ((bits >> bit) & 1) != 0;
+                }
+            }
+        } else if constexpr (std::is_same_v<T, Shader::VaryingState>) {
+            Field(value.mask);
+        } else if constexpr (IsMap<T>::value) {
+            u32 size{};
+            Field(size);
+            value.clear();
+            for (u32 i = 0; i < size; ++i) {
+                typename T::key_type key{};
+                typename T::mapped_type mapped{};
+                Field(key);
+                Field(mapped);
+                value.emplace(key, mapped);
+            }
+        } else if constexpr (Sequence<T>) {
+            u32 size{};
+            Field(size);
+            const size_t element_size{sizeof(typename T::value_type)};
+            if (size > value.max_size() || size > (data.size() - offset) / element_size) {
+                throw std::ios_base::failure("Invalid sequence size");
+            }
+            value.resize(size);
+            Bytes(value.data(), size * element_size);
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Bytes(&value, sizeof(value));
+        }
+    }
+
+    void Bytes(void* out, size_t size) {
+        if (data.size() - offset < size) {
+            throw std::ios_base::failure("Unexpected end of data");
+        }
+        std::memcpy(out, data.data() + offset, size);
+        offset += size;
+    }
+
+    std::span<const u8> data;
+    size_t offset{};
+};
+
+/// Calls the archive with every field of the info, shared by the writer and the reader
+template <typename Archive, typename InfoType>
+void VisitInfo(Archive& ar, InfoType& info) {
+    ar(info.uses_workgroup_id, info.uses_local_invocation_id, info.uses_invocation_id,
+       info.uses_invocation_info, info.uses_sample_id, info.uses_is_helper_invocation,
+       info.uses_subgroup_invocation_id, info.uses_subgroup_shuffles, info.uses_patches);
+    ar(info.interpolation, info.loads, info.stores, info.passthrough, info.legacy_stores_mapping);
+    ar(info.loads_indexed_attributes, info.stores_frag_color, info.stores_sample_mask,
+       info.stores_frag_depth, info.stores_tess_level_outer, info.stores_tess_level_inner,
+       info.stores_indexed_attributes, info.stores_global_memory, info.uses_local_memory);
+    ar(info.uses_fp16, info.uses_fp64, info.uses_fp16_denorms_flush,
+       info.uses_fp16_denorms_preserve, info.uses_fp32_denorms_flush,
+       info.uses_fp32_denorms_preserve, info.uses_int8, info.uses_int16, info.uses_int64,
+       info.uses_image_1d, info.uses_sampled_1d, info.uses_sparse_residency,
+       info.uses_demote_to_helper_invocation, info.uses_subgroup_vote, info.uses_subgroup_mask,
+       info.uses_fswzadd, info.uses_derivatives, info.uses_typeless_image_reads,
+       info.uses_typeless_image_writes, info.uses_image_buffers, info.uses_shared_increment,
+       info.uses_shared_decrement, info.uses_global_increment, info.uses_global_decrement);
+    ar(info.uses_atomic_f32_add, info.uses_atomic_f16x2_add, info.uses_atomic_f16x2_min,
+       info.uses_atomic_f16x2_max, info.uses_atomic_f32x2_add, info.uses_atomic_f32x2_min,
+       info.uses_atomic_f32x2_max, info.uses_atomic_s32_min, info.uses_atomic_s32_max,
+       info.uses_int64_bit_atomics, info.uses_global_memory, info.uses_atomic_image_u32,
+       info.uses_shadow_lod, info.uses_rescaling_uniform, info.uses_cbuf_indirect,
+       info.uses_render_area);
+    ar(info.used_constant_buffer_types, info.used_storage_buffer_types,
+       info.used_indirect_cbuf_types);
+    ar(info.constant_buffer_mask, info.constant_buffer_used_sizes, info.nvn_buffer_base,
+       info.nvn_buffer_used, info.requires_layer_emulation, info.emulated_layer,
+       info.used_clip_distances);
+    ar(info.constant_buffer_descriptors, info.storage_buffers_descriptors,
+       info.texture_buffer_descriptors, info.image_buffer_descriptors, info.texture_descriptors,
+       info.image_descriptors);
+}
+
+} // Anonymous namespace
+
+std::vector<u8> EncodeTranslatedStages(std::span<const TranslatedStage> stages) {
+    std::vector<u8> data;
+    Writer writer{data};
+    writer(static_cast<u32>(stages.size()));
+    for (const TranslatedStage& stage : stages) {
+        writer(stage.index);
+        VisitInfo(writer, stage.info);
+        writer(stage.code);
+    }
+    return data;
+}
+
+std::optional<std::vector<TranslatedStage>> DecodeTranslatedStages(
+    std::span<const u8> data) try {
+    Reader reader{data};
+    u32 num_stages{};
+    reader(num_stages);
+
+    std::vector<TranslatedStage> stages;
+    for (u32 i = 0; i < num_stages && !reader.AtEnd(); ++i) {
+        TranslatedStage& stage{stages.emplace_back()};
+        reader(stage.index);
+        VisitInfo(reader, stage.info);
+        reader(stage.code);
+    }
+    if (stages.size() != num_stages || !reader.AtEnd()) {
+        return std::nullopt;
+    }
+    return stages;
+
+} catch (const std::ios_base::failure&) {
+    return std::nullopt;
+}
+
+TranslatedShaderCache::TranslatedShaderCache() = default;
+
+TranslatedShaderCache::~TranslatedShaderCache() = default;
+
+void TranslatedShaderCache::Open(const std::filesystem::path& path, u32 cache_version,
+                                 u64 host_hash) {
+    filename = path;
+
+    size_t valid_size = 0;
+    bool is_valid = false;
+    if (Common::FS::Exists(filename) && mapped_file.Open(filename)) {
+        const std::span<const u8> data = mapped_file.Data();
+        FileHeader header;
+        if (data.size() >= sizeof(header)) {
+            std::memcpy(&header, data.data(), sizeof(header));
+            is_valid = header.magic == MAGIC_NUMBER && header.format_version == FORMAT_VERSION &&
+                       header.cache_version == cache_version && header.host_hash == host_hash;
+        }
+        if (is_valid) {
+            size_t offset = sizeof(header);
+            while (data.size() - offset >= sizeof(RecordHeader)) {
+                RecordHeader record;
+                std::memcpy(&record, data.data() + offset, sizeof(record));
+                const size_t payload_offset = offset + sizeof(record);
+                if (record.compressed_size > data.size() - payload_offset) {
+                    break;
+                }
+                entries.try_emplace(record.record_hash,
+                                    Entry{
+                                        .offset = payload_offset,
+                                        .compressed_size = record.compressed_size,
+                                        .uncompressed_size = record.uncompressed_size,
+                                    });
+                offset = payload_offset + record.compressed_size;
+            }
+            valid_size = offset;
+        }
+    }
+
+    if (mapped_file.IsOpen() && (!is_valid || valid_size != mapped_file.Size())) {
+        LOG_INFO(Render, "Discarding {} of the translated shader cache",
+                 is_valid ? "the corrupted tail" : "the outdated contents");
+        // The mapping has to go before the file can be resized or removed
+        entries.clear();
+        mapped_file.Close();
+        std::error_code ec;
+        if (is_valid) {
+            std::filesystem::resize_file(filename, valid_size, ec);
+            if (!ec) {
+                Open(filename, cache_version, host_hash);
+                return;
+            }
+        }
+        std::filesystem::remove(filename, ec);
+        valid_size = 0;
+    }
+
+    file.Open(filename, Common::FS::FileAccessMode::Append, Common::FS::FileType::BinaryFile);
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open translated shader cache at {}",
+                  Common::FS::PathToUTF8String(filename));
+        return;
+    }
+    if (valid_size == 0) {
+        const FileHeader header{
+            .magic = MAGIC_NUMBER,
+            .format_version = FORMAT_VERSION,
+            .cache_version = cache_version,
+            .host_hash = host_hash,
+        };
+        if (!file.WriteObject(header)) {
+            LOG_ERROR(Common_Filesystem, "Failed to write translated shader cache header");
+            file.Close();
+            return;
+        }
+        file.Flush();
+    }
+
+    LOG_INFO(Render, "Loaded {} translated pipelines from disk", entries.size());
+    is_open.store(true, std::memory_order_release);
+}
+
+std::optional<std::vector<TranslatedStage>> TranslatedShaderCache::Find(u64 record_hash) const {
+    if (!IsOpen()) {
+        return std::nullopt;
+    }
+    const auto it = entries.find(record_hash);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    const Entry& entry = it->second;
+    const std::vector<u8> payload{Common::Compression::DecompressDataZSTD(
+        mapped_file.Data().subspan(entry.offset, entry.compressed_size))};
+    std::optional<std::vector<TranslatedStage>> stages;
+    if (payload.size() == entry.uncompressed_size) {
+        stages = DecodeTranslatedStages(payload);
+    }
+    if (!stages) {
+        LOG_ERROR(Render, "Corrupt translated shader cache entry at offset {:#x}", entry.offset);
+    }
+    return stages;
+}
+
+void TranslatedShaderCache::Store(u64 record_hash, std::span<const TranslatedStage> stages) {
+    if (!IsOpen() || stages.empty() || entries.contains(record_hash)) {
+        return;
+    }
+    const std::vector<u8> payload{EncodeTranslatedStages(stages)};
+    const std::vector<u8> compressed{
+        Common::Compression::CompressDataZSTDDefault(payload.data(), payload.size())};
+    if (compressed.empty()) {
+        LOG_ERROR(Render, "Failed to compress translated shader cache entry");
+        return;
+    }
+    const RecordHeader header{
+        .record_hash = record_hash,
+        .compressed_size = static_cast<u32>(compressed.size()),
+        .uncompressed_size = static_cast<u32>(payload.size()),
+    };
+
+    std::scoped_lock lock{file_mutex};
+    if (!stored_hashes.insert(record_hash).second) {
+        return;
+    }
+    if (!file.WriteObject(header) ||
+        file.WriteSpan(std::span<const u8>(compressed)) != compressed.size()) {
+        LOG_ERROR(Common_Filesystem, "Failed to write translated shader cache entry");
+    }
+    file.Flush();
+}
+
+} // namespace VideoCommon
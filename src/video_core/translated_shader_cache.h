@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/fs/mapped_file.h"
+#include "shader_recompiler/shader_info.h"
+
+namespace VideoCommon {
+
+/// Host code emitted for a shader stage and the resources it uses
+struct TranslatedStage {
+    u32 index{};
+    Shader::Info info;
+    std::vector<u32> code;
+};
+
+/**
+ * Persistent cache of the host shaders emitted for the pipelines of the pipeline cache.
+ *
+ * Entries are keyed by the hash of the pipeline record they were translated from, a hit skips
+ * decoding the guest environments, translating and emitting the shaders. Emitted code depends on
+ * the build, the driver and a few settings, the file is discarded when any of them changes.
+ */
+class TranslatedShaderCache {
+public:
+    TranslatedShaderCache();
+    ~TranslatedShaderCache();
+
+    TranslatedShaderCache(const TranslatedShaderCache&) = delete;
+    TranslatedShaderCache& operator=(const TranslatedShaderCache&) = delete;
+
+    /// Maps the cache file, entries written with a different cache version or host are dropped
+    void Open(const std::filesystem::path& path, u32 cache_version, u64 host_hash);
+
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return is_open.load(std::memory_order_acquire);
+    }
+
+    /// Returns the stages stored for a pipeline record, std::nullopt on a miss or a corrupt entry
+    [[nodiscard]] std::optional<std::vector<TranslatedStage>> Find(u64 record_hash) const;
+
+    /// Appends the stages of a pipeline record, they are visible on the next boot. Thread safe.
+    void Store(u64 record_hash, std::span<const TranslatedStage> stages);
+
+private:
+    struct Entry {
+        size_t offset;
+        u32 compressed_size;
+        u32 uncompressed_size;
+    };
+
+    std::filesystem::path filename;
+    Common::FS::MappedFile mapped_file;
+    std::unordered_map<u64, Entry> entries;
+    std::atomic<bool> is_open{};
+
+    std::mutex file_mutex;
+    std::unordered_set<u64> stored_hashes;
+    Common::FS::IOFile file;
+};
+
+/// Encodes the stages of a pipeline in the format stored by TranslatedShaderCache
+[[nodiscard]] std::vector<u8> EncodeTranslatedStages(std::span<const TranslatedStage> stages);
+
+/// Decodes stages encoded with EncodeTranslatedStages, std::nullopt when the data is corrupt
+[[nodiscard]] std::optional<std::vector<TranslatedStage>> DecodeTranslatedStages(
+    std::span<const u8> data);
+
+} // namespace VideoCommon
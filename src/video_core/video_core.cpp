@@ -30,7 +30,8 @@ std::unique_ptr<VideoCore::RendererBase> CreateRenderer(
         return std::make_unique<Vulkan::RendererVulkan>(telemetry_session, emu_window,
                                                         device_memory, gpu, std::move(context));
     case Settings::RendererBackend::Null:
-        return std::make_unique<Null::RendererNull>(emu_window, gpu, std::move(context));
+        return std::make_unique<Null::RendererNull>(emu_window, device_memory, gpu,
+                                                    std::move(context));
     default:
         return nullptr;
     }